@@ -451,8 +451,8 @@ int main ( int argc, char **argv )
 		return 1;
 	}
 
-	// Have another instance running?
-	if (app.setup()) {
+	// Have another instance running? (headless ones don't care)
+	if (!options.bHeadless && app.setup()) {
 		app.quit();
 		return 2;
 	}
@@ -493,7 +493,8 @@ int main ( int argc, char **argv )
 	// Construct, setup and show the main form.
 	QSampler::MainForm w;
 	w.setup(&options);
-	w.show();
+	if (!options.bHeadless)
+		w.show();
 
 	// Settle this one as application main widget...
 	app.setMainWidget(&w);
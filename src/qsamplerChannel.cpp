@@ -26,6 +26,10 @@
 
 #include "qsamplerMainForm.h"
 #include "qsamplerChannelForm.h"
+#include "qsamplerInstrumentCache.h"
+#include "qsamplerLoadScheduler.h"
+#include "qsamplerServerCaps.h"
+#include "qsamplerServerCall.h"
 
 #include <QFileInfo>
 #include <QComboBox>
@@ -68,6 +72,8 @@ Channel::Channel ( int iChannelID )
 	m_fVolume           = 0.0f;
 	m_bMute             = false;
 	m_bSolo             = false;
+	m_bCritical         = false;
+	m_bInfoChanged      = false;
 }
 
 // Default destructor.
@@ -87,8 +93,12 @@ bool Channel::addChannel (void)
 
 	// Are we a new channel?
 	if (m_iChannelID < 0) {
+		ServerCall call(pMainForm->client(), ServerCall::Interactive);
+		if (!call.isValid())
+			return false;
 		m_iChannelID = ::lscp_add_channel(pMainForm->client());
 		if (m_iChannelID < 0) {
+			call.check();
 			appendMessagesClient("lscp_add_channel");
 			appendMessagesError(
 				QObject::tr("Could not add channel.\n\nSorry."));
@@ -112,7 +122,12 @@ bool Channel::removeChannel (void)
 
 	// Are we an existing channel?
 	if (m_iChannelID >= 0) {
+		ServerCall call(pMainForm->client(), ServerCall::Interactive);
+		if (!call.isValid())
+			return false;
+
 		if (::lscp_remove_channel(pMainForm->client(), m_iChannelID) != LSCP_OK) {
+			call.check();
 			appendMessagesClient("lscp_remove_channel");
 			appendMessagesError(QObject::tr("Could not remove channel.\n\nSorry."));
 		} else {
@@ -162,8 +177,13 @@ bool Channel::loadEngine ( const QString& sEngineName )
 	if (m_iInstrumentStatus == 100 && m_sEngineName == sEngineName)
 		return true;
 
+	ServerCall call(pMainForm->client(), ServerCall::Interactive);
+	if (!call.isValid())
+		return false;
+
 	if (::lscp_load_engine(pMainForm->client(),
 			sEngineName.toUtf8().constData(), m_iChannelID) != LSCP_OK) {
+		call.check();
 		appendMessagesClient("lscp_load_engine");
 		return false;
 	}
@@ -214,12 +234,26 @@ bool Channel::loadInstrument ( const QString& sInstrumentFile, int iInstrumentNr
 		&& m_iInstrumentNr == iInstrumentNr)
 		return true;
 
+	// Hold it back while disk streaming is struggling...
+	LoadScheduler *pLoadScheduler = LoadScheduler::getInstance();
+	if (pLoadScheduler && pLoadScheduler->deferLoad(
+			m_iChannelID, sInstrumentFile, iInstrumentNr)) {
+		appendMessages(QObject::tr("Instrument: \"%1\" (%2) queued.")
+			.arg(sInstrumentFile).arg(iInstrumentNr));
+		return true;
+	}
+
+	ServerCall call(pMainForm->client(), ServerCall::Interactive);
+	if (!call.isValid())
+		return false;
+
 	if (::lscp_load_instrument_non_modal(
 			pMainForm->client(),
 			qsamplerUtilities::lscpEscapePath(
 				sInstrumentFile).toUtf8().constData(),
 			iInstrumentNr, m_iChannelID
 		) != LSCP_OK) {
+		call.check();
 		appendMessagesClient("lscp_load_instrument");
 		return false;
 	}
@@ -231,16 +265,50 @@ bool Channel::loadInstrument ( const QString& sInstrumentFile, int iInstrumentNr
 }
 
 
+// Forced instrument file reloader (eg. changed on disk).
+bool Channel::reloadInstrument (void)
+{
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL)
+		return false;
+	if (pMainForm->client() == NULL || m_iChannelID < 0)
+		return false;
+	if (m_sInstrumentFile.isEmpty() || m_iInstrumentNr < 0)
+		return false;
+
+	ServerCall call(pMainForm->client(), ServerCall::Interactive);
+	if (!call.isValid())
+		return false;
+
+	if (::lscp_load_instrument_non_modal(
+			pMainForm->client(),
+			qsamplerUtilities::lscpEscapePath(
+				m_sInstrumentFile).toUtf8().constData(),
+			m_iInstrumentNr, m_iChannelID
+		) != LSCP_OK) {
+		call.check();
+		appendMessagesClient("lscp_load_instrument");
+		return false;
+	}
+
+	appendMessages(QObject::tr("Instrument: \"%1\" (%2) reloaded.")
+		.arg(m_sInstrumentFile).arg(m_iInstrumentNr));
+
+	return setInstrument(m_sInstrumentFile, m_iInstrumentNr);
+}
+
+
 // Special instrument file/name/number settler.
 bool Channel::setInstrument ( const QString& sInstrumentFile, int iInstrumentNr )
 {
 	m_sInstrumentFile = sInstrumentFile;
 	m_iInstrumentNr = iInstrumentNr;
 #ifdef CONFIG_INSTRUMENT_NAME
-	m_sInstrumentName = QString::null;  // We'll get it, maybe later, on channel_info...
-#else
-	m_sInstrumentName = getInstrumentName(sInstrumentFile, iInstrumentNr, true);
+	if (ServerCaps::supports(ServerCaps::InstrumentName))
+		m_sInstrumentName = QString::null;  // We'll get it, maybe later, on channel_info...
+	else
 #endif
+	m_sInstrumentName = getInstrumentName(sInstrumentFile, iInstrumentNr, true);
 	m_iInstrumentStatus = 0;
 
 	return true;
@@ -263,8 +331,13 @@ bool Channel::setMidiDriver ( const QString& sMidiDriver )
 	if (m_iInstrumentStatus == 100 && m_sMidiDriver == sMidiDriver)
 		return true;
 
+	ServerCall call(pMainForm->client(), ServerCall::Interactive);
+	if (!call.isValid())
+		return false;
+
 	if (::lscp_set_channel_midi_type(pMainForm->client(),
 			m_iChannelID, sMidiDriver.toUtf8().constData()) != LSCP_OK) {
+		call.check();
 		appendMessagesClient("lscp_set_channel_midi_type");
 		return false;
 	}
@@ -292,7 +365,12 @@ bool Channel::setMidiDevice ( int iMidiDevice )
 	if (m_iInstrumentStatus == 100 && m_iMidiDevice == iMidiDevice)
 		return true;
 
+	ServerCall call(pMainForm->client(), ServerCall::Interactive);
+	if (!call.isValid())
+		return false;
+
 	if (::lscp_set_channel_midi_device(pMainForm->client(), m_iChannelID, iMidiDevice) != LSCP_OK) {
+		call.check();
 		appendMessagesClient("lscp_set_channel_midi_device");
 		return false;
 	}
@@ -320,7 +398,12 @@ bool Channel::setMidiPort ( int iMidiPort )
 	if (m_iInstrumentStatus == 100 && m_iMidiPort == iMidiPort)
 		return true;
 
+	ServerCall call(pMainForm->client(), ServerCall::Interactive);
+	if (!call.isValid())
+		return false;
+
 	if (::lscp_set_channel_midi_port(pMainForm->client(), m_iChannelID, iMidiPort) != LSCP_OK) {
+		call.check();
 		appendMessagesClient("lscp_set_channel_midi_port");
 		return false;
 	}
@@ -348,7 +431,12 @@ bool Channel::setMidiChannel ( int iMidiChannel )
 	if (m_iInstrumentStatus == 100 && m_iMidiChannel == iMidiChannel)
 		return true;
 
+	ServerCall call(pMainForm->client(), ServerCall::Interactive);
+	if (!call.isValid())
+		return false;
+
 	if (::lscp_set_channel_midi_channel(pMainForm->client(), m_iChannelID, iMidiChannel) != LSCP_OK) {
+		call.check();
 		appendMessagesClient("lscp_set_channel_midi_channel");
 		return false;
 	}
@@ -376,7 +464,12 @@ bool Channel::setMidiMap ( int iMidiMap )
 	if (m_iInstrumentStatus == 100 && m_iMidiMap == iMidiMap)
 		return true;
 #ifdef CONFIG_MIDI_INSTRUMENT
+	ServerCall call(pMainForm->client(), ServerCall::Interactive);
+	if (!call.isValid())
+		return false;
+
 	if (::lscp_set_channel_midi_map(pMainForm->client(), m_iChannelID, iMidiMap) != LSCP_OK) {
+		call.check();
 		appendMessagesClient("lscp_set_channel_midi_map");
 		return false;
 	}
@@ -404,7 +497,12 @@ bool Channel::setAudioDevice ( int iAudioDevice )
 	if (m_iInstrumentStatus == 100 && m_iAudioDevice == iAudioDevice)
 		return true;
 
+	ServerCall call(pMainForm->client(), ServerCall::Interactive);
+	if (!call.isValid())
+		return false;
+
 	if (::lscp_set_channel_audio_device(pMainForm->client(), m_iChannelID, iAudioDevice) != LSCP_OK) {
+		call.check();
 		appendMessagesClient("lscp_set_channel_audio_device");
 		return false;
 	}
@@ -432,8 +530,13 @@ bool Channel::setAudioDriver ( const QString& sAudioDriver )
 	if (m_iInstrumentStatus == 100 && m_sAudioDriver == sAudioDriver)
 		return true;
 
+	ServerCall call(pMainForm->client(), ServerCall::Interactive);
+	if (!call.isValid())
+		return false;
+
 	if (::lscp_set_channel_audio_type(pMainForm->client(),
 			m_iChannelID, sAudioDriver.toUtf8().constData()) != LSCP_OK) {
+		call.check();
 		appendMessagesClient("lscp_set_channel_audio_type");
 		return false;
 	}
@@ -461,7 +564,12 @@ bool Channel::setVolume ( float fVolume )
 	if (m_iInstrumentStatus == 100 && m_fVolume == fVolume)
 		return true;
 
+	ServerCall call(pMainForm->client(), ServerCall::Interactive);
+	if (!call.isValid())
+		return false;
+
 	if (::lscp_set_channel_volume(pMainForm->client(), m_iChannelID, fVolume) != LSCP_OK) {
+		call.check();
 		appendMessagesClient("lscp_set_channel_volume");
 		return false;
 	}
@@ -490,7 +598,14 @@ bool Channel::setChannelMute ( bool bMute )
 		return true;
 
 #ifdef CONFIG_MUTE_SOLO
+	if (!ServerCaps::supports(ServerCaps::MuteSolo))
+		return false;
+	ServerCall call(pMainForm->client(), ServerCall::Interactive);
+	if (!call.isValid())
+		return false;
+
 	if (::lscp_set_channel_mute(pMainForm->client(), m_iChannelID, bMute) != LSCP_OK) {
+		call.check();
 		appendMessagesClient("lscp_set_channel_mute");
 		return false;
 	}
@@ -520,7 +635,14 @@ bool Channel::setChannelSolo ( bool bSolo )
 		return true;
 
 #ifdef CONFIG_MUTE_SOLO
+	if (!ServerCaps::supports(ServerCaps::MuteSolo))
+		return false;
+	ServerCall call(pMainForm->client(), ServerCall::Interactive);
+	if (!call.isValid())
+		return false;
+
 	if (::lscp_set_channel_solo(pMainForm->client(), m_iChannelID, bSolo) != LSCP_OK) {
+		call.check();
 		appendMessagesClient("lscp_set_channel_solo");
 		return false;
 	}
@@ -533,6 +655,18 @@ bool Channel::setChannelSolo ( bool bSolo )
 }
 
 
+// Sampler channel restore priority (client-side only).
+bool Channel::isCritical (void) const
+{
+	return m_bCritical;
+}
+
+void Channel::setCritical ( bool bCritical )
+{
+	m_bCritical = bCritical;
+}
+
+
 // Audio routing accessors.
 int Channel::audioChannel ( int iAudioOut ) const
 {
@@ -550,8 +684,13 @@ bool Channel::setAudioChannel ( int iAudioOut, int iAudioIn )
 			m_audioRouting[iAudioOut] == iAudioIn)
 		return true;
 
+	ServerCall call(pMainForm->client(), ServerCall::Interactive);
+	if (!call.isValid())
+		return false;
+
 	if (::lscp_set_channel_audio_channel(pMainForm->client(),
 			m_iChannelID, iAudioOut, iAudioIn) != LSCP_OK) {
+		call.check();
 		appendMessagesClient("lscp_set_channel_audio_channel");
 		return false;
 	}
@@ -573,10 +712,15 @@ const ChannelRoutingMap& Channel::audioRouting (void) const
 // Istrument name remapper.
 void Channel::updateInstrumentName (void)
 {
-#ifndef CONFIG_INSTRUMENT_NAME
-	m_sInstrumentName = getInstrumentName(m_sInstrumentFile,
-		m_iInstrumentNr, (options() && options()->bInstrumentNames));
+#ifdef CONFIG_INSTRUMENT_NAME
+	// The server tells it already?
+	if (ServerCaps::supports(ServerCaps::InstrumentName))
+		return;
 #endif
+	MainForm *pMainForm = MainForm::getInstance();
+	Options *pOptions = (pMainForm ? pMainForm->options() : NULL);
+	m_sInstrumentName = getInstrumentName(m_sInstrumentFile,
+		m_iInstrumentNr, (pOptions && pOptions->bInstrumentNames));
 }
 
 
@@ -589,22 +733,30 @@ bool Channel::updateChannelInfo (void)
 	if (pMainForm->client() == NULL || m_iChannelID < 0)
 		return false;
 
+	ServerCall call(pMainForm->client(), ServerCall::Interactive);
+	if (!call.isValid())
+		return false;
+
 	// Read channel information.
 	lscp_channel_info_t *pChannelInfo = ::lscp_get_channel_info(pMainForm->client(), m_iChannelID);
 	if (pChannelInfo == NULL) {
+		call.check();
 		appendMessagesClient("lscp_get_channel_info");
 		appendMessagesError(QObject::tr("Could not get channel information.\n\nSorry."));
 		return false;
 	}
 
 #ifdef CONFIG_INSTRUMENT_NAME
-	// We got all actual instrument datum...
-	m_sInstrumentFile =
-		qsamplerUtilities::lscpEscapedPathToPosix(pChannelInfo->instrument_file);
-	m_iInstrumentNr   = pChannelInfo->instrument_nr;
-	m_sInstrumentName =
-		qsamplerUtilities::lscpEscapedTextToRaw(pChannelInfo->instrument_name);
-#else
+	if (ServerCaps::supports(ServerCaps::InstrumentName)) {
+		// We got all actual instrument datum...
+		m_sInstrumentFile =
+			qsamplerUtilities::lscpEscapedPathToPosix(pChannelInfo->instrument_file);
+		m_iInstrumentNr   = pChannelInfo->instrument_nr;
+		m_sInstrumentName =
+			qsamplerUtilities::lscpEscapedTextToRaw(pChannelInfo->instrument_name);
+	}
+	else
+#endif
 	// First, check if intrument name has changed,
 	// taking care that instrument name lookup might be expensive,
 	// so we better make it only once and when really needed...
@@ -614,7 +766,6 @@ bool Channel::updateChannelInfo (void)
 		m_iInstrumentNr   = pChannelInfo->instrument_nr;
 		updateInstrumentName();
 	}
-#endif
 	// Cache in other channel information.
 	m_sEngineName       = pChannelInfo->engine_name;
 	m_iInstrumentStatus = pChannelInfo->instrument_status;
@@ -642,16 +793,20 @@ bool Channel::updateChannelInfo (void)
 	lscp_device_info_t *pDeviceInfo;
 	const QString sNone = QObject::tr("(none)");
 	// Audio device driver type.
-	pDeviceInfo = ::lscp_get_audio_device_info(pMainForm->client(), m_iAudioDevice);
+	pDeviceInfo = (call.isValid() ? ::lscp_get_audio_device_info(
+		pMainForm->client(), m_iAudioDevice) : NULL);
 	if (pDeviceInfo == NULL) {
+		call.check();
 		appendMessagesClient("lscp_get_audio_device_info");
 		m_sAudioDriver = sNone;
 	} else {
 		m_sAudioDriver = pDeviceInfo->driver;
 	}
 	// MIDI device driver type.
-	pDeviceInfo = ::lscp_get_midi_device_info(pMainForm->client(), m_iMidiDevice);
+	pDeviceInfo = (call.isValid() ? ::lscp_get_midi_device_info(
+		pMainForm->client(), m_iMidiDevice) : NULL);
 	if (pDeviceInfo == NULL) {
+		call.check();
 		appendMessagesClient("lscp_get_midi_device_info");
 		m_sMidiDriver = sNone;
 	} else {
@@ -670,10 +825,43 @@ bool Channel::updateChannelInfo (void)
 		m_audioRouting[i] = ::atoi(ppszAudioRouting[i]);
 #endif
 
+	// Anything new, setup-wise?
+	const QString& sInfoState = infoState();
+	m_bInfoChanged = (sInfoState != m_sInfoState);
+	m_sInfoState = sInfoState;
+
 	return true;
 }
 
 
+// Whether the last channel info update brought any change.
+bool Channel::isInfoChanged (void) const
+{
+	return m_bInfoChanged;
+}
+
+
+// Channel setup state signature.
+QString Channel::infoState (void) const
+{
+	QStringList state;
+	state << m_sEngineName << m_sInstrumentFile
+		<< QString::number(m_iInstrumentNr)
+		<< m_sMidiDriver << QString::number(m_iMidiDevice)
+		<< QString::number(m_iMidiPort) << QString::number(m_iMidiChannel)
+		<< QString::number(m_iMidiMap)
+		<< m_sAudioDriver << QString::number(m_iAudioDevice)
+		<< QString::number(m_fVolume)
+		<< QString::number(int(m_bMute)) << QString::number(int(m_bSolo));
+
+	ChannelRoutingMap::ConstIterator iter = m_audioRouting.constBegin();
+	for ( ; iter != m_audioRouting.constEnd(); ++iter)
+		state << QString::number(iter.key()) + '>' + QString::number(iter.value());
+
+	return state.join(",");
+}
+
+
 // Reset channel method.
 bool Channel::channelReset (void)
 {
@@ -683,7 +871,12 @@ bool Channel::channelReset (void)
 	if (pMainForm->client() == NULL || m_iChannelID < 0)
 		return false;
 
+	ServerCall call(pMainForm->client(), ServerCall::Interactive);
+	if (!call.isValid())
+		return false;
+
 	if (::lscp_reset_channel(pMainForm->client(), m_iChannelID) != LSCP_OK) {
+		call.check();
 		appendMessagesClient("lscp_reset_channel");
 		return false;
 	}
@@ -705,8 +898,13 @@ bool Channel::editChannel (void)
 	if (pMainForm->client() == NULL || m_iChannelID < 0)
 		return false;
 
+	ServerCall call(pMainForm->client(), ServerCall::Interactive);
+	if (!call.isValid())
+		return false;
+
 	if (::lscp_edit_channel_instrument(pMainForm->client(), m_iChannelID)
 		!= LSCP_OK) {
+		call.check();
 		appendMessagesClient("lscp_edit_channel_instrument");
 		appendMessagesError(QObject::tr(
 			"Could not launch an appropriate instrument editor "
@@ -844,66 +1042,103 @@ bool Channel::isSf2InstrumentFile ( const QString& sInstrumentFile )
 }
 
 
+// Read the instrument names of a local instrument file (.gig);
+// no caches involved, so that it may be called from any thread.
+QStringList Channel::readInstrumentList ( const QString& sInstrumentFile )
+{
+	QStringList instlist;
+
+#ifdef CONFIG_LIBGIG
+	if (isDlsInstrumentFile(sInstrumentFile)) {
+		RIFF::File *pRiff
+			= new RIFF::File(sInstrumentFile.toUtf8().constData());
+		gig::File *pGig = new gig::File(pRiff);
+	#ifdef CONFIG_LIBGIG_SETAUTOLOAD
+		// prevent sleepy response time on large .gig files
+		pGig->SetAutoLoad(false);
+	#endif
+		gig::Instrument *pInstrument = pGig->GetFirstInstrument();
+		while (pInstrument) {
+			instlist.append((pInstrument->pInfo)->Name.c_str());
+			pInstrument = pGig->GetNextInstrument();
+		}
+		delete pGig;
+		delete pRiff;
+	}
+#ifdef CONFIG_LIBGIG_SF2
+	else
+	if (isSf2InstrumentFile(sInstrumentFile)) {
+		const QString& sFileName = QFileInfo(sInstrumentFile).fileName();
+		RIFF::File *pRiff
+			= new RIFF::File(sInstrumentFile.toUtf8().constData());
+		sf2::File *pSf2 = new sf2::File(pRiff);
+		const int iPresetCount = pSf2->GetPresetCount();
+		for (int iIndex = 0; iIndex < iPresetCount; ++iIndex) {
+			sf2::Preset *pPreset = pSf2->GetPreset(iIndex);
+			if (pPreset) {
+				instlist.append(pPreset->Name.c_str());
+			} else {
+				instlist.append(sFileName
+					+ " [" + QString::number(iIndex) + "]");
+			}
+		}
+		delete pSf2;
+		delete pRiff;
+	}
+#endif
+#else
+	Q_UNUSED(sInstrumentFile);
+#endif
+
+	return instlist;
+}
+
+
 // Retrieve the instrument list of a instrument file (.gig).
 QStringList Channel::getInstrumentList (
 	const QString& sInstrumentFile,	bool bInstrumentNames )
 {
 	QStringList instlist;
 
+	// Already known and still fresh?
+	InstrumentCache *pInstrumentCache = InstrumentCache::getInstance();
+	if (pInstrumentCache && pInstrumentCache->lookup(
+			sInstrumentFile, bInstrumentNames, instlist))
+		return instlist;
+
 	const QFileInfo fi(sInstrumentFile);
+
+	// Remote instrument files are enumerated by the server
+	// (asynchronously); meanwhile, go with the usual placeholders...
+	if (pInstrumentCache
+		&& InstrumentCache::isServerInstrumentFile(sInstrumentFile)) {
+		pInstrumentCache->request(sInstrumentFile, bInstrumentNames);
+		for (int iIndex = 0; iIndex < QSAMPLER_INSTRUMENT_MAX; ++iIndex) {
+			instlist.append(fi.fileName()
+				+ " [" + QString::number(iIndex) + "]");
+		}
+		return instlist;
+	}
+
 	if (!fi.exists()) {
 		instlist.append(noInstrumentName());
 		return instlist;
 	}
 
-#ifdef CONFIG_LIBGIG
-	if (bInstrumentNames) {
-		if (isDlsInstrumentFile(sInstrumentFile)) {
-			RIFF::File *pRiff
-				= new RIFF::File(sInstrumentFile.toUtf8().constData());
-			gig::File *pGig = new gig::File(pRiff);
-		#ifdef CONFIG_LIBGIG_SETAUTOLOAD
-			// prevent sleepy response time on large .gig files
-			pGig->SetAutoLoad(false);
-		#endif
-			gig::Instrument *pInstrument = pGig->GetFirstInstrument();
-			while (pInstrument) {
-				instlist.append((pInstrument->pInfo)->Name.c_str());
-				pInstrument = pGig->GetNextInstrument();
-			}
-			delete pGig;
-			delete pRiff;
-		}
-	#ifdef CONFIG_LIBGIG_SF2
-		else
-		if (isSf2InstrumentFile(sInstrumentFile)) {
-			RIFF::File *pRiff
-				= new RIFF::File(sInstrumentFile.toUtf8().constData());
-			sf2::File *pSf2 = new sf2::File(pRiff);
-			const int iPresetCount = pSf2->GetPresetCount();
-			for (int iIndex = 0; iIndex < iPresetCount; ++iIndex) {
-				sf2::Preset *pPreset = pSf2->GetPreset(iIndex);
-				if (pPreset) {
-					instlist.append(pPreset->Name.c_str());
-				} else {
-					instlist.append(fi.fileName()
-						+ " [" + QString::number(iIndex) + "]");
-				}
-			}
-			delete pSf2;
-			delete pRiff;
-		}
-	#endif
-	}
-#endif
+	if (bInstrumentNames)
+		instlist = readInstrumentList(sInstrumentFile);
 
 	if (instlist.isEmpty()) {
 		for (int iIndex = 0; iIndex < QSAMPLER_INSTRUMENT_MAX; ++iIndex) {
 			instlist.append(fi.fileName()
 				+ " [" + QString::number(iIndex) + "]");
 		}
+		bInstrumentNames = false;
 	}
 
+	if (pInstrumentCache)
+		pInstrumentCache->insert(sInstrumentFile, bInstrumentNames, instlist);
+
 	return instlist;
 }
 
@@ -913,13 +1148,35 @@ QString Channel::getInstrumentName (
 	const QString& sInstrumentFile, int iInstrumentNr, bool bInstrumentNames )
 {
 	const QFileInfo fi(sInstrumentFile);
-	if (!fi.exists())
-		return noInstrumentName();
+	bool bLocal = fi.exists();
 
 	QString sInstrumentName;
 
+	// Already known (or else remote)?
+	InstrumentCache *pInstrumentCache = InstrumentCache::getInstance();
+	if (pInstrumentCache) {
+		QStringList instlist;
+		if (pInstrumentCache->lookup(
+				sInstrumentFile, bInstrumentNames, instlist)) {
+			if (iInstrumentNr >= 0 && iInstrumentNr < instlist.count())
+				sInstrumentName = instlist.at(iInstrumentNr);
+			bLocal = false;
+		}
+		else
+		if (InstrumentCache::isServerInstrumentFile(sInstrumentFile)) {
+			pInstrumentCache->request(sInstrumentFile, bInstrumentNames);
+			bLocal = false;
+		}
+		else
+		if (!bLocal)
+			return noInstrumentName();
+	}
+	else
+	if (!bLocal)
+		return noInstrumentName();
+
 #ifdef CONFIG_LIBGIG
-	if (bInstrumentNames) {
+	if (bInstrumentNames && bLocal) {
 		if (isDlsInstrumentFile(sInstrumentFile)) {
 			RIFF::File *pRiff
 				= new RIFF::File(sInstrumentFile.toUtf8().constData());
@@ -30,6 +30,7 @@
 #include <lscp/device.h>
 
 #include "qsamplerOptions.h"
+#include "qsamplerResources.h"
 
 namespace QSampler {
 
@@ -75,6 +76,8 @@ public:
 
 	// Instrument file loader.
 	bool     loadInstrument(const QString& sInstrumentFile, int iInstrumentNr);
+	// Forced instrument file reloader (eg. changed on disk).
+	bool     reloadInstrument();
 	// Special instrument file/name/number settler.
 	bool     setInstrument(const QString& sInstrumentFile, int iInstrumentNr);
 
@@ -118,6 +121,10 @@ public:
 	bool     channelSolo() const;
 	bool     setChannelSolo(bool bSolo);
 
+	// Sampler channel restore priority (client-side only).
+	bool     isCritical() const;
+	void     setCritical(bool bCritical);
+
 	// Audio routing accessors.
 	int      audioChannel(int iAudioOut) const;
 	bool     setAudioChannel(int iAudioOut, int iAudioIn);
@@ -130,6 +137,10 @@ public:
 	// Channel info structure map executive.
 	bool     updateChannelInfo();
 
+	// Whether the last channel info update brought any change
+	// to the channel setup proper (ie. not just its load status).
+	bool     isInfoChanged() const;
+
 	// Channel setup dialog form.
 	bool     channelSetup(QWidget *pParent);
 
@@ -158,12 +169,20 @@ public:
 	static bool isDlsInstrumentFile (const QString& sInstrumentFile);
 	static bool isSf2InstrumentFile (const QString& sInstrumentFile);
 
+	// Read the instrument names of a local instrument file (thread-safe).
+	static QStringList readInstrumentList(const QString& sInstrumentFile);
+
 	// Retrieve the available instrument name(s) of an instrument file (.gig).
 	static QString getInstrumentName (const QString& sInstrumentFile,
 							int iInstrumentNr, bool bInstrumentNames);
 	static QStringList getInstrumentList (const QString& sInstrumentFile,
 							bool bInstrumentNames);
 
+protected:
+
+	// Channel setup state signature.
+	QString infoState() const;
+
 private:
 
 	// Unique channel identifier.
@@ -185,9 +204,17 @@ private:
 	float   m_fVolume;
 	bool    m_bMute;
 	bool    m_bSolo;
+	bool    m_bCritical;
 
 	// The audio routing mapping.
 	ChannelRoutingMap m_audioRouting;
+
+	// Channel setup state, as of last channel info update.
+	QString m_sInfoState;
+	bool    m_bInfoChanged;
+
+	// Live object accounting.
+	ResourceCount<Resources::Channels> m_resourceCount;
 };
 
 
@@ -27,6 +27,7 @@
 
 #include "qsamplerMainForm.h"
 #include "qsamplerInstrument.h"
+#include "qsamplerInstrumentCache.h"
 
 #include <QValidator>
 #include <QMessageBox>
@@ -132,6 +133,13 @@ ChannelForm::ChannelForm ( QWidget* pParent )
 	QObject::connect(&m_routingModel,
 		SIGNAL(modelReset()),
 		SLOT(updateTableCellRenderers()));
+
+	InstrumentCache *pInstrumentCache = InstrumentCache::getInstance();
+	if (pInstrumentCache) {
+		QObject::connect(pInstrumentCache,
+			SIGNAL(instrumentListChanged(const QString&)),
+			SLOT(instrumentListChanged(const QString&)));
+	}
 }
 
 ChannelForm::~ChannelForm()
@@ -528,6 +536,21 @@ void ChannelForm::updateInstrumentName (void)
 }
 
 
+// Instrument file list arrival (server-side enumeration).
+void ChannelForm::instrumentListChanged ( const QString& sInstrumentFile )
+{
+	if (m_ui.InstrumentFileComboBox->currentText() != sInstrumentFile)
+		return;
+
+	// Keep current selection, while refreshing names...
+	const int iInstrumentNr = m_ui.InstrumentNrComboBox->currentIndex();
+	m_iDirtySetup++;
+	updateInstrumentName();
+	m_ui.InstrumentNrComboBox->setCurrentIndex(iInstrumentNr);
+	m_iDirtySetup--;
+}
+
+
 // Show device options dialog.
 void ChannelForm::setupDevice ( Device *pDevice,
 	Device::DeviceType deviceTypeMode,
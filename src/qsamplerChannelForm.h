@@ -62,6 +62,7 @@ protected slots:
 	void reject();
 	void openInstrumentFile();
 	void updateInstrumentName();
+	void instrumentListChanged(const QString& sInstrumentFile);
 	void selectMidiDriver(const QString& sMidiDriver);
 	void selectMidiDevice(int iMidiItem);
 	void setupMidiDevice();
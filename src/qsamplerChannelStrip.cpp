@@ -24,6 +24,10 @@
 #include "qsamplerChannelStrip.h"
 
 #include "qsamplerMainForm.h"
+#include "qsamplerStorageForm.h"
+#include "qsamplerDevice.h"
+#include "qsamplerServerCaps.h"
+#include "qsamplerServerCall.h"
 
 #include "qsamplerChannelFxForm.h"
 
@@ -78,6 +82,11 @@ ChannelStrip::ChannelStrip ( QWidget* pParent, Qt::WindowFlags wflags )
 	m_pChannel     = NULL;
 	m_iDirtyChange = 0;
 	m_iErrorCount  = 0;
+	m_iAudioDevice = -1;
+	m_iPeakVoiceCount  = 0;
+	m_iPeakStreamCount = 0;
+	m_iStreamCount = 0;
+	m_iStreamUsage = -1;
 	m_instrumentListPopupMenu = NULL;
 
 	if (++g_iMidiActivityRefCount == 1) {
@@ -87,9 +96,8 @@ ChannelStrip::ChannelStrip ( QWidget* pParent, Qt::WindowFlags wflags )
 
 	m_ui.MidiActivityLabel->setPixmap(*g_pMidiActivityLedOff);
 
-#ifndef CONFIG_EVENT_CHANNEL_MIDI
-	m_ui.MidiActivityLabel->setToolTip("MIDI activity (disabled)");
-#endif
+	if (!ServerCaps::supports(ServerCaps::ChannelMidiEvents))
+		m_ui.MidiActivityLabel->setToolTip("MIDI activity (disabled)");
 
 	m_pMidiActivityTimer = new QTimer(this);
 	m_pMidiActivityTimer->setSingleShot(true);
@@ -287,8 +295,11 @@ bool ChannelStrip::channelSetup (void)
 	// Invoke the channel setup dialog.
 	bool bResult = m_pChannel->channelSetup(this);
 	// Notify that this channel has changed.
-	if (bResult)
+	if (bResult) {
+		// Audio device settings may have changed as well...
+		m_iAudioDevice = -1;
 		emit channelChanged(this);
+	}
 
 	return bResult;
 }
@@ -346,6 +357,12 @@ bool ChannelStrip::channelFxEdit (void)
 	bool bResult = false;
 
 #if CONFIG_FXSEND
+	if (!ServerCaps::supports(ServerCaps::FxSends)) {
+		QMessageBox::critical(this,
+			QSAMPLER_TITLE ": " + tr("Unavailable"),
+				tr("Sorry, the connected server has no FX send support!"));
+		return false;
+	}
 	ChannelFxForm *pChannelFxForm =
 		new ChannelFxForm(channel(), parentWidget());
 	if (pChannelFxForm) {
@@ -508,6 +525,18 @@ bool ChannelStrip::updateChannelInfo (void)
 			' ' + m_pChannel->engineName());
 	}
 
+	// Audio device output latency (only when it's changed)...
+	const int iAudioDevice = m_pChannel->audioDevice();
+	if (iAudioDevice != m_iAudioDevice) {
+		m_iAudioDevice = iAudioDevice;
+		QString sToolTip;
+		if (iAudioDevice >= 0) {
+			const Device device(Device::Audio, iAudioDevice);
+			sToolTip = device.deviceName() + '\n' + device.latencyText();
+		}
+		m_ui.ChannelInfoFrame->setToolTip(sToolTip);
+	}
+
 	// Instrument name...
 	updateInstrumentName(false);
 
@@ -543,6 +572,10 @@ bool ChannelStrip::updateChannelInfo (void)
 	m_iErrorCount = 0;
 
 #ifdef CONFIG_MUTE_SOLO
+	// Mute/Solo, if the server is up to it...
+	const bool bMuteSolo = ServerCaps::supports(ServerCaps::MuteSolo);
+	m_ui.ChannelMutePushButton->setEnabled(bMuteSolo);
+	m_ui.ChannelSoloPushButton->setEnabled(bMuteSolo);
 	// Mute/Solo button state coloring...
 	bool bMute = m_pChannel->channelMute();
 	const QColor& rgbButton = pal.color(QPalette::Button);
@@ -579,7 +612,16 @@ bool ChannelStrip::updateChannelUsage (void)
 		return false;
 
 	// This only makes sense on fully loaded channels...
-	if (m_pChannel->instrumentStatus() < 100)
+	if (m_pChannel->instrumentStatus() < 100) {
+		m_iStreamCount = 0;
+		m_iStreamUsage = -1;
+		m_streamUsageTime.start();
+		return false;
+	}
+
+	// Usage polling is background work...
+	ServerCall call(pMainForm->client(), ServerCall::Background);
+	if (!call.isValid())
 		return false;
 
 	// Get current channel voice count.
@@ -593,12 +635,32 @@ bool ChannelStrip::updateChannelUsage (void)
 	// of the least filled buffer stream...
 	int iStreamUsage = ::lscp_get_channel_stream_usage(
 		pMainForm->client(), m_pChannel->channelID());;
+	if (!call.check())
+		return false;
+
+	// Remember the peaks...
+	if (m_iPeakVoiceCount < iVoiceCount)
+		m_iPeakVoiceCount = iVoiceCount;
+	if (m_iPeakStreamCount < iStreamCount)
+		m_iPeakStreamCount = iStreamCount;
+
+	// And the latest, for the load scheduler to peek at...
+	m_iStreamCount = iStreamCount;
+	m_iStreamUsage = iStreamUsage;
+	m_streamUsageTime.start();
 
 	// Update the GUI elements...
 	m_ui.StreamUsageProgressBar->setValue(iStreamUsage);
 	m_ui.StreamVoiceCountTextLabel->setText(
 		QString("%1 / %2").arg(iStreamCount).arg(iVoiceCount));
 
+	// Keep the storage advisor posted...
+	StorageForm *pStorageForm = pMainForm->storageForm();
+	if (pStorageForm) {
+		pStorageForm->usageArrived(
+			m_pChannel->instrumentFile(), iStreamCount, iStreamUsage);
+	}
+
 	// We're clean.
 	return true;
 }
@@ -658,6 +720,35 @@ void ChannelStrip::resetErrorCount (void)
 }
 
 
+// Peak voice/stream counts seen so far.
+int ChannelStrip::peakVoiceCount (void) const
+{
+	return m_iPeakVoiceCount;
+}
+
+int ChannelStrip::peakStreamCount (void) const
+{
+	return m_iPeakStreamCount;
+}
+
+
+// Last polled stream count and buffer usage.
+int ChannelStrip::streamCount (void) const
+{
+	return m_iStreamCount;
+}
+
+int ChannelStrip::streamUsage (void) const
+{
+	return m_iStreamUsage;
+}
+
+qint64 ChannelStrip::streamUsageAge (void) const
+{
+	return (m_streamUsageTime.isValid() ? m_streamUsageTime.elapsed() : -1);
+}
+
+
 // Channel strip activation/selection.
 void ChannelStrip::setSelected ( bool bSelected )
 {
@@ -27,6 +27,8 @@
 
 #include "qsamplerChannel.h"
 
+#include <QElapsedTimer>
+
 class QDragEnterEvent;
 class QTimer;
 class QMenu;
@@ -65,6 +67,16 @@ public:
 
 	void resetErrorCount();
 
+	// Peak voice/stream counts seen so far.
+	int peakVoiceCount() const;
+	int peakStreamCount() const;
+
+	// Last polled stream count and buffer usage (percent),
+	// and how long ago these were polled (msecs; -1 if never).
+	int streamCount() const;
+	int streamUsage() const;
+	qint64 streamUsageAge() const;
+
 	// Channel strip activation/selection.
 	void setSelected(bool bSelected);
 	bool isSelected() const;
@@ -103,6 +115,12 @@ private:
 	Channel *m_pChannel;
 	int m_iDirtyChange;
 	int m_iErrorCount;
+	int m_iAudioDevice;
+	int m_iPeakVoiceCount;
+	int m_iPeakStreamCount;
+	int m_iStreamCount;
+	int m_iStreamUsage;
+	QElapsedTimer m_streamUsageTime;
 	QMenu* m_instrumentListPopupMenu;
 
 	QTimer  *m_pMidiActivityTimer;
@@ -114,6 +132,9 @@ private:
 
 	// Channel strip activation/selection.
 	static ChannelStrip *g_pSelectedStrip;
+
+	// Live object accounting.
+	ResourceCount<Resources::ChannelStrips> m_resourceCount;
 };
 
 } // namespace QSampler
@@ -0,0 +1,604 @@
+// qsamplerChannelTemplate.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerChannelTemplate.h"
+
+#include "qsamplerChannel.h"
+#include "qsamplerFxSend.h"
+#include "qsamplerUtilities.h"
+#include "qsamplerServerCaps.h"
+
+#include <QSettings>
+
+
+namespace QSampler {
+
+// Settings group where all templates are kept.
+#define QSAMPLER_CHANNEL_TEMPLATES  "/ChannelTemplates"
+
+
+// Routing map to/from settings (as "src:dst" pairs).
+static QStringList channelTemplateRouting ( const QMap<int, int>& routing )
+{
+	QStringList list;
+	QMap<int, int>::ConstIterator iter = routing.constBegin();
+	for ( ; iter != routing.constEnd(); ++iter)
+		list.append(QString("%1:%2").arg(iter.key()).arg(iter.value()));
+	return list;
+}
+
+static QMap<int, int> channelTemplateRouting ( const QStringList& list )
+{
+	QMap<int, int> routing;
+	QStringListIterator iter(list);
+	while (iter.hasNext()) {
+		const QString& sRoute = iter.next();
+		routing.insert(
+			sRoute.section(':', 0, 0).toInt(),
+			sRoute.section(':', 1, 1).toInt());
+	}
+	return routing;
+}
+
+
+// Device parameters to/from settings (as "key=value" pairs).
+static QStringList channelTemplateParams ( const QMap<QString, QString>& params )
+{
+	QStringList list;
+	QMap<QString, QString>::ConstIterator iter = params.constBegin();
+	for ( ; iter != params.constEnd(); ++iter)
+		list.append(iter.key() + '=' + iter.value());
+	return list;
+}
+
+static QMap<QString, QString> channelTemplateParams ( const QStringList& list )
+{
+	QMap<QString, QString> params;
+	QStringListIterator iter(list);
+	while (iter.hasNext()) {
+		const QString& sParam = iter.next();
+		params.insert(
+			sParam.section('=', 0, 0),
+			sParam.section('=', 1));
+	}
+	return params;
+}
+
+
+// Live device driver name and parameters.
+static QString channelTemplateDeviceInfo ( lscp_client_t *pClient,
+	bool bMidi, int iDeviceID, QMap<QString, QString>& params )
+{
+	lscp_device_info_t *pDeviceInfo = (bMidi
+		? ::lscp_get_midi_device_info(pClient, iDeviceID)
+		: ::lscp_get_audio_device_info(pClient, iDeviceID));
+	if (pDeviceInfo == NULL)
+		return QString();
+
+	for (int i = 0; pDeviceInfo->params && pDeviceInfo->params[i].key; ++i) {
+		params.insert(QString(pDeviceInfo->params[i].key).toUpper(),
+			QString(pDeviceInfo->params[i].value));
+	}
+
+	return pDeviceInfo->driver;
+}
+
+
+// Best current device for a driver and its parameters: the one
+// with all the same parameters, otherwise the first one of the
+// same driver; -1 when there's none.
+static int channelTemplateFindDevice ( lscp_client_t *pClient, bool bMidi,
+	const QString& sDriver, const QMap<QString, QString>& params,
+	QMap<QString, QString> *pDeviceParams )
+{
+	if (sDriver.isEmpty())
+		return -1;
+
+	// Take a copy, as the client result buffer gets reused...
+	const int *piDevices = (bMidi
+		? ::lscp_list_midi_devices(pClient)
+		: ::lscp_list_audio_devices(pClient));
+	QList<int> devices;
+	for (int i = 0; piDevices && piDevices[i] >= 0; ++i)
+		devices.append(piDevices[i]);
+
+	int iDeviceID = -1;
+	QListIterator<int> iter(devices);
+	while (iter.hasNext()) {
+		const int iDevice = iter.next();
+		QMap<QString, QString> device;
+		if (channelTemplateDeviceInfo(pClient, bMidi, iDevice, device)
+				.compare(sDriver, Qt::CaseInsensitive))
+			continue;
+		bool bMatch = true;
+		QMap<QString, QString>::ConstIterator param = params.constBegin();
+		for ( ; bMatch && param != params.constEnd(); ++param)
+			bMatch = (device.value(param.key()) == param.value());
+		if (bMatch || iDeviceID < 0) {
+			iDeviceID = iDevice;
+			if (pDeviceParams)
+				*pDeviceParams = device;
+		}
+		if (bMatch)
+			break;
+	}
+
+	return iDeviceID;
+}
+
+
+//-------------------------------------------------------------------------
+// QSampler::ChannelTemplate - named sampler channel setup.
+//
+
+// Constructor.
+ChannelTemplate::ChannelTemplate ( const QString& sName )
+	: m_iInstrumentNr(0), m_iMidiPort(0),
+		m_iMidiChannel(LSCP_MIDI_CHANNEL_ALL), m_bMidiMap(false),
+		m_fVolume(1.0f)
+{
+	setName(sName);
+}
+
+
+// Template name.
+const QString& ChannelTemplate::name (void) const
+{
+	return m_sName;
+}
+
+void ChannelTemplate::setName ( const QString& sName )
+{
+	// Names are settings keys too...
+	m_sName = sName.simplified();
+	m_sName.replace('/', '-');
+	m_sName.replace('\\', '-');
+}
+
+
+// Take all settings from a live sampler channel (FX sends included).
+bool ChannelTemplate::capture ( lscp_client_t *pClient, Channel *pChannel )
+{
+	if (pClient == NULL || pChannel == NULL)
+		return false;
+
+	m_sEngineName     = pChannel->engineName();
+	m_sInstrumentFile = pChannel->instrumentFile();
+	m_iInstrumentNr   = pChannel->instrumentNr();
+	m_iMidiPort       = pChannel->midiPort();
+	m_iMidiChannel    = pChannel->midiChannel();
+	m_audioRouting    = pChannel->audioRouting();
+	m_fVolume         = pChannel->volume();
+
+	// Devices by what they are, not by their current IDs...
+	m_sMidiDriver = pChannel->midiDriver();
+	m_midiParams.clear();
+	if (pChannel->midiDevice() >= 0) {
+		const QString& sDriver = channelTemplateDeviceInfo(
+			pClient, true, pChannel->midiDevice(), m_midiParams);
+		if (!sDriver.isEmpty())
+			m_sMidiDriver = sDriver;
+	}
+
+	m_sAudioDriver = pChannel->audioDriver();
+	m_audioParams.clear();
+	if (pChannel->audioDevice() >= 0) {
+		const QString& sDriver = channelTemplateDeviceInfo(
+			pClient, false, pChannel->audioDevice(), m_audioParams);
+		if (!sDriver.isEmpty())
+			m_sAudioDriver = sDriver;
+	}
+
+	// Likewise, maps by name...
+	m_bMidiMap = false;
+	m_sMidiMapName.clear();
+#ifdef CONFIG_MIDI_INSTRUMENT
+	if (pChannel->midiMap() >= 0) {
+		m_bMidiMap = true;
+		const char *pszMapName
+			= ::lscp_get_midi_instrument_map_name(pClient, pChannel->midiMap());
+		if (pszMapName)
+			m_sMidiMapName = pszMapName;
+	}
+#endif
+
+	m_sends.clear();
+	QListIterator<int> iter(
+		FxSend::allFxSendsOfSamplerChannel(pChannel->channelID()));
+	while (iter.hasNext()) {
+		FxSend fxSend(pChannel->channelID(), iter.next());
+		if (!fxSend.getFromSampler())
+			return false;
+		Send send;
+		send.sName           = fxSend.name();
+		send.iMidiController = fxSend.sendDepthMidiCtrl();
+		send.fLevel          = fxSend.currentDepth();
+		send.routing         = fxSend.audioRouting();
+		m_sends.append(send);
+	}
+
+	return true;
+}
+
+
+// Settings accessors.
+const QString& ChannelTemplate::engineName (void) const
+{
+	return m_sEngineName;
+}
+
+const QString& ChannelTemplate::instrumentFile (void) const
+{
+	return m_sInstrumentFile;
+}
+
+int ChannelTemplate::instrumentNr (void) const
+{
+	return m_iInstrumentNr;
+}
+
+const QString& ChannelTemplate::midiDriver (void) const
+{
+	return m_sMidiDriver;
+}
+
+int ChannelTemplate::midiPort (void) const
+{
+	return m_iMidiPort;
+}
+
+int ChannelTemplate::midiChannel (void) const
+{
+	return m_iMidiChannel;
+}
+
+const QString& ChannelTemplate::midiMapName (void) const
+{
+	return m_sMidiMapName;
+}
+
+const QString& ChannelTemplate::audioDriver (void) const
+{
+	return m_sAudioDriver;
+}
+
+float ChannelTemplate::volume (void) const
+{
+	return m_fVolume;
+}
+
+int ChannelTemplate::fxSendCount (void) const
+{
+	return m_sends.count();
+}
+
+
+// Create so many sampler channels out of this one, in one batch.
+QList<int> ChannelTemplate::instantiate ( lscp_client_t *pClient,
+	int iCount, const Variation& variation, QStringList *pErrors ) const
+{
+	QList<int> channels;
+
+	if (pClient == NULL)
+		return channels;
+
+	// Where it all goes on this very server...
+	const Targets& targets = resolve(pClient, pErrors);
+
+	for (int iInstance = 0; iInstance < iCount; ++iInstance) {
+		const int iChannelID = ::lscp_add_channel(pClient);
+		if (iChannelID < 0) {
+			if (pErrors) {
+				pErrors->append(QString("ADD CHANNEL: %1")
+					.arg(::lscp_client_get_result(pClient)));
+			}
+			break;
+		}
+		channels.append(iChannelID);
+		// All settings back to back...
+		QStringListIterator iter(
+			commands(iChannelID, iInstance, variation, targets));
+		while (iter.hasNext()) {
+			const QString& sCommand = iter.next();
+			const QString& sQuery = sCommand + "\r\n";
+			if (::lscp_client_query(pClient,
+					sQuery.toUtf8().constData()) != LSCP_OK && pErrors) {
+				pErrors->append(QString("%1: %2").arg(sCommand)
+					.arg(::lscp_client_get_result(pClient)));
+			}
+		}
+	#ifdef CONFIG_FXSEND
+		// Effect sends have their own IDs (if the server has any)...
+		QListIterator<Send> send_iter(m_sends);
+		while (send_iter.hasNext()
+			&& ServerCaps::supports(ServerCaps::FxSends)) {
+			const Send& send = send_iter.next();
+			const QByteArray aName
+				= qsamplerUtilities::lscpEscapeText(send.sName).toUtf8();
+			const int iFxSend = ::lscp_create_fxsend(pClient, iChannelID,
+				send.iMidiController,
+				send.sName.isEmpty() ? NULL : aName.constData());
+			if (iFxSend < 0) {
+				if (pErrors) {
+					pErrors->append(QString("CREATE FX_SEND %1: %2")
+						.arg(iChannelID)
+						.arg(::lscp_client_get_result(pClient)));
+				}
+				continue;
+			}
+			QStringList fx;
+			QMap<int, int>::ConstIterator route = send.routing.constBegin();
+			for ( ; route != send.routing.constEnd(); ++route) {
+				fx.append(QString("SET FX_SEND AUDIO_OUTPUT_CHANNEL %1 %2 %3 %4")
+					.arg(iChannelID).arg(iFxSend)
+					.arg(route.key()).arg(route.value()));
+			}
+		#ifdef CONFIG_FXSEND_LEVEL
+			fx.append(QString("SET FX_SEND LEVEL %1 %2 %3")
+				.arg(iChannelID).arg(iFxSend).arg(send.fLevel));
+		#endif
+			QStringListIterator fx_iter(fx);
+			while (fx_iter.hasNext()) {
+				const QString& sCommand = fx_iter.next();
+				const QString& sQuery = sCommand + "\r\n";
+				if (::lscp_client_query(pClient,
+						sQuery.toUtf8().constData()) != LSCP_OK && pErrors) {
+					pErrors->append(QString("%1: %2").arg(sCommand)
+						.arg(::lscp_client_get_result(pClient)));
+				}
+			}
+		}
+	#endif
+	}
+
+	return channels;
+}
+
+
+// Resolve devices and map into the current server IDs.
+ChannelTemplate::Targets ChannelTemplate::resolve (
+	lscp_client_t *pClient, QStringList *pErrors ) const
+{
+	Targets targets;
+
+	targets.iMidiDevice = channelTemplateFindDevice(pClient, true,
+		m_sMidiDriver, m_midiParams, NULL);
+
+	// Rotating outputs needs to know how many there are...
+	QMap<QString, QString> audioParams;
+	targets.iAudioDevice = channelTemplateFindDevice(pClient, false,
+		m_sAudioDriver, m_audioParams, &audioParams);
+	targets.iAudioChannels = audioParams.value("CHANNELS").toInt();
+
+	targets.iMidiMap = -1;
+#ifdef CONFIG_MIDI_INSTRUMENT
+	if (m_bMidiMap) {
+		// Take a copy, as the client result buffer gets reused...
+		const int *piMaps = ::lscp_list_midi_instrument_maps(pClient);
+		QList<int> maps;
+		for (int i = 0; piMaps && piMaps[i] >= 0; ++i)
+			maps.append(piMaps[i]);
+		QListIterator<int> iter(maps);
+		while (iter.hasNext() && targets.iMidiMap < 0) {
+			const int iMap = iter.next();
+			const char *pszMapName
+				= ::lscp_get_midi_instrument_map_name(pClient, iMap);
+			if (QString(pszMapName ? pszMapName : "") == m_sMidiMapName)
+				targets.iMidiMap = iMap;
+		}
+		if (targets.iMidiMap < 0 && pErrors) {
+			pErrors->append(QObject::tr("No such MIDI instrument map: \"%1\".")
+				.arg(m_sMidiMapName));
+		}
+	}
+#endif
+
+	return targets;
+}
+
+
+// The per channel command batch for a given instance.
+QStringList ChannelTemplate::commands ( int iChannelID, int iInstance,
+	const Variation& variation, const Targets& targets ) const
+{
+	QStringList list;
+
+	const QString sChannelID = QString::number(iChannelID);
+
+	if (!m_sEngineName.isEmpty())
+		list.append("LOAD ENGINE " + m_sEngineName + ' ' + sChannelID);
+
+	// Audio outputs, rotated by instance...
+	// (no such device? let the server make one of that driver)
+	if (targets.iAudioDevice >= 0 || !m_sAudioDriver.isEmpty()) {
+		if (targets.iAudioDevice >= 0) {
+			list.append(QString("SET CHANNEL AUDIO_OUTPUT_DEVICE %1 %2")
+				.arg(iChannelID).arg(targets.iAudioDevice));
+		} else {
+			list.append(QString("SET CHANNEL AUDIO_OUTPUT_TYPE %1 %2")
+				.arg(iChannelID).arg(m_sAudioDriver));
+		}
+		const int iRotate = iInstance * variation.iAudioRotate;
+		QMap<int, int>::ConstIterator route = m_audioRouting.constBegin();
+		for ( ; route != m_audioRouting.constEnd(); ++route) {
+			int iAudioIn = route.value();
+			if (targets.iAudioChannels > 0)
+				iAudioIn = (iAudioIn + iRotate) % targets.iAudioChannels;
+			list.append(QString("SET CHANNEL AUDIO_OUTPUT_CHANNEL %1 %2 %3")
+				.arg(iChannelID).arg(route.key()).arg(iAudioIn));
+		}
+	}
+
+	// MIDI input, stepping channels (and ports) by instance...
+	if (targets.iMidiDevice >= 0 || !m_sMidiDriver.isEmpty()) {
+		if (targets.iMidiDevice >= 0) {
+			list.append(QString("SET CHANNEL MIDI_INPUT_DEVICE %1 %2")
+				.arg(iChannelID).arg(targets.iMidiDevice));
+		} else {
+			list.append(QString("SET CHANNEL MIDI_INPUT_TYPE %1 %2")
+				.arg(iChannelID).arg(m_sMidiDriver));
+		}
+		int iMidiPort = m_iMidiPort;
+		QString sMidiChannel = "ALL";
+		if (m_iMidiChannel != LSCP_MIDI_CHANNEL_ALL) {
+			const int iMidiChannel = m_iMidiChannel
+				+ iInstance * variation.iMidiChannelStep;
+			if (variation.bMidiPortCarry)
+				iMidiPort += iMidiChannel / 16;
+			sMidiChannel = QString::number(iMidiChannel % 16);
+		}
+		list.append(QString("SET CHANNEL MIDI_INPUT_PORT %1 %2")
+			.arg(iChannelID).arg(iMidiPort));
+		list.append(QString("SET CHANNEL MIDI_INPUT_CHANNEL %1 %2")
+			.arg(iChannelID).arg(sMidiChannel));
+	}
+
+#ifdef CONFIG_MIDI_INSTRUMENT
+	if (targets.iMidiMap >= 0) {
+		list.append(QString("SET CHANNEL MIDI_INSTRUMENT_MAP %1 %2")
+			.arg(iChannelID).arg(targets.iMidiMap));
+	}
+#endif
+
+	list.append(QString("SET CHANNEL VOLUME %1 %2")
+		.arg(iChannelID).arg(m_fVolume));
+
+	// Last but not least, in background...
+	if (variation.bInstrument && !m_sInstrumentFile.isEmpty()) {
+		list.append(QString("LOAD INSTRUMENT NON_MODAL '%1' %2 %3")
+			.arg(qsamplerUtilities::lscpEscapePath(m_sInstrumentFile))
+			.arg(m_iInstrumentNr).arg(iChannelID));
+	}
+
+	return list;
+}
+
+
+// Persistence.
+bool ChannelTemplate::load ( QSettings& settings )
+{
+	if (m_sName.isEmpty())
+		return false;
+
+	settings.beginGroup(QSAMPLER_CHANNEL_TEMPLATES);
+	const bool bExists = settings.childGroups().contains(m_sName);
+	settings.endGroup();
+	if (!bExists)
+		return false;
+
+	settings.beginGroup(QSAMPLER_CHANNEL_TEMPLATES "/" + m_sName);
+	m_sEngineName     = settings.value("/Engine").toString();
+	m_sInstrumentFile = settings.value("/InstrumentFile").toString();
+	m_iInstrumentNr   = settings.value("/InstrumentNr", 0).toInt();
+	m_sMidiDriver     = settings.value("/MidiDriver").toString();
+	m_midiParams      = channelTemplateParams(
+		settings.value("/MidiDeviceParams").toStringList());
+	m_iMidiPort       = settings.value("/MidiPort", 0).toInt();
+	m_iMidiChannel    = settings.value("/MidiChannel",
+		LSCP_MIDI_CHANNEL_ALL).toInt();
+	m_bMidiMap        = settings.contains("/MidiMapName");
+	m_sMidiMapName    = settings.value("/MidiMapName").toString();
+	m_sAudioDriver    = settings.value("/AudioDriver").toString();
+	m_audioParams     = channelTemplateParams(
+		settings.value("/AudioDeviceParams").toStringList());
+	m_audioRouting    = channelTemplateRouting(
+		settings.value("/AudioRouting").toStringList());
+	m_fVolume         = settings.value("/Volume", 1.0f).toFloat();
+	m_sends.clear();
+	const int iSends = settings.beginReadArray("/FxSends");
+	for (int i = 0; i < iSends; ++i) {
+		settings.setArrayIndex(i);
+		Send send;
+		send.sName           = settings.value("/Name").toString();
+		send.iMidiController = settings.value("/MidiController", 91).toInt();
+		send.fLevel          = settings.value("/Level", 0.0f).toFloat();
+		send.routing         = channelTemplateRouting(
+			settings.value("/AudioRouting").toStringList());
+		m_sends.append(send);
+	}
+	settings.endArray();
+	settings.endGroup();
+
+	return true;
+}
+
+
+void ChannelTemplate::save ( QSettings& settings ) const
+{
+	if (m_sName.isEmpty())
+		return;
+
+	// Start afresh...
+	remove(settings, m_sName);
+
+	settings.beginGroup(QSAMPLER_CHANNEL_TEMPLATES "/" + m_sName);
+	settings.setValue("/Engine", m_sEngineName);
+	settings.setValue("/InstrumentFile", m_sInstrumentFile);
+	settings.setValue("/InstrumentNr", m_iInstrumentNr);
+	settings.setValue("/MidiDriver", m_sMidiDriver);
+	settings.setValue("/MidiDeviceParams", channelTemplateParams(m_midiParams));
+	settings.setValue("/MidiPort", m_iMidiPort);
+	settings.setValue("/MidiChannel", m_iMidiChannel);
+	if (m_bMidiMap)
+		settings.setValue("/MidiMapName", m_sMidiMapName);
+	settings.setValue("/AudioDriver", m_sAudioDriver);
+	settings.setValue("/AudioDeviceParams", channelTemplateParams(m_audioParams));
+	settings.setValue("/AudioRouting", channelTemplateRouting(m_audioRouting));
+	settings.setValue("/Volume", double(m_fVolume));
+	settings.beginWriteArray("/FxSends", m_sends.count());
+	for (int i = 0; i < m_sends.count(); ++i) {
+		const Send& send = m_sends.at(i);
+		settings.setArrayIndex(i);
+		settings.setValue("/Name", send.sName);
+		settings.setValue("/MidiController", send.iMidiController);
+		settings.setValue("/Level", double(send.fLevel));
+		settings.setValue("/AudioRouting", channelTemplateRouting(send.routing));
+	}
+	settings.endArray();
+	settings.endGroup();
+}
+
+
+// All stored template names.
+QStringList ChannelTemplate::names ( QSettings& settings )
+{
+	settings.beginGroup(QSAMPLER_CHANNEL_TEMPLATES);
+	QStringList list = settings.childGroups();
+	settings.endGroup();
+
+	list.sort();
+	return list;
+}
+
+
+// Remove a stored template.
+void ChannelTemplate::remove ( QSettings& settings, const QString& sName )
+{
+	settings.beginGroup(QSAMPLER_CHANNEL_TEMPLATES);
+	settings.remove(sName);
+	settings.endGroup();
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerChannelTemplate.cpp
@@ -0,0 +1,154 @@
+// qsamplerChannelTemplate.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerChannelTemplate_h
+#define __qsamplerChannelTemplate_h
+
+#include <QStringList>
+#include <QList>
+#include <QMap>
+
+#include <lscp/client.h>
+
+class QSettings;
+
+
+namespace QSampler {
+
+class Channel;
+
+
+//-------------------------------------------------------------------------
+// QSampler::ChannelTemplate - named sampler channel setup.
+//
+
+class ChannelTemplate
+{
+public:
+
+	// Constructor.
+	ChannelTemplate(const QString& sName = QString());
+
+	// Template name.
+	const QString& name() const;
+	void setName(const QString& sName);
+
+	// Take all settings from a live sampler channel (FX sends included).
+	bool capture(lscp_client_t *pClient, Channel *pChannel);
+
+	// Settings accessors.
+	const QString& engineName() const;
+	const QString& instrumentFile() const;
+	int instrumentNr() const;
+	const QString& midiDriver() const;
+	int midiPort() const;
+	int midiChannel() const;
+	const QString& midiMapName() const;
+	const QString& audioDriver() const;
+	float volume() const;
+	int fxSendCount() const;
+
+	// Per instance variation rules.
+	struct Variation
+	{
+		int  iMidiChannelStep;  // MIDI channel increment.
+		bool bMidiPortCarry;    // Next MIDI port on channel wrap-around.
+		int  iAudioRotate;      // Audio outputs rotation.
+		bool bInstrument;       // Load the instrument as well.
+	};
+
+	// Create so many sampler channels out of this one,
+	// in one batch; returns the new channel IDs.
+	QList<int> instantiate(lscp_client_t *pClient, int iCount,
+		const Variation& variation, QStringList *pErrors = NULL) const;
+
+	// Persistence.
+	bool load(QSettings& settings);
+	void save(QSettings& settings) const;
+
+	// All stored template names.
+	static QStringList names(QSettings& settings);
+
+	// Remove a stored template.
+	static void remove(QSettings& settings, const QString& sName);
+
+protected:
+
+	// Server side IDs, as resolved for the time being.
+	struct Targets
+	{
+		int iMidiDevice;
+		int iMidiMap;
+		int iAudioDevice;
+		int iAudioChannels;
+	};
+
+	// Resolve devices (by driver and parameters) and map (by name)
+	// into the current server IDs; -1 where there's no such thing.
+	Targets resolve(lscp_client_t *pClient, QStringList *pErrors) const;
+
+	// The per channel command batch for a given instance.
+	QStringList commands(int iChannelID, int iInstance,
+		const Variation& variation, const Targets& targets) const;
+
+private:
+
+	// One effect send.
+	struct Send
+	{
+		QString sName;
+		int     iMidiController;
+		float   fLevel;
+		QMap<int, int> routing;
+	};
+
+	// Instance variables.
+	QString m_sName;
+
+	QString m_sEngineName;
+	QString m_sInstrumentFile;
+	int     m_iInstrumentNr;
+
+	// Devices are kept by driver and parameters,
+	// maps by name, as server IDs don't last.
+	QString m_sMidiDriver;
+	QMap<QString, QString> m_midiParams;
+	int     m_iMidiPort;
+	int     m_iMidiChannel;
+	bool    m_bMidiMap;
+	QString m_sMidiMapName;
+
+	QString m_sAudioDriver;
+	QMap<QString, QString> m_audioParams;
+	QMap<int, int> m_audioRouting;
+
+	float   m_fVolume;
+
+	QList<Send> m_sends;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerChannelTemplate_h
+
+
+// end of qsamplerChannelTemplate.h
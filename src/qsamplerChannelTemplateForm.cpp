@@ -0,0 +1,197 @@
+// qsamplerChannelTemplateForm.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerChannelTemplateForm.h"
+
+#include "qsamplerOptions.h"
+
+#include <QPushButton>
+#include <QMessageBox>
+#include <QFileInfo>
+
+
+namespace QSampler {
+
+// Most sampler channels created in one go.
+#define QSAMPLER_CHANNEL_TEMPLATE_MAX  256
+
+
+//-------------------------------------------------------------------------
+// QSampler::ChannelTemplateForm -- channel template instantiation dialog.
+//
+
+// Constructor.
+ChannelTemplateForm::ChannelTemplateForm ( Options *pOptions, QWidget *pParent )
+	: QDialog(pParent), m_pOptions(pOptions)
+{
+	m_ui.setupUi(this);
+
+	m_ui.CountSpinBox->setMaximum(QSAMPLER_CHANNEL_TEMPLATE_MAX);
+
+	// Last time choices...
+	if (m_pOptions) {
+		m_ui.TemplateComboBox->addItems(
+			ChannelTemplate::names(m_pOptions->settings()));
+		const int iIndex
+			= m_ui.TemplateComboBox->findText(m_pOptions->sChannelTemplate);
+		if (iIndex >= 0)
+			m_ui.TemplateComboBox->setCurrentIndex(iIndex);
+		m_ui.CountSpinBox->setValue(m_pOptions->iTemplateCount);
+		m_ui.MidiChannelStepSpinBox->setValue(m_pOptions->iTemplateMidiStep);
+		m_ui.MidiPortCarryCheckBox->setChecked(m_pOptions->bTemplateMidiCarry);
+		m_ui.AudioRotateSpinBox->setValue(m_pOptions->iTemplateAudioRotate);
+		m_ui.InstrumentCheckBox->setChecked(m_pOptions->bTemplateInstrument);
+	}
+
+	QObject::connect(m_ui.TemplateComboBox,
+		SIGNAL(activated(int)),
+		SLOT(templateChanged()));
+	QObject::connect(m_ui.RemovePushButton,
+		SIGNAL(clicked()),
+		SLOT(removeTemplate()));
+	QObject::connect(m_ui.MidiChannelStepSpinBox,
+		SIGNAL(valueChanged(int)),
+		SLOT(stabilizeForm()));
+	QObject::connect(m_ui.DialogButtonBox,
+		SIGNAL(accepted()),
+		SLOT(accept()));
+	QObject::connect(m_ui.DialogButtonBox,
+		SIGNAL(rejected()),
+		SLOT(reject()));
+
+	templateChanged();
+}
+
+
+// Destructor.
+ChannelTemplateForm::~ChannelTemplateForm (void)
+{
+}
+
+
+// The chosen template, count and variation rules.
+const ChannelTemplate& ChannelTemplateForm::channelTemplate (void) const
+{
+	return m_template;
+}
+
+int ChannelTemplateForm::count (void) const
+{
+	return m_ui.CountSpinBox->value();
+}
+
+ChannelTemplate::Variation ChannelTemplateForm::variation (void) const
+{
+	ChannelTemplate::Variation variation;
+	variation.iMidiChannelStep = m_ui.MidiChannelStepSpinBox->value();
+	variation.bMidiPortCarry   = m_ui.MidiPortCarryCheckBox->isChecked();
+	variation.iAudioRotate     = m_ui.AudioRotateSpinBox->value();
+	variation.bInstrument      = m_ui.InstrumentCheckBox->isChecked();
+	return variation;
+}
+
+
+// Template selection.
+void ChannelTemplateForm::templateChanged (void)
+{
+	m_template = ChannelTemplate(m_ui.TemplateComboBox->currentText());
+
+	QString sSummary;
+	if (m_pOptions && m_template.load(m_pOptions->settings())) {
+		sSummary = tr("Engine: %1").arg(m_template.engineName());
+		if (!m_template.instrumentFile().isEmpty()) {
+			sSummary += '\n' + tr("Instrument: %1 [%2]")
+				.arg(QFileInfo(m_template.instrumentFile()).fileName())
+				.arg(m_template.instrumentNr());
+		}
+		sSummary += '\n' + tr("MIDI %1 device, port %2, channel %3")
+			.arg(m_template.midiDriver())
+			.arg(m_template.midiPort())
+			.arg(m_template.midiChannel() == LSCP_MIDI_CHANNEL_ALL
+				? tr("All") : QString::number(m_template.midiChannel() + 1));
+		sSummary += '\n' + tr("Audio %1 device, volume %2%, %3 FX send(s)")
+			.arg(m_template.audioDriver())
+			.arg(int(100.0f * m_template.volume() + 0.5f))
+			.arg(m_template.fxSendCount());
+	}
+	else sSummary = tr("(no channel templates yet)");
+
+	m_ui.SummaryTextLabel->setText(sSummary);
+
+	stabilizeForm();
+}
+
+
+// Remove the current template for good.
+void ChannelTemplateForm::removeTemplate (void)
+{
+	if (m_pOptions == NULL || m_template.name().isEmpty())
+		return;
+
+	if (QMessageBox::warning(this,
+		QSAMPLER_TITLE ": " + tr("Warning"),
+		tr("About to remove channel template:\n\n"
+		"%1\n\n"
+		"Are you sure?").arg(m_template.name()),
+		QMessageBox::Ok | QMessageBox::Cancel) == QMessageBox::Cancel)
+		return;
+
+	ChannelTemplate::remove(m_pOptions->settings(), m_template.name());
+
+	m_ui.TemplateComboBox->removeItem(m_ui.TemplateComboBox->currentIndex());
+
+	templateChanged();
+}
+
+
+// Form state stabilization.
+void ChannelTemplateForm::stabilizeForm (void)
+{
+	const bool bValid = !m_template.name().isEmpty()
+		&& m_ui.TemplateComboBox->count() > 0;
+
+	m_ui.RemovePushButton->setEnabled(bValid);
+	m_ui.MidiPortCarryCheckBox->setEnabled(
+		m_ui.MidiChannelStepSpinBox->value() > 0);
+	m_ui.DialogButtonBox->button(QDialogButtonBox::Ok)->setEnabled(bValid);
+}
+
+
+// Remember the choices.
+void ChannelTemplateForm::accept (void)
+{
+	if (m_pOptions) {
+		m_pOptions->sChannelTemplate     = m_template.name();
+		m_pOptions->iTemplateCount       = m_ui.CountSpinBox->value();
+		m_pOptions->iTemplateMidiStep    = m_ui.MidiChannelStepSpinBox->value();
+		m_pOptions->bTemplateMidiCarry   = m_ui.MidiPortCarryCheckBox->isChecked();
+		m_pOptions->iTemplateAudioRotate = m_ui.AudioRotateSpinBox->value();
+		m_pOptions->bTemplateInstrument  = m_ui.InstrumentCheckBox->isChecked();
+	}
+
+	QDialog::accept();
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerChannelTemplateForm.cpp
@@ -0,0 +1,87 @@
+// qsamplerChannelTemplateForm.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerChannelTemplateForm_h
+#define __qsamplerChannelTemplateForm_h
+
+#include "ui_qsamplerChannelTemplateForm.h"
+
+#include "qsamplerChannelTemplate.h"
+
+
+namespace QSampler {
+
+class Options;
+
+
+//-------------------------------------------------------------------------
+// QSampler::ChannelTemplateForm -- channel template instantiation dialog.
+//
+
+class ChannelTemplateForm : public QDialog
+{
+	Q_OBJECT
+
+public:
+
+	// Constructor.
+	ChannelTemplateForm(Options *pOptions, QWidget *pParent = NULL);
+
+	// Destructor.
+	~ChannelTemplateForm();
+
+	// The chosen template, count and variation rules.
+	const ChannelTemplate& channelTemplate() const;
+	int count() const;
+	ChannelTemplate::Variation variation() const;
+
+protected slots:
+
+	// Template selection.
+	void templateChanged();
+
+	// Remove the current template for good.
+	void removeTemplate();
+
+	// Form state stabilization.
+	void stabilizeForm();
+
+	// Remember the choices.
+	void accept();
+
+private:
+
+	// The Qt-designer UI struct...
+	Ui::qsamplerChannelTemplateForm m_ui;
+
+	// Instance variables.
+	Options *m_pOptions;
+
+	ChannelTemplate m_template;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerChannelTemplateForm_h
+
+
+// end of qsamplerChannelTemplateForm.h
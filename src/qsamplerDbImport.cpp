@@ -0,0 +1,411 @@
+// qsamplerDbImport.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerDbImport.h"
+
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QRegExp>
+
+
+namespace QSampler {
+
+// Job progress polling period (msecs).
+#define QSAMPLER_DBIMPORT_POLL_MSECS  500
+
+
+// No events are subscribed, whatsoever.
+static lscp_status_t qsampler_dbimport_callback ( lscp_client_t */*pClient*/,
+	lscp_event_t /*event*/, const char */*pchData*/, int /*cchData*/,
+	void */*pvData*/ )
+{
+	return LSCP_OK;
+}
+
+
+//-------------------------------------------------------------------------
+// QSampler::DbImport - server-side instruments DB import jobs runner.
+//
+
+// Constructor.
+DbImport::DbImport ( const QString& sHost, int iPort, int iTimeout,
+	int iMaxJobs ) : QThread(), m_sHost(sHost), m_iPort(iPort),
+		m_iTimeout(iTimeout), m_iMaxJobs(qMax(1, iMaxJobs)),
+		m_bCancel(false), m_iElapsed(0)
+{
+}
+
+
+// Job queueing (before starting only).
+void DbImport::addJob ( const QString& sPath, const QString& sDbDir,
+	Mode mode, bool bFileAsDir )
+{
+	Job job;
+	job.sPath         = sPath;
+	job.sDbDir        = (sDbDir.isEmpty() ? QString("/") : sDbDir);
+	job.mode          = mode;
+	job.bFileAsDir    = bFileAsDir;
+	job.state         = Queued;
+	job.iJobID        = -1;
+	job.iFilesTotal   = -1;
+	job.iFilesScanned = 0;
+	job.iStatus       = 0;
+	job.iElapsed      = 0;
+
+	QMutexLocker locker(&m_mutex);
+	m_jobs.append(job);
+}
+
+
+// Cancel (and wait for) the whole thing.
+void DbImport::cancel (void)
+{
+	m_bCancel = true;
+
+	QThread::wait();
+}
+
+
+// Progress accessors (any time).
+QList<DbImport::Job> DbImport::jobs (void) const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_jobs;
+}
+
+int DbImport::filesScanned (void) const
+{
+	QMutexLocker locker(&m_mutex);
+	int iFilesScanned = 0;
+	QListIterator<Job> iter(m_jobs);
+	while (iter.hasNext())
+		iFilesScanned += iter.next().iFilesScanned;
+	return iFilesScanned;
+}
+
+int DbImport::elapsed (void) const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_iElapsed;
+}
+
+
+// Overall throughput (files per minute).
+float DbImport::filesPerMinute (void) const
+{
+	const int iElapsed = elapsed();
+	if (iElapsed < 1)
+		return 0.0f;
+
+	return (60000.0f * float(filesScanned())) / float(iElapsed);
+}
+
+
+// Results accessors (only after the thread is finished).
+const QStringList& DbImport::errors (void) const
+{
+	return m_errors;
+}
+
+
+// State description.
+QString DbImport::stateText ( State state )
+{
+	switch (state) {
+		case Running:
+			return QObject::tr("Running");
+		case Done:
+			return QObject::tr("Done");
+		case Failed:
+			return QObject::tr("Failed");
+		case Cancelled:
+			return QObject::tr("Cancelled");
+		case Queued:
+		default:
+			return QObject::tr("Queued");
+	}
+}
+
+
+// The main thread executive.
+void DbImport::run (void)
+{
+	lscp_client_t *pClient = ::lscp_client_create(
+		m_sHost.toUtf8().constData(), m_iPort,
+		qsampler_dbimport_callback, NULL);
+	if (pClient == NULL) {
+		addError(QObject::tr("Could not connect to server %1:%2.")
+			.arg(m_sHost).arg(m_iPort));
+		QMutexLocker locker(&m_mutex);
+		for (int iJob = 0; iJob < m_jobs.count(); ++iJob)
+			m_jobs[iJob].state = Failed;
+		return;
+	}
+
+	::lscp_client_set_timeout(pClient, m_iTimeout);
+
+	const qsamplerUtilities::lscpVersion_t& version
+		= qsamplerUtilities::getRemoteLscpVersion(pClient);
+
+	m_mutex.lock();
+	const int iJobs = m_jobs.count();
+	m_mutex.unlock();
+
+	// Launch times, as of the overall timer...
+	QVector<qint64> starts(iJobs, 0);
+
+	QElapsedTimer timer;
+	timer.start();
+
+	while (!m_bCancel) {
+		int iQueued  = 0;
+		int iRunning = 0;
+		m_mutex.lock();
+		for (int iJob = 0; iJob < iJobs; ++iJob) {
+			const State state = m_jobs.at(iJob).state;
+			if (state == Queued)
+				++iQueued;
+			else
+			if (state == Running)
+				++iRunning;
+		}
+		m_mutex.unlock();
+		// All over?
+		if (iQueued < 1 && iRunning < 1)
+			break;
+		// Launch the next ones in line, as long as there's room...
+		for (int iJob = 0; iJob < iJobs
+				&& iQueued > 0 && iRunning < m_iMaxJobs && !m_bCancel; ++iJob) {
+			m_mutex.lock();
+			const State state = m_jobs.at(iJob).state;
+			m_mutex.unlock();
+			if (state != Queued)
+				continue;
+			starts[iJob] = timer.elapsed();
+			launch(pClient, iJob, version);
+			--iQueued;
+			m_mutex.lock();
+			if (m_jobs.at(iJob).state == Running)
+				++iRunning;
+			m_mutex.unlock();
+		}
+		// Keep track of the running ones...
+		for (int iJob = 0; iJob < iJobs && !m_bCancel; ++iJob) {
+			m_mutex.lock();
+			const State state = m_jobs.at(iJob).state;
+			m_mutex.unlock();
+			if (state != Running)
+				continue;
+			poll(pClient, iJob, version);
+			QMutexLocker locker(&m_mutex);
+			m_jobs[iJob].iElapsed = int(timer.elapsed() - starts.at(iJob));
+		}
+		m_mutex.lock();
+		m_iElapsed = int(timer.elapsed());
+		m_mutex.unlock();
+		QThread::msleep(QSAMPLER_DBIMPORT_POLL_MSECS);
+	}
+
+	// Whatever was still in line won't be any longer...
+	m_mutex.lock();
+	for (int iJob = 0; iJob < iJobs; ++iJob) {
+		if (m_jobs.at(iJob).state == Queued)
+			m_jobs[iJob].state = Cancelled;
+	}
+	m_iElapsed = int(timer.elapsed());
+	m_mutex.unlock();
+
+	::lscp_client_destroy(pClient);
+}
+
+
+// Send one command, terminated as LSCP wants it.
+lscp_status_t DbImport::query ( lscp_client_t *pClient, const QString& sQuery )
+{
+	const QString& sCommand = sQuery + "\r\n";
+	return ::lscp_client_query(pClient, sCommand.toUtf8().constData());
+}
+
+
+// Make sure a DB directory exists (all the way down).
+bool DbImport::makeDbDir ( lscp_client_t *pClient, const QString& sDbDir,
+	const qsamplerUtilities::lscpVersion_t& version )
+{
+	QString sDir;
+	QStringListIterator iter(sDbDir.split('/', QString::SkipEmptyParts));
+	while (iter.hasNext()) {
+		sDir += '/' + iter.next();
+		if (m_dbDirs.contains(sDir))
+			continue;
+		const QString& sEscaped
+			= qsamplerUtilities::lscpEscapePath(sDir, version);
+		QString sQuery = "GET DB_INSTRUMENT_DIRECTORY INFO '" + sEscaped + '\'';
+		if (query(pClient, sQuery) != LSCP_OK) {
+			sQuery = "ADD DB_INSTRUMENT_DIRECTORY '" + sEscaped + '\'';
+			if (query(pClient, sQuery) != LSCP_OK) {
+				addError(QObject::tr("Could not create DB directory \"%1\": %2")
+					.arg(sDir).arg(::lscp_client_get_result(pClient)));
+				return false;
+			}
+		}
+		m_dbDirs.insert(sDir);
+	}
+
+	return true;
+}
+
+
+// Launch one (non-modal) job on the server.
+void DbImport::launch ( lscp_client_t *pClient, int iJob,
+	const qsamplerUtilities::lscpVersion_t& version )
+{
+	m_mutex.lock();
+	const Job job = m_jobs.at(iJob);
+	m_mutex.unlock();
+
+	int iJobID = -1;
+	QString sError;
+
+	if (makeDbDir(pClient, job.sDbDir, version)) {
+		QString sQuery = "ADD DB_INSTRUMENTS NON_MODAL ";
+		switch (job.mode) {
+			case NonRecursive:
+				sQuery += "NON_RECURSIVE ";
+				break;
+			case Flat:
+				sQuery += "FLAT ";
+				break;
+			case Recursive:
+			default:
+				sQuery += "RECURSIVE ";
+				break;
+		}
+		if (job.bFileAsDir)
+			sQuery += "FILE_AS_DIR ";
+		sQuery += '\'' + qsamplerUtilities::lscpEscapePath(job.sDbDir, version)
+			+ "' '" + qsamplerUtilities::lscpEscapePath(job.sPath, version) + '\'';
+		if (query(pClient, sQuery) == LSCP_OK) {
+			// The job id comes along as in OK[<job-id>]...
+			bool bOk = false;
+			iJobID = QString(::lscp_client_get_result(pClient))
+				.trimmed().toInt(&bOk);
+			if (!bOk) {
+				iJobID = -1;
+				sError = QObject::tr("No job id from the server.");
+			}
+		}
+		else sError = ::lscp_client_get_result(pClient);
+	}
+	else sError = QObject::tr("Could not create DB directory.");
+
+	QMutexLocker locker(&m_mutex);
+	Job& jobRef = m_jobs[iJob];
+	if (iJobID >= 0) {
+		jobRef.iJobID = iJobID;
+		jobRef.state  = Running;
+	} else {
+		jobRef.sError = sError;
+		jobRef.state  = Failed;
+	}
+}
+
+
+// Query one running job for progress.
+void DbImport::poll ( lscp_client_t *pClient, int iJob,
+	const qsamplerUtilities::lscpVersion_t& version )
+{
+	m_mutex.lock();
+	const int iJobID = m_jobs.at(iJob).iJobID;
+	m_mutex.unlock();
+
+	const QString& sQuery
+		= QString("GET DB_INSTRUMENTS_JOB INFO %1").arg(iJobID);
+	if (query(pClient, sQuery) != LSCP_OK) {
+		const QString sError = ::lscp_client_get_result(pClient);
+		// Finished jobs may well be gone already...
+		QMutexLocker locker(&m_mutex);
+		Job& job = m_jobs[iJob];
+		if (job.iFilesTotal >= 0 && job.iFilesScanned >= job.iFilesTotal) {
+			job.state = Done;
+		} else {
+			job.sError = sError;
+			job.state  = Failed;
+		}
+		return;
+	}
+
+	int iFilesTotal   = -1;
+	int iFilesScanned = 0;
+	int iStatus       = 0;
+	QString sScanning;
+
+	const QStringList& lines = QString(::lscp_client_get_result(pClient))
+		.split(QRegExp("[\r\n]+"), QString::SkipEmptyParts);
+	QStringListIterator iter(lines);
+	while (iter.hasNext()) {
+		const QString& sLine = iter.next();
+		const QString& sKey = sLine.section(':', 0, 0).trimmed().toUpper();
+		const QString& sValue = sLine.section(':', 1).trimmed();
+		if (sKey == "FILES_TOTAL")
+			iFilesTotal = sValue.toInt();
+		else
+		if (sKey == "FILES_SCANNED")
+			iFilesScanned = sValue.toInt();
+		else
+		if (sKey == "STATUS")
+			iStatus = sValue.toInt();
+		else
+		if (sKey == "SCANNING") {
+			sScanning = qsamplerUtilities::lscpEscapedTextToRaw(
+				sValue, version);
+		}
+	}
+
+	QMutexLocker locker(&m_mutex);
+	Job& job = m_jobs[iJob];
+	job.iFilesTotal   = iFilesTotal;
+	job.iFilesScanned = iFilesScanned;
+	job.iStatus       = iStatus;
+	job.sScanning     = sScanning;
+	// Negative status means the scan went wrong...
+	if (iStatus < 0) {
+		job.sError = QObject::tr("Scanning failed (status %1).").arg(iStatus);
+		job.state  = Failed;
+	}
+	else
+	if (iFilesTotal >= 0 && iFilesScanned >= iFilesTotal && iStatus >= 100)
+		job.state = Done;
+}
+
+
+// Error accounting.
+void DbImport::addError ( const QString& sError )
+{
+	QMutexLocker locker(&m_mutex);
+	m_errors.append(sError);
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerDbImport.cpp
@@ -0,0 +1,146 @@
+// qsamplerDbImport.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerDbImport_h
+#define __qsamplerDbImport_h
+
+#include "qsamplerUtilities.h"
+
+#include <QThread>
+#include <QMutex>
+#include <QStringList>
+#include <QList>
+#include <QSet>
+
+#include <lscp/client.h>
+
+
+namespace QSampler {
+
+//-------------------------------------------------------------------------
+// QSampler::DbImport - server-side instruments DB import jobs runner.
+//
+
+class DbImport : public QThread
+{
+public:
+
+	// Scanning modes (as of ADD DB_INSTRUMENTS).
+	enum Mode { Recursive = 0, NonRecursive, Flat };
+
+	// Job states.
+	enum State { Queued = 0, Running, Done, Failed, Cancelled };
+
+	// One import job.
+	struct Job
+	{
+		QString sPath;          // Server-side directory (or file).
+		QString sDbDir;         // Instruments DB directory.
+		Mode    mode;
+		bool    bFileAsDir;
+		State   state;
+		int     iJobID;         // Server job id (-1 if none yet).
+		int     iFilesTotal;    // Files to scan (-1 if not known yet).
+		int     iFilesScanned;
+		int     iStatus;        // Current file progress (%).
+		QString sScanning;      // Current file.
+		QString sError;
+		int     iElapsed;       // Running time (msecs).
+	};
+
+	// Constructor.
+	DbImport(const QString& sHost, int iPort, int iTimeout,
+		int iMaxJobs = 1);
+
+	// Job queueing (before starting only).
+	void addJob(const QString& sPath, const QString& sDbDir,
+		Mode mode = Recursive, bool bFileAsDir = false);
+
+	// Cancel (and wait for) the whole thing; jobs
+	// already running on the server are left alone.
+	void cancel();
+
+	// Progress accessors (any time).
+	QList<Job> jobs() const;
+	int filesScanned() const;
+	int elapsed() const;
+
+	// Overall throughput (files per minute).
+	float filesPerMinute() const;
+
+	// Results accessors (only after the thread is finished).
+	const QStringList& errors() const;
+
+	// State description.
+	static QString stateText(State state);
+
+protected:
+
+	// The main thread executive.
+	void run();
+
+	// Send one command, terminated as LSCP wants it.
+	static lscp_status_t query(lscp_client_t *pClient, const QString& sQuery);
+
+	// Make sure a DB directory exists (all the way down).
+	bool makeDbDir(lscp_client_t *pClient, const QString& sDbDir,
+		const qsamplerUtilities::lscpVersion_t& version);
+
+	// Launch one (non-modal) job on the server.
+	void launch(lscp_client_t *pClient, int iJob,
+		const qsamplerUtilities::lscpVersion_t& version);
+
+	// Query one running job for progress.
+	void poll(lscp_client_t *pClient, int iJob,
+		const qsamplerUtilities::lscpVersion_t& version);
+
+	// Error accounting.
+	void addError(const QString& sError);
+
+private:
+
+	// Instance variables.
+	QString m_sHost;
+	int     m_iPort;
+	int     m_iTimeout;
+	int     m_iMaxJobs;
+
+	QList<Job> m_jobs;
+
+	mutable QMutex m_mutex;
+
+	volatile bool m_bCancel;
+
+	int m_iElapsed;
+
+	QStringList m_errors;
+
+	// DB directories known to exist (this thread only).
+	QSet<QString> m_dbDirs;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerDbImport_h
+
+
+// end of qsamplerDbImport.h
@@ -0,0 +1,428 @@
+// qsamplerDbImportForm.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerDbImportForm.h"
+
+#include "qsamplerMainForm.h"
+#include "qsamplerOptions.h"
+#include "qsamplerServerCaps.h"
+
+#include <QApplication>
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QTimer>
+
+#include <stdio.h>
+
+
+namespace QSampler {
+
+// Progress refresh period (msecs).
+#define QSAMPLER_DBIMPORT_PERIOD_MSECS  1000
+
+// Most import jobs allowed at once.
+#define QSAMPLER_DBIMPORT_JOBS_MAX      8
+
+
+//-------------------------------------------------------------------------
+// QSampler::DbImportForm -- instruments DB import jobs form.
+//
+
+// Constructor.
+DbImportForm::DbImportForm ( QWidget *pParent, Qt::WindowFlags wflags )
+	: QWidget(pParent, wflags), m_pDbImport(NULL)
+{
+	m_ui.setupUi(this);
+
+	m_ui.JobsSpinBox->setMaximum(QSAMPLER_DBIMPORT_JOBS_MAX);
+	m_ui.JobsListView->header()->resizeSection(0, 240);
+
+	m_pTimer = new QTimer(this);
+
+	// Last time choices...
+	MainForm *pMainForm = MainForm::getInstance();
+	Options *pOptions = (pMainForm ? pMainForm->options() : NULL);
+	if (pOptions) {
+		m_ui.DbDirLineEdit->setText(pOptions->sDbImportDir);
+		m_ui.ModeComboBox->setCurrentIndex(pOptions->iDbImportMode);
+		m_ui.FileAsDirCheckBox->setChecked(pOptions->bDbImportFileAsDir);
+		m_ui.JobsSpinBox->setValue(pOptions->iDbImportJobs);
+	}
+
+	QObject::connect(m_ui.JobsListView,
+		SIGNAL(itemSelectionChanged()),
+		SLOT(stabilizeForm()));
+	QObject::connect(m_ui.DbDirLineEdit,
+		SIGNAL(textChanged(const QString&)),
+		SLOT(stabilizeForm()));
+	QObject::connect(m_ui.AddPushButton,
+		SIGNAL(clicked()),
+		SLOT(addPaths()));
+	QObject::connect(m_ui.RemovePushButton,
+		SIGNAL(clicked()),
+		SLOT(removePaths()));
+	QObject::connect(m_ui.StartPushButton,
+		SIGNAL(clicked()),
+		SLOT(startImport()));
+	QObject::connect(m_pTimer,
+		SIGNAL(timeout()),
+		SLOT(refreshProgress()));
+
+	stabilizeForm();
+}
+
+
+// Destructor.
+DbImportForm::~DbImportForm (void)
+{
+	if (m_pDbImport) {
+		m_pDbImport->cancel();
+		delete m_pDbImport;
+	}
+}
+
+
+// Queue another (server-side) path to import.
+void DbImportForm::addPath ( const QString& sPath )
+{
+	if (sPath.isEmpty())
+		return;
+
+	QTreeWidgetItem *pItem = new QTreeWidgetItem(m_ui.JobsListView);
+	pItem->setText(0, sPath);
+	pItem->setToolTip(0, sPath);
+	pItem->setText(2, DbImport::stateText(DbImport::Queued));
+	pItem->setData(2, Qt::UserRole, int(DbImport::Queued));
+
+	stabilizeForm();
+}
+
+
+// Whether any import is currently running.
+bool DbImportForm::isRunning (void) const
+{
+	return (m_pDbImport != NULL);
+}
+
+
+// Add paths to import.
+void DbImportForm::addPaths (void)
+{
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL)
+		return;
+
+	Options *pOptions = pMainForm->options();
+	if (pOptions == NULL)
+		return;
+
+	const QString& sPath = QFileDialog::getExistingDirectory(this,
+		QSAMPLER_TITLE ": " + tr("Add Directory"),  // Caption.
+		pOptions->sInstrumentDir);                  // Start here.
+
+	addPath(sPath);
+}
+
+
+// Remove paths to import.
+void DbImportForm::removePaths (void)
+{
+	if (m_pDbImport)
+		return;
+
+	qDeleteAll(m_ui.JobsListView->selectedItems());
+
+	stabilizeForm();
+}
+
+
+// Start/stop importing.
+void DbImportForm::startImport (void)
+{
+	if (m_pDbImport) {
+		stopImport();
+		return;
+	}
+
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL || pMainForm->client() == NULL)
+		return;
+
+	Options *pOptions = pMainForm->options();
+	if (pOptions == NULL)
+		return;
+
+	if (!ServerCaps::supports(ServerCaps::InstrumentsDb)) {
+		print(tr("DB import: the server has no instruments database support."),
+			true);
+		finishImport();
+		return;
+	}
+
+	QString sDbDir = m_ui.DbDirLineEdit->text().trimmed();
+	if (!sDbDir.startsWith('/')) {
+		print(tr("DB import: \"%1\" is not an absolute DB directory.")
+			.arg(sDbDir), true);
+		finishImport();
+		return;
+	}
+
+	const DbImport::Mode mode
+		= DbImport::Mode(m_ui.ModeComboBox->currentIndex());
+	const bool bFileAsDir = m_ui.FileAsDirCheckBox->isChecked();
+	const int iJobs = m_ui.JobsSpinBox->value();
+
+	// Remember the choices.
+	pOptions->sDbImportDir       = sDbDir;
+	pOptions->iDbImportMode      = int(mode);
+	pOptions->bDbImportFileAsDir = bFileAsDir;
+	pOptions->iDbImportJobs      = iJobs;
+
+	m_pDbImport = new DbImport(pOptions->sServerHost,
+		pOptions->iServerPort, pOptions->iServerTimeout, iJobs);
+
+	// Everything but what's already done goes (again)...
+	m_rows.clear();
+	m_states.clear();
+	const int iItems = m_ui.JobsListView->topLevelItemCount();
+	for (int i = 0; i < iItems; ++i) {
+		QTreeWidgetItem *pItem = m_ui.JobsListView->topLevelItem(i);
+		if (pItem->data(2, Qt::UserRole).toInt() == int(DbImport::Done))
+			continue;
+		pItem->setText(1, sDbDir);
+		pItem->setText(2, DbImport::stateText(DbImport::Queued));
+		pItem->setData(2, Qt::UserRole, int(DbImport::Queued));
+		pItem->setText(3, QString());
+		pItem->setText(4, QString());
+		pItem->setText(5, QString());
+		pItem->setToolTip(2, QString());
+		m_pDbImport->addJob(pItem->text(0), sDbDir, mode, bFileAsDir);
+		m_rows.append(i);
+		m_states.append(DbImport::Queued);
+	}
+
+	if (m_rows.isEmpty()) {
+		delete m_pDbImport;
+		m_pDbImport = NULL;
+		finishImport();
+		return;
+	}
+
+	m_ui.SummaryTextLabel->clear();
+	m_ui.ImportProgressBar->setValue(0);
+
+	m_pDbImport->start();
+	m_pTimer->start(QSAMPLER_DBIMPORT_PERIOD_MSECS);
+
+	print(tr("DB import: %1 path(s) into \"%2\", %3 job(s) at once...")
+		.arg(m_rows.count()).arg(sDbDir).arg(iJobs));
+
+	stabilizeForm();
+}
+
+
+void DbImportForm::stopImport (void)
+{
+	if (m_pDbImport == NULL)
+		return;
+
+	m_pDbImport->cancel();
+
+	print(tr("DB import: stopped; jobs already running "
+		"on the server will carry on there."), true);
+
+	refreshProgress();
+}
+
+
+// Periodic progress refreshment.
+void DbImportForm::refreshProgress (void)
+{
+	if (m_pDbImport == NULL)
+		return;
+
+	// Mind the order: last progress after it's all over.
+	const bool bFinished = m_pDbImport->isFinished();
+	const QList<DbImport::Job>& jobs = m_pDbImport->jobs();
+
+	int iFilesTotal = 0;
+	int iFilesScanned = 0;
+	for (int iJob = 0; iJob < jobs.count() && iJob < m_rows.count(); ++iJob) {
+		const DbImport::Job& job = jobs.at(iJob);
+		QTreeWidgetItem *pItem = m_ui.JobsListView->topLevelItem(m_rows.at(iJob));
+		if (pItem == NULL)
+			continue;
+		pItem->setText(2, DbImport::stateText(job.state));
+		pItem->setData(2, Qt::UserRole, int(job.state));
+		pItem->setToolTip(2, job.sError);
+		if (job.iFilesTotal >= 0) {
+			pItem->setText(3, QString("%1 / %2")
+				.arg(job.iFilesScanned).arg(job.iFilesTotal));
+			iFilesTotal += job.iFilesTotal;
+		}
+		else if (job.state != DbImport::Queued) {
+			pItem->setText(3, QString::number(job.iFilesScanned));
+		}
+		iFilesScanned += job.iFilesScanned;
+		if (job.state != DbImport::Queued)
+			pItem->setText(4, elapsedText(job.iElapsed));
+		if (job.state == DbImport::Running) {
+			pItem->setText(5, QString("%1 (%2%)")
+				.arg(job.sScanning).arg(job.iStatus));
+		} else {
+			pItem->setText(5, QString());
+		}
+		// Tell about the state changes...
+		if (job.state == m_states.at(iJob))
+			continue;
+		m_states[iJob] = job.state;
+		switch (job.state) {
+			case DbImport::Running:
+				print(tr("DB import: \"%1\" started (job %2).")
+					.arg(job.sPath).arg(job.iJobID));
+				break;
+			case DbImport::Done:
+				print(tr("DB import: \"%1\" done, %2 files in %3.")
+					.arg(job.sPath).arg(job.iFilesScanned)
+					.arg(elapsedText(job.iElapsed)));
+				break;
+			case DbImport::Failed:
+				print(tr("DB import: \"%1\" failed: %2")
+					.arg(job.sPath).arg(job.sError), true);
+				break;
+			default:
+				break;
+		}
+	}
+
+	if (iFilesTotal > 0)
+		m_ui.ImportProgressBar->setValue((100 * iFilesScanned) / iFilesTotal);
+
+	m_ui.SummaryTextLabel->setText(tr("%1 files scanned in %2 (%3 files/min).")
+		.arg(iFilesScanned)
+		.arg(elapsedText(m_pDbImport->elapsed()))
+		.arg(m_pDbImport->filesPerMinute(), 0, 'f', 1));
+
+	if (bFinished)
+		finishImport();
+}
+
+
+// Wrap up a finished run.
+void DbImportForm::finishImport (void)
+{
+	m_pTimer->stop();
+
+	int iFailed = 0;
+
+	if (m_pDbImport) {
+		m_pDbImport->wait();
+		int iDone = 0;
+		QListIterator<DbImport::Job> iter(m_pDbImport->jobs());
+		while (iter.hasNext()) {
+			const DbImport::State state = iter.next().state;
+			if (state == DbImport::Done)
+				++iDone;
+			else
+				++iFailed;
+		}
+		print(tr("DB import: %1 of %2 job(s) done; "
+			"%3 files in %4 (%5 files/min).")
+			.arg(iDone).arg(iDone + iFailed)
+			.arg(m_pDbImport->filesScanned())
+			.arg(elapsedText(m_pDbImport->elapsed()))
+			.arg(m_pDbImport->filesPerMinute(), 0, 'f', 1), iFailed > 0);
+		QStringListIterator error_iter(m_pDbImport->errors());
+		while (error_iter.hasNext())
+			print(tr("DB import: %1").arg(error_iter.next()), true);
+		delete m_pDbImport;
+		m_pDbImport = NULL;
+	}
+	else ++iFailed;
+
+	stabilizeForm();
+
+	// Headless runs are just about the imports.
+	MainForm *pMainForm = MainForm::getInstance();
+	Options *pOptions = (pMainForm ? pMainForm->options() : NULL);
+	if (pOptions && pOptions->bHeadless && pOptions->sScriptFile.isEmpty())
+		QApplication::exit(iFailed > 0 ? 1 : 0);
+}
+
+
+// Messages window (and standard output, when headless).
+void DbImportForm::print ( const QString& sText, bool bWarning ) const
+{
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL)
+		return;
+
+	if (bWarning)
+		pMainForm->appendMessagesColor(sText, "#996633");
+	else
+		pMainForm->appendMessages(sText);
+
+	Options *pOptions = pMainForm->options();
+	if (pOptions && pOptions->bHeadless) {
+		FILE *pFile = (bWarning ? stderr : stdout);
+		::fputs((sText + '\n').toUtf8().constData(), pFile);
+		::fflush(pFile);
+	}
+}
+
+
+// Running time text.
+QString DbImportForm::elapsedText ( int iElapsed )
+{
+	const int iSecs = iElapsed / 1000;
+	return QString("%1:%2:%3")
+		.arg(iSecs / 3600)
+		.arg((iSecs / 60) % 60, 2, 10, QChar('0'))
+		.arg(iSecs % 60, 2, 10, QChar('0'));
+}
+
+
+// Form state stabilization.
+void DbImportForm::stabilizeForm (void)
+{
+	MainForm *pMainForm = MainForm::getInstance();
+	const bool bClient = (pMainForm && pMainForm->client() != NULL);
+	const bool bRunning = (m_pDbImport != NULL);
+
+	m_ui.DbDirLineEdit->setEnabled(!bRunning);
+	m_ui.ModeComboBox->setEnabled(!bRunning);
+	m_ui.FileAsDirCheckBox->setEnabled(!bRunning);
+	m_ui.JobsSpinBox->setEnabled(!bRunning);
+	m_ui.AddPushButton->setEnabled(!bRunning);
+	m_ui.RemovePushButton->setEnabled(!bRunning
+		&& !m_ui.JobsListView->selectedItems().isEmpty());
+	m_ui.StartPushButton->setText(bRunning ? tr("S&top") : tr("&Start"));
+	m_ui.StartPushButton->setEnabled(bRunning
+		|| (bClient && ServerCaps::supports(ServerCaps::InstrumentsDb)
+			&& m_ui.JobsListView->topLevelItemCount() > 0
+			&& !m_ui.DbDirLineEdit->text().trimmed().isEmpty()));
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerDbImportForm.cpp
@@ -0,0 +1,106 @@
+// qsamplerDbImportForm.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerDbImportForm_h
+#define __qsamplerDbImportForm_h
+
+#include "ui_qsamplerDbImportForm.h"
+
+#include "qsamplerDbImport.h"
+
+class QTimer;
+
+
+namespace QSampler {
+
+//-------------------------------------------------------------------------
+// QSampler::DbImportForm -- instruments DB import jobs form.
+//
+
+class DbImportForm : public QWidget
+{
+	Q_OBJECT
+
+public:
+
+	// Constructor.
+	DbImportForm(QWidget *pParent = NULL, Qt::WindowFlags wflags = 0);
+
+	// Destructor.
+	~DbImportForm();
+
+	// Queue another (server-side) path to import.
+	void addPath(const QString& sPath);
+
+	// Whether any import is currently running.
+	bool isRunning() const;
+
+public slots:
+
+	// Add/remove paths to import.
+	void addPaths();
+	void removePaths();
+
+	// Start/stop importing.
+	void startImport();
+	void stopImport();
+
+	// Form state stabilization.
+	void stabilizeForm();
+
+protected slots:
+
+	// Periodic progress refreshment.
+	void refreshProgress();
+
+protected:
+
+	// Wrap up a finished run.
+	void finishImport();
+
+	// Messages window (and standard output, when headless).
+	void print(const QString& sText, bool bWarning = false) const;
+
+	// Running time text.
+	static QString elapsedText(int iElapsed);
+
+private:
+
+	// The Qt-designer UI struct...
+	Ui::qsamplerDbImportForm m_ui;
+
+	// Instance variables.
+	DbImport *m_pDbImport;
+
+	// Form rows being run, by job index.
+	QList<int> m_rows;
+	QList<DbImport::State> m_states;
+
+	QTimer *m_pTimer;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerDbImportForm_h
+
+
+// end of qsamplerDbImportForm.h
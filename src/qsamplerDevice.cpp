@@ -29,6 +29,8 @@
 #include <QCheckBox>
 #include <QSpinBox>
 #include <QLineEdit>
+#include <QtAlgorithms>
+#include <QPair>
 
 
 namespace QSampler {
@@ -739,6 +741,231 @@ QStringList Device::getDrivers ( lscp_client_t *pClient,
 }
 
 
+// Audio output latency parameter names (in order of preference).
+static const char *g_apszLatencyPeriods[] = { "FRAGMENTS", "PERIODS", "BUFFERS", NULL };
+static const char *g_apszLatencyFrames[]  = { "FRAGMENTSIZE", "PERIODSIZE", "BUFFERSIZE", NULL };
+static const char *g_apszLatencyRates[]   = { "SAMPLERATE", NULL };
+
+// Lowest sensible figures, when the driver tells nothing better.
+#define QSAMPLER_LATENCY_MIN_PERIODS  2
+#define QSAMPLER_LATENCY_MIN_FRAMES   32
+
+// Latency skew across audio devices worth a warning (msecs).
+#define QSAMPLER_LATENCY_SKEW_MSECS   1.0f
+
+
+// Latency parameter value lookup (0 if not found).
+static int latencyParam ( const DeviceParamMap& params,
+	const char **ppszNames, QString *psName = NULL )
+{
+	for (int i = 0; ppszNames[i]; ++i) {
+		DeviceParamMap::ConstIterator iter = params.constFind(ppszNames[i]);
+		if (iter == params.constEnd())
+			continue;
+		bool bOk = false;
+		const int iValue = iter.value().value.toInt(&bOk);
+		if (bOk && iValue > 0) {
+			if (psName)
+				*psName = iter.key();
+			return iValue;
+		}
+	}
+
+	return 0;
+}
+
+
+// Lower values of a latency parameter, as allowed by the driver (descending).
+static QList<int> latencyCandidates ( const DeviceParam& param,
+	int iCurrent, int iLowest )
+{
+	bool bOk = false;
+	const int iRangeMin = param.range_min.toInt(&bOk);
+	if (bOk && iRangeMin > iLowest)
+		iLowest = iRangeMin;
+	int iRangeMax = param.range_max.toInt(&bOk);
+	if (!bOk || iRangeMax < 1)
+		iRangeMax = iCurrent;
+
+	QList<int> candidates;
+	if (!param.possibilities.isEmpty()) {
+		QStringListIterator iter(param.possibilities);
+		while (iter.hasNext()) {
+			const int iValue = iter.next().toInt(&bOk);
+			if (bOk && iValue >= iLowest && iValue < iCurrent
+				&& iValue <= iRangeMax && !candidates.contains(iValue))
+				candidates.append(iValue);
+		}
+		qSort(candidates.begin(), candidates.end(), qGreater<int>());
+	} else {
+		// Halving steps, down to the lowest allowed...
+		for (int iValue = iCurrent / 2; iValue >= iLowest; iValue /= 2) {
+			if (iValue <= iRangeMax)
+				candidates.append(iValue);
+		}
+		if (iLowest < iCurrent && iLowest <= iRangeMax
+			&& (candidates.isEmpty() || candidates.last() > iLowest))
+			candidates.append(iLowest);
+	}
+
+	return candidates;
+}
+
+
+// Output latency figures (periods x period frames @ sample rate).
+bool Device::latencyFrames ( int *piPeriods, int *piFrames,
+	int *piSampleRate, QString *psPeriods, QString *psFrames ) const
+{
+	if (m_deviceType != Device::Audio)
+		return false;
+
+	const int iSampleRate = latencyParam(m_params, g_apszLatencyRates);
+	const int iFrames = latencyParam(m_params, g_apszLatencyFrames, psFrames);
+	if (iSampleRate < 1 || iFrames < 1)
+		return false;
+
+	// Assume plain double buffering when the period count is not told.
+	int iPeriods = latencyParam(m_params, g_apszLatencyPeriods, psPeriods);
+	if (iPeriods < 1)
+		iPeriods = QSAMPLER_LATENCY_MIN_PERIODS;
+
+	*piPeriods = iPeriods;
+	*piFrames = iFrames;
+	*piSampleRate = iSampleRate;
+
+	return true;
+}
+
+
+// Effective output latency (audio devices only; msecs, -1 if unknown).
+float Device::latencyMsecs (void) const
+{
+	int iPeriods, iFrames, iSampleRate;
+	if (!latencyFrames(&iPeriods, &iFrames, &iSampleRate))
+		return -1.0f;
+
+	return (1000.0f * float(iPeriods * iFrames)) / float(iSampleRate);
+}
+
+
+// Effective output latency description.
+QString Device::latencyText (void) const
+{
+	if (m_deviceType != Device::Audio)
+		return QString::null;
+
+	int iPeriods, iFrames, iSampleRate;
+	if (!latencyFrames(&iPeriods, &iFrames, &iSampleRate)) {
+		if (m_sDriverName.toUpper() == "JACK")
+			return QObject::tr("Output latency: as set by the JACK server.");
+		return QObject::tr("Output latency: unknown.");
+	}
+
+	return QObject::tr("Output latency: %1 ms (%2 x %3 frames @ %4 Hz).")
+		.arg(latencyMsecs(), 0, 'f', 1)
+		.arg(iPeriods).arg(iFrames).arg(iSampleRate);
+}
+
+
+// Lower output latency configuration suggestions.
+QStringList Device::latencySuggestions (void) const
+{
+	QStringList suggestions;
+
+	int iPeriods, iFrames, iSampleRate;
+	QString sPeriods, sFrames;
+	if (!latencyFrames(&iPeriods, &iFrames, &iSampleRate, &sPeriods, &sFrames))
+		return suggestions;
+
+	QList<int> periods;
+	if (!sPeriods.isEmpty()) {
+		periods = latencyCandidates(m_params.value(sPeriods),
+			iPeriods, QSAMPLER_LATENCY_MIN_PERIODS);
+	}
+	const QList<int> frames = latencyCandidates(m_params.value(sFrames),
+		iFrames, QSAMPLER_LATENCY_MIN_FRAMES);
+
+	// Next smaller period size, fewest periods and then both...
+	QList<QPair<int, int> > configs;
+	if (!frames.isEmpty())
+		configs.append(qMakePair(iPeriods, frames.first()));
+	if (!periods.isEmpty())
+		configs.append(qMakePair(periods.last(), iFrames));
+	if (!periods.isEmpty() && !frames.isEmpty())
+		configs.append(qMakePair(periods.last(), frames.first()));
+
+	QListIterator<QPair<int, int> > iter(configs);
+	while (iter.hasNext()) {
+		const QPair<int, int>& config = iter.next();
+		QStringList values;
+		if (config.first != iPeriods)
+			values.append(sPeriods + '=' + QString::number(config.first));
+		if (config.second != iFrames)
+			values.append(sFrames + '=' + QString::number(config.second));
+		const float fMsecs = (1000.0f * float(config.first * config.second))
+			/ float(iSampleRate);
+		suggestions.append(QObject::tr("%1 (%2 ms)")
+			.arg(values.join(", ")).arg(fMsecs, 0, 'f', 1));
+	}
+
+	return suggestions;
+}
+
+
+// Inconsistent audio device settings warnings.
+QStringList Device::latencyWarnings ( lscp_client_t *pClient )
+{
+	QStringList warnings;
+	if (pClient == NULL)
+		return warnings;
+
+	QStringList rates;
+	QList<int> distinctRates;
+	QString sMinDevice, sMaxDevice;
+	float fMinMsecs = -1.0f;
+	float fMaxMsecs = -1.0f;
+
+	const std::set<int> ids = getDeviceIDs(pClient, Device::Audio);
+	std::set<int>::const_iterator iter = ids.begin();
+	for ( ; iter != ids.end(); ++iter) {
+		const Device device(Device::Audio, *iter);
+		const int iSampleRate = latencyParam(device.params(), g_apszLatencyRates);
+		if (iSampleRate > 0) {
+			rates.append(QObject::tr("%1: %2 Hz")
+				.arg(device.deviceName()).arg(iSampleRate));
+			if (!distinctRates.contains(iSampleRate))
+				distinctRates.append(iSampleRate);
+		}
+		const float fMsecs = device.latencyMsecs();
+		if (fMsecs < 0.0f)
+			continue;
+		if (fMinMsecs < 0.0f || fMsecs < fMinMsecs) {
+			fMinMsecs = fMsecs;
+			sMinDevice = device.deviceName();
+		}
+		if (fMaxMsecs < 0.0f || fMsecs > fMaxMsecs) {
+			fMaxMsecs = fMsecs;
+			sMaxDevice = device.deviceName();
+		}
+	}
+
+	if (distinctRates.count() > 1) {
+		warnings.append(QObject::tr("Audio devices run at different "
+			"sample rates (%1).").arg(rates.join(", ")));
+	}
+
+	if (fMaxMsecs - fMinMsecs > QSAMPLER_LATENCY_SKEW_MSECS) {
+		warnings.append(QObject::tr("Output latency differs across "
+			"audio devices (%1: %2 ms, %3: %4 ms); channels on "
+			"different devices will not play in sync.")
+			.arg(sMinDevice).arg(fMinMsecs, 0, 'f', 1)
+			.arg(sMaxDevice).arg(fMaxMsecs, 0, 'f', 1));
+	}
+
+	return warnings;
+}
+
+
 //-------------------------------------------------------------------------
 // QSampler::DevicePort - MIDI/Audio Device port/channel structure.
 //
@@ -976,8 +1203,7 @@ AbstractDeviceParamModel::AbstractDeviceParamModel ( QObject* pParent )
 
 int AbstractDeviceParamModel::rowCount ( const QModelIndex& /*parent*/) const
 {
-	//std::cout << "model size=" << params.size() << "\n" << std::flush;
-	return (m_pParams ? m_pParams->size() : 0);
+	return m_rows.count();
 }
 
 
@@ -987,9 +1213,87 @@ int AbstractDeviceParamModel::columnCount ( const QModelIndex& /*parent*/) const
 }
 
 
-Qt::ItemFlags AbstractDeviceParamModel::flags ( const QModelIndex& /*index*/) const
+QVariant AbstractDeviceParamModel::data (
+	const QModelIndex& index, int role ) const
 {
-	return Qt::ItemIsEditable | Qt::ItemIsEnabled;
+	if (!index.isValid())
+		return QVariant();
+
+	const int iRow = index.row();
+	if (iRow < 0 || iRow >= m_rows.count())
+		return QVariant();
+
+	const DeviceParam& param = m_rows.at(iRow).value();
+
+	switch (index.column()) {
+		case 0:
+			if (role == Qt::DisplayRole)
+				return m_rows.at(iRow).key();
+			break;
+		case 1:
+			if (param.type == LSCP_TYPE_BOOL) {
+				if (role == Qt::CheckStateRole) {
+					return (paramValue(iRow).toLower() == "true"
+						? Qt::Checked : Qt::Unchecked);
+				}
+			}
+			else
+			if (role == Qt::DisplayRole || role == Qt::EditRole)
+				return paramValue(iRow);
+			break;
+		case 2:
+			if (role == Qt::DisplayRole)
+				return param.description;
+			break;
+		default:
+			break;
+	}
+
+	return QVariant();
+}
+
+
+bool AbstractDeviceParamModel::setData (
+	const QModelIndex& index, const QVariant& value, int role )
+{
+	if (!index.isValid() || index.column() != 1)
+		return false;
+
+	const int iRow = index.row();
+	if (iRow < 0 || iRow >= m_rows.count())
+		return false;
+
+	QString sValue;
+	if (role == Qt::CheckStateRole)
+		sValue = (value.toInt() == Qt::Checked ? "true" : "false");
+	else
+	if (role == Qt::EditRole)
+		sValue = value.toString();
+	else
+		return false;
+
+	const QString sParam = m_rows.at(iRow).key();
+	const int iRows = m_rows.count();
+
+	setParam(sParam, sValue);
+
+	// The parameter map may have been changed underneath
+	// (eg. dependent parameters), so better index it again...
+	reindex();
+	if (m_rows.count() != iRows) {
+	#if QT_VERSION < 0x050000
+		QAbstractTableModel::reset();
+	#else
+		QAbstractTableModel::beginResetModel();
+		QAbstractTableModel::endResetModel();
+	#endif
+	} else {
+		emit dataChanged(
+			QAbstractTableModel::index(0, 0),
+			QAbstractTableModel::index(iRows - 1, 2));
+	}
+
+	return true;
 }
 
 
@@ -1012,11 +1316,34 @@ QVariant AbstractDeviceParamModel::headerData (
 }
 
 
+Qt::ItemFlags AbstractDeviceParamModel::flags ( const QModelIndex& index ) const
+{
+	Qt::ItemFlags flags = Qt::ItemIsEnabled;
+
+	// Only values are editable, and only if not fixed...
+	const int iRow = index.row();
+	if (index.column() != 1 || iRow < 0 || iRow >= m_rows.count())
+		return flags;
+
+	const DeviceParam& param = m_rows.at(iRow).value();
+	if (isAlive() && param.fix)
+		return flags;
+
+	if (param.type == LSCP_TYPE_BOOL)
+		flags |= Qt::ItemIsUserCheckable;
+	else
+		flags |= Qt::ItemIsEditable;
+
+	return flags;
+}
+
+
 void AbstractDeviceParamModel::refresh (
 	const DeviceParamMap* pParams, bool bEditable )
 {
 	m_pParams   = pParams;
 	m_bEditable = bEditable;
+	reindex();
 	// inform the outer world (QTableView) that our data changed
 #if QT_VERSION < 0x050000
 	QAbstractTableModel::reset();
@@ -1030,6 +1357,7 @@ void AbstractDeviceParamModel::refresh (
 void AbstractDeviceParamModel::clear (void)
 {
 	m_pParams = NULL;
+	reindex();
 	// inform the outer world (QTableView) that our data changed
 #if QT_VERSION < 0x050000
 	QAbstractTableModel::reset();
@@ -1040,6 +1368,58 @@ void AbstractDeviceParamModel::clear (void)
 }
 
 
+// Row-indexed parameter accessors (no copies involved).
+const QString& AbstractDeviceParamModel::paramName ( int iRow ) const
+{
+	return m_rows.at(iRow).key();
+}
+
+const DeviceParam& AbstractDeviceParamModel::param ( int iRow ) const
+{
+	return m_rows.at(iRow).value();
+}
+
+
+// Current value of a parameter, or its default if not set yet
+// (eg. a device still to be created, with some values edited).
+QString AbstractDeviceParamModel::paramValue ( int iRow ) const
+{
+	const DeviceParam& param = m_rows.at(iRow).value();
+	if (isAlive() || !param.value.isEmpty())
+		return param.value;
+	return param.defaultv;
+}
+
+
+// Whether these params refer to an existing device (or port).
+bool AbstractDeviceParamModel::isAlive (void) const
+{
+	return false;
+}
+
+
+// Parameter value commit (actual device or port).
+void AbstractDeviceParamModel::setParam (
+	const QString& /*sParam*/, const QString& /*sValue*/ )
+{
+}
+
+
+// Row index (re)builder.
+void AbstractDeviceParamModel::reindex (void)
+{
+	m_rows.clear();
+
+	if (m_pParams == NULL)
+		return;
+
+	m_rows.reserve(m_pParams->count());
+	DeviceParamMap::ConstIterator iter = m_pParams->constBegin();
+	for ( ; iter != m_pParams->constEnd(); ++iter)
+		m_rows.append(iter);
+}
+
+
 //-------------------------------------------------------------------------
 // QSampler::DeviceParamModel - data model for device parameters
 //                              (used for QTableView)
@@ -1050,35 +1430,18 @@ DeviceParamModel::DeviceParamModel ( QObject *pParent )
 	m_pDevice = NULL;
 }
 
-QVariant DeviceParamModel::data (
-	const QModelIndex &index, int role) const
-{
-	if (!index.isValid())
-		return QVariant();
 
-	if (role != Qt::DisplayRole)
-		return QVariant();
-
-	DeviceParameterRow item;
-	item.name  = m_pParams->keys()[index.row()];
-	item.param = (*m_pParams)[item.name];
-	item.alive = (m_pDevice && m_pDevice->deviceID() >= 0);
-
-	return QVariant::fromValue(item);
+bool DeviceParamModel::isAlive (void) const
+{
+	return (m_pDevice && m_pDevice->deviceID() >= 0);
 }
 
 
-bool DeviceParamModel::setData (
-	const QModelIndex& index, const QVariant& value, int /*role*/)
+void DeviceParamModel::setParam (
+	const QString& sParam, const QString& sValue )
 {
-	if (!index.isValid())
-		return false;
-
-	QString key = m_pParams->keys()[index.row()];
-	//m_pParams[key].value = value.toString();
-	m_pDevice->setParam(key, value.toString());
-	emit dataChanged(index, index);
-	return true;
+	if (m_pDevice)
+		m_pDevice->setParam(sParam, sValue);
 }
 
 
@@ -1106,34 +1469,18 @@ PortParamModel::PortParamModel ( QObject *pParent)
 	m_pPort = NULL;
 }
 
-QVariant PortParamModel::data ( const QModelIndex &index, int role ) const
-{
-	if (!index.isValid())
-		return QVariant();
-
-	if (role != Qt::DisplayRole)
-		return QVariant();
-
-	DeviceParameterRow item;
-	item.name  = m_pParams->keys()[index.row()];
-	item.param = (*m_pParams)[item.name];
-	item.alive = (m_pPort && m_pPort->portID() >= 0);
 
-	return QVariant::fromValue(item);
+bool PortParamModel::isAlive (void) const
+{
+	return (m_pPort && m_pPort->portID() >= 0);
 }
 
 
-bool PortParamModel::setData (
-	const QModelIndex& index, const QVariant& value, int /*role*/)
+void PortParamModel::setParam (
+	const QString& sParam, const QString& sValue )
 {
-	if (!index.isValid())
-		return false;
-
-	QString key = m_pParams->keys()[index.row()];
-	//params[key].value = value.toString();
-	m_pPort->setParam(key, value.toString());
-	emit dataChanged(index, index);
-	return true;
+	if (m_pPort)
+		m_pPort->setParam(sParam, sValue);
 }
 
 
@@ -1153,7 +1500,7 @@ void PortParamModel::clear (void)
 
 //-------------------------------------------------------------------------
 // QSampler::DeviceParamDelegate - table cell renderer for device/port parameters
-//
+//                                 (editors are only created on demand)
 
 DeviceParamDelegate::DeviceParamDelegate ( QObject *pParent)
 	: QItemDelegate(pParent)
@@ -1164,62 +1511,43 @@ DeviceParamDelegate::DeviceParamDelegate ( QObject *pParent)
 QWidget* DeviceParamDelegate::createEditor ( QWidget *pParent,
 	const QStyleOptionViewItem& /* option */, const QModelIndex& index ) const
 {
-	if (!index.isValid())
+	if (!index.isValid() || index.column() != 1)
 		return NULL;
 
-	DeviceParameterRow r = index.model()->data(index,
-		Qt::DisplayRole).value<DeviceParameterRow>();
-
-	const bool bEnabled = (r.alive) ? !r.param.fix : true;
-
-	QString val = (r.alive) ? r.param.value : r.param.defaultv;
+	const AbstractDeviceParamModel *pModel
+		= qobject_cast<const AbstractDeviceParamModel *> (index.model());
+	if (pModel == NULL)
+		return NULL;
 
-	switch (index.column()) {
-		case 0:
-			return new QLabel(r.name, pParent);
-		case 1: {
-			if (r.param.type == LSCP_TYPE_BOOL) {
-				QCheckBox *pCheckBox = new QCheckBox(pParent);
-				if (val != QString::null)
-					pCheckBox->setChecked(val.toLower() == "true");
-				pCheckBox->setEnabled(bEnabled);
-				return pCheckBox;
-			} else if (r.param.possibilities.count() > 0) {
-				QStringList opts = r.param.possibilities;
-				if (r.param.multiplicity)
-					opts.prepend(tr("(none)"));
-				QComboBox *pComboBox = new QComboBox(pParent);
-				pComboBox->addItems(opts);
-				if (r.param.value.isEmpty())
-					pComboBox->setCurrentIndex(0);
-				else
-					pComboBox->setCurrentIndex(pComboBox->findText(val));
-				pComboBox->setEnabled(bEnabled);
-				return pComboBox;
-			} else if (r.param.type == LSCP_TYPE_INT && bEnabled) {
-				QSpinBox *pSpinBox = new QSpinBox(pParent);
-				pSpinBox->setMinimum(
-					(!r.param.range_min.isEmpty()) ?
-						r.param.range_min.toInt() : 0 // or better a negative default min value ?
-				);
-				pSpinBox->setMaximum(
-					(!r.param.range_max.isEmpty()) ?
-						r.param.range_max.toInt() : (1 << 24) // or better a higher default max value ?
-				);
-				pSpinBox->setValue(val.toInt());
-				return pSpinBox;
-			} else if (bEnabled) {
-				QLineEdit *pLineEdit = new QLineEdit(val, pParent);
-				return pLineEdit;
-			} else {
-				QLabel *pLabel = new QLabel(val, pParent);
-				return pLabel;
-			}
-		}
-		case 2:
-			return new QLabel(r.param.description, pParent);
-		default:
-			return NULL;
+	const DeviceParam& param = pModel->param(index.row());
+	const QString& val = pModel->paramValue(index.row());
+
+	if (param.possibilities.count() > 0) {
+		QStringList opts = param.possibilities;
+		if (param.multiplicity)
+			opts.prepend(tr("(none)"));
+		QComboBox *pComboBox = new QComboBox(pParent);
+		pComboBox->addItems(opts);
+		if (param.value.isEmpty())
+			pComboBox->setCurrentIndex(0);
+		else
+			pComboBox->setCurrentIndex(pComboBox->findText(val));
+		return pComboBox;
+	} else if (param.type == LSCP_TYPE_INT) {
+		QSpinBox *pSpinBox = new QSpinBox(pParent);
+		pSpinBox->setMinimum(
+			(!param.range_min.isEmpty()) ?
+				param.range_min.toInt() : 0 // or better a negative default min value ?
+		);
+		pSpinBox->setMaximum(
+			(!param.range_max.isEmpty()) ?
+				param.range_max.toInt() : (1 << 24) // or better a higher default max value ?
+		);
+		pSpinBox->setValue(val.toInt());
+		return pSpinBox;
+	} else {
+		QLineEdit *pLineEdit = new QLineEdit(val, pParent);
+		return pLineEdit;
 	}
 }
 
@@ -1235,12 +1563,7 @@ void DeviceParamDelegate::setModelData ( QWidget *pEditor,
 	QAbstractItemModel *pModel, const QModelIndex& index ) const
 {
 	if (index.column() == 1) {
-		DeviceParameterRow r = index.model()->data(index,
-			Qt::DisplayRole).value<DeviceParameterRow> ();
-		if (pEditor->metaObject()->className() == QString("QCheckBox")) {
-			QCheckBox *pCheckBox = static_cast<QCheckBox *> (pEditor);
-			pModel->setData(index, QVariant(pCheckBox->checkState() == Qt::Checked));
-		} else if (pEditor->metaObject()->className() == QString("QComboBox")) {
+		if (pEditor->metaObject()->className() == QString("QComboBox")) {
 			QComboBox *pComboBox = static_cast<QComboBox *> (pEditor);
 			pModel->setData(index, pComboBox->currentText());
 		} else if (pEditor->metaObject()->className() == QString("QSpinBox")) {
@@ -1249,9 +1572,6 @@ void DeviceParamDelegate::setModelData ( QWidget *pEditor,
 		} else if (pEditor->metaObject()->className() == QString("QLineEdit")) {
 			QLineEdit *pLineEdit = static_cast<QLineEdit *> (pEditor);
 			pModel->setData(index, pLineEdit->text());
-		} else if (pEditor->metaObject()->className() == QString("QLabel")) {
-			QLabel *pLabel = static_cast<QLabel *> (pEditor);
-			pModel->setData(index, pLabel->text());
 		}
 	}
 }
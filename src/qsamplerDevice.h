@@ -34,12 +34,14 @@
 #include <QModelIndex>
 #include <QSize>
 #include <QList>
+#include <QVector>
 #include <set>
 
 #include <lscp/client.h>
 #include <lscp/device.h>
 
 #include "qsamplerOptions.h"
+#include "qsamplerResources.h"
 
 namespace QSampler {
 
@@ -160,11 +162,25 @@ public:
 	static QStringList getDrivers(lscp_client_t *pClient,
 		DeviceType deviceType);
 
+	// Effective output latency (audio devices only; msecs, -1 if unknown).
+	float latencyMsecs() const;
+	// Effective output latency description.
+	QString latencyText() const;
+	// Lower output latency configuration suggestions.
+	QStringList latencySuggestions() const;
+
+	// Inconsistent audio device settings warnings.
+	static QStringList latencyWarnings(lscp_client_t *pClient);
+
 private:
 
 	// Refresh/set given parameter based on driver supplied dependencies.
 	int refreshParam(const QString& sParam);
 
+	// Output latency figures (periods x period frames @ sample rate).
+	bool latencyFrames(int *piPeriods, int *piFrames, int *piSampleRate,
+		QString *psPeriods = NULL, QString *psFrames = NULL) const;
+
 	// Instance variables.
 	int        m_iDeviceID;
 	DeviceType m_deviceType;
@@ -177,6 +193,9 @@ private:
 
 	// Device port/channel list.
 	DevicePortList m_ports;
+
+	// Live object accounting.
+	ResourceCount<Resources::Devices> m_resourceCount;
 };
 
 
@@ -217,6 +236,9 @@ private:
 
 	// Device port parameter list.
 	DeviceParamMap m_params;
+
+	// Live object accounting.
+	ResourceCount<Resources::DevicePorts> m_resourceCount;
 };
 
 
@@ -247,14 +269,6 @@ private:
 };
 
 
-struct DeviceParameterRow {
-	QString     name;
-	DeviceParam param;
-	bool        alive; // whether these params refer to an existing device
-	                   // or for a device that is yet to be created
-};
-
-
 //-------------------------------------------------------------------------
 // QSampler::AbstractDeviceParamModel - data model base class for device parameters
 //
@@ -270,6 +284,9 @@ public:
 	// Overridden methods from subclass(es)
 	int rowCount(const QModelIndex& parent = QModelIndex()) const;
 	int columnCount(const QModelIndex& parent = QModelIndex() ) const;
+	QVariant data(const QModelIndex& index, int role) const;
+	bool setData(const QModelIndex& index,
+		const QVariant& value, int role = Qt::EditRole);
 	QVariant headerData(int section,
 		Qt::Orientation orientation, int role = Qt::DisplayRole) const;
 	Qt::ItemFlags flags(const QModelIndex& index) const;
@@ -278,10 +295,32 @@ public:
 
 	void refresh(const DeviceParamMap* params, bool bEditable);
 
+	// Row-indexed parameter accessors (no copies involved).
+	const QString& paramName(int iRow) const;
+	const DeviceParam& param(int iRow) const;
+
+	// Current value of a parameter, or its default if not alive.
+	QString paramValue(int iRow) const;
+
+	// Whether these params refer to an existing device (or port)
+	// or for a device that is yet to be created.
+	virtual bool isAlive() const;
+
 protected:
 
+	// Parameter value commit (actual device or port).
+	virtual void setParam(const QString& sParam, const QString& sValue);
+
+	// Row index (re)builder.
+	void reindex();
+
 	const DeviceParamMap *m_pParams;
 	bool m_bEditable;
+
+private:
+
+	// Parameter map iterators, by row.
+	QVector<DeviceParamMap::ConstIterator> m_rows;
 };
 
 
@@ -297,17 +336,18 @@ public:
 
 	DeviceParamModel(QObject *pParent = NULL);
 
-	// Overridden methods from subclass(es)
-	QVariant data(const QModelIndex &index, int role) const;
-	bool setData(const QModelIndex& index,
-		const QVariant& value, int role = Qt::EditRole);
-
 	void clear();
 
+	bool isAlive() const;
+
 public slots:
 
 	void refresh(Device* pDevice, bool bEditable);
 
+protected:
+
+	void setParam(const QString& sParam, const QString& sValue);
+
 private:
 
 	Device *m_pDevice;
@@ -326,17 +366,18 @@ public:
 
 	PortParamModel(QObject *pParent = 0);
 
-	// overridden methods from subclass(es)
-	QVariant data(const QModelIndex &index, int role) const;
-	bool setData(const QModelIndex& index,
-		const QVariant& value, int role = Qt::EditRole);
-
 	void clear();
 
+	bool isAlive() const;
+
 public slots:
 
 	void refresh(DevicePort* pPort, bool bEditable);
 
+protected:
+
+	void setParam(const QString& sParam, const QString& sValue);
+
 private:
 
 	DevicePort* m_pPort;
@@ -345,7 +386,7 @@ private:
 
 //-------------------------------------------------------------------------
 // QSampler::DeviceParamDelegate - table cell renderer for device/port parameters
-//
+//                                 (editors are only created on demand)
 
 class DeviceParamDelegate : public QItemDelegate
 {
@@ -366,9 +407,6 @@ public:
 
 } // namespace QSampler
 
-// so we can use it i.e. through QVariant
-Q_DECLARE_METATYPE(QSampler::DeviceParameterRow)
-
 #endif  // __qsamplerDevice_h
 
 
@@ -24,6 +24,7 @@
 
 #include "qsamplerAbout.h"
 #include "qsamplerMainForm.h"
+#include "qsamplerServerCall.h"
 
 #include <QHeaderView>
 #include <QMessageBox>
@@ -60,8 +61,10 @@ DeviceForm::DeviceForm ( QWidget *pParent, Qt::WindowFlags wflags )
 	m_ui.DeviceParamTable->horizontalHeader()->setDefaultAlignment(Qt::AlignLeft);
 	m_ui.DevicePortParamTable->horizontalHeader()->setDefaultAlignment(Qt::AlignLeft);
 
+	// Cells are just painted; editors only come to life when editing.
 	m_ui.DeviceParamTable->setModel(&m_deviceParamModel);
 	m_ui.DeviceParamTable->setItemDelegate(&m_deviceParamDelegate);
+	m_ui.DeviceParamTable->setEditTriggers(QAbstractItemView::AllEditTriggers);
 #if QT_VERSION >= 0x050000
 	m_ui.DeviceParamTable->horizontalHeader()->setSectionResizeMode(2, QHeaderView::Stretch);
 #else
@@ -71,6 +74,7 @@ DeviceForm::DeviceForm ( QWidget *pParent, Qt::WindowFlags wflags )
 
 	m_ui.DevicePortParamTable->setModel(&m_devicePortParamModel);
 	m_ui.DevicePortParamTable->setItemDelegate(&m_devicePortParamDelegate);
+	m_ui.DevicePortParamTable->setEditTriggers(QAbstractItemView::AllEditTriggers);
 #if QT_VERSION >= 0x050000
 	m_ui.DevicePortParamTable->horizontalHeader()->setSectionResizeMode(2, QHeaderView::Stretch);
 #else
@@ -108,17 +112,8 @@ DeviceForm::DeviceForm ( QWidget *pParent, Qt::WindowFlags wflags )
 		SIGNAL(clicked()),
 		SLOT(close()));
 	QObject::connect(&m_deviceParamModel,
-		SIGNAL(modelReset()),
-		SLOT(updateCellRenderers()));
-	QObject::connect(&m_deviceParamModel,
-		SIGNAL(dataChanged(const QModelIndex&, const QModelIndex&)),
-		SLOT(updateCellRenderers(const QModelIndex&, const QModelIndex&)));
-	QObject::connect(&m_devicePortParamModel,
-		SIGNAL(modelReset()),
-		SLOT(updatePortCellRenderers()));
-	QObject::connect(&m_devicePortParamModel,
 		SIGNAL(dataChanged(const QModelIndex&, const QModelIndex&)),
-		SLOT(updatePortCellRenderers(const QModelIndex&, const QModelIndex&)));
+		SLOT(updateDeviceLatency()));
 }
 
 
@@ -337,7 +332,10 @@ void DeviceForm::refreshDevices (void)
 	m_pAudioItems = NULL;
 	m_pMidiItems = NULL;
 	m_ui.DeviceListView->clear();
-	if (pMainForm->client()) {
+	m_latencyWarnings.clear();
+	// Interactive deadlines, as long as the form is there to care...
+	ServerCall call(pMainForm->client(), ServerCall::Interactive, this);
+	if (call.isValid()) {
 		int *piDeviceIDs;
 		// Grab and pop Audio devices...
 		if (m_deviceTypeMode == Device::None ||
@@ -348,11 +346,14 @@ void DeviceForm::refreshDevices (void)
 		if (m_pAudioItems) {
 			piDeviceIDs = Device::getDevices(pMainForm->client(),
 				Device::Audio);
-			for (int i = 0; piDeviceIDs && piDeviceIDs[i] >= 0; i++) {
+			for (int i = 0; piDeviceIDs && piDeviceIDs[i] >= 0
+					&& call.check(); i++) {
 				new DeviceItem(m_pAudioItems,
 					Device::Audio, piDeviceIDs[i]);
 			}
 			m_pAudioItems->setExpanded(true);
+			if (call.check())
+				m_latencyWarnings = Device::latencyWarnings(pMainForm->client());
 		}
 		// Grab and pop MIDI devices...
 		if (m_deviceTypeMode == Device::None ||
@@ -360,10 +361,11 @@ void DeviceForm::refreshDevices (void)
 			m_pMidiItems = new DeviceItem(m_ui.DeviceListView,
 				Device::Midi);
 		}
-		if (m_pMidiItems) {
+		if (m_pMidiItems && call.check()) {
 			piDeviceIDs = Device::getDevices(pMainForm->client(),
 				Device::Midi);
-			for (int i = 0; piDeviceIDs && piDeviceIDs[i] >= 0; i++) {
+			for (int i = 0; piDeviceIDs && piDeviceIDs[i] >= 0
+					&& call.check(); i++) {
 				new DeviceItem(m_pMidiItems,
 					Device::Midi, piDeviceIDs[i]);
 			}
@@ -425,6 +427,7 @@ void DeviceForm::selectDevice ()
 	if (pItem == NULL || pItem->type() != QSAMPLER_DEVICE_ITEM) {
 		m_deviceType = Device::None;
 		m_ui.DeviceNameTextLabel->setText(QString::null);
+		m_ui.DeviceLatencyTextLabel->setText(QString::null);
 		m_deviceParamModel.clear();
 		m_ui.DevicePortComboBox->clear();
 		m_devicePortParamModel.clear();
@@ -458,6 +461,8 @@ void DeviceForm::selectDevice ()
 	m_ui.DriverNameComboBox->setEnabled(m_bNewDevice);
 	// Fill the device parameter table...
 	m_deviceParamModel.refresh(&device, m_bNewDevice);
+	// Effective output latency, if any...
+	updateDeviceLatency();
 	// And now the device port/channel parameter table...
 	switch (device.deviceType()) {
 	case Device::Audio:
@@ -559,8 +564,8 @@ void DeviceForm::changeDeviceParam ( int iRow, int iCol )
 	// Table 1st column has the parameter name;
 	//const QString sParam = m_ui.DeviceParamTable->text(iRow, 0);
 	//const QString sValue = m_ui.DeviceParamTable->text(iRow, iCol);
-	const QString sParam = m_deviceParamModel.data(m_deviceParamModel.index(iRow, 0), Qt::DisplayRole).value<DeviceParameterRow>().name;
-	const QString sValue = m_deviceParamModel.data(m_deviceParamModel.index(iRow, iCol), Qt::DisplayRole).value<DeviceParameterRow>().param.value;
+	const QString sParam = m_deviceParamModel.paramName(iRow);
+	const QString sValue = m_deviceParamModel.paramValue(iRow);
 	// Set the local device parameter value.
 	if (device.setParam(sParam, sValue)) {
 		selectDevice();
@@ -605,8 +610,8 @@ void DeviceForm::changeDevicePortParam ( int iRow, int iCol )
 	// Table 1st column has the parameter name;
 	//const QString sParam = m_ui.DevicePortParamTable->text(iRow, 0);
 	//const QString sValue = m_ui.DevicePortParamTable->text(iRow, iCol);
-	const QString sParam = m_devicePortParamModel.data(m_devicePortParamModel.index(iRow, 0), Qt::DisplayRole).value<DeviceParameterRow>().name;
-	const QString sValue = m_devicePortParamModel.data(m_devicePortParamModel.index(iRow, iCol), Qt::DisplayRole).value<DeviceParameterRow>().param.value;
+	const QString sParam = m_devicePortParamModel.paramName(iRow);
+	const QString sValue = m_devicePortParamModel.paramValue(iRow);
 
 	// Set the local device port/channel parameter value.
 	pPort->setParam(sParam, sValue);
@@ -674,49 +679,32 @@ void DeviceForm::stabilizeForm (void)
 }
 
 
-void DeviceForm::updateCellRenderers (void)
+// Audio device output latency display.
+void DeviceForm::updateDeviceLatency (void)
 {
-	const int rows = m_deviceParamModel.rowCount();
-	const int cols = m_deviceParamModel.columnCount();
-	updateCellRenderers(
-		m_deviceParamModel.index(0, 0),
-		m_deviceParamModel.index(rows - 1, cols - 1));
-}
-
+	QTreeWidgetItem* pItem = m_ui.DeviceListView->currentItem();
+	if (pItem == NULL || pItem->type() != QSAMPLER_DEVICE_ITEM) {
+		m_ui.DeviceLatencyTextLabel->setText(QString::null);
+		return;
+	}
 
-void DeviceForm::updateCellRenderers (
-	const QModelIndex& topLeft, const QModelIndex& bottomRight )
-{
-	for (int r = topLeft.row(); r <= bottomRight.row(); r++) {
-		for (int c = topLeft.column(); c <= bottomRight.column(); c++) {
-			const QModelIndex index = m_deviceParamModel.index(r, c);
-			m_ui.DeviceParamTable->openPersistentEditor(index);
-		}
+	const Device& device = ((DeviceItem *) pItem)->device();
+	if (device.deviceType() != Device::Audio) {
+		m_ui.DeviceLatencyTextLabel->setText(QString::null);
+		return;
 	}
-}
 
+	QString sText = device.latencyText();
+	const QStringList& suggestions = device.latencySuggestions();
+	if (!suggestions.isEmpty())
+		sText += '\n' + tr("Lower latency: %1.").arg(suggestions.join("; "));
+	if (!m_latencyWarnings.isEmpty())
+		sText += '\n' + m_latencyWarnings.join("\n");
 
-void DeviceForm::updatePortCellRenderers (void)
-{
-	const int rows = m_devicePortParamModel.rowCount();
-	const int cols = m_devicePortParamModel.columnCount();
-	updatePortCellRenderers(
-		m_devicePortParamModel.index(0, 0),
-		m_devicePortParamModel.index(rows - 1, cols - 1));
+	m_ui.DeviceLatencyTextLabel->setText(sText);
 }
 
 
-void DeviceForm::updatePortCellRenderers ( 
-	const QModelIndex& topLeft, const QModelIndex& bottomRight )
-{
-	for (int r = topLeft.row(); r <= bottomRight.row(); r++) {
-		for (int c = topLeft.column(); c <= bottomRight.column(); c++) {
-			const QModelIndex index = m_devicePortParamModel.index(r, c);
-			m_ui.DevicePortParamTable->openPersistentEditor(index);
-		}
-	}
-}
-
 } // namespace QSampler
 
 
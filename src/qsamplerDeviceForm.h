@@ -60,12 +60,7 @@ public slots:
 	void deviceListViewContextMenu(const QPoint& pos);
 	void stabilizeForm();
 
-	void updateCellRenderers();
-	void updateCellRenderers(
-		const QModelIndex& topLeft, const QModelIndex& bottomRight);
-	void updatePortCellRenderers();
-	void updatePortCellRenderers(
-		const QModelIndex& topLeft, const QModelIndex& bottomRight);
+	void updateDeviceLatency();
 
 signals:
 
@@ -94,6 +89,9 @@ private:
 	Device::DeviceType m_deviceTypeMode;
 	DeviceItem *m_pAudioItems;
 	DeviceItem *m_pMidiItems;
+
+	// Audio device settings consistency warnings.
+	QStringList m_latencyWarnings;
 };
 
 } // namespace QSampler
@@ -24,6 +24,7 @@
 #include "qsamplerDeviceStatusForm.h"
 
 #include "qsamplerMainForm.h"
+#include "qsamplerServerCaps.h"
 
 #include <QGridLayout>
 
@@ -55,9 +56,8 @@ MidiActivityLED::MidiActivityLED ( QString sText, QWidget *pParent )
 	}
 
 	setPixmap(*g_pMidiActivityLedOff);
-#ifndef CONFIG_EVENT_DEVICE_MIDI
-	setToolTip("MIDI Activity disabled");
-#endif
+	if (!ServerCaps::supports(ServerCaps::DeviceMidiEvents))
+		setToolTip("MIDI Activity disabled");
 	m_timer.setSingleShot(true);
 
 	QObject::connect(&m_timer,
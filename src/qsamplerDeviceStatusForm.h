@@ -98,6 +98,9 @@ private:
 	std::vector<MidiActivityLED *> m_midiActivityLEDs;
 
 	static std::map<int, DeviceStatusForm*> g_instances;
+
+	// Live object accounting.
+	ResourceCount<Resources::DeviceStatusForms> m_resourceCount;
 };
 
 } // namespace QSampler
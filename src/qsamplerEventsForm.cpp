@@ -0,0 +1,317 @@
+// qsamplerEventsForm.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerEventsForm.h"
+
+#include "qsamplerMainForm.h"
+
+#include <QHeaderView>
+#include <QTimer>
+
+#include <QShowEvent>
+#include <QHideEvent>
+#include <QCloseEvent>
+
+
+namespace QSampler {
+
+// Rate sampling period (msecs).
+#define QSAMPLER_EVENTS_PERIOD_MSECS  1000
+
+// Maximum gap between events of the same burst (msecs).
+#define QSAMPLER_EVENTS_BURST_MSECS   50
+
+// Recent events ring-buffer capacity.
+#define QSAMPLER_EVENTS_RECENT        1000
+
+
+//-------------------------------------------------------------------------
+// QSampler::EventsForm -- LSCP event inspector form.
+//
+
+// Constructor.
+EventsForm::EventsForm ( QWidget *pParent, Qt::WindowFlags wflags )
+	: QWidget(pParent, wflags), m_items(QSAMPLER_EVENTS_RECENT),
+		m_iHead(0), m_iCount(0), m_bDirty(false)
+{
+	m_ui.setupUi(this);
+
+	m_ui.EventsGraph->setStats(&m_stats);
+	m_ui.StatsListView->sortByColumn(0, Qt::AscendingOrder);
+	m_ui.StatsListView->header()->resizeSection(0, 200);
+	m_ui.RecentListView->header()->resizeSection(0, 100);
+	m_ui.RecentListView->header()->resizeSection(1, 200);
+
+	m_pTimer = new QTimer(this);
+
+	QObject::connect(m_pTimer,
+		SIGNAL(timeout()),
+		SLOT(timerSlot()));
+	QObject::connect(m_ui.FilterLineEdit,
+		SIGNAL(textChanged(const QString&)),
+		SLOT(filterChanged()));
+	QObject::connect(m_ui.ClearPushButton,
+		SIGNAL(clicked()),
+		SLOT(clearEvents()));
+	QObject::connect(m_ui.StatsListView,
+		SIGNAL(itemChanged(QTreeWidgetItem *, int)),
+		SLOT(statsItemChanged(QTreeWidgetItem *, int)));
+}
+
+
+// Destructor.
+EventsForm::~EventsForm (void)
+{
+	m_stats.clear();
+}
+
+
+// Account for one dispatched event (stamped on callback arrival).
+void EventsForm::eventArrived ( lscp_event_t event,
+	const QString& sData, qint64 iStamp )
+{
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL)
+		return;
+
+	const qint64 iDelay = pMainForm->timestamp() - iStamp;
+
+	EventsGraph::StatsMap::Iterator iter = m_stats.find(int(event));
+	if (iter == m_stats.end()) {
+		EventsGraph::Stats stats;
+		stats.pItem = NULL;
+		stats.color = QColor::fromHsv((m_stats.count() * 67) % 360, 200, 220);
+		stats.iTotal = 0;
+		stats.iCount = 0;
+		stats.iPeakRate = 0;
+		stats.iBurst = 0;
+		stats.iLastBurst = 0;
+		stats.iMaxBurst = 0;
+		stats.iLastStamp = 0;
+		stats.iDelaySum = 0;
+		stats.iDelayMax = 0;
+		iter = m_stats.insert(int(event), stats);
+	}
+
+	EventsGraph::Stats& stats = iter.value();
+	++stats.iTotal;
+	++stats.iCount;
+	if (stats.iBurst > 0
+		&& iStamp - stats.iLastStamp <= QSAMPLER_EVENTS_BURST_MSECS) {
+		++stats.iBurst;
+	} else {
+		if (stats.iBurst > 0)
+			stats.iLastBurst = stats.iBurst;
+		stats.iBurst = 1;
+	}
+	if (stats.iMaxBurst < stats.iBurst)
+		stats.iMaxBurst = stats.iBurst;
+	stats.iLastStamp = iStamp;
+	stats.iDelaySum += iDelay;
+	if (stats.iDelayMax < iDelay)
+		stats.iDelayMax = iDelay;
+
+	// Recent events ring-buffer...
+	Item& item = m_items[m_iHead];
+	item.time   = QTime::currentTime();
+	item.event  = event;
+	item.iDelay = int(iDelay);
+	item.sData  = sData.simplified();
+	m_iHead = (m_iHead + 1) % QSAMPLER_EVENTS_RECENT;
+	if (m_iCount < QSAMPLER_EVENTS_RECENT)
+		++m_iCount;
+
+	m_bDirty = true;
+}
+
+
+// Reset all statistics and the recent event buffer.
+void EventsForm::clearEvents (void)
+{
+	m_stats.clear();
+	m_ui.StatsListView->clear();
+	m_ui.RecentListView->clear();
+
+	m_iHead  = 0;
+	m_iCount = 0;
+
+	m_bDirty = false;
+
+	m_ui.EventsGraph->update();
+}
+
+
+// Periodic rate sampling and view refreshment (only while visible).
+void EventsForm::timerSlot (void)
+{
+	EventsGraph::StatsMap::Iterator iter = m_stats.begin();
+	for ( ; iter != m_stats.end(); ++iter) {
+		EventsGraph::Stats& stats = iter.value();
+		stats.rates.append(stats.iCount);
+		while (stats.rates.count() > QSAMPLER_EVENTS_HISTORY)
+			stats.rates.removeFirst();
+		if (stats.iPeakRate < stats.iCount)
+			stats.iPeakRate = stats.iCount;
+		stats.iCount = 0;
+	}
+
+	refreshStats();
+	m_ui.EventsGraph->update();
+
+	if (m_bDirty)
+		refreshRecent();
+}
+
+
+// Recent event list filter.
+void EventsForm::filterChanged (void)
+{
+	refreshRecent();
+}
+
+
+// Graph visibility of each event type.
+void EventsForm::statsItemChanged ( QTreeWidgetItem */*pItem*/, int iColumn )
+{
+	if (iColumn == 0)
+		m_ui.EventsGraph->update();
+}
+
+
+// Per-type statistics view refresher.
+void EventsForm::refreshStats (void)
+{
+	m_ui.StatsListView->blockSignals(true);
+	m_ui.StatsListView->setSortingEnabled(false);
+
+	EventsGraph::StatsMap::Iterator iter = m_stats.begin();
+	for ( ; iter != m_stats.end(); ++iter) {
+		EventsGraph::Stats& stats = iter.value();
+		if (stats.pItem == NULL) {
+			stats.pItem = new QTreeWidgetItem(m_ui.StatsListView);
+			stats.pItem->setText(0,
+				::lscp_event_to_text(lscp_event_t(iter.key())));
+			stats.pItem->setData(0, Qt::DecorationRole, stats.color);
+			stats.pItem->setCheckState(0, Qt::Checked);
+			for (int i = 1; i < 8; ++i)
+				stats.pItem->setTextAlignment(i, Qt::AlignRight);
+		}
+		const int iRate = (stats.rates.isEmpty() ? 0 : stats.rates.last());
+		const int iBurst = (stats.iLastBurst > 0
+			? stats.iLastBurst : stats.iBurst);
+		stats.pItem->setText(1, QString::number(stats.iTotal));
+		stats.pItem->setText(2, tr("%1/s").arg(iRate));
+		stats.pItem->setText(3, tr("%1/s").arg(stats.iPeakRate));
+		stats.pItem->setText(4, QString::number(iBurst));
+		stats.pItem->setText(5, QString::number(stats.iMaxBurst));
+		stats.pItem->setText(6, tr("%1 ms")
+			.arg(stats.iTotal > 0 ? stats.iDelaySum / stats.iTotal : 0));
+		stats.pItem->setText(7, tr("%1 ms").arg(stats.iDelayMax));
+	}
+
+	m_ui.StatsListView->setSortingEnabled(true);
+	m_ui.StatsListView->blockSignals(false);
+}
+
+
+// Recent events view refresher (most recent first).
+void EventsForm::refreshRecent (void)
+{
+	const QString& sFilter = m_ui.FilterLineEdit->text().trimmed();
+
+	m_ui.RecentListView->setUpdatesEnabled(false);
+	m_ui.RecentListView->clear();
+
+	QList<QTreeWidgetItem *> items;
+	for (int i = 0; i < m_iCount; ++i) {
+		const int iIndex = (m_iHead - 1 - i + QSAMPLER_EVENTS_RECENT)
+			% QSAMPLER_EVENTS_RECENT;
+		const Item& item = m_items.at(iIndex);
+		const QString sEvent = ::lscp_event_to_text(item.event);
+		if (!sFilter.isEmpty()
+			&& !sEvent.contains(sFilter, Qt::CaseInsensitive)
+			&& !item.sData.contains(sFilter, Qt::CaseInsensitive))
+			continue;
+		QTreeWidgetItem *pItem = new QTreeWidgetItem();
+		pItem->setText(0, item.time.toString("hh:mm:ss.zzz"));
+		pItem->setText(1, sEvent);
+		pItem->setText(2, tr("%1 ms").arg(item.iDelay));
+		pItem->setTextAlignment(2, Qt::AlignRight);
+		pItem->setText(3, item.sData);
+		items.append(pItem);
+	}
+	m_ui.RecentListView->addTopLevelItems(items);
+
+	m_ui.RecentListView->setUpdatesEnabled(true);
+
+	m_bDirty = false;
+}
+
+
+// Notify our parent that we're emerging.
+void EventsForm::showEvent ( QShowEvent *pShowEvent )
+{
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm)
+		pMainForm->stabilizeForm();
+
+	// Whatever arrived while hidden is not a rate sample...
+	EventsGraph::StatsMap::Iterator iter = m_stats.begin();
+	for ( ; iter != m_stats.end(); ++iter)
+		iter.value().iCount = 0;
+
+	refreshStats();
+	refreshRecent();
+
+	m_pTimer->start(QSAMPLER_EVENTS_PERIOD_MSECS);
+
+	QWidget::showEvent(pShowEvent);
+}
+
+
+// Notify our parent that we're closing.
+void EventsForm::hideEvent ( QHideEvent *pHideEvent )
+{
+	m_pTimer->stop();
+
+	QWidget::hideEvent(pHideEvent);
+
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm)
+		pMainForm->stabilizeForm();
+}
+
+
+// Just about to notify main-window that we're closing.
+void EventsForm::closeEvent ( QCloseEvent * /*pCloseEvent*/ )
+{
+	QWidget::hide();
+
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm)
+		pMainForm->stabilizeForm();
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerEventsForm.cpp
@@ -0,0 +1,116 @@
+// qsamplerEventsForm.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerEventsForm_h
+#define __qsamplerEventsForm_h
+
+#include "ui_qsamplerEventsForm.h"
+
+#include <QVector>
+#include <QTime>
+
+#include <lscp/client.h>
+
+class QTreeWidgetItem;
+class QTimer;
+
+
+namespace QSampler {
+
+//-------------------------------------------------------------------------
+// QSampler::EventsForm -- LSCP event inspector form.
+//
+
+class EventsForm : public QWidget
+{
+	Q_OBJECT
+
+public:
+
+	// Constructor.
+	EventsForm(QWidget *pParent = NULL, Qt::WindowFlags wflags = 0);
+
+	// Destructor.
+	~EventsForm();
+
+	// Account for one dispatched event (stamped on callback arrival).
+	void eventArrived(lscp_event_t event,
+		const QString& sData, qint64 iStamp);
+
+public slots:
+
+	// Reset all statistics and the recent event buffer.
+	void clearEvents();
+
+protected slots:
+
+	// Periodic rate sampling and view refreshment (only while visible).
+	void timerSlot();
+
+	// Recent event list filter.
+	void filterChanged();
+
+	// Graph visibility of each event type.
+	void statsItemChanged(QTreeWidgetItem *pItem, int iColumn);
+
+protected:
+
+	void showEvent(QShowEvent *pShowEvent);
+	void hideEvent(QHideEvent *pHideEvent);
+	void closeEvent(QCloseEvent *pCloseEvent);
+
+	// View refreshers.
+	void refreshStats();
+	void refreshRecent();
+
+private:
+
+	// The Qt-designer UI struct...
+	Ui::qsamplerEventsForm m_ui;
+
+	// Recent event ring-buffer item.
+	struct Item
+	{
+		QTime        time;
+		lscp_event_t event;
+		int          iDelay;
+		QString      sData;
+	};
+
+	// Instance variables.
+	EventsGraph::StatsMap m_stats;
+
+	QVector<Item> m_items;
+	int m_iHead;
+	int m_iCount;
+
+	bool m_bDirty;
+
+	QTimer *m_pTimer;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerEventsForm_h
+
+
+// end of qsamplerEventsForm.h
@@ -0,0 +1,115 @@
+// qsamplerEventsGraph.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerEventsGraph.h"
+
+#include <QTreeWidgetItem>
+#include <QPainter>
+#include <QPolygonF>
+
+
+namespace QSampler {
+
+//-------------------------------------------------------------------------
+// QSampler::EventsGraph -- per-type event rate graph.
+//
+
+// Constructor.
+EventsGraph::EventsGraph ( QWidget *pParent )
+	: QWidget(pParent), m_pStats(NULL)
+{
+}
+
+
+// Statistics to draw from.
+void EventsGraph::setStats ( const StatsMap *pStats )
+{
+	m_pStats = pStats;
+
+	QWidget::update();
+}
+
+
+// Rate history painter (most recent on the right).
+void EventsGraph::paintEvent ( QPaintEvent * /*pPaintEvent*/ )
+{
+	QPainter painter(this);
+
+	const int w = QWidget::width();
+	const int h = QWidget::height();
+
+	painter.fillRect(0, 0, w, h, Qt::black);
+
+	if (m_pStats == NULL)
+		return;
+
+	// Find the common scale...
+	int iMaxRate = 1;
+	StatsMap::ConstIterator iter = m_pStats->constBegin();
+	for ( ; iter != m_pStats->constEnd(); ++iter) {
+		const Stats& stats = iter.value();
+		if (stats.pItem && stats.pItem->checkState(0) != Qt::Checked)
+			continue;
+		QListIterator<int> rate(stats.rates);
+		while (rate.hasNext()) {
+			const int iRate = rate.next();
+			if (iMaxRate < iRate)
+				iMaxRate = iRate;
+		}
+	}
+
+	// Grid...
+	painter.setPen(QColor(Qt::darkGray).darker());
+	for (int i = 1; i < 4; ++i)
+		painter.drawLine(0, (h * i) / 4, w, (h * i) / 4);
+
+	const qreal dx = qreal(w - 1) / qreal(QSAMPLER_EVENTS_HISTORY - 1);
+	const qreal dy = qreal(h - 4) / qreal(iMaxRate);
+
+	painter.setRenderHint(QPainter::Antialiasing, true);
+	for (iter = m_pStats->constBegin(); iter != m_pStats->constEnd(); ++iter) {
+		const Stats& stats = iter.value();
+		if (stats.pItem && stats.pItem->checkState(0) != Qt::Checked)
+			continue;
+		const int iCount = stats.rates.count();
+		if (iCount < 1)
+			continue;
+		QPolygonF polyline;
+		for (int i = 0; i < iCount; ++i) {
+			const qreal x = qreal(w - 1) - dx * qreal(iCount - 1 - i);
+			const qreal y = qreal(h - 2) - dy * qreal(stats.rates.at(i));
+			polyline.append(QPointF(x, y));
+		}
+		painter.setPen(stats.color);
+		painter.drawPolyline(polyline);
+	}
+	painter.setRenderHint(QPainter::Antialiasing, false);
+
+	painter.setPen(Qt::gray);
+	painter.drawText(4, 2, w - 8, h - 4, Qt::AlignTop | Qt::AlignLeft,
+		tr("%1/s").arg(iMaxRate));
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerEventsGraph.cpp
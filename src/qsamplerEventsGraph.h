@@ -0,0 +1,87 @@
+// qsamplerEventsGraph.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerEventsGraph_h
+#define __qsamplerEventsGraph_h
+
+#include <QWidget>
+#include <QColor>
+#include <QList>
+#include <QMap>
+
+class QTreeWidgetItem;
+
+
+namespace QSampler {
+
+// Rate history length (periods).
+#define QSAMPLER_EVENTS_HISTORY  60
+
+
+//-------------------------------------------------------------------------
+// QSampler::EventsGraph -- per-type event rate graph.
+//
+
+class EventsGraph : public QWidget
+{
+public:
+
+	// Constructor.
+	EventsGraph(QWidget *pParent = NULL);
+
+	// Per-type statistics.
+	struct Stats
+	{
+		QTreeWidgetItem *pItem;
+		QColor     color;
+		int        iTotal;
+		int        iCount;      // Current period.
+		QList<int> rates;       // Rate history (events/sec).
+		int        iPeakRate;
+		int        iBurst;      // Current burst size.
+		int        iLastBurst;
+		int        iMaxBurst;
+		qint64     iLastStamp;
+		qint64     iDelaySum;
+		qint64     iDelayMax;
+	};
+
+	typedef QMap<int, Stats> StatsMap;
+
+	// Statistics to draw from.
+	void setStats(const StatsMap *pStats);
+
+protected:
+
+	void paintEvent(QPaintEvent *pPaintEvent);
+
+private:
+
+	const StatsMap *m_pStats;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerEventsGraph_h
+
+
+// end of qsamplerEventsGraph.h
@@ -24,6 +24,7 @@
 #include "qsamplerUtilities.h"
 #include "qsamplerOptions.h"
 #include "qsamplerMainForm.h"
+#include "qsamplerServerCall.h"
 
 namespace QSampler {
 
@@ -130,6 +131,10 @@ bool FxSend::getFromSampler() {
 	if (!pMainForm || !pMainForm->client())
 		return false;
 
+	ServerCall call(pMainForm->client(), ServerCall::Interactive);
+	if (!call.isValid())
+		return false;
+
 	lscp_fxsend_info_t* pFxSendInfo =
 		::lscp_get_fxsend_info(
 			pMainForm->client(),
@@ -137,6 +142,7 @@ bool FxSend::getFromSampler() {
 			m_iFxSendID);
 
 	if (!pFxSendInfo) {
+		call.check();
 		pMainForm->appendMessagesClient("lscp_get_fxsend_info");
 		return false;
 	}
@@ -162,6 +168,10 @@ bool FxSend::applyToSampler() {
 	if (!pMainForm || !pMainForm->client())
 		return false;
 
+	ServerCall call(pMainForm->client(), ServerCall::Interactive);
+	if (!call.isValid())
+		return false;
+
 	// in case FX send doesn't exist on sampler side yet, create it
 	if (isNew()) {
 		// doesn't exist and scheduled for deletion? nothing to do
@@ -177,6 +187,7 @@ bool FxSend::applyToSampler() {
 				m_MidiCtrl, NULL
 			);
 		if (result == -1) {
+			call.check();
 			pMainForm->appendMessagesClient("lscp_create_fxsend");
 			return false;
 		}
@@ -192,6 +203,7 @@ bool FxSend::applyToSampler() {
 				pMainForm->client(), m_iSamplerChannelID, m_iFxSendID
 			);
 		if (result != LSCP_OK) {
+			call.check();
 			pMainForm->appendMessagesClient("lscp_destroy_fxsend");
 			return false;
 		}
@@ -206,6 +218,7 @@ bool FxSend::applyToSampler() {
 			m_iSamplerChannelID, m_iFxSendID, m_MidiCtrl
 		);
 	if (result != LSCP_OK) {
+		call.check();
 		pMainForm->appendMessagesClient("lscp_set_fxsend_midi_controller");
 		return false;
 	}
@@ -221,6 +234,7 @@ bool FxSend::applyToSampler() {
 			).toUtf8().constData()
 		);
 	if (result != LSCP_OK) {
+		call.check();
 		pMainForm->appendMessagesClient("lscp_set_fxsend_name");
 		return false;
 	}
@@ -233,6 +247,7 @@ bool FxSend::applyToSampler() {
 			m_iSamplerChannelID, m_iFxSendID, m_Depth
 		);
 	if (result != LSCP_OK) {
+		call.check();
 		pMainForm->appendMessagesClient("lscp_set_fxsend_level");
 		return false;
 	}
@@ -246,6 +261,7 @@ bool FxSend::applyToSampler() {
 				m_AudioRouting[i] /*audio destination*/
 			);
 		if (result != LSCP_OK) {
+			call.check();
 			pMainForm->appendMessagesClient("lscp_set_fxsend_audio_channel");
 			return false;
 		}
@@ -266,8 +282,13 @@ QList<int> FxSend::allFxSendsOfSamplerChannel(int samplerChannelID) {
 		return sends;
 
 #ifdef CONFIG_FXSEND
+	ServerCall call(pMainForm->client(), ServerCall::Interactive);
+	if (!call.isValid())
+		return sends;
+
 	int *piSends = ::lscp_list_fxsends(pMainForm->client(), samplerChannelID);
 	if (!piSends) {
+		call.check();
 		if (::lscp_client_get_errno(pMainForm->client()))
 			pMainForm->appendMessagesClient("lscp_list_fxsends");
 	} else {
@@ -26,6 +26,8 @@
 #include <QMap>
 #include <QList>
 
+#include "qsamplerResources.h"
+
 namespace QSampler {
 
 // Typedef'd QMap.
@@ -82,6 +84,9 @@ private:
 	int m_MidiCtrl;
 	float m_Depth;
 	FxSendRoutingMap m_AudioRouting;
+
+	// Live object accounting.
+	ResourceCount<Resources::FxSends> m_resourceCount;
 };
 
 } // namespace QSampler
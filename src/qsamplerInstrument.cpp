@@ -26,6 +26,7 @@
 
 #include "qsamplerOptions.h"
 #include "qsamplerMainForm.h"
+#include "qsamplerLoadScheduler.h"
 
 
 namespace QSampler {
@@ -194,6 +195,13 @@ bool Instrument::mapInstrument (void)
 			break;
 	}
 
+	// Persistent ones load right away, so hold them back
+	// while disk streaming is struggling...
+	LoadScheduler *pLoadScheduler = LoadScheduler::getInstance();
+	if (load_mode == LSCP_LOAD_PERSISTENT
+		&& pLoadScheduler && pLoadScheduler->deferMap(*this))
+		return true;
+
 	if (::lscp_map_midi_instrument(pMainForm->client(), &instr,
 			m_sEngineName.toUtf8().constData(),
 			qsamplerUtilities::lscpEscapePath(
@@ -25,6 +25,8 @@
 
 #include <QStringList>
 
+#include "qsamplerResources.h"
+
 namespace QSampler {
 
 //-------------------------------------------------------------------------
@@ -93,6 +95,9 @@ private:
 	int     m_iInstrumentNr;
 	float   m_fVolume;
 	int     m_iLoadMode;
+
+	// Live object accounting.
+	ResourceCount<Resources::Instruments> m_resourceCount;
 };
 
 } // namespace QSampler
@@ -0,0 +1,469 @@
+// qsamplerInstrumentCache.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerInstrumentCache.h"
+#include "qsamplerUtilities.h"
+
+#include "qsamplerOptions.h"
+#include "qsamplerChannel.h"
+#include "qsamplerMainForm.h"
+#include "qsamplerServerCaps.h"
+
+#include <QApplication>
+#include <QFileInfo>
+#include <QRegExp>
+
+
+namespace QSampler {
+
+// Specialties for thread-callback comunication.
+#define QSAMPLER_INSTRUMENT_CACHE_EVENT QEvent::Type(QEvent::User + 2)
+
+// Remote entries time-to-live and failed fetch retry back-off (secs).
+#define QSAMPLER_INSTRUMENT_CACHE_TTL_SECS    300
+#define QSAMPLER_INSTRUMENT_CACHE_RETRY_SECS  30
+
+
+//-------------------------------------------------------------------------
+// QSampler::InstrumentCacheEvent -- server-side enumeration result.
+
+class InstrumentCacheEvent : public QEvent
+{
+public:
+
+	// Constructor.
+	InstrumentCacheEvent(const QString& sInstrumentFile,
+		bool bInstrumentNames, const QStringList& instlist, bool bResult)
+		: QEvent(QSAMPLER_INSTRUMENT_CACHE_EVENT),
+			m_sInstrumentFile(sInstrumentFile),
+			m_bInstrumentNames(bInstrumentNames),
+			m_instlist(instlist), m_bResult(bResult) {}
+
+	// Accessors.
+	const QString& instrumentFile() const { return m_sInstrumentFile; }
+	bool instrumentNames() const { return m_bInstrumentNames; }
+	const QStringList& instrumentList() const { return m_instlist; }
+	bool result() const { return m_bResult; }
+
+private:
+
+	QString     m_sInstrumentFile;
+	bool        m_bInstrumentNames;
+	QStringList m_instlist;
+	bool        m_bResult;
+};
+
+
+// The dedicated connection is not subscribed to any events.
+static lscp_status_t qsampler_instrument_cache_callback (
+	lscp_client_t */*pClient*/, lscp_event_t /*event*/,
+	const char */*pchData*/, int /*cchData*/, void */*pvData*/ )
+{
+	return LSCP_OK;
+}
+
+
+//-------------------------------------------------------------------------
+// QSampler::InstrumentCacheThread - server-side instrument file enumerator.
+//
+
+// Constructor.
+InstrumentCacheThread::InstrumentCacheThread ( QObject *pReceiver,
+	const QString& sServerHost, int iServerPort, int iServerTimeout )
+	: QThread(), m_pReceiver(pReceiver),
+		m_sServerHost(sServerHost), m_iServerPort(iServerPort),
+		m_iServerTimeout(iServerTimeout), m_bRunState(true)
+{
+}
+
+
+// Destructor.
+InstrumentCacheThread::~InstrumentCacheThread (void)
+{
+	stop();
+}
+
+
+// Enqueue a new instrument file request.
+void InstrumentCacheThread::request ( const QString& sInstrumentFile,
+	const QString& sInstrumentPath, bool bInstrumentNames )
+{
+	Request req;
+	req.sInstrumentFile  = sInstrumentFile;
+	req.sInstrumentPath  = sInstrumentPath;
+	req.bInstrumentNames = bInstrumentNames;
+
+	QMutexLocker locker(&m_mutex);
+	m_requests.append(req);
+	m_cond.wakeAll();
+}
+
+
+// Stop (and wait for) the thread.
+void InstrumentCacheThread::stop (void)
+{
+	m_mutex.lock();
+	m_bRunState = false;
+	m_requests.clear();
+	m_cond.wakeAll();
+	m_mutex.unlock();
+
+	QThread::wait();
+}
+
+
+// The main thread executive.
+void InstrumentCacheThread::run (void)
+{
+	lscp_client_t *pClient = NULL;
+
+	m_mutex.lock();
+	while (m_bRunState) {
+		if (m_requests.isEmpty()) {
+			m_cond.wait(&m_mutex);
+			continue;
+		}
+		const Request req = m_requests.takeFirst();
+		m_mutex.unlock();
+		// We'll have our very own connection,
+		// so not to get in the way of the main one...
+		if (pClient == NULL) {
+			pClient = ::lscp_client_create(
+				m_sServerHost.toUtf8().constData(), m_iServerPort,
+				qsampler_instrument_cache_callback, NULL);
+			if (pClient)
+				::lscp_client_set_timeout(pClient, m_iServerTimeout);
+		}
+		QStringList instlist;
+		const bool bResult = (pClient && fetch(pClient, req, instlist));
+		QApplication::postEvent(m_pReceiver,
+			new InstrumentCacheEvent(req.sInstrumentFile,
+				req.bInstrumentNames, instlist, bResult));
+		m_mutex.lock();
+	}
+	m_mutex.unlock();
+
+	if (pClient)
+		::lscp_client_destroy(pClient);
+}
+
+
+// Server-side enumeration (runs on this thread only).
+bool InstrumentCacheThread::fetch ( lscp_client_t *pClient,
+	const Request& req, QStringList& instlist ) const
+{
+	QString sQuery = "LIST FILE INSTRUMENTS '"
+		+ req.sInstrumentPath + "'\r\n";
+	if (::lscp_client_query(pClient, sQuery.toUtf8().constData()) != LSCP_OK)
+		return false;
+
+	const QStringList& indexes
+		= QString::fromUtf8(::lscp_client_get_result(pClient))
+			.split(',', QString::SkipEmptyParts);
+
+	const QString& sFileName = QFileInfo(req.sInstrumentFile).fileName();
+
+	QStringListIterator iter(indexes);
+	while (iter.hasNext()) {
+		const QString& sIndex = iter.next().trimmed();
+		QString sInstrumentName;
+		if (req.bInstrumentNames) {
+			sQuery = "GET FILE INSTRUMENT INFO '"
+				+ req.sInstrumentPath + "' " + sIndex + "\r\n";
+			if (::lscp_client_query(pClient, sQuery.toUtf8().constData())
+				== LSCP_OK) {
+				const QStringList& lines
+					= QString::fromUtf8(::lscp_client_get_result(pClient))
+						.split(QRegExp("[\r\n]+"), QString::SkipEmptyParts);
+				QStringListIterator line(lines);
+				while (line.hasNext()) {
+					const QString& sLine = line.next();
+					if (sLine.startsWith("NAME: ")) {
+						sInstrumentName = sLine.mid(6).trimmed();
+						break;
+					}
+				}
+			}
+		}
+		if (sInstrumentName.isEmpty())
+			sInstrumentName = sFileName + " [" + sIndex + "]";
+		instlist.append(sInstrumentName);
+	}
+
+	return true;
+}
+
+
+//-------------------------------------------------------------------------
+// QSampler::InstrumentCache - instrument file list cache.
+//
+
+// Kind of singleton reference.
+InstrumentCache *InstrumentCache::g_pInstrumentCache = NULL;
+
+
+// Constructor.
+InstrumentCache::InstrumentCache ( QObject *pParent )
+	: QObject(pParent), m_pThread(NULL)
+{
+	g_pInstrumentCache = this;
+}
+
+
+// Destructor.
+InstrumentCache::~InstrumentCache (void)
+{
+	reset();
+
+	g_pInstrumentCache = NULL;
+}
+
+
+// Pseudo-singleton instance accessor.
+InstrumentCache *InstrumentCache::getInstance (void)
+{
+	return g_pInstrumentCache;
+}
+
+
+// Cached instrument list lookup, keyed by (file, mtime);
+// expired remote entries are still returned, while refetched.
+bool InstrumentCache::lookup ( const QString& sInstrumentFile,
+	bool bInstrumentNames, QStringList& instlist )
+{
+	QHash<QString, Item>::ConstIterator iter
+		= m_items.constFind(sInstrumentFile);
+	if (iter == m_items.constEnd())
+		return false;
+
+	const Item& item = iter.value();
+	if (bInstrumentNames && !item.bInstrumentNames)
+		return false;
+
+	// Local file changed meanwhile?
+	const QFileInfo fi(sInstrumentFile);
+	if (fi.exists() && fi.lastModified() != item.modified)
+		return false;
+
+	// Remote file, possibly changed meanwhile?
+	if (item.fetched.isValid() && item.fetched.secsTo(
+			QDateTime::currentDateTime()) > QSAMPLER_INSTRUMENT_CACHE_TTL_SECS)
+		request(sInstrumentFile, item.bInstrumentNames);
+
+	if (!bInstrumentNames && item.bInstrumentNames
+		&& item.instlist.first() != Channel::noInstrumentName()) {
+		const int iCount = item.instlist.count();
+		for (int iIndex = 0; iIndex < iCount; ++iIndex) {
+			instlist.append(fi.fileName()
+				+ " [" + QString::number(iIndex) + "]");
+		}
+	} else {
+		instlist = item.instlist;
+	}
+
+	return true;
+}
+
+
+// Cache a (locally enumerated) instrument list.
+void InstrumentCache::insert ( const QString& sInstrumentFile,
+	bool bInstrumentNames, const QStringList& instlist )
+{
+	const QFileInfo fi(sInstrumentFile);
+
+	Item item;
+	if (fi.exists())
+		item.modified = fi.lastModified();
+	else
+		item.fetched = QDateTime::currentDateTime();
+	item.bInstrumentNames = bInstrumentNames;
+	item.instlist = instlist;
+
+	m_items.insert(sInstrumentFile, item);
+}
+
+
+// Schedule a server-side instrument list fetch.
+void InstrumentCache::request (
+	const QString& sInstrumentFile, bool bInstrumentNames )
+{
+	if (m_pending.contains(sInstrumentFile))
+		return;
+
+	// Failed not so long ago?
+	QHash<QString, QDateTime>::ConstIterator iter
+		= m_failed.constFind(sInstrumentFile);
+	if (iter != m_failed.constEnd() && iter.value().secsTo(
+			QDateTime::currentDateTime()) < QSAMPLER_INSTRUMENT_CACHE_RETRY_SECS)
+		return;
+
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL)
+		return;
+	if (pMainForm->client() == NULL)
+		return;
+
+	Options *pOptions = pMainForm->options();
+	if (pOptions == NULL)
+		return;
+
+	if (m_pThread == NULL) {
+		m_pThread = new InstrumentCacheThread(this,
+			pOptions->sServerHost,
+			pOptions->iServerPort,
+			pOptions->iServerTimeout);
+		m_pThread->start();
+	}
+
+	m_pending.insert(sInstrumentFile);
+
+	// Path escaping must be resolved here (main client).
+	m_pThread->request(sInstrumentFile,
+		qsamplerUtilities::lscpEscapePath(sInstrumentFile),
+		bInstrumentNames);
+}
+
+
+// Invalidate cached entries (all, if file name is empty).
+void InstrumentCache::invalidate ( const QString& sInstrumentFile )
+{
+	if (sInstrumentFile.isEmpty()) {
+		m_items.clear();
+		m_failed.clear();
+	} else {
+		m_items.remove(sInstrumentFile);
+		m_failed.remove(sInstrumentFile);
+	}
+}
+
+
+// Instrument name index snapshot: actual instrument count
+// and last known modification time, per enumerated file.
+QHash<QString, InstrumentCache::Count> InstrumentCache::counts (void) const
+{
+	QHash<QString, Count> counts;
+
+	QHash<QString, Item>::ConstIterator iter = m_items.constBegin();
+	for ( ; iter != m_items.constEnd(); ++iter) {
+		const Item& item = iter.value();
+		// Only true enumerations count (not the usual placeholders)...
+		if (!item.bInstrumentNames || item.instlist.isEmpty()
+			|| item.instlist.first() == Channel::noInstrumentName())
+			continue;
+		Count count;
+		count.modified = item.modified;
+		count.iCount   = item.instlist.count();
+		counts.insert(iter.key(), count);
+	}
+
+	return counts;
+}
+
+
+// Whether a given instrument file is to be enumerated server-side.
+bool InstrumentCache::isServerInstrumentFile ( const QString& sInstrumentFile )
+{
+	if (sInstrumentFile.isEmpty()
+		|| sInstrumentFile == Channel::noInstrumentName())
+		return false;
+
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL)
+		return false;
+	if (pMainForm->client() == NULL)
+		return false;
+
+	// No way the server lists it for us?
+	if (!ServerCaps::supports(ServerCaps::FileInstruments))
+		return false;
+
+	const QFileInfo fi(sInstrumentFile);
+	if (fi.isRelative())
+		return false;
+
+	Options *pOptions = pMainForm->options();
+	if (pOptions && pOptions->bServerInstrumentNames)
+		return true;
+
+#ifdef CONFIG_LIBGIG
+	return !fi.exists();
+#else
+	// Nothing to parse it locally with, anyway...
+	return true;
+#endif
+}
+
+
+// Stop any server-side enumeration (eg. client shutdown).
+void InstrumentCache::reset (void)
+{
+	if (m_pThread) {
+		m_pThread->stop();
+		delete m_pThread;
+		m_pThread = NULL;
+	}
+
+	m_pending.clear();
+	m_failed.clear();
+	m_items.clear();
+}
+
+
+// Server-side results receiver.
+void InstrumentCache::customEvent ( QEvent *pEvent )
+{
+	if (pEvent->type() != QSAMPLER_INSTRUMENT_CACHE_EVENT)
+		return;
+
+	InstrumentCacheEvent *pCacheEvent
+		= static_cast<InstrumentCacheEvent *> (pEvent);
+
+	// Stale (eg. after reset)?
+	const QString& sInstrumentFile = pCacheEvent->instrumentFile();
+	if (!m_pending.remove(sInstrumentFile))
+		return;
+
+	// Failures are not cached, just retried later (if ever)...
+	if (!pCacheEvent->result()) {
+		m_failed.insert(sInstrumentFile, QDateTime::currentDateTime());
+		return;
+	}
+
+	m_failed.remove(sInstrumentFile);
+
+	QStringList instlist;
+	QStringListIterator iter(pCacheEvent->instrumentList());
+	while (iter.hasNext())
+		instlist.append(qsamplerUtilities::lscpEscapedTextToRaw(iter.next()));
+
+	if (instlist.isEmpty())
+		instlist.append(Channel::noInstrumentName());
+
+	insert(sInstrumentFile, pCacheEvent->instrumentNames(), instlist);
+
+	emit instrumentListChanged(sInstrumentFile);
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerInstrumentCache.cpp
@@ -0,0 +1,183 @@
+// qsamplerInstrumentCache.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerInstrumentCache_h
+#define __qsamplerInstrumentCache_h
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QStringList>
+#include <QDateTime>
+#include <QHash>
+#include <QSet>
+
+#include <lscp/client.h>
+
+
+namespace QSampler {
+
+//-------------------------------------------------------------------------
+// QSampler::InstrumentCacheThread - server-side instrument file enumerator.
+//
+
+class InstrumentCacheThread : public QThread
+{
+public:
+
+	// Constructor.
+	InstrumentCacheThread(QObject *pReceiver,
+		const QString& sServerHost, int iServerPort, int iServerTimeout);
+
+	// Destructor.
+	~InstrumentCacheThread();
+
+	// Enqueue a new instrument file request.
+	void request(const QString& sInstrumentFile,
+		const QString& sInstrumentPath, bool bInstrumentNames);
+
+	// Stop (and wait for) the thread.
+	void stop();
+
+protected:
+
+	// The main thread executive.
+	void run();
+
+private:
+
+	// Request queue item.
+	struct Request
+	{
+		QString sInstrumentFile;
+		QString sInstrumentPath;	// LSCP escaped.
+		bool    bInstrumentNames;
+	};
+
+	// Server-side enumeration (runs on this thread only).
+	bool fetch(lscp_client_t *pClient,
+		const Request& req, QStringList& instlist) const;
+
+	// Instance variables.
+	QObject *m_pReceiver;
+
+	QString m_sServerHost;
+	int     m_iServerPort;
+	int     m_iServerTimeout;
+
+	QMutex         m_mutex;
+	QWaitCondition m_cond;
+	QList<Request> m_requests;
+	bool           m_bRunState;
+};
+
+
+//-------------------------------------------------------------------------
+// QSampler::InstrumentCache - instrument file list cache.
+//
+
+class InstrumentCache : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	// Constructor.
+	InstrumentCache(QObject *pParent = NULL);
+
+	// Destructor.
+	~InstrumentCache();
+
+	// Pseudo-singleton instance accessor.
+	static InstrumentCache *getInstance();
+
+	// Cached instrument list lookup, keyed by (file, mtime);
+	// expired remote entries are still returned, while refetched.
+	bool lookup(const QString& sInstrumentFile,
+		bool bInstrumentNames, QStringList& instlist);
+
+	// Cache a (locally enumerated) instrument list.
+	void insert(const QString& sInstrumentFile,
+		bool bInstrumentNames, const QStringList& instlist);
+
+	// Schedule a server-side instrument list fetch.
+	void request(const QString& sInstrumentFile, bool bInstrumentNames);
+
+	// Invalidate cached entries (all, if file name is empty).
+	void invalidate(const QString& sInstrumentFile = QString());
+
+	// Instrument name index snapshot: actual instrument count
+	// and last known modification time, per enumerated file.
+	struct Count
+	{
+		QDateTime modified;
+		int       iCount;
+	};
+
+	QHash<QString, Count> counts() const;
+
+	// Whether a given instrument file is to be enumerated server-side.
+	static bool isServerInstrumentFile(const QString& sInstrumentFile);
+
+	// Stop any server-side enumeration (eg. client shutdown).
+	void reset();
+
+signals:
+
+	// Server-side instrument list arrival notification.
+	void instrumentListChanged(const QString& sInstrumentFile);
+
+protected:
+
+	// Server-side results receiver.
+	void customEvent(QEvent *pEvent);
+
+private:
+
+	// Cache item.
+	struct Item
+	{
+		QDateTime   modified;	// Local files only.
+		QDateTime   fetched;	// Remote files only.
+		bool        bInstrumentNames;
+		QStringList instlist;
+	};
+
+	// Instance variables.
+	QHash<QString, Item> m_items;
+	QSet<QString> m_pending;
+
+	// Last failed server-side fetches (retry back-off).
+	QHash<QString, QDateTime> m_failed;
+
+	InstrumentCacheThread *m_pThread;
+
+	// Kind-of singleton reference.
+	static InstrumentCache *g_pInstrumentCache;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerInstrumentCache_h
+
+
+// end of qsamplerInstrumentCache.h
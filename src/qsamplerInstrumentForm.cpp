@@ -26,6 +26,7 @@
 #include "qsamplerOptions.h"
 #include "qsamplerChannel.h"
 #include "qsamplerMainForm.h"
+#include "qsamplerInstrumentCache.h"
 
 #include <QMessageBox>
 #include <QPushButton>
@@ -103,6 +104,13 @@ InstrumentForm::InstrumentForm ( QWidget *pParent )
 	QObject::connect(m_ui.DialogButtonBox,
 		SIGNAL(rejected()),
 		SLOT(reject()));
+
+	InstrumentCache *pInstrumentCache = InstrumentCache::getInstance();
+	if (pInstrumentCache) {
+		QObject::connect(pInstrumentCache,
+			SIGNAL(instrumentListChanged(const QString&)),
+			SLOT(instrumentListChanged(const QString&)));
+	}
 }
 
 
@@ -306,6 +314,21 @@ void InstrumentForm::updateInstrumentName (void)
 }
 
 
+// Instrument file list arrival (server-side enumeration).
+void InstrumentForm::instrumentListChanged ( const QString& sInstrumentFile )
+{
+	if (m_ui.InstrumentFileComboBox->currentText() != sInstrumentFile)
+		return;
+
+	// Keep current selection, while refreshing names...
+	const int iInstrumentNr = m_ui.InstrumentNrComboBox->currentIndex();
+	m_iDirtySetup++;
+	updateInstrumentName();
+	m_ui.InstrumentNrComboBox->setCurrentIndex(iInstrumentNr);
+	m_iDirtySetup--;
+}
+
+
 // Special case for instrumnet index change,
 void InstrumentForm::instrumentNrChanged (void)
 {
@@ -50,6 +50,7 @@ public slots:
 	void nameChanged(const QString& sName);
 	void openInstrumentFile();
 	void updateInstrumentName();
+	void instrumentListChanged(const QString& sInstrumentFile);
 	void instrumentNrChanged();
 	void accept();
 	void reject();
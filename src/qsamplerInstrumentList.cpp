@@ -27,6 +27,7 @@
 
 #include "qsamplerOptions.h"
 #include "qsamplerMainForm.h"
+#include "qsamplerServerCall.h"
 
 #include <QApplication>
 #include <QHeaderView>
@@ -40,7 +41,8 @@ namespace QSampler {
 //
 
 InstrumentListModel::InstrumentListModel ( QObject *pParent )
-	: QAbstractItemModel(pParent), m_iMidiMap(LSCP_MIDI_MAP_ALL)
+	: QAbstractItemModel(pParent), m_iMidiMap(LSCP_MIDI_MAP_ALL),
+		m_bValidAll(false)
 {
 //	QAbstractItemModel::reset();
 }
@@ -261,7 +263,57 @@ void InstrumentListModel::resortInstrument ( Instrument *pInstrument )
 }
 
 
+// General reloader (discards all cached map partitions).
 void InstrumentListModel::refresh (void)
+{
+	clear();
+
+	refreshMap(m_iMidiMap);
+}
+
+
+// Whether the given map partition is currently cached.
+bool InstrumentListModel::isMapValid ( int iMidiMap ) const
+{
+	if (iMidiMap < 0 || iMidiMap == LSCP_MIDI_MAP_ALL)
+		return m_bValidAll;
+	else
+		return m_validMaps.contains(iMidiMap);
+}
+
+
+// Mark a map partition as stale (to be reloaded on next refreshMap);
+// invalidating all maps just forces to re-check the maps list itself.
+void InstrumentListModel::invalidateMap ( int iMidiMap )
+{
+	if (iMidiMap >= 0 && iMidiMap != LSCP_MIDI_MAP_ALL)
+		m_validMaps.remove(iMidiMap);
+
+	m_bValidAll = false;
+}
+
+
+// Copy of all cached (valid) map partitions.
+QMap<int, QList<Instrument> > InstrumentListModel::cachedMaps (void) const
+{
+	QMap<int, QList<Instrument> > maps;
+
+	InstrumentMap::ConstIterator itMap = m_instruments.constBegin();
+	for ( ; itMap != m_instruments.constEnd(); ++itMap) {
+		if (!m_validMaps.contains(itMap.key()))
+			continue;
+		QList<Instrument>& instruments = maps[itMap.key()];
+		QListIterator<Instrument *> iter(itMap.value());
+		while (iter.hasNext())
+			instruments.append(*iter.next());
+	}
+
+	return maps;
+}
+
+
+// Partial reloader: only stale map partitions get fetched again.
+void InstrumentListModel::refreshMap ( int iMidiMap )
 {
 	MainForm *pMainForm = MainForm::getInstance();
 	if (pMainForm == NULL)
@@ -269,31 +321,152 @@ void InstrumentListModel::refresh (void)
 	if (pMainForm->client() == NULL)
 		return;
 
-	QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
+	if (iMidiMap < 0)
+		iMidiMap = LSCP_MIDI_MAP_ALL;
+	if (isMapValid(iMidiMap))
+		return;
 
-	clear();
+	QList<int> maps;
+	if (iMidiMap == LSCP_MIDI_MAP_ALL) {
+		int *piMaps = ::lscp_list_midi_instrument_maps(pMainForm->client());
+		if (piMaps == NULL) {
+			if (::lscp_client_get_errno(pMainForm->client()))
+				pMainForm->appendMessagesClient("lscp_list_midi_instrument_maps");
+			return;
+		}
+		for (int i = 0; piMaps[i] >= 0; ++i)
+			maps.append(piMaps[i]);
+		// Drop partitions of maps that are gone meanwhile...
+		InstrumentMap::iterator itMap = m_instruments.begin();
+		while (itMap != m_instruments.end()) {
+			if (maps.contains(itMap.key())) {
+				++itMap;
+			} else {
+				qDeleteAll(itMap.value());
+				m_validMaps.remove(itMap.key());
+				itMap = m_instruments.erase(itMap);
+			}
+		}
+	} else {
+		maps.append(iMidiMap);
+	}
 
-	// Load the whole bunch of instrument items...
-	lscp_midi_instrument_t *pInstrs
-		= ::lscp_list_midi_instruments(pMainForm->client(), m_iMidiMap);
-	for (int iInstr = 0; pInstrs && pInstrs[iInstr].map >= 0; ++iInstr) {
-		const int iMap  = pInstrs[iInstr].map;
-		const int iBank = pInstrs[iInstr].bank;
-		const int iProg = pInstrs[iInstr].prog;
-		addInstrument(iMap, iBank, iProg);
-		// Try to keep it snappy :)
-		QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+	QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
+
+	// Bulk deadlines, for as long as the view is there to care...
+	ServerCall call(pMainForm->client(), ServerCall::Bulk,
+		QObject::parent());
+
+	int iErrors = 0;
+	QListIterator<int> iter(maps);
+	while (iter.hasNext() && call.isValid()) {
+		const int iMap = iter.next();
+		if (m_validMaps.contains(iMap))
+			continue;
+		// Discard the stale partition...
+		if (m_instruments.contains(iMap))
+			qDeleteAll(m_instruments.take(iMap));
+		// Load the whole bunch of instrument items...
+		lscp_midi_instrument_t *pInstrs
+			= ::lscp_list_midi_instruments(pMainForm->client(), iMap);
+		for (int iInstr = 0; pInstrs && pInstrs[iInstr].map >= 0; ++iInstr) {
+			const int iBank = pInstrs[iInstr].bank;
+			const int iProg = pInstrs[iInstr].prog;
+			addInstrument(iMap, iBank, iProg);
+			// Try to keep it snappy :)
+			QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+			// Stale, if abandoned halfway...
+			if (!call.check())
+				break;
+		}
+		if (pInstrs == NULL && ::lscp_client_get_errno(pMainForm->client()))
+			iErrors++;
+		else if (call.isValid())
+			m_validMaps.insert(iMap);
 	}
 
 	QApplication::restoreOverrideCursor();
 
-	if (pInstrs == NULL && ::lscp_client_get_errno(pMainForm->client())) {
+	if (iErrors > 0) {
 		pMainForm->appendMessagesClient("lscp_list_midi_instruments");
 		pMainForm->appendMessagesError(
 			tr("Could not get current list of MIDI instrument mappings.\n\nSorry."));
+	} else if (iMidiMap == LSCP_MIDI_MAP_ALL) {
+		m_bValidAll = true;
+	}
+}
+
+// Single entry update: only the named (bank, prog) entry gets
+// fetched again, added or dropped; stale partitions are left alone
+// as those will be fetched as a whole anyway.
+void InstrumentListModel::updateMapEntry (
+	int iMidiMap, int iBank, int iProg )
+{
+	if (iMidiMap < 0 || !m_validMaps.contains(iMidiMap))
+		return;
+
+	InstrumentList& list = m_instruments[iMidiMap];
+	for (int i = 0; i < list.size(); ++i) {
+		Instrument *pInstr = list.at(i);
+		if (pInstr->bank() == iBank && pInstr->prog() == iProg) {
+			if (!pInstr->getInstrument()) {
+				delete pInstr;
+				list.removeAt(i);
+			}
+			return;
+		}
+	}
+
+	addInstrument(iMidiMap, iBank, iProg);
+}
+
+
+// Entry count change: just sync the partition keys, fetching
+// only the entries that were added meanwhile.
+void InstrumentListModel::updateMapCount ( int iMidiMap, int iCount )
+{
+	if (iMidiMap < 0 || !m_validMaps.contains(iMidiMap))
+		return;
+
+	InstrumentList& list = m_instruments[iMidiMap];
+	if (list.size() == iCount)
+		return;
+
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL)
+		return;
+	if (pMainForm->client() == NULL)
+		return;
+
+	lscp_midi_instrument_t *pInstrs
+		= ::lscp_list_midi_instruments(pMainForm->client(), iMidiMap);
+	if (pInstrs == NULL && ::lscp_client_get_errno(pMainForm->client())) {
+		invalidateMap(iMidiMap);
+		return;
+	}
+
+	QSet<int> keys;
+	for (int iInstr = 0; pInstrs && pInstrs[iInstr].map >= 0; ++iInstr)
+		keys.insert((pInstrs[iInstr].bank << 7) + pInstrs[iInstr].prog);
+
+	// Drop the ones that are gone...
+	for (int i = 0; i < list.size(); ++i) {
+		Instrument *pInstr = list.at(i);
+		if (!keys.remove((pInstr->bank() << 7) + pInstr->prog())) {
+			delete pInstr;
+			list.removeAt(i--);
+		}
+	}
+
+	// Add the new ones...
+	QSetIterator<int> iter(keys);
+	while (iter.hasNext()) {
+		const int iKey = iter.next();
+		addInstrument(iMidiMap, iKey >> 7, iKey & 0x7f);
 	}
 }
 
+
 void InstrumentListModel::beginReset (void)
 {
 #if QT_VERSION >= 0x040600
@@ -322,6 +495,9 @@ void InstrumentListModel::clear (void)
 	}
 
 	m_instruments.clear();
+
+	m_validMaps.clear();
+	m_bValidAll = false;
 }
 
 
@@ -370,7 +546,9 @@ InstrumentListView::~InstrumentListView (void)
 
 void InstrumentListView::setMidiMap ( int iMidiMap )
 {
+	m_pListModel->beginReset();
 	m_pListModel->setMidiMap(iMidiMap);
+	m_pListModel->endReset();
 }
 
 
@@ -426,6 +604,59 @@ void InstrumentListView::refresh (void)
 }
 
 
+// Partial (per-map) cache management.
+bool InstrumentListView::isMapValid ( int iMidiMap ) const
+{
+	return m_pListModel->isMapValid(iMidiMap);
+}
+
+
+void InstrumentListView::invalidateMap ( int iMidiMap )
+{
+	m_pListModel->invalidateMap(iMidiMap);
+}
+
+
+void InstrumentListView::refreshMap ( int iMidiMap )
+{
+	if (m_pListModel->isMapValid(iMidiMap))
+		return;
+
+	m_pListModel->beginReset();
+	m_pListModel->refreshMap(iMidiMap);
+	m_pListModel->endReset();
+}
+
+
+// Single entry updates (eg. on server events).
+void InstrumentListView::updateMapEntry ( int iMidiMap, int iBank, int iProg )
+{
+	if (!m_pListModel->isMapValid(iMidiMap))
+		return;
+
+	m_pListModel->beginReset();
+	m_pListModel->updateMapEntry(iMidiMap, iBank, iProg);
+	m_pListModel->endReset();
+}
+
+
+void InstrumentListView::updateMapCount ( int iMidiMap, int iCount )
+{
+	if (!m_pListModel->isMapValid(iMidiMap))
+		return;
+
+	m_pListModel->beginReset();
+	m_pListModel->updateMapCount(iMidiMap, iCount);
+	m_pListModel->endReset();
+}
+
+
+QMap<int, QList<Instrument> > InstrumentListView::cachedMaps (void) const
+{
+	return m_pListModel->cachedMaps();
+}
+
+
 } // namespace QSampler
 
 
@@ -24,6 +24,8 @@
 #define __qsamplerInstrumentList_h
 
 #include <QTreeView>
+#include <QSet>
+#include <QMap>
 
 namespace QSampler {
 
@@ -66,6 +68,18 @@ public:
 	// General reloader.
 	void refresh();
 
+	// Partial (per-map) cache management.
+	bool isMapValid(int iMidiMap) const;
+	void invalidateMap(int iMidiMap);
+	void refreshMap(int iMidiMap);
+
+	// Single entry updates (eg. on server events).
+	void updateMapEntry(int iMidiMap, int iBank, int iProg);
+	void updateMapCount(int iMidiMap, int iCount);
+
+	// Copy of all cached (valid) map partitions.
+	QMap<int, QList<Instrument> > cachedMaps() const;
+
 	// Make the following method public
 	void beginReset();
 	void endReset();
@@ -87,6 +101,10 @@ private:
 
 	// Current map selection.
 	int m_iMidiMap;
+
+	// Cached (valid) map partitions.
+	QSet<int> m_validMaps;
+	bool m_bValidAll;
 };
 
 
@@ -119,6 +137,18 @@ public:
 	// General reloader.
 	void refresh();
 
+	// Partial (per-map) cache management.
+	bool isMapValid(int iMidiMap) const;
+	void invalidateMap(int iMidiMap);
+	void refreshMap(int iMidiMap);
+
+	// Single entry updates (eg. on server events).
+	void updateMapEntry(int iMidiMap, int iBank, int iProg);
+	void updateMapCount(int iMidiMap, int iCount);
+
+	// Copy of all cached (valid) map partitions.
+	QMap<int, QList<Instrument> > cachedMaps() const;
+
 private:
 
 	// Instance variables.
@@ -26,6 +26,7 @@
 #include "qsamplerInstrumentList.h"
 
 #include "qsamplerInstrumentForm.h"
+#include "qsamplerMapCheckForm.h"
 
 #include "qsamplerOptions.h"
 #include "qsamplerInstrument.h"
@@ -33,6 +34,7 @@
 
 #include <QHeaderView>
 #include <QMessageBox>
+#include <QTimer>
 #include <QContextMenuEvent>
 
 #include <QCheckBox>
@@ -50,6 +52,9 @@ InstrumentListForm::InstrumentListForm (
 {
 	m_ui.setupUi(this);
 
+	// No pending map revalidation, initially.
+	m_iDirtyMaps = 0;
+
 	m_pInstrumentListView = new InstrumentListView(this);
 	QMainWindow::setCentralWidget(m_pInstrumentListView);
 
@@ -66,6 +71,7 @@ InstrumentListForm::InstrumentListForm (
 	m_ui.instrumentToolbar->addAction(m_ui.deleteInstrumentAction);
 	m_ui.instrumentToolbar->addSeparator();
 	m_ui.instrumentToolbar->addAction(m_ui.refreshInstrumentsAction);
+	m_ui.instrumentToolbar->addAction(m_ui.checkInstrumentsAction);
 
 	QObject::connect(m_pMapComboBox,
 		SIGNAL(activated(int)),
@@ -93,6 +99,10 @@ InstrumentListForm::InstrumentListForm (
 		m_ui.refreshInstrumentsAction,
 		SIGNAL(triggered()),
 		SLOT(refreshInstruments()));
+	QObject::connect(
+		m_ui.checkInstrumentsAction,
+		SIGNAL(triggered()),
+		SLOT(checkInstruments()));
 
 	// Things must be stable from the start.
 	stabilizeForm();
@@ -113,6 +123,10 @@ void InstrumentListForm::showEvent ( QShowEvent *pShowEvent )
 	if (pMainForm)
 		pMainForm->stabilizeForm();
 
+	// Catch up with any changes while we were hidden...
+	if (m_iDirtyMaps > 0)
+		revalidateMaps();
+
 	QWidget::showEvent(pShowEvent);
 }
 
@@ -141,6 +155,17 @@ void InstrumentListForm::closeEvent ( QCloseEvent * /*pCloseEvent*/ )
 
 // Refresh all instrument list and views.
 void InstrumentListForm::refreshInstruments (void)
+{
+	// Discard all cached map partitions...
+	m_pInstrumentListView->refresh();
+	m_iDirtyMaps = 0;
+
+	refreshMaps();
+}
+
+
+// Refresh instrument maps selector (cached partitions are kept).
+void InstrumentListForm::refreshMaps (void)
 {
 	MainForm* pMainForm = MainForm::getInstance();
 	if (pMainForm == NULL)
@@ -185,13 +210,74 @@ void InstrumentListForm::activateMap ( int iMap )
 	if (iMidiMap >= 0)
 		pOptions->iMidiMap = iMidiMap;
 
+	// Just a view change, if already cached...
 	m_pInstrumentListView->setMidiMap(iMidiMap);
-	m_pInstrumentListView->refresh();
+	m_pInstrumentListView->refreshMap(iMidiMap);
 
 	stabilizeForm();
 }
 
 
+// Map change notification (eg. from server events).
+void InstrumentListForm::invalidateMap ( int iMidiMap )
+{
+	m_pInstrumentListView->invalidateMap(iMidiMap);
+
+	// Defer revalidation, so that bursts get coalesced...
+	if (m_iDirtyMaps++ == 0 && QMainWindow::isVisible())
+		QTimer::singleShot(200, this, SLOT(revalidateMaps()));
+}
+
+
+// Reload stale map partitions of current selection only.
+void InstrumentListForm::revalidateMaps (void)
+{
+	if (m_iDirtyMaps == 0)
+		return;
+
+	if (!QMainWindow::isVisible())
+		return;
+
+	m_iDirtyMaps = 0;
+
+	m_pInstrumentListView->refreshMap(m_pInstrumentListView->midiMap());
+
+	stabilizeForm();
+}
+
+
+// Single entry change notifications (eg. from server events).
+void InstrumentListForm::updateMapEntry ( int iMidiMap, int iBank, int iProg )
+{
+	m_pInstrumentListView->updateMapEntry(iMidiMap, iBank, iProg);
+
+	stabilizeForm();
+}
+
+
+void InstrumentListForm::updateMapCount ( int iMidiMap, int iCount )
+{
+	m_pInstrumentListView->updateMapCount(iMidiMap, iCount);
+
+	stabilizeForm();
+}
+
+
+// Check mappings for missing (or broken) instrument files.
+void InstrumentListForm::checkInstruments (void)
+{
+	MapCheckForm form(this);
+	form.check(m_pInstrumentListView->midiMap(),
+		m_pInstrumentListView->cachedMaps());
+	form.exec();
+
+	// Whatever got fixed is stale now...
+	QSetIterator<int> iter(form.fixedMaps());
+	while (iter.hasNext())
+		invalidateMap(iter.next());
+}
+
+
 void InstrumentListForm::newInstrument (void)
 {
 	Instrument instrument;
@@ -324,6 +410,7 @@ void InstrumentListForm::stabilizeForm (void)
 
 	bool bEnabled = (pMainForm && pMainForm->client());
 	m_ui.newInstrumentAction->setEnabled(bEnabled);
+	m_ui.checkInstrumentsAction->setEnabled(bEnabled);
 	const QModelIndex& index = m_pInstrumentListView->currentIndex();
 	bEnabled = (bEnabled && index.isValid());
 	m_ui.editInstrumentAction->setEnabled(bEnabled);
@@ -343,6 +430,7 @@ void InstrumentListForm::contextMenuEvent (
 	menu.addAction(m_ui.deleteInstrumentAction);
 	menu.addSeparator();
 	menu.addAction(m_ui.refreshInstrumentsAction);
+	menu.addAction(m_ui.checkInstrumentsAction);
 
 	menu.exec(pContextMenuEvent->globalPos());
 }
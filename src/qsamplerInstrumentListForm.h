@@ -52,8 +52,16 @@ public slots:
 	void editInstrument(const QModelIndex& index);
 	void deleteInstrument();
 	void refreshInstruments();
+	void checkInstruments();
+	void refreshMaps();
 	void activateMap(int);
 
+	void invalidateMap(int iMidiMap);
+	void revalidateMaps();
+
+	void updateMapEntry(int iMidiMap, int iBank, int iProg);
+	void updateMapCount(int iMidiMap, int iCount);
+
 	void stabilizeForm();
 
 protected:
@@ -71,6 +79,9 @@ private:
 	QComboBox *m_pMapComboBox;
 
 	InstrumentListView *m_pInstrumentListView;
+
+	// Pending map change notifications.
+	int m_iDirtyMaps;
 };
 
 } // namespace QSampler
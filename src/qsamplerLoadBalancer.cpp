@@ -0,0 +1,620 @@
+// qsamplerLoadBalancer.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerLoadBalancer.h"
+#include "qsamplerUtilities.h"
+
+#include <QRunnable>
+#include <QMutexLocker>
+#include <QFileInfo>
+#include <QTime>
+#include <QRegExp>
+#include <QVector>
+#include <QtAlgorithms>
+
+
+namespace QSampler {
+
+// LinuxSampler defaults, when the server won't tell.
+#define QSAMPLER_BALANCE_MAX_VOICES   64
+#define QSAMPLER_BALANCE_MAX_STREAMS  90
+
+// Remote instrument load status polling period (msecs).
+#define QSAMPLER_BALANCE_POLL_MSECS   200
+
+// Remote instrument load time limit (msecs).
+#define QSAMPLER_BALANCE_LOAD_MSECS   (5 * 60 * 1000)
+
+
+//-------------------------------------------------------------------------
+// QSampler::LoadBalancerJob - one server channel placement.
+//
+
+class LoadBalancerJob : public QRunnable
+{
+public:
+
+	// Constructor.
+	LoadBalancerJob(LoadBalancer *pBalancer, int iServer)
+		: m_pBalancer(pBalancer), m_iServer(iServer) {}
+
+	// Job executive.
+	void run()
+		{ m_pBalancer->place(m_iServer); }
+
+private:
+
+	// Instance variables.
+	LoadBalancer *m_pBalancer;
+	int m_iServer;
+};
+
+
+// No events are subscribed on other servers, whatsoever.
+static lscp_status_t qsampler_balancer_callback ( lscp_client_t */*pClient*/,
+	lscp_event_t /*event*/, const char */*pchData*/, int /*cchData*/,
+	void */*pvData*/ )
+{
+	return LSCP_OK;
+}
+
+
+// Heaviest demands go first (longest processing time first).
+static bool demandGreaterThan (
+	const LoadBalancer::Demand *pDemand1, const LoadBalancer::Demand *pDemand2 )
+{
+	const int iWeight1 = pDemand1->iVoices + pDemand1->iStreams;
+	const int iWeight2 = pDemand2->iVoices + pDemand2->iStreams;
+	if (iWeight1 != iWeight2)
+		return (iWeight1 > iWeight2);
+	return (pDemand1->iMemory > pDemand2->iMemory);
+}
+
+
+//-------------------------------------------------------------------------
+// QSampler::LoadBalancer - sampler channel distribution across servers.
+//
+
+// Constructor.
+LoadBalancer::LoadBalancer ( int iTimeout )
+	: m_iTimeout(iTimeout), m_iJobs(0), m_bCancel(false)
+{
+}
+
+
+// Destructor.
+LoadBalancer::~LoadBalancer (void)
+{
+	// Placements still running are on our clients...
+	cancel();
+	m_pool.waitForDone();
+
+	QListIterator<Server> iter(m_servers);
+	while (iter.hasNext()) {
+		const Server& server = iter.next();
+		if (server.bOwned && server.pClient)
+			::lscp_client_destroy(server.pClient);
+	}
+}
+
+
+// Server registry.
+bool LoadBalancer::addServer ( const QString& sHost, int iPort,
+	lscp_client_t *pClient )
+{
+	Server server;
+	server.sHost  = sHost;
+	server.iPort  = iPort;
+	server.bOwned = (pClient == NULL);
+	if (server.bOwned) {
+		pClient = ::lscp_client_create(
+			sHost.toUtf8().constData(), iPort,
+			qsampler_balancer_callback, NULL);
+		if (pClient == NULL) {
+			addError(QObject::tr("Could not connect to server %1.")
+				.arg(serverName(server)));
+			return false;
+		}
+		::lscp_client_set_timeout(pClient, m_iTimeout);
+	}
+	server.pClient = pClient;
+
+	server.iMaxVoices  = -1;
+	server.iMaxStreams = -1;
+#ifdef CONFIG_MAX_VOICES
+	server.iMaxVoices  = ::lscp_get_voices(pClient);
+	server.iMaxStreams = ::lscp_get_streams(pClient);
+#endif
+	if (server.iMaxVoices < 1)
+		server.iMaxVoices = QSAMPLER_BALANCE_MAX_VOICES;
+	if (server.iMaxStreams < 1)
+		server.iMaxStreams = QSAMPLER_BALANCE_MAX_STREAMS;
+
+	server.iVoices   = 0;
+	server.iStreams  = 0;
+	server.iMemory   = 0;
+	server.iChannels = 0;
+
+	m_servers.append(server);
+
+	return true;
+}
+
+
+int LoadBalancer::serverCount (void) const
+{
+	return m_servers.count();
+}
+
+const LoadBalancer::Server& LoadBalancer::server ( int iServer ) const
+{
+	return m_servers.at(iServer);
+}
+
+
+// Pretty server name.
+QString LoadBalancer::serverName ( const Server& server )
+{
+	return server.sHost + ':' + QString::number(server.iPort);
+}
+
+
+// Parse a "host[:port] ..." server list.
+QList<QPair<QString, int> > LoadBalancer::parseServers (
+	const QString& sServers, int iDefaultPort )
+{
+	QList<QPair<QString, int> > servers;
+
+	const QStringList& items
+		= sServers.split(QRegExp("[\\s,;]+"), QString::SkipEmptyParts);
+	QStringListIterator iter(items);
+	while (iter.hasNext()) {
+		const QString& sItem = iter.next();
+		QString sHost = sItem;
+		int iPort = iDefaultPort;
+		const int iColon = sItem.lastIndexOf(':');
+		if (iColon > 0) {
+			bool bOk = false;
+			const int iValue = sItem.mid(iColon + 1).toInt(&bOk);
+			if (bOk && iValue > 0) {
+				sHost = sItem.left(iColon);
+				iPort = iValue;
+			}
+		}
+		servers.append(qMakePair(sHost, iPort));
+	}
+
+	return servers;
+}
+
+
+// Observed server load, but the given (moving) channels.
+void LoadBalancer::refreshLoad ( int iServer, const QList<int>& excludes )
+{
+	if (iServer < 0 || iServer >= m_servers.count())
+		return;
+
+	Server& server = m_servers[iServer];
+	server.iVoices   = 0;
+	server.iStreams  = 0;
+	server.iMemory   = 0;
+	server.iChannels = 0;
+
+	const int *piChannels = ::lscp_list_channels(server.pClient);
+	if (piChannels == NULL)
+		return;
+
+	// Take a copy, as the client result buffer gets reused...
+	QList<int> channels;
+	for (int i = 0; piChannels[i] >= 0; ++i) {
+		if (!excludes.contains(piChannels[i]))
+			channels.append(piChannels[i]);
+	}
+
+	QListIterator<int> iter(channels);
+	while (iter.hasNext()) {
+		const int iChannel = iter.next();
+		const int iVoices = ::lscp_get_channel_voice_count(
+			server.pClient, iChannel);
+		const int iStreams = ::lscp_get_channel_stream_count(
+			server.pClient, iChannel);
+		if (iVoices > 0)
+			server.iVoices += iVoices;
+		if (iStreams > 0)
+			server.iStreams += iStreams;
+		lscp_channel_info_t *pChannelInfo
+			= ::lscp_get_channel_info(server.pClient, iChannel);
+		if (pChannelInfo && pChannelInfo->instrument_file)
+			server.iMemory += QFileInfo(pChannelInfo->instrument_file).size();
+		++server.iChannels;
+	}
+}
+
+
+// Channel demands to be placed.
+void LoadBalancer::addDemand ( const Demand& demand )
+{
+	m_demands.append(demand);
+
+	Demand& last = m_demands.last();
+	last.iServer = -1;
+	last.iRemoteChannel = -1;
+	if (last.iMemory < 1 && !last.sInstrumentFile.isEmpty())
+		last.iMemory = QFileInfo(last.sInstrumentFile).size();
+}
+
+
+const QList<LoadBalancer::Demand>& LoadBalancer::demands (void) const
+{
+	return m_demands;
+}
+
+
+// Assign all demands to the least loaded servers.
+void LoadBalancer::assign (void)
+{
+	if (m_servers.isEmpty())
+		return;
+
+	// Instrument memory is only compared relatively...
+	qint64 iMemoryTotal = 0;
+	QListIterator<Server> server_iter(m_servers);
+	while (server_iter.hasNext())
+		iMemoryTotal += server_iter.next().iMemory;
+	QListIterator<Demand> demand_iter(m_demands);
+	while (demand_iter.hasNext())
+		iMemoryTotal += demand_iter.next().iMemory;
+
+	QList<Demand *> demands;
+	for (int i = 0; i < m_demands.count(); ++i)
+		demands.append(&m_demands[i]);
+	qStableSort(demands.begin(), demands.end(), demandGreaterThan);
+
+	QListIterator<Demand *> iter(demands);
+	while (iter.hasNext()) {
+		Demand *pDemand = iter.next();
+		int iBestServer = 0;
+		float fBestLoad = -1.0f;
+		for (int i = 0; i < m_servers.count(); ++i) {
+			const Server& server = m_servers.at(i);
+			const float fVoices = float(server.iVoices + pDemand->iVoices)
+				/ float(server.iMaxVoices);
+			const float fStreams = float(server.iStreams + pDemand->iStreams)
+				/ float(server.iMaxStreams);
+			const float fMemory = (iMemoryTotal > 0
+				? float(server.iMemory + pDemand->iMemory) / float(iMemoryTotal)
+				: 0.0f);
+			const float fLoad = qMax(qMax(fVoices, fStreams), fMemory);
+			// Ties are left to the main server (no moves)...
+			if (fBestLoad < 0.0f || fLoad < fBestLoad) {
+				iBestServer = i;
+				fBestLoad = fLoad;
+			}
+		}
+		Server& server = m_servers[iBestServer];
+		server.iVoices  += pDemand->iVoices;
+		server.iStreams += pDemand->iStreams;
+		server.iMemory  += pDemand->iMemory;
+		++server.iChannels;
+		pDemand->iServer = iBestServer;
+	}
+}
+
+
+// Projected server load (0.0 .. 1.0, or even more).
+float LoadBalancer::load ( int iServer ) const
+{
+	if (iServer < 0 || iServer >= m_servers.count())
+		return 0.0f;
+
+	const Server& server = m_servers.at(iServer);
+	const float fVoices = float(server.iVoices) / float(server.iMaxVoices);
+	const float fStreams = float(server.iStreams) / float(server.iMaxStreams);
+
+	return qMax(fVoices, fStreams);
+}
+
+
+// Create channels and load instruments of all demands
+// assigned to other than the main server (concurrently,
+// in the background).
+void LoadBalancer::dispatch (void)
+{
+	const int iDemands = m_demands.count();
+
+	m_mutex.lock();
+	m_remotes.fill(-1, iDemands);
+	m_statuses.fill(0, iDemands);
+	m_iJobs = qMax(0, m_servers.count() - 1);
+	m_bCancel = false;
+	m_mutex.unlock();
+
+	m_pool.setMaxThreadCount(qMax(1, m_servers.count() - 1));
+	for (int iServer = 1; iServer < m_servers.count(); ++iServer)
+		m_pool.start(new LoadBalancerJob(this, iServer));
+}
+
+
+// Wait for all dispatched instrument loads to complete (or fail).
+bool LoadBalancer::wait ( int iMsecs )
+{
+	QMutexLocker locker(&m_mutex);
+
+	if (m_iJobs > 0)
+		m_cond.wait(&m_mutex, iMsecs);
+	if (m_iJobs > 0)
+		return false;
+
+	// All done; final results are on record now...
+	for (int i = 0; i < m_demands.count() && i < m_remotes.count(); ++i)
+		m_demands[i].iRemoteChannel = m_remotes.at(i);
+
+	return true;
+}
+
+
+// Give up on all pending instrument loads.
+void LoadBalancer::cancel (void)
+{
+	QMutexLocker locker(&m_mutex);
+	m_bCancel = true;
+	m_cond.wakeAll();
+}
+
+
+// Remote instruments fully loaded so far.
+int LoadBalancer::loaded (void) const
+{
+	QMutexLocker locker(&m_mutex);
+
+	int iLoaded = 0;
+	for (int i = 0; i < m_statuses.count(); ++i) {
+		if (m_remotes.at(i) >= 0 && m_statuses.at(i) >= 100)
+			++iLoaded;
+	}
+
+	return iLoaded;
+}
+
+
+// Place all demands assigned to one server (runs on a worker thread);
+// instruments are loaded in parallel across servers, but each remote
+// channel only counts as placed once its instrument is fully loaded.
+void LoadBalancer::place ( int iServer )
+{
+	const Server& server = m_servers.at(iServer);
+	lscp_client_t *pClient = server.pClient;
+	const QString& sServerName = serverName(server);
+
+	// Just the first audio/MIDI devices around...
+	int iAudioDevice = -1;
+	const int *piAudioDevices = ::lscp_list_audio_devices(pClient);
+	if (piAudioDevices && piAudioDevices[0] >= 0)
+		iAudioDevice = piAudioDevices[0];
+	int iMidiDevice = -1;
+	const int *piMidiDevices = ::lscp_list_midi_devices(pClient);
+	if (piMidiDevices && piMidiDevices[0] >= 0)
+		iMidiDevice = piMidiDevices[0];
+
+	// MIDI instrument maps go by name...
+	QMap<QString, int> maps;
+#ifdef CONFIG_MIDI_INSTRUMENT
+	QList<int> mapIDs;
+	const int *piMaps = ::lscp_list_midi_instrument_maps(pClient);
+	for (int i = 0; piMaps && piMaps[i] >= 0; ++i)
+		mapIDs.append(piMaps[i]);
+	QListIterator<int> map_iter(mapIDs);
+	while (map_iter.hasNext()) {
+		const int iMap = map_iter.next();
+		const char *pszMapName
+			= ::lscp_get_midi_instrument_map_name(pClient, iMap);
+		if (pszMapName)
+			maps.insert(QString::fromUtf8(pszMapName), iMap);
+	}
+#endif
+
+	// Instrument paths get escaped as the target server wants them...
+	const qsamplerUtilities::lscpVersion_t& version
+		= qsamplerUtilities::getRemoteLscpVersion(pClient);
+
+	QList<int> pending;
+
+	for (int i = 0; i < m_demands.count() && iAudioDevice >= 0; ++i) {
+		const Demand& demand = m_demands.at(i);
+		if (demand.iServer != iServer)
+			continue;
+		int iMidiMap = demand.iMidiMap;
+		if (iMidiMap >= 0) {
+			iMidiMap = maps.value(demand.sMidiMapName, -1);
+			if (iMidiMap < 0) {
+				addError(QObject::tr("No \"%1\" MIDI instrument map "
+					"on server %2 for channel %3.").arg(demand.sMidiMapName)
+					.arg(sServerName).arg(demand.iChannelID));
+				continue;
+			}
+		}
+		const int iChannel = ::lscp_add_channel(pClient);
+		if (iChannel < 0) {
+			addError(QObject::tr("Could not add channel on server %1: %2.")
+				.arg(sServerName).arg(::lscp_client_get_result(pClient)));
+			continue;
+		}
+		// The whole channel setup, as far as it can be replicated...
+		bool bResult = (::lscp_load_engine(pClient,
+			demand.sEngineName.toUtf8().constData(), iChannel) == LSCP_OK);
+		if (bResult) bResult = (::lscp_set_channel_audio_device(
+			pClient, iChannel, iAudioDevice) == LSCP_OK);
+		QMap<int, int>::ConstIterator route = demand.audioRouting.constBegin();
+		for ( ; bResult && route != demand.audioRouting.constEnd(); ++route) {
+			bResult = (::lscp_set_channel_audio_channel(pClient,
+				iChannel, route.key(), route.value()) == LSCP_OK);
+		}
+		if (bResult && iMidiDevice >= 0) {
+			bResult = (::lscp_set_channel_midi_device(
+				pClient, iChannel, iMidiDevice) == LSCP_OK);
+			if (bResult) bResult = (::lscp_set_channel_midi_port(
+				pClient, iChannel, demand.iMidiPort) == LSCP_OK);
+			if (bResult) bResult = (::lscp_set_channel_midi_channel(
+				pClient, iChannel, demand.iMidiChannel) == LSCP_OK);
+		}
+	#ifdef CONFIG_MIDI_INSTRUMENT
+		if (bResult && iMidiMap != -1) bResult = (::lscp_set_channel_midi_map(
+			pClient, iChannel, iMidiMap) == LSCP_OK);
+	#endif
+		if (bResult) bResult = (::lscp_set_channel_volume(
+			pClient, iChannel, demand.fVolume) == LSCP_OK);
+	#ifdef CONFIG_MUTE_SOLO
+		if (bResult && demand.bMute) bResult = (::lscp_set_channel_mute(
+			pClient, iChannel, 1) == LSCP_OK);
+		if (bResult && demand.bSolo) bResult = (::lscp_set_channel_solo(
+			pClient, iChannel, 1) == LSCP_OK);
+	#endif
+	#ifdef CONFIG_FXSEND
+		QListIterator<Send> send_iter(demand.sends);
+		while (bResult && send_iter.hasNext()) {
+			const Send& send = send_iter.next();
+			const QByteArray aName = send.sName.toUtf8();
+			const int iFxSend = ::lscp_create_fxsend(pClient, iChannel,
+				send.iMidiController,
+				send.sName.isEmpty() ? NULL : aName.constData());
+			bResult = (iFxSend >= 0);
+			QMap<int, int>::ConstIterator fx_route = send.routing.constBegin();
+			for ( ; bResult && fx_route != send.routing.constEnd(); ++fx_route) {
+				bResult = (::lscp_set_fxsend_audio_channel(pClient, iChannel,
+					iFxSend, fx_route.key(), fx_route.value()) == LSCP_OK);
+			}
+		#ifdef CONFIG_FXSEND_LEVEL
+			if (bResult) bResult = (::lscp_set_fxsend_level(
+				pClient, iChannel, iFxSend, send.fLevel) == LSCP_OK);
+		#endif
+		}
+	#endif
+		// Instrument loading goes non-modal, so that all servers
+		// keep loading in parallel while we're sending along...
+		if (bResult) bResult = (::lscp_load_instrument_non_modal(pClient,
+			qsamplerUtilities::lscpEscapePath(demand.sInstrumentFile,
+				version).toUtf8().constData(),
+			demand.iInstrumentNr, iChannel) == LSCP_OK);
+		if (!bResult) {
+			addError(QObject::tr("Could not set up channel %1 "
+				"on server %2: %3.").arg(iChannel).arg(sServerName)
+				.arg(::lscp_client_get_result(pClient)));
+			::lscp_remove_channel(pClient, iChannel);
+			continue;
+		}
+		setRemote(i, iChannel, 0);
+		pending.append(i);
+	}
+
+	if (iAudioDevice < 0) {
+		addError(QObject::tr("No audio output device on server %1.")
+			.arg(sServerName));
+	}
+
+	// Now wait for those instruments to be fully loaded...
+	QTime t;
+	t.start();
+	while (!pending.isEmpty() && !isCanceled()
+		&& t.elapsed() < QSAMPLER_BALANCE_LOAD_MSECS) {
+		// Sleep a while, unless cancelled...
+		m_mutex.lock();
+		if (!m_bCancel)
+			m_cond.wait(&m_mutex, QSAMPLER_BALANCE_POLL_MSECS);
+		m_mutex.unlock();
+		QMutableListIterator<int> iter(pending);
+		while (iter.hasNext()) {
+			const int i = iter.next();
+			m_mutex.lock();
+			const int iChannel = m_remotes.at(i);
+			m_mutex.unlock();
+			lscp_channel_info_t *pChannelInfo
+				= ::lscp_get_channel_info(pClient, iChannel);
+			const int iStatus
+				= (pChannelInfo ? pChannelInfo->instrument_status : -1);
+			if (iStatus < 0) {
+				addError(QObject::tr("Could not load instrument of channel %1 "
+					"on server %2.").arg(iChannel).arg(sServerName));
+				::lscp_remove_channel(pClient, iChannel);
+				setRemote(i, -1, iStatus);
+				iter.remove();
+			} else {
+				setRemote(i, iChannel, iStatus);
+				if (iStatus >= 100)
+					iter.remove();
+			}
+		}
+	}
+
+	// Whatever didn't make it (timeout or cancel) stays where it was...
+	QListIterator<int> iter(pending);
+	while (iter.hasNext()) {
+		const int i = iter.next();
+		m_mutex.lock();
+		const int iChannel = m_remotes.at(i);
+		m_mutex.unlock();
+		addError(QObject::tr("Gave up loading instrument of channel %1 "
+			"on server %2.").arg(iChannel).arg(sServerName));
+		::lscp_remove_channel(pClient, iChannel);
+		setRemote(i, -1, 0);
+	}
+
+	QMutexLocker locker(&m_mutex);
+	if (--m_iJobs < 1)
+		m_cond.wakeAll();
+}
+
+
+// Accumulated errors.
+const QStringList& LoadBalancer::errors (void) const
+{
+	return m_errors;
+}
+
+
+// Error accounting (any thread).
+void LoadBalancer::addError ( const QString& sError )
+{
+	QMutexLocker locker(&m_mutex);
+	m_errors.append(sError);
+}
+
+
+// Placement results (any thread).
+void LoadBalancer::setRemote ( int iDemand,
+	int iRemoteChannel, int iRemoteStatus )
+{
+	QMutexLocker locker(&m_mutex);
+	m_remotes[iDemand]  = iRemoteChannel;
+	m_statuses[iDemand] = iRemoteStatus;
+}
+
+
+bool LoadBalancer::isCanceled (void) const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_bCancel;
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerLoadBalancer.cpp
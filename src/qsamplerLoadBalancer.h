@@ -0,0 +1,183 @@
+// qsamplerLoadBalancer.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerLoadBalancer_h
+#define __qsamplerLoadBalancer_h
+
+#include <QStringList>
+#include <QThreadPool>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QVector>
+#include <QList>
+#include <QPair>
+#include <QMap>
+
+#include <lscp/client.h>
+
+
+namespace QSampler {
+
+//-------------------------------------------------------------------------
+// QSampler::LoadBalancer - sampler channel distribution across servers.
+//
+
+class LoadBalancer
+{
+public:
+
+	// Constructor.
+	LoadBalancer(int iTimeout = 1000);
+
+	// Destructor.
+	~LoadBalancer();
+
+	// One sampler server (instance).
+	struct Server
+	{
+		QString sHost;
+		int     iPort;
+		lscp_client_t *pClient;
+		bool    bOwned;         // Whether we've connected it ourselves.
+		int     iMaxVoices;
+		int     iMaxStreams;
+		int     iVoices;        // Current plus assigned load.
+		int     iStreams;
+		qint64  iMemory;
+		int     iChannels;
+	};
+
+	// One effect send of a sampler channel.
+	struct Send
+	{
+		QString sName;
+		int     iMidiController;
+		float   fLevel;
+		QMap<int, int> routing;
+	};
+
+	// One sampler channel to be placed (full setup).
+	struct Demand
+	{
+		int     iChannelID;     // Origin (main server) channel.
+		QString sEngineName;
+		QString sInstrumentFile;
+		int     iInstrumentNr;
+		int     iMidiPort;
+		int     iMidiChannel;
+		int     iMidiMap;       // None (-1), default (-2) or else...
+		QString sMidiMapName;   // ...the one of the same name there.
+		QMap<int, int> audioRouting;
+		float   fVolume;
+		bool    bMute;
+		bool    bSolo;
+		QList<Send> sends;
+		int     iVoices;        // Observed or predicted peaks.
+		int     iStreams;
+		qint64  iMemory;        // Instrument file size, as best guess.
+		int     iServer;        // Assigned server (-1 if none yet).
+		int     iRemoteChannel; // Created channel (-1 if none yet).
+	};
+
+	// Server registry; the first one is the main (current) one,
+	// which is connected already and therefore not owned here.
+	bool addServer(const QString& sHost, int iPort,
+		lscp_client_t *pClient = NULL);
+
+	int serverCount() const;
+	const Server& server(int iServer) const;
+
+	// Pretty server name.
+	static QString serverName(const Server& server);
+
+	// Parse a "host[:port] ..." server list.
+	static QList<QPair<QString, int> > parseServers(
+		const QString& sServers, int iDefaultPort);
+
+	// Observed server load, but the given (moving) channels.
+	void refreshLoad(int iServer, const QList<int>& excludes = QList<int>());
+
+	// Channel demands to be placed.
+	void addDemand(const Demand& demand);
+	const QList<Demand>& demands() const;
+
+	// Assign all demands to the least loaded servers.
+	void assign();
+
+	// Projected server load (0.0 .. 1.0, or even more).
+	float load(int iServer) const;
+
+	// Create channels and load instruments of all demands
+	// assigned to other than the main server (concurrently,
+	// in the background).
+	void dispatch();
+
+	// Wait for all dispatched instrument loads to complete
+	// (or fail); true when done, false on timeout.
+	bool wait(int iMsecs);
+
+	// Give up on all pending instrument loads.
+	void cancel();
+
+	// Remote instruments fully loaded so far.
+	int loaded() const;
+
+	// Place all demands assigned to one server (runs on a worker thread).
+	void place(int iServer);
+
+	// Accumulated errors.
+	const QStringList& errors() const;
+
+protected:
+
+	// Error accounting (any thread).
+	void addError(const QString& sError);
+
+	// Placement results (any thread).
+	void setRemote(int iDemand, int iRemoteChannel, int iRemoteStatus);
+	bool isCanceled() const;
+
+private:
+
+	// Instance variables.
+	int m_iTimeout;
+
+	QList<Server> m_servers;
+	QList<Demand> m_demands;
+
+	QThreadPool  m_pool;
+
+	mutable QMutex m_mutex;
+	QWaitCondition m_cond;
+	int          m_iJobs;       // Placements still running.
+	QStringList  m_errors;
+	QVector<int> m_remotes;     // Remote channel, per demand.
+	QVector<int> m_statuses;    // Remote instrument status, per demand.
+	bool         m_bCancel;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerLoadBalancer_h
+
+
+// end of qsamplerLoadBalancer.h
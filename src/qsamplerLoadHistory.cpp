@@ -0,0 +1,202 @@
+// qsamplerLoadHistory.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerLoadHistory.h"
+
+#include <QSettings>
+#include <QFileInfo>
+#include <QMap>
+
+
+namespace QSampler {
+
+// Maximum number of instruments to remember.
+#define QSAMPLER_LOAD_HISTORY_MAX  500
+
+
+//-------------------------------------------------------------------------
+// QSampler::LoadHistory - instrument load-time history.
+//
+
+// Constructor.
+LoadHistory::LoadHistory (void) : m_iSerial(0)
+{
+}
+
+
+// Load history from settings.
+void LoadHistory::load ( QSettings& settings )
+{
+	m_items.clear();
+	m_iSerial = 0;
+
+	settings.beginGroup("/LoadHistory");
+	const int iCount = settings.beginReadArray("/Instruments");
+	for (int i = 0; i < iCount; ++i) {
+		settings.setArrayIndex(i);
+		Item item;
+		item.sInstrumentFile = settings.value("/File").toString();
+		item.iInstrumentNr   = settings.value("/Nr", 0).toInt();
+		item.iMsecs  = settings.value("/Msecs", 0).toInt();
+		item.iCount  = settings.value("/Count", 1).toInt();
+		item.iSize   = settings.value("/Size", 0).toLongLong();
+		item.iSerial = ++m_iSerial;
+		if (!item.sInstrumentFile.isEmpty() && item.iMsecs > 0) {
+			m_items.insert(
+				key(item.sInstrumentFile, item.iInstrumentNr), item);
+		}
+	}
+	settings.endArray();
+	settings.endGroup();
+}
+
+
+// Save history into settings (most recent ones only).
+void LoadHistory::save ( QSettings& settings ) const
+{
+	QMap<uint, const Item *> items;
+	QHash<QString, Item>::ConstIterator iter = m_items.constBegin();
+	for ( ; iter != m_items.constEnd(); ++iter)
+		items.insert(iter.value().iSerial, &iter.value());
+	while (items.count() > QSAMPLER_LOAD_HISTORY_MAX)
+		items.erase(items.begin());
+
+	settings.beginGroup("/LoadHistory");
+	settings.remove("/Instruments");
+	settings.beginWriteArray("/Instruments", items.count());
+	int i = 0;
+	QMapIterator<uint, const Item *> iter2(items);
+	while (iter2.hasNext()) {
+		const Item *pItem = iter2.next().value();
+		settings.setArrayIndex(i++);
+		settings.setValue("/File", pItem->sInstrumentFile);
+		settings.setValue("/Nr", pItem->iInstrumentNr);
+		settings.setValue("/Msecs", pItem->iMsecs);
+		settings.setValue("/Count", pItem->iCount);
+		settings.setValue("/Size", pItem->iSize);
+	}
+	settings.endArray();
+	settings.endGroup();
+}
+
+
+// Account for one actual instrument load time (msecs).
+void LoadHistory::record (
+	const QString& sInstrumentFile, int iInstrumentNr, int iMsecs )
+{
+	if (sInstrumentFile.isEmpty() || iMsecs < 1)
+		return;
+
+	const QString& sKey = key(sInstrumentFile, iInstrumentNr);
+	QHash<QString, Item>::Iterator iter = m_items.find(sKey);
+	if (iter == m_items.end()) {
+		Item item;
+		item.sInstrumentFile = sInstrumentFile;
+		item.iInstrumentNr = iInstrumentNr;
+		item.iMsecs = iMsecs;
+		item.iCount = 0;
+		item.iSize  = 0;
+		iter = m_items.insert(sKey, item);
+	}
+
+	Item& item = iter.value();
+	// Smooth it out, as disk caches get in the way...
+	if (item.iCount > 0)
+		item.iMsecs = (3 * item.iMsecs + iMsecs) / 4;
+	++item.iCount;
+	item.iSerial = ++m_iSerial;
+
+	const QFileInfo fi(sInstrumentFile);
+	if (fi.exists())
+		item.iSize = fi.size();
+}
+
+
+// Known load time of a given instrument (msecs; -1 if unknown).
+int LoadHistory::predict (
+	const QString& sInstrumentFile, int iInstrumentNr ) const
+{
+	QHash<QString, Item>::ConstIterator iter
+		= m_items.constFind(key(sInstrumentFile, iInstrumentNr));
+	if (iter == m_items.constEnd())
+		return -1;
+
+	return iter.value().iMsecs;
+}
+
+
+// Known or else guessed load time (msecs; -1 if clueless).
+int LoadHistory::estimate (
+	const QString& sInstrumentFile, int iInstrumentNr ) const
+{
+	const int iMsecs = predict(sInstrumentFile, iInstrumentNr);
+	if (iMsecs >= 0)
+		return iMsecs;
+
+	const QFileInfo fi(sInstrumentFile);
+	if (!fi.exists())
+		return -1;
+
+	// Overall known throughput (bytes/msec)...
+	qint64 iSizeSum  = 0;
+	qint64 iMsecsSum = 0;
+	QHash<QString, Item>::ConstIterator iter = m_items.constBegin();
+	for ( ; iter != m_items.constEnd(); ++iter) {
+		const Item& item = iter.value();
+		if (item.iSize > 0) {
+			iSizeSum  += item.iSize;
+			iMsecsSum += item.iMsecs;
+		}
+	}
+
+	if (iSizeSum < 1 || iMsecsSum < 1)
+		return -1;
+
+	return int((fi.size() * iMsecsSum) / iSizeSum);
+}
+
+
+// Number of instruments with known load times.
+int LoadHistory::count (void) const
+{
+	return m_items.count();
+}
+
+
+// Forget everything.
+void LoadHistory::clear (void)
+{
+	m_items.clear();
+	m_iSerial = 0;
+}
+
+
+// Instrument key helper.
+QString LoadHistory::key ( const QString& sInstrumentFile, int iInstrumentNr )
+{
+	return sInstrumentFile + '#' + QString::number(iInstrumentNr);
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerLoadHistory.cpp
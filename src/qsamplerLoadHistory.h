@@ -0,0 +1,93 @@
+// qsamplerLoadHistory.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerLoadHistory_h
+#define __qsamplerLoadHistory_h
+
+#include <QString>
+#include <QHash>
+
+class QSettings;
+
+
+namespace QSampler {
+
+//-------------------------------------------------------------------------
+// QSampler::LoadHistory - instrument load-time history.
+//
+
+class LoadHistory
+{
+public:
+
+	// Constructor.
+	LoadHistory();
+
+	// Persistence (as found on settings).
+	void load(QSettings& settings);
+	void save(QSettings& settings) const;
+
+	// Account for one actual instrument load time (msecs).
+	void record(const QString& sInstrumentFile, int iInstrumentNr, int iMsecs);
+
+	// Known load time of a given instrument (msecs; -1 if unknown).
+	int predict(const QString& sInstrumentFile, int iInstrumentNr) const;
+
+	// Known or else guessed load time, from the instrument file size
+	// and the overall known throughput (msecs; -1 if clueless).
+	int estimate(const QString& sInstrumentFile, int iInstrumentNr) const;
+
+	// Number of instruments with known load times.
+	int count() const;
+
+	// Forget everything.
+	void clear();
+
+protected:
+
+	// Instrument key helper.
+	static QString key(const QString& sInstrumentFile, int iInstrumentNr);
+
+private:
+
+	// Per-instrument history item.
+	struct Item
+	{
+		QString sInstrumentFile;
+		int     iInstrumentNr;
+		int     iMsecs;         // Smoothed load time.
+		int     iCount;
+		qint64  iSize;          // Instrument file size (bytes).
+		uint    iSerial;        // Recency order.
+	};
+
+	// Instance variables.
+	QHash<QString, Item> m_items;
+	uint m_iSerial;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerLoadHistory_h
+
+
+// end of qsamplerLoadHistory.h
@@ -0,0 +1,356 @@
+// qsamplerLoadScheduler.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerLoadScheduler.h"
+
+#include "qsamplerOptions.h"
+#include "qsamplerChannel.h"
+#include "qsamplerChannelStrip.h"
+#include "qsamplerMainForm.h"
+
+#include <QTimer>
+
+
+namespace QSampler {
+
+// Stream buffer sampling period (msecs).
+#define QSAMPLER_LOAD_SCHEDULER_TICK_MSECS  500
+
+// Base gap between consecutive loads, per 10% of buffer drain (msecs).
+#define QSAMPLER_LOAD_SCHEDULER_GAP_MSECS   250
+
+// How long a persistent map entry load is taken as in progress (msecs).
+#define QSAMPLER_LOAD_SCHEDULER_MAP_MSECS   2000
+
+
+//-------------------------------------------------------------------------
+// QSampler::LoadScheduler - stream buffer aware background loader.
+//
+
+// Kind-of singleton reference.
+LoadScheduler *LoadScheduler::g_pLoadScheduler = NULL;
+
+
+// Constructor.
+LoadScheduler::LoadScheduler ( QObject *pParent )
+	: QObject(pParent), m_iLoadGap(0), m_iLoadChannelID(-1),
+		m_bLoadMap(false), m_bPaused(false), m_bDispatching(false)
+{
+	m_pTimer = new QTimer(this);
+	m_pTimer->setInterval(QSAMPLER_LOAD_SCHEDULER_TICK_MSECS);
+	QObject::connect(m_pTimer,
+		SIGNAL(timeout()),
+		SLOT(timerSlot()));
+
+	g_pLoadScheduler = this;
+}
+
+
+// Destructor.
+LoadScheduler::~LoadScheduler (void)
+{
+	g_pLoadScheduler = NULL;
+}
+
+
+// Pseudo-singleton instance accessor.
+LoadScheduler *LoadScheduler::getInstance (void)
+{
+	return g_pLoadScheduler;
+}
+
+
+// Queue a channel instrument load, if currently throttling.
+bool LoadScheduler::deferLoad ( int iChannelID,
+	const QString& sInstrumentFile, int iInstrumentNr )
+{
+	if (!isEnabled())
+		return false;
+
+	// Go straight ahead when disk streaming is healthy...
+	if (m_jobs.isEmpty() && !m_bPaused && !isLoading()) {
+		MainForm *pMainForm = MainForm::getInstance();
+		Options *pOptions = pMainForm->options();
+		const int iFill = streamFill();
+		if (iFill < 0 || iFill >= pOptions->iLoadResumeFill) {
+			m_iLoadChannelID = iChannelID;
+			m_bLoadMap = false;
+			m_lastLoad.start();
+			return false;
+		}
+	}
+
+	// Replace any other load still pending on the same channel...
+	QMutableListIterator<Job> iter(m_jobs);
+	while (iter.hasNext()) {
+		if (iter.next().iChannelID == iChannelID)
+			iter.remove();
+	}
+
+	Job job;
+	job.iChannelID      = iChannelID;
+	job.sInstrumentFile = sInstrumentFile;
+	job.iInstrumentNr   = iInstrumentNr;
+	m_jobs.append(job);
+
+	schedule();
+
+	return true;
+}
+
+
+// Queue a persistent MIDI instrument map entry, likewise.
+bool LoadScheduler::deferMap ( const Instrument& instr )
+{
+	if (!isEnabled())
+		return false;
+
+	if (m_jobs.isEmpty() && !m_bPaused && !isLoading()) {
+		MainForm *pMainForm = MainForm::getInstance();
+		Options *pOptions = pMainForm->options();
+		const int iFill = streamFill();
+		if (iFill < 0 || iFill >= pOptions->iLoadResumeFill) {
+			m_iLoadChannelID = -1;
+			m_bLoadMap = true;
+			m_lastLoad.start();
+			return false;
+		}
+	}
+
+	Job job;
+	job.iChannelID    = -1;
+	job.iInstrumentNr = instr.instrumentNr();
+	job.instr         = instr;
+	m_jobs.append(job);
+
+	schedule();
+
+	return true;
+}
+
+
+// Number of loads still waiting.
+int LoadScheduler::pending (void) const
+{
+	return m_jobs.count();
+}
+
+
+// Whether queued loads are being held back.
+bool LoadScheduler::isPaused (void) const
+{
+	return m_bPaused;
+}
+
+
+// Drop all pending loads (eg. client shutdown).
+void LoadScheduler::reset (void)
+{
+	m_pTimer->stop();
+	m_jobs.clear();
+
+	m_iLoadChannelID = -1;
+	m_bLoadMap = false;
+	m_iLoadGap = 0;
+	m_bPaused = false;
+}
+
+
+// Periodic buffer sampling and dispatch.
+void LoadScheduler::timerSlot (void)
+{
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL)
+		return;
+
+	Options *pOptions = pMainForm->options();
+	if (pOptions == NULL)
+		return;
+
+	if (m_jobs.isEmpty() || pMainForm->client() == NULL) {
+		reset();
+		return;
+	}
+
+	// Throttling just got disabled? flush it all...
+	if (!pOptions->bLoadThrottle) {
+		m_bPaused = false;
+		while (!m_jobs.isEmpty())
+			dispatch();
+		m_pTimer->stop();
+		return;
+	}
+
+	const int iFill = streamFill();
+
+	// Pause/resume hysteresis...
+	if (m_bPaused) {
+		if (iFill >= 0 && iFill < pOptions->iLoadResumeFill)
+			return;
+		m_bPaused = false;
+		pMainForm->appendMessages(
+			tr("Background loading resumed (%1 pending).")
+			.arg(m_jobs.count()));
+	}
+	else
+	if (iFill >= 0 && iFill < pOptions->iLoadPauseFill) {
+		m_bPaused = true;
+		pMainForm->appendMessagesColor(
+			tr("Background loading paused: "
+			"stream buffers down to %1% (%2 pending).")
+			.arg(iFill).arg(m_jobs.count()), "#996633");
+		return;
+	}
+
+	// One at a time...
+	if (isLoading())
+		return;
+
+	// The lower the buffers, the longer the gap in between...
+	m_iLoadGap = (iFill < 0 ? 0
+		: QSAMPLER_LOAD_SCHEDULER_GAP_MSECS * (100 - iFill) / 10);
+	if (m_lastLoad.isValid() && m_lastLoad.elapsed() < m_iLoadGap)
+		return;
+
+	dispatch();
+
+	if (m_jobs.isEmpty())
+		m_pTimer->stop();
+}
+
+
+// Least stream buffer fill over all streaming channels,
+// as last polled by the channel strips themselves; only the
+// ones not refreshed lately (eg. hidden, no auto-refresh)
+// get polled here, keeping server round trips down.
+int LoadScheduler::streamFill (void) const
+{
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL || pMainForm->client() == NULL)
+		return -1;
+
+	int iMinFill = -1;
+	for (int i = 0; ; ++i) {
+		ChannelStrip *pChannelStrip = pMainForm->channelStripAt(i);
+		if (pChannelStrip == NULL)
+			break;
+		const qint64 iAge = pChannelStrip->streamUsageAge();
+		if (iAge < 0 || iAge >= QSAMPLER_LOAD_SCHEDULER_TICK_MSECS)
+			pChannelStrip->updateChannelUsage();
+		if (pChannelStrip->streamCount() < 1)
+			continue;
+		const int iFill = pChannelStrip->streamUsage();
+		if (iFill >= 0 && (iMinFill < 0 || iFill < iMinFill))
+			iMinFill = iFill;
+	}
+
+	return iMinFill;
+}
+
+
+// Whether the last dispatched load (or map) is still in progress.
+bool LoadScheduler::isLoading (void) const
+{
+	// Persistent map entries have no status to poll for,
+	// so give them a while to settle down instead...
+	if (m_bLoadMap) {
+		return (m_lastLoad.isValid()
+			&& m_lastLoad.elapsed() < QSAMPLER_LOAD_SCHEDULER_MAP_MSECS);
+	}
+
+	if (m_iLoadChannelID < 0)
+		return false;
+
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL)
+		return false;
+
+	ChannelStrip *pChannelStrip = pMainForm->channelStrip(m_iLoadChannelID);
+	if (pChannelStrip == NULL || pChannelStrip->channel() == NULL)
+		return false;
+
+	const int iStatus = pChannelStrip->channel()->instrumentStatus();
+	return (iStatus >= 0 && iStatus < 100);
+}
+
+
+// Whether loads are to be throttled at all.
+bool LoadScheduler::isEnabled (void) const
+{
+	if (m_bDispatching)
+		return false;
+
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL || pMainForm->client() == NULL)
+		return false;
+
+	Options *pOptions = pMainForm->options();
+	return (pOptions && pOptions->bLoadThrottle);
+}
+
+
+// Kick the sampling timer, if not already.
+void LoadScheduler::schedule (void)
+{
+	if (!m_pTimer->isActive())
+		m_pTimer->start();
+}
+
+
+// Dispatch the next pending load.
+void LoadScheduler::dispatch (void)
+{
+	if (m_jobs.isEmpty())
+		return;
+
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL)
+		return;
+
+	Job job = m_jobs.takeFirst();
+
+	m_bDispatching = true;
+
+	if (job.iChannelID < 0) {
+		job.instr.mapInstrument();
+		m_iLoadChannelID = -1;
+		m_bLoadMap = true;
+	} else {
+		m_bLoadMap = false;
+		ChannelStrip *pChannelStrip = pMainForm->channelStrip(job.iChannelID);
+		if (pChannelStrip && pChannelStrip->channel()) {
+			pChannelStrip->channel()->loadInstrument(
+				job.sInstrumentFile, job.iInstrumentNr);
+			pMainForm->channelStripChanged(pChannelStrip);
+			m_iLoadChannelID = job.iChannelID;
+		}
+	}
+
+	m_bDispatching = false;
+
+	m_lastLoad.start();
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerLoadScheduler.cpp
@@ -0,0 +1,129 @@
+// qsamplerLoadScheduler.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerLoadScheduler_h
+#define __qsamplerLoadScheduler_h
+
+#include "qsamplerInstrument.h"
+
+#include <QObject>
+#include <QList>
+#include <QElapsedTimer>
+
+class QTimer;
+
+
+namespace QSampler {
+
+//-------------------------------------------------------------------------
+// QSampler::LoadScheduler - stream buffer aware background loader.
+//
+
+class LoadScheduler : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	// Constructor.
+	LoadScheduler(QObject *pParent = NULL);
+
+	// Destructor.
+	~LoadScheduler();
+
+	// Pseudo-singleton instance accessor.
+	static LoadScheduler *getInstance();
+
+	// Queue a channel instrument load, if currently throttling;
+	// returns false when the load should go on immediately.
+	bool deferLoad(int iChannelID,
+		const QString& sInstrumentFile, int iInstrumentNr);
+
+	// Queue a persistent MIDI instrument map entry, likewise.
+	bool deferMap(const Instrument& instr);
+
+	// Number of loads still waiting.
+	int pending() const;
+
+	// Whether queued loads are being held back.
+	bool isPaused() const;
+
+	// Drop all pending loads (eg. client shutdown).
+	void reset();
+
+protected slots:
+
+	// Periodic buffer sampling and dispatch.
+	void timerSlot();
+
+protected:
+
+	// Least stream buffer fill over all streaming channels
+	// (percent; -1 when nothing is streaming at all).
+	int streamFill() const;
+
+	// Whether the last dispatched load (or map) is still in progress.
+	bool isLoading() const;
+
+	// Whether loads are to be throttled at all.
+	bool isEnabled() const;
+
+	// Kick the sampling timer, if not already.
+	void schedule();
+
+	// Dispatch the next pending load.
+	void dispatch();
+
+private:
+
+	// Pending load queue item.
+	struct Job
+	{
+		int        iChannelID;   // -1 for MIDI instrument map entries.
+		QString    sInstrumentFile;
+		int        iInstrumentNr;
+		Instrument instr;
+	};
+
+	// Instance variables.
+	QList<Job> m_jobs;
+
+	QTimer *m_pTimer;
+
+	QElapsedTimer m_lastLoad;
+
+	int  m_iLoadGap;
+	int  m_iLoadChannelID;
+	bool m_bLoadMap;
+	bool m_bPaused;
+	bool m_bDispatching;
+
+	// Kind-of singleton reference.
+	static LoadScheduler *g_pLoadScheduler;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerLoadScheduler_h
+
+
+// end of qsamplerLoadScheduler.h
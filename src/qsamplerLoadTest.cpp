@@ -0,0 +1,433 @@
+// qsamplerLoadTest.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerLoadTest.h"
+
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QVector>
+
+#include <string.h>
+
+
+namespace QSampler {
+
+// Load sampling period (msecs).
+#define QSAMPLER_LOADTEST_SAMPLE_MSECS  50
+
+// Scheduling granularity (msecs).
+#define QSAMPLER_LOADTEST_TICK_MSECS    2
+
+// Release tail, still sampled after the last event (msecs).
+#define QSAMPLER_LOADTEST_TAIL_MSECS    2000
+
+// Give up when the very first injections all fail.
+#define QSAMPLER_LOADTEST_FAIL_LIMIT    16
+
+// Maximum number of distinct errors to keep.
+#define QSAMPLER_LOADTEST_ERROR_MAX     10
+
+
+// No events are subscribed, whatsoever.
+static lscp_status_t qsampler_loadtest_callback ( lscp_client_t */*pClient*/,
+	lscp_event_t /*event*/, const char */*pchData*/, int /*cchData*/,
+	void */*pvData*/ )
+{
+	return LSCP_OK;
+}
+
+
+//-------------------------------------------------------------------------
+// QSampler::LoadTestSampler - load sampling, on its own connection.
+//
+
+class LoadTestSampler : public QThread
+{
+public:
+
+	// Constructor.
+	LoadTestSampler(const QString& sHost, int iPort, int iTimeout,
+		const QList<int>& channels)
+		: QThread(), m_sHost(sHost), m_iPort(iPort), m_iTimeout(iTimeout),
+			m_channels(channels), m_bRunState(true), m_bConnected(false),
+			m_iPeakTotalVoices(0)
+	{
+		Peaks peaks;
+		peaks.iVoices  = 0;
+		peaks.iStreams = 0;
+		peaks.iMinFill = -1;
+		m_peaks.fill(peaks, m_channels.count());
+	}
+
+	// Stop (and wait for) the thread.
+	void stop()
+		{ m_bRunState = false; QThread::wait(); }
+
+	// Per channel peaks.
+	struct Peaks
+	{
+		int iVoices;
+		int iStreams;
+		int iMinFill;
+	};
+
+	// Results accessors (only after stopped).
+	bool isConnected() const
+		{ return m_bConnected; }
+	const Peaks& peaks(int iChannel) const
+		{ return m_peaks.at(iChannel); }
+	int peakTotalVoices() const
+		{ return m_iPeakTotalVoices; }
+
+protected:
+
+	// The main thread executive.
+	void run();
+
+	// Take one load sample from all channels.
+	void sample(lscp_client_t *pClient);
+
+private:
+
+	// Instance variables.
+	QString m_sHost;
+	int     m_iPort;
+	int     m_iTimeout;
+
+	QList<int> m_channels;
+
+	volatile bool m_bRunState;
+
+	bool m_bConnected;
+
+	QVector<Peaks> m_peaks;
+	int m_iPeakTotalVoices;
+};
+
+
+// The main thread executive.
+void LoadTestSampler::run (void)
+{
+	lscp_client_t *pClient = ::lscp_client_create(
+		m_sHost.toUtf8().constData(), m_iPort,
+		qsampler_loadtest_callback, NULL);
+	if (pClient == NULL)
+		return;
+
+	::lscp_client_set_timeout(pClient, m_iTimeout);
+
+	m_bConnected = true;
+
+	while (m_bRunState) {
+		sample(pClient);
+		QThread::msleep(QSAMPLER_LOADTEST_SAMPLE_MSECS);
+	}
+
+	::lscp_client_destroy(pClient);
+}
+
+
+// Take one load sample from all channels.
+void LoadTestSampler::sample ( lscp_client_t *pClient )
+{
+	for (int i = 0; i < m_channels.count() && m_bRunState; ++i) {
+		const int iChannelID = m_channels.at(i);
+		Peaks& peaks = m_peaks[i];
+		const int iVoices = ::lscp_get_channel_voice_count(
+			pClient, iChannelID);
+		const int iStreams = ::lscp_get_channel_stream_count(
+			pClient, iChannelID);
+		if (peaks.iVoices < iVoices)
+			peaks.iVoices = iVoices;
+		if (peaks.iStreams < iStreams)
+			peaks.iStreams = iStreams;
+		if (iStreams > 0) {
+			const int iFill = ::lscp_get_channel_stream_usage(
+				pClient, iChannelID);
+			if (iFill >= 0 && (peaks.iMinFill < 0 || iFill < peaks.iMinFill))
+				peaks.iMinFill = iFill;
+		}
+	}
+
+	const int iTotalVoices = ::lscp_get_total_voice_count(pClient);
+	if (m_iPeakTotalVoices < iTotalVoices)
+		m_iPeakTotalVoices = iTotalVoices;
+}
+
+
+//-------------------------------------------------------------------------
+// QSampler::LoadTest - MIDI file driven sampler load test.
+//
+
+// Constructor.
+LoadTest::LoadTest ( const QString& sHost, int iPort, int iTimeout,
+	const QList<MidiFile::Event>& events,
+	const QList<Target>& targets, float fSpeed )
+	: QThread(), m_sHost(sHost), m_iPort(iPort), m_iTimeout(iTimeout),
+		m_fSpeed(fSpeed), m_events(events), m_targets(targets),
+		m_bCancel(false), m_iPosition(0), m_iDuration(0),
+		m_iPeakTotalVoices(0), m_iMaxVoices(-1),
+		m_iEventsSent(0), m_iEventsFailed(0), m_iEventsSkipped(0)
+{
+	if (m_fSpeed < 0.01f)
+		m_fSpeed = 1.0f;
+	if (!m_events.isEmpty())
+		m_iDuration = m_events.last().iTime;
+
+	QMutableListIterator<Target> iter(m_targets);
+	while (iter.hasNext()) {
+		Target& target = iter.next();
+		target.iEvents = 0;
+		target.iPeakVoices = 0;
+		target.iPeakStreams = 0;
+		target.iMinFill = -1;
+	}
+
+	::memset(m_notes, 0, sizeof(m_notes));
+}
+
+
+// Cancel (and wait for) the whole thing.
+void LoadTest::cancel (void)
+{
+	m_bCancel = true;
+
+	QThread::wait();
+}
+
+
+// Progress accessors, in MIDI file time (any time).
+qint64 LoadTest::position (void) const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_iPosition;
+}
+
+qint64 LoadTest::duration (void) const
+{
+	return m_iDuration;
+}
+
+
+// Results accessors (only after the thread is finished).
+const QList<LoadTest::Target>& LoadTest::targets (void) const
+{
+	return m_targets;
+}
+
+const QStringList& LoadTest::errors (void) const
+{
+	return m_errors;
+}
+
+int LoadTest::peakTotalVoices (void) const
+{
+	return m_iPeakTotalVoices;
+}
+
+int LoadTest::maxVoices (void) const
+{
+	return m_iMaxVoices;
+}
+
+int LoadTest::eventsSent (void) const
+{
+	return m_iEventsSent;
+}
+
+int LoadTest::eventsFailed (void) const
+{
+	return m_iEventsFailed;
+}
+
+int LoadTest::eventsSkipped (void) const
+{
+	return m_iEventsSkipped;
+}
+
+
+// The main thread executive.
+void LoadTest::run (void)
+{
+	lscp_client_t *pClient = ::lscp_client_create(
+		m_sHost.toUtf8().constData(), m_iPort,
+		qsampler_loadtest_callback, NULL);
+	if (pClient == NULL) {
+		addError(QObject::tr("Could not connect to server %1:%2.")
+			.arg(m_sHost).arg(m_iPort));
+		return;
+	}
+
+	::lscp_client_set_timeout(pClient, m_iTimeout);
+#ifdef CONFIG_MAX_VOICES
+	m_iMaxVoices = ::lscp_get_voices(pClient);
+#endif
+
+	// Load sampling goes on its own connection (and thread),
+	// so that its round trips never delay any MIDI injection...
+	QList<int> channels;
+	QListIterator<Target> target_iter(m_targets);
+	while (target_iter.hasNext())
+		channels.append(target_iter.next().iChannelID);
+	LoadTestSampler sampler(m_sHost, m_iPort, m_iTimeout, channels);
+	sampler.start();
+
+	const int iEvents = m_events.count();
+	int iEvent = 0;
+	qint64 iTailStart = -1;
+
+	QElapsedTimer timer;
+	timer.start();
+
+	while (!m_bCancel) {
+		// MIDI file time, possibly accelerated...
+		const qint64 iElapsed = timer.elapsed();
+		const qint64 iNow
+			= qint64(double(timer.nsecsElapsed() / 1000) * double(m_fSpeed));
+		while (iEvent < iEvents && m_events.at(iEvent).iTime <= iNow && !m_bCancel)
+			dispatch(pClient, m_events.at(iEvent++));
+		// Does the server take it at all?
+		if (m_iEventsSent < 1 && m_iEventsFailed >= QSAMPLER_LOADTEST_FAIL_LIMIT) {
+			addError(QObject::tr("The server does not seem to "
+				"support MIDI data injection."));
+			break;
+		}
+		m_mutex.lock();
+		m_iPosition = qMin(iNow, m_iDuration);
+		m_mutex.unlock();
+		// Let the last notes ring for a while...
+		if (iEvent >= iEvents) {
+			if (iTailStart < 0)
+				iTailStart = iElapsed;
+			else
+			if (iElapsed - iTailStart > QSAMPLER_LOADTEST_TAIL_MSECS)
+				break;
+		}
+		QThread::msleep(QSAMPLER_LOADTEST_TICK_MSECS);
+	}
+
+	// Release any hanging notes...
+	for (int iMidiChannel = 0; iMidiChannel < 16; ++iMidiChannel) {
+		for (int iNote = 0; iNote < 128; ++iNote) {
+			if (m_notes[iMidiChannel][iNote] == 0)
+				continue;
+			MidiFile::Event event;
+			event.iTime  = 0;
+			event.status = 0x80 | iMidiChannel;
+			event.data1  = iNote;
+			event.data2  = 0;
+			dispatch(pClient, event);
+		}
+	}
+
+	::lscp_client_destroy(pClient);
+
+	// Collect the load samples...
+	sampler.stop();
+	if (!sampler.isConnected()) {
+		addError(QObject::tr("Could not connect to server %1:%2 "
+			"for load sampling.").arg(m_sHost).arg(m_iPort));
+	}
+	for (int i = 0; i < m_targets.count(); ++i) {
+		Target& target = m_targets[i];
+		const LoadTestSampler::Peaks& peaks = sampler.peaks(i);
+		target.iPeakVoices  = peaks.iVoices;
+		target.iPeakStreams = peaks.iStreams;
+		target.iMinFill     = peaks.iMinFill;
+	}
+	m_iPeakTotalVoices = sampler.peakTotalVoices();
+}
+
+
+// Inject one MIDI file event into all listening channels.
+void LoadTest::dispatch ( lscp_client_t *pClient,
+	const MidiFile::Event& event )
+{
+	const int iMidiChannel = (event.status & 0x0f);
+	const char *pszType = NULL;
+	switch (event.status & 0xf0) {
+	case 0x90:
+		if (event.data2 > 0) {
+			pszType = "NOTE_ON";
+			m_notes[iMidiChannel][event.data1] = 1;
+			break;
+		}
+		// Fall thru...
+	case 0x80:
+		pszType = "NOTE_OFF";
+		m_notes[iMidiChannel][event.data1] = 0;
+		break;
+	case 0xb0:
+		pszType = "CC";
+		break;
+	default:
+		break;
+	}
+
+	if (pszType == NULL) {
+		++m_iEventsSkipped;
+		return;
+	}
+
+	QMutableListIterator<Target> iter(m_targets);
+	while (iter.hasNext()) {
+		Target& target = iter.next();
+		if (target.iMidiChannel != iMidiChannel
+			&& target.iMidiChannel != LSCP_MIDI_CHANNEL_ALL)
+			continue;
+		if (send(pClient, pszType, target.iChannelID, event.data1, event.data2))
+			++target.iEvents;
+	}
+}
+
+
+// Inject one MIDI message into one sampler channel.
+bool LoadTest::send ( lscp_client_t *pClient, const char *pszType,
+	int iChannelID, int iData1, int iData2 )
+{
+	const QString& sQuery = QString("SEND CHANNEL MIDI_DATA %1 %2 %3 %4\r\n")
+		.arg(pszType).arg(iChannelID).arg(iData1).arg(iData2);
+
+	if (::lscp_client_query(pClient, sQuery.toUtf8().constData()) != LSCP_OK) {
+		++m_iEventsFailed;
+		addError(QString::fromUtf8(::lscp_client_get_result(pClient)));
+		return false;
+	}
+
+	++m_iEventsSent;
+	return true;
+}
+
+
+// Error accounting.
+void LoadTest::addError ( const QString& sError )
+{
+	const QString& s = sError.simplified();
+	if (!s.isEmpty() && !m_errors.contains(s)
+		&& m_errors.count() < QSAMPLER_LOADTEST_ERROR_MAX)
+		m_errors.append(s);
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerLoadTest.cpp
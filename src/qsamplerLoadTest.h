@@ -0,0 +1,129 @@
+// qsamplerLoadTest.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerLoadTest_h
+#define __qsamplerLoadTest_h
+
+#include "qsamplerMidiFile.h"
+
+#include <QThread>
+#include <QMutex>
+#include <QStringList>
+
+#include <lscp/client.h>
+
+
+namespace QSampler {
+
+//-------------------------------------------------------------------------
+// QSampler::LoadTest - MIDI file driven sampler load test.
+//
+
+class LoadTest : public QThread
+{
+public:
+
+	// One sampler channel under test.
+	struct Target
+	{
+		int     iChannelID;
+		int     iMidiChannel;   // LSCP_MIDI_CHANNEL_ALL for omni.
+		QString sName;
+		int     iEvents;        // MIDI events sent.
+		int     iPeakVoices;
+		int     iPeakStreams;
+		int     iMinFill;       // Least stream buffer fill (%; -1 if none).
+	};
+
+	// Constructor.
+	LoadTest(const QString& sHost, int iPort, int iTimeout,
+		const QList<MidiFile::Event>& events,
+		const QList<Target>& targets, float fSpeed = 1.0f);
+
+	// Cancel (and wait for) the whole thing.
+	void cancel();
+
+	// Progress accessors, in MIDI file time (any time).
+	qint64 position() const;
+	qint64 duration() const;
+
+	// Results accessors (only after the thread is finished).
+	const QList<Target>& targets() const;
+	const QStringList& errors() const;
+
+	int peakTotalVoices() const;
+	int maxVoices() const;
+	int eventsSent() const;
+	int eventsFailed() const;
+	int eventsSkipped() const;
+
+protected:
+
+	// The main thread executive.
+	void run();
+
+	// Inject one MIDI file event into all listening channels.
+	void dispatch(lscp_client_t *pClient, const MidiFile::Event& event);
+
+	// Inject one MIDI message into one sampler channel.
+	bool send(lscp_client_t *pClient, const char *pszType,
+		int iChannelID, int iData1, int iData2);
+
+	// Error accounting.
+	void addError(const QString& sError);
+
+private:
+
+	// Instance variables.
+	QString m_sHost;
+	int     m_iPort;
+	int     m_iTimeout;
+	float   m_fSpeed;
+
+	QList<MidiFile::Event> m_events;
+	QList<Target> m_targets;
+
+	mutable QMutex m_mutex;
+
+	volatile bool m_bCancel;
+
+	qint64 m_iPosition;
+	qint64 m_iDuration;
+
+	QStringList m_errors;
+
+	int m_iPeakTotalVoices;
+	int m_iMaxVoices;
+	int m_iEventsSent;
+	int m_iEventsFailed;
+	int m_iEventsSkipped;
+
+	// Notes currently held, per MIDI channel.
+	unsigned char m_notes[16][128];
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerLoadTest_h
+
+
+// end of qsamplerLoadTest.h
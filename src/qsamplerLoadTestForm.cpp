@@ -0,0 +1,385 @@
+// qsamplerLoadTestForm.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerLoadTestForm.h"
+#include "qsamplerLoadTest.h"
+
+#include "qsamplerMainForm.h"
+#include "qsamplerOptions.h"
+#include "qsamplerChannelStrip.h"
+#include "qsamplerChannel.h"
+
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QFile>
+#include <QTextStream>
+#include <QTimer>
+
+
+namespace QSampler {
+
+// Progress refresh period (msecs).
+#define QSAMPLER_LOADTEST_PERIOD_MSECS  200
+
+// Total voice count warning level (percent of maximum).
+#define QSAMPLER_LOADTEST_VOICES_HIGH   90
+
+// Stream buffer fill low-water mark (percent).
+#define QSAMPLER_LOADTEST_LOW_BUFFER    25
+
+
+//-------------------------------------------------------------------------
+// QSampler::LoadTestForm -- MIDI file driven load test form.
+//
+
+// Constructor.
+LoadTestForm::LoadTestForm ( QWidget *pParent, Qt::WindowFlags wflags )
+	: QWidget(pParent, wflags), m_pLoadTest(NULL)
+{
+	m_ui.setupUi(this);
+
+	m_ui.ReportListView->header()->resizeSection(0, 200);
+
+	m_pTimer = new QTimer(this);
+
+	QObject::connect(m_ui.OpenPushButton,
+		SIGNAL(clicked()),
+		SLOT(openMidiFile()));
+	QObject::connect(m_ui.StartPushButton,
+		SIGNAL(clicked()),
+		SLOT(startTest()));
+	QObject::connect(m_ui.SavePushButton,
+		SIGNAL(clicked()),
+		SLOT(saveReport()));
+	QObject::connect(m_pTimer,
+		SIGNAL(timeout()),
+		SLOT(refreshProgress()));
+
+	stabilizeForm();
+}
+
+
+// Destructor.
+LoadTestForm::~LoadTestForm (void)
+{
+	if (m_pLoadTest) {
+		m_pLoadTest->cancel();
+		delete m_pLoadTest;
+	}
+}
+
+
+// Whether a test is currently running.
+bool LoadTestForm::isRunning (void) const
+{
+	return (m_pLoadTest != NULL);
+}
+
+
+// Choose the MIDI file to play.
+void LoadTestForm::openMidiFile (void)
+{
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL)
+		return;
+
+	Options *pOptions = pMainForm->options();
+	if (pOptions == NULL)
+		return;
+
+	QString sFilename = m_midiFile.filename();
+	if (sFilename.isEmpty())
+		sFilename = pOptions->sSessionDir;
+
+	sFilename = QFileDialog::getOpenFileName(this,
+		QSAMPLER_TITLE ": " + tr("Open MIDI File"),      // Caption.
+		sFilename,                                       // Start here.
+		tr("MIDI files") + " (*.mid *.midi *.smf)"       // Filter.
+	);
+
+	if (sFilename.isEmpty())
+		return;
+
+	if (m_midiFile.load(sFilename)) {
+		m_ui.MidiFileTextLabel->setText(tr("%1 (%2 tracks, %3 events, %4 s)")
+			.arg(QFileInfo(sFilename).fileName())
+			.arg(m_midiFile.tracks())
+			.arg(m_midiFile.events().count())
+			.arg(double(m_midiFile.duration()) / 1000000.0, 0, 'f', 1));
+	} else {
+		m_ui.MidiFileTextLabel->setText(tr("(no MIDI file)"));
+		pMainForm->appendMessagesError(
+			tr("Could not read MIDI file:\n\n"
+			"\"%1\" (%2).\n\nSorry.")
+			.arg(sFilename).arg(m_midiFile.errorString()));
+	}
+
+	stabilizeForm();
+}
+
+
+// Start/stop the load test.
+void LoadTestForm::startTest (void)
+{
+	if (m_pLoadTest) {
+		stopTest();
+		return;
+	}
+
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL || pMainForm->client() == NULL)
+		return;
+
+	Options *pOptions = pMainForm->options();
+	if (pOptions == NULL || m_midiFile.events().isEmpty())
+		return;
+
+	// All current sampler channels are under test...
+	QList<LoadTest::Target> targets;
+	for (int i = 0; ; ++i) {
+		ChannelStrip *pChannelStrip = pMainForm->channelStripAt(i);
+		if (pChannelStrip == NULL)
+			break;
+		Channel *pChannel = pChannelStrip->channel();
+		if (pChannel == NULL)
+			continue;
+		LoadTest::Target target;
+		target.iChannelID   = pChannel->channelID();
+		target.iMidiChannel = pChannel->midiChannel();
+		target.sName        = pChannelStrip->windowTitle();
+		targets.append(target);
+	}
+
+	if (targets.isEmpty()) {
+		pMainForm->appendMessagesColor(
+			tr("Load test: no sampler channels to play."), "#996633");
+		return;
+	}
+
+	m_ui.ReportListView->clear();
+	m_ui.SummaryTextLabel->clear();
+	m_sSummary.clear();
+	m_ui.TestProgressBar->setValue(0);
+
+	m_pLoadTest = new LoadTest(pOptions->sServerHost,
+		pOptions->iServerPort, pOptions->iServerTimeout,
+		m_midiFile.events(), targets, float(m_ui.SpeedSpinBox->value()));
+	m_pLoadTest->start();
+	m_pTimer->start(QSAMPLER_LOADTEST_PERIOD_MSECS);
+
+	pMainForm->appendMessages(tr("Load test: playing \"%1\" at %2x...")
+		.arg(m_midiFile.filename()).arg(m_ui.SpeedSpinBox->value()));
+
+	stabilizeForm();
+}
+
+
+void LoadTestForm::stopTest (void)
+{
+	if (m_pLoadTest == NULL)
+		return;
+
+	m_pLoadTest->cancel();
+
+	finishTest();
+}
+
+
+// Periodic progress refreshment.
+void LoadTestForm::refreshProgress (void)
+{
+	if (m_pLoadTest == NULL)
+		return;
+
+	const qint64 iDuration = m_pLoadTest->duration();
+	if (iDuration > 0) {
+		m_ui.TestProgressBar->setValue(
+			int((100 * m_pLoadTest->position()) / iDuration));
+	}
+
+	if (m_pLoadTest->isFinished())
+		finishTest();
+}
+
+
+// Fill in the report of a finished test.
+void LoadTestForm::finishTest (void)
+{
+	m_pTimer->stop();
+
+	if (m_pLoadTest == NULL)
+		return;
+
+	m_pLoadTest->wait();
+
+	QStringList warnings;
+	QListIterator<LoadTest::Target> iter(m_pLoadTest->targets());
+	while (iter.hasNext()) {
+		const LoadTest::Target& target = iter.next();
+		QTreeWidgetItem *pItem = new QTreeWidgetItem(m_ui.ReportListView);
+		pItem->setText(0, target.sName);
+		pItem->setText(1, target.iMidiChannel == LSCP_MIDI_CHANNEL_ALL
+			? tr("All") : QString::number(target.iMidiChannel + 1));
+		pItem->setData(2, Qt::DisplayRole, target.iEvents);
+		pItem->setData(3, Qt::DisplayRole, target.iPeakVoices);
+		pItem->setData(4, Qt::DisplayRole, target.iPeakStreams);
+		if (target.iMinFill >= 0)
+			pItem->setData(5, Qt::DisplayRole, target.iMinFill);
+		else
+			pItem->setText(5, "-");
+		if (target.iMinFill >= 0
+			&& target.iMinFill < QSAMPLER_LOADTEST_LOW_BUFFER) {
+			pItem->setForeground(5, Qt::red);
+			warnings.append(tr("%1: disk streaming buffers down to %2%.")
+				.arg(target.sName).arg(target.iMinFill));
+		}
+	}
+
+	const int iPeak = m_pLoadTest->peakTotalVoices();
+	const int iMax  = m_pLoadTest->maxVoices();
+	if (iMax > 0) {
+		m_sSummary = tr("Total voices peak: %1 of %2 (%3%).")
+			.arg(iPeak).arg(iMax).arg((100 * iPeak) / iMax);
+		if (100 * iPeak >= QSAMPLER_LOADTEST_VOICES_HIGH * iMax)
+			warnings.append(tr("Total voices too close to the maximum."));
+	} else {
+		m_sSummary = tr("Total voices peak: %1.").arg(iPeak);
+	}
+	m_sSummary += ' ' + tr("Events sent: %1, failed: %2, skipped: %3.")
+		.arg(m_pLoadTest->eventsSent())
+		.arg(m_pLoadTest->eventsFailed())
+		.arg(m_pLoadTest->eventsSkipped());
+	if (m_pLoadTest->position() < m_pLoadTest->duration())
+		m_sSummary += ' ' + tr("(incomplete)");
+
+	m_ui.SummaryTextLabel->setText(m_sSummary
+		+ (warnings.isEmpty() ? QString() : '\n' + warnings.join("\n")));
+
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm) {
+		pMainForm->appendMessages(tr("Load test: %1").arg(m_sSummary));
+		QStringListIterator warn_iter(warnings);
+		while (warn_iter.hasNext())
+			pMainForm->appendMessagesColor(
+				tr("Load test: %1").arg(warn_iter.next()), "#996633");
+		QStringListIterator error_iter(m_pLoadTest->errors());
+		while (error_iter.hasNext())
+			pMainForm->appendMessagesColor(
+				tr("Load test: %1").arg(error_iter.next()), "#996633");
+	}
+
+	delete m_pLoadTest;
+	m_pLoadTest = NULL;
+
+	m_ui.TestProgressBar->setValue(100);
+
+	stabilizeForm();
+}
+
+
+// Report as plain text.
+QString LoadTestForm::reportText (void) const
+{
+	QString sText;
+	QTextStream ts(&sText);
+
+	ts << QSAMPLER_TITLE " " << tr("Load Test") << endl;
+	ts << m_midiFile.filename() << endl;
+	ts << m_ui.SummaryTextLabel->text() << endl << endl;
+
+	QStringList headers;
+	QTreeWidgetItem *pHeader = m_ui.ReportListView->headerItem();
+	for (int iCol = 0; iCol < pHeader->columnCount(); ++iCol)
+		headers.append(pHeader->text(iCol));
+	ts << headers.join("\t") << endl;
+
+	const int iItems = m_ui.ReportListView->topLevelItemCount();
+	for (int i = 0; i < iItems; ++i) {
+		QTreeWidgetItem *pItem = m_ui.ReportListView->topLevelItem(i);
+		QStringList cols;
+		for (int iCol = 0; iCol < pItem->columnCount(); ++iCol)
+			cols.append(pItem->text(iCol));
+		ts << cols.join("\t") << endl;
+	}
+
+	return sText;
+}
+
+
+// Save the last report as text.
+void LoadTestForm::saveReport (void)
+{
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL)
+		return;
+
+	QString sFilename = m_midiFile.filename();
+	if (!sFilename.isEmpty())
+		sFilename = QFileInfo(sFilename).completeBaseName() + ".txt";
+
+	sFilename = QFileDialog::getSaveFileName(this,
+		QSAMPLER_TITLE ": " + tr("Save Load Test Report"), // Caption.
+		sFilename,                                         // Start here.
+		tr("Text files") + " (*.txt)"                      // Filter.
+	);
+
+	if (sFilename.isEmpty())
+		return;
+
+	QFile file(sFilename);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		pMainForm->appendMessagesError(
+			tr("Could not open \"%1\" report file.\n\nSorry.")
+			.arg(sFilename));
+		return;
+	}
+
+	QTextStream ts(&file);
+	ts << reportText();
+	file.close();
+
+	pMainForm->appendMessages(tr("Load test report saved: \"%1\".")
+		.arg(sFilename));
+}
+
+
+// Form state stabilization.
+void LoadTestForm::stabilizeForm (void)
+{
+	MainForm *pMainForm = MainForm::getInstance();
+	const bool bClient = (pMainForm && pMainForm->client() != NULL);
+	const bool bRunning = (m_pLoadTest != NULL);
+
+	m_ui.OpenPushButton->setEnabled(!bRunning);
+	m_ui.SpeedSpinBox->setEnabled(!bRunning);
+	m_ui.StartPushButton->setText(bRunning ? tr("S&top") : tr("&Start"));
+	m_ui.StartPushButton->setEnabled(bRunning
+		|| (bClient && !m_midiFile.events().isEmpty()));
+	m_ui.SavePushButton->setEnabled(!bRunning
+		&& m_ui.ReportListView->topLevelItemCount() > 0);
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerLoadTestForm.cpp
@@ -0,0 +1,102 @@
+// qsamplerLoadTestForm.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerLoadTestForm_h
+#define __qsamplerLoadTestForm_h
+
+#include "ui_qsamplerLoadTestForm.h"
+
+#include "qsamplerMidiFile.h"
+
+class QTimer;
+
+
+namespace QSampler {
+
+class LoadTest;
+
+//-------------------------------------------------------------------------
+// QSampler::LoadTestForm -- MIDI file driven load test form.
+//
+
+class LoadTestForm : public QWidget
+{
+	Q_OBJECT
+
+public:
+
+	// Constructor.
+	LoadTestForm(QWidget *pParent = NULL, Qt::WindowFlags wflags = 0);
+
+	// Destructor.
+	~LoadTestForm();
+
+	// Whether a test is currently running.
+	bool isRunning() const;
+
+public slots:
+
+	// Choose the MIDI file to play.
+	void openMidiFile();
+
+	// Start/stop the load test.
+	void startTest();
+	void stopTest();
+
+	// Save the last report as text.
+	void saveReport();
+
+	// Form state stabilization.
+	void stabilizeForm();
+
+protected slots:
+
+	// Periodic progress refreshment.
+	void refreshProgress();
+
+protected:
+
+	// Fill in the report of a finished test.
+	void finishTest();
+
+	// Report as plain text.
+	QString reportText() const;
+
+private:
+
+	// Instance variables.
+	Ui::qsamplerLoadTestForm m_ui;
+
+	MidiFile  m_midiFile;
+	LoadTest *m_pLoadTest;
+
+	QString m_sSummary;
+
+	QTimer *m_pTimer;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerLoadTestForm_h
+
+
+// end of qsamplerLoadTestForm.h
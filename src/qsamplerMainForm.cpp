@@ -28,12 +28,36 @@
 #include "qsamplerMessages.h"
 
 #include "qsamplerChannelStrip.h"
+#include "qsamplerInstrument.h"
 #include "qsamplerInstrumentList.h"
+#include "qsamplerFxSend.h"
+#include "qsamplerInstrumentCache.h"
+#include "qsamplerMapIndex.h"
 
 #include "qsamplerInstrumentListForm.h"
 #include "qsamplerDeviceForm.h"
 #include "qsamplerOptionsForm.h"
 #include "qsamplerDeviceStatusForm.h"
+#include "qsamplerEventsForm.h"
+#include "qsamplerSwitchesForm.h"
+#include "qsamplerStorageForm.h"
+#include "qsamplerLoadTestForm.h"
+#include "qsamplerDbImportForm.h"
+#include "qsamplerResourcesForm.h"
+#include "qsamplerSession.h"
+#include "qsamplerLoadHistory.h"
+#include "qsamplerLoadScheduler.h"
+#include "qsamplerSessionBundle.h"
+#include "qsamplerServerProcess.h"
+#include "qsamplerLoadBalancer.h"
+#include "qsamplerMirror.h"
+#include "qsamplerSessionStage.h"
+#include "qsamplerScript.h"
+#include "qsamplerChannelTemplate.h"
+#include "qsamplerChannelTemplateForm.h"
+#include "qsamplerServerCall.h"
+#include "qsamplerServerCaps.h"
+#include "qsamplerUtilities.h"
 
 #include <QMdiArea>
 #include <QMdiSubWindow>
@@ -49,6 +73,12 @@
 #include <QFile>
 #include <QUrl>
 
+#include <QFileSystemWatcher>
+#include <QSet>
+#include <QProgressDialog>
+#include <QDir>
+#include <QInputDialog>
+
 #include <QDragEnterEvent>
 
 #include <QStatusBar>
@@ -79,6 +109,8 @@ const WindowFlags WindowCloseButtonHint = WindowFlags(0x08000000);
 // Needed for lroundf()
 #include <math.h>
 
+#include <stdio.h>
+
 #ifndef CONFIG_ROUND
 static inline long lroundf ( float x )
 {
@@ -131,6 +163,21 @@ namespace QSampler {
 // Timer constant stuff.
 #define QSAMPLER_TIMER_MSECS    200
 
+// Instrument file change settling delay.
+#define QSAMPLER_RELOAD_MSECS   1000
+
+// Server watchdog: last known state snapshot period,
+// and the maximum restarts allowed in a given period.
+#define QSAMPLER_SNAPSHOT_MSECS     2000
+#define QSAMPLER_WATCHDOG_MSECS     60000
+#define QSAMPLER_WATCHDOG_RESTARTS  3
+
+// Standby mirroring period, way shorter than the snapshot's (msecs).
+#define QSAMPLER_MIRROR_MSECS       400
+
+// Not responding server probing period (msecs).
+#define QSAMPLER_PROBE_MSECS        2000
+
 // Status bar item indexes
 #define QSAMPLER_STATUS_CLIENT  0       // Client connection state.
 #define QSAMPLER_STATUS_SERVER  1       // Currenr server address (host:port)
@@ -151,16 +198,18 @@ class LscpEvent : public QEvent
 public:
 
 	// Constructor.
-	LscpEvent(lscp_event_t event, const char *pchData, int cchData)
-		: QEvent(QSAMPLER_LSCP_EVENT)
+	LscpEvent(lscp_event_t event, const char *pchData, int cchData,
+		qint64 iStamp) : QEvent(QSAMPLER_LSCP_EVENT)
 	{
 		m_event = event;
 		m_data  = QString::fromUtf8(pchData, cchData);
+		m_stamp = iStamp;
 	}
 
 	// Accessors.
 	lscp_event_t event() { return m_event; }
 	QString&     data()  { return m_data;  }
+	qint64       stamp() { return m_stamp; }
 
 private:
 
@@ -168,6 +217,10 @@ private:
 	lscp_event_t m_event;
 	// The event data as a string.
 	QString      m_data;
+	// The callback arrival time.
+	qint64       m_stamp;
+	// Pending events accounting.
+	ResourceCount<Resources::LscpEvents> m_resourceCount;
 };
 
 
@@ -192,6 +245,16 @@ MainForm::MainForm ( QWidget *pParent )
 	m_pMessages = NULL;
 	m_pInstrumentListForm = NULL;
 	m_pDeviceForm = NULL;
+	m_pEventsForm = NULL;
+	m_pSwitchesForm = NULL;
+	m_pStorageForm = NULL;
+	m_pLoadTestForm = NULL;
+	m_pDbImportForm = NULL;
+	m_pResourcesForm = NULL;
+	m_pSessionThread = NULL;
+	m_pMirror = NULL;
+	m_pSessionStage = NULL;
+	m_pScript = NULL;
 
 	// We'll start clean.
 	m_iUntitled   = 0;
@@ -200,11 +263,54 @@ MainForm::MainForm ( QWidget *pParent )
 	m_pServer = NULL;
 	m_pClient = NULL;
 
+	bForceServerStop = true;
+	m_bServerStopping = false;
+
+	m_bSnapshotDirty = false;
+	m_iSnapshotTimer = 0;
+	m_iSnapshotDirtyCount = 0;
+	m_bWatchdogRestore = false;
+	m_iWatchdogRestarts = 0;
+
 	m_iStartDelay = 0;
 	m_iTimerDelay = 0;
 
 	m_iTimerSlot = 0;
 
+	m_iProbeTimer = 0;
+	m_bServerResponsive = true;
+
+	// Connected server capabilities (probed on each connection).
+	m_pServerCaps = new ServerCaps();
+
+	// Instrument file list cache (server-side enumeration).
+	m_pInstrumentCache = new InstrumentCache(this);
+	QObject::connect(m_pInstrumentCache,
+		SIGNAL(instrumentListChanged(const QString&)),
+		SLOT(instrumentListChanged(const QString&)));
+
+	// MIDI instrument map entries index (kept by server events).
+	m_pMapIndex = new MapIndex(this);
+	QObject::connect(m_pMapIndex,
+		SIGNAL(changed()),
+		SLOT(updateInstrumentWatches()));
+
+	// Instrument load-time history (persistent).
+	m_pLoadHistory = new LoadHistory();
+	m_iLoadDone = 0;
+
+	// Event and instrument load timing reference.
+	m_clock.start();
+
+	// Stream buffer aware background loading.
+	m_pLoadScheduler = new LoadScheduler(this);
+
+	// Instrument file change watcher.
+	m_pFileWatcher = new QFileSystemWatcher(this);
+	QObject::connect(m_pFileWatcher,
+		SIGNAL(fileChanged(const QString&)),
+		SLOT(instrumentFileChanged(const QString&)));
+
 #if defined(HAVE_SIGNAL_H) && defined(HAVE_SYS_SOCKET_H)
 
 	// Set to ignore any fatal "Broken pipe" signals.
@@ -325,12 +431,30 @@ MainForm::MainForm ( QWidget *pParent )
 	QObject::connect(m_ui.fileSaveAsAction,
 		SIGNAL(triggered()),
 		SLOT(fileSaveAs()));
+	QObject::connect(m_ui.fileCollectAction,
+		SIGNAL(triggered()),
+		SLOT(fileCollect()));
 	QObject::connect(m_ui.fileResetAction,
 		SIGNAL(triggered()),
 		SLOT(fileReset()));
 	QObject::connect(m_ui.fileRestartAction,
 		SIGNAL(triggered()),
 		SLOT(fileRestart()));
+	QObject::connect(m_ui.fileStageAction,
+		SIGNAL(triggered()),
+		SLOT(fileStage()));
+	QObject::connect(m_ui.fileSwitchAction,
+		SIGNAL(triggered()),
+		SLOT(fileSwitch()));
+	QObject::connect(m_ui.fileMirrorAction,
+		SIGNAL(triggered(bool)),
+		SLOT(fileMirror(bool)));
+	QObject::connect(m_ui.fileFailoverAction,
+		SIGNAL(triggered()),
+		SLOT(fileFailover()));
+	QObject::connect(m_ui.fileScriptAction,
+		SIGNAL(triggered()),
+		SLOT(fileScript()));
 	QObject::connect(m_ui.fileExitAction,
 		SIGNAL(triggered()),
 		SLOT(fileExit()));
@@ -352,6 +476,18 @@ MainForm::MainForm ( QWidget *pParent )
 	QObject::connect(m_ui.editResetAllChannelsAction,
 		SIGNAL(triggered()),
 		SLOT(editResetAllChannels()));
+	QObject::connect(m_ui.editCriticalChannelAction,
+		SIGNAL(triggered(bool)),
+		SLOT(editCriticalChannel(bool)));
+	QObject::connect(m_ui.editSaveTemplateAction,
+		SIGNAL(triggered()),
+		SLOT(editSaveTemplate()));
+	QObject::connect(m_ui.editInstantiateTemplateAction,
+		SIGNAL(triggered()),
+		SLOT(editInstantiateTemplate()));
+	QObject::connect(m_ui.editDistributeChannelsAction,
+		SIGNAL(triggered()),
+		SLOT(editDistributeChannels()));
 	QObject::connect(m_ui.viewMenubarAction,
 		SIGNAL(toggled(bool)),
 		SLOT(viewMenubar(bool)));
@@ -370,6 +506,24 @@ MainForm::MainForm ( QWidget *pParent )
 	QObject::connect(m_ui.viewDevicesAction,
 		SIGNAL(triggered()),
 		SLOT(viewDevices()));
+	QObject::connect(m_ui.viewEventsAction,
+		SIGNAL(triggered()),
+		SLOT(viewEvents()));
+	QObject::connect(m_ui.viewSwitchesAction,
+		SIGNAL(triggered()),
+		SLOT(viewSwitches()));
+	QObject::connect(m_ui.viewStorageAction,
+		SIGNAL(triggered()),
+		SLOT(viewStorage()));
+	QObject::connect(m_ui.viewLoadTestAction,
+		SIGNAL(triggered()),
+		SLOT(viewLoadTest()));
+	QObject::connect(m_ui.viewDbImportAction,
+		SIGNAL(triggered()),
+		SLOT(viewDbImport()));
+	QObject::connect(m_ui.viewResourcesAction,
+		SIGNAL(triggered()),
+		SLOT(viewResources()));
 	QObject::connect(m_ui.viewOptionsAction,
 		SIGNAL(triggered()),
 		SLOT(viewOptions()));
@@ -414,7 +568,45 @@ MainForm::~MainForm()
 		delete m_pUsr1Notifier;
 #endif
 
+	// Standby mirroring is over...
+	if (m_pMirror)
+		delete m_pMirror;
+
+	// And so is any script still running.
+#ifdef CONFIG_SCRIPT
+	if (m_pScript)
+		delete m_pScript;
+#endif
+
 	// Finally drop any widgets around...
+	if (m_pSessionThread) {
+		m_pSessionThread->wait();
+		delete m_pSessionThread;
+	}
+	if (m_pFileWatcher)
+		delete m_pFileWatcher;
+	if (m_pInstrumentCache)
+		delete m_pInstrumentCache;
+	if (m_pMapIndex)
+		delete m_pMapIndex;
+	if (m_pServerCaps)
+		delete m_pServerCaps;
+	if (m_pLoadHistory)
+		delete m_pLoadHistory;
+	if (m_pLoadScheduler)
+		delete m_pLoadScheduler;
+	if (m_pEventsForm)
+		delete m_pEventsForm;
+	if (m_pSwitchesForm)
+		delete m_pSwitchesForm;
+	if (m_pStorageForm)
+		delete m_pStorageForm;
+	if (m_pLoadTestForm)
+		delete m_pLoadTestForm;
+	if (m_pDbImportForm)
+		delete m_pDbImportForm;
+	if (m_pResourcesForm)
+		delete m_pResourcesForm;
 	if (m_pDeviceForm)
 		delete m_pDeviceForm;
 	if (m_pInstrumentListForm)
@@ -463,11 +655,20 @@ void MainForm::setup ( Options *pOptions )
 	// Some child forms are to be created right now.
 	m_pMessages = new Messages(this);
 	m_pDeviceForm = new DeviceForm(this, wflags);
+	m_pEventsForm = new EventsForm(this, wflags);
+	m_pSwitchesForm = new SwitchesForm(this, wflags);
+	m_pStorageForm = new StorageForm(this, wflags);
+	m_pLoadTestForm = new LoadTestForm(this, wflags);
+	m_pDbImportForm = new DbImportForm(this, wflags);
+	m_pResourcesForm = new ResourcesForm(this, wflags);
 #ifdef CONFIG_MIDI_INSTRUMENT
 	m_pInstrumentListForm = new InstrumentListForm(this, wflags);
 #else
 	m_ui.viewInstrumentsAction->setEnabled(false);
 #endif
+#ifndef CONFIG_SCRIPT
+	m_ui.fileScriptAction->setVisible(false);
+#endif
 
 	// Setup messages logging appropriately...
 	m_pMessages->setLogging(
@@ -478,6 +679,7 @@ void MainForm::setup ( Options *pOptions )
 	updateMessagesFont();
 	updateMessagesLimit();
 	updateMessagesCapture();
+	updateGuiAffinity();
 	// Set the visibility signal.
 	QObject::connect(m_pMessages,
 		SIGNAL(visibilityChanged(bool)),
@@ -507,6 +709,17 @@ void MainForm::setup ( Options *pOptions )
 	m_pOptions->loadWidgetGeometry(this, true);
 	m_pOptions->loadWidgetGeometry(m_pInstrumentListForm);
 	m_pOptions->loadWidgetGeometry(m_pDeviceForm);
+	m_pOptions->loadWidgetGeometry(m_pEventsForm);
+	m_pOptions->loadWidgetGeometry(m_pSwitchesForm);
+	m_pOptions->loadWidgetGeometry(m_pStorageForm);
+	m_pOptions->loadWidgetGeometry(m_pLoadTestForm);
+	m_pOptions->loadWidgetGeometry(m_pDbImportForm);
+	m_pOptions->loadWidgetGeometry(m_pResourcesForm);
+
+	// Instrument load times are good to remember...
+	m_pLoadHistory->load(m_pOptions->settings());
+	// and so are disk streaming statistics.
+	m_pStorageForm->loadHistory(m_pOptions->settings());
 
 	// Final startup stabilization...
 	updateMaxVolume();
@@ -547,13 +760,38 @@ bool MainForm::queryClose (void)
 			m_pOptions->settings().setValue("/Layout/DockWindows", saveState());
 			// And the children, and the main windows state,.
 			m_pOptions->saveWidgetGeometry(m_pDeviceForm);
+			m_pOptions->saveWidgetGeometry(m_pEventsForm);
+			m_pOptions->saveWidgetGeometry(m_pSwitchesForm);
+			m_pOptions->saveWidgetGeometry(m_pStorageForm);
+			m_pOptions->saveWidgetGeometry(m_pLoadTestForm);
+			m_pOptions->saveWidgetGeometry(m_pDbImportForm);
+			m_pOptions->saveWidgetGeometry(m_pResourcesForm);
 			m_pOptions->saveWidgetGeometry(m_pInstrumentListForm);
 			m_pOptions->saveWidgetGeometry(this, true);
+			// And the instrument load times, for next time.
+			m_pLoadHistory->save(m_pOptions->settings());
+			m_pStorageForm->saveHistory(m_pOptions->settings());
 			// Close popup widgets.
 			if (m_pInstrumentListForm)
 				m_pInstrumentListForm->close();
 			if (m_pDeviceForm)
 				m_pDeviceForm->close();
+			if (m_pEventsForm)
+				m_pEventsForm->close();
+			if (m_pSwitchesForm)
+				m_pSwitchesForm->close();
+			if (m_pStorageForm)
+				m_pStorageForm->close();
+			if (m_pLoadTestForm) {
+				m_pLoadTestForm->stopTest();
+				m_pLoadTestForm->close();
+			}
+			if (m_pDbImportForm) {
+				m_pDbImportForm->stopImport();
+				m_pDbImportForm->close();
+			}
+			if (m_pResourcesForm)
+				m_pResourcesForm->close();
 			// Stop client and/or server, gracefully.
 			stopServer(true /*interactive*/);
 		}
@@ -637,12 +875,35 @@ void MainForm::customEvent ( QEvent* pEvent )
 	// For the time being, just pump it to messages.
 	if (pEvent->type() == QSAMPLER_LSCP_EVENT) {
 		LscpEvent *pLscpEvent = static_cast<LscpEvent *> (pEvent);
+		// Account for it in the event inspector, whatsoever...
+		if (m_pEventsForm) {
+			m_pEventsForm->eventArrived(pLscpEvent->event(),
+				pLscpEvent->data(), pLscpEvent->stamp());
+		}
+		// Anything but MIDI activity may change the last known state
+		// (channel info changes are told apart on update, later)...
+		switch (pLscpEvent->event()) {
+			case LSCP_EVENT_CHANNEL_INFO:
+		#if CONFIG_EVENT_CHANNEL_MIDI
+			case LSCP_EVENT_CHANNEL_MIDI:
+		#endif
+		#if CONFIG_EVENT_DEVICE_MIDI
+			case LSCP_EVENT_DEVICE_MIDI:
+		#endif
+				break;
+			default:
+				m_bSnapshotDirty = true;
+		}
 		switch (pLscpEvent->event()) {
 			case LSCP_EVENT_CHANNEL_COUNT:
 				updateAllChannelStrips(true);
 				break;
 			case LSCP_EVENT_CHANNEL_INFO: {
 				int iChannelID = pLscpEvent->data().toInt();
+				if (m_pSwitchesForm) {
+					m_pSwitchesForm->channelInfoArrived(
+						iChannelID, pLscpEvent->stamp());
+				}
 				ChannelStrip *pChannelStrip = channelStrip(iChannelID);
 				if (pChannelStrip)
 					channelStripChanged(pChannelStrip);
@@ -684,6 +945,34 @@ void MainForm::customEvent ( QEvent* pEvent )
 					pDeviceStatusForm->midiArrived(iPortID);
 				break;
 			}
+		#endif
+		#ifdef CONFIG_MIDI_INSTRUMENT
+			case LSCP_EVENT_MIDI_INSTRUMENT_MAP_COUNT:
+			case LSCP_EVENT_MIDI_INSTRUMENT_MAP_INFO:
+				if (m_pInstrumentListForm) {
+					m_pInstrumentListForm->invalidateMap(LSCP_MIDI_MAP_ALL);
+					m_pInstrumentListForm->refreshMaps();
+				}
+				if (pLscpEvent->event() == LSCP_EVENT_MIDI_INSTRUMENT_MAP_COUNT)
+					m_pMapIndex->updateMaps();
+				break;
+			case LSCP_EVENT_MIDI_INSTRUMENT_COUNT: {
+				const int iMidiMap = pLscpEvent->data().section(' ', 0, 0).toInt();
+				const int iCount   = pLscpEvent->data().section(' ', 1, 1).toInt();
+				if (m_pInstrumentListForm)
+					m_pInstrumentListForm->updateMapCount(iMidiMap, iCount);
+				m_pMapIndex->updateMap(iMidiMap);
+				break;
+			}
+			case LSCP_EVENT_MIDI_INSTRUMENT_INFO: {
+				const int iMidiMap = pLscpEvent->data().section(' ', 0, 0).toInt();
+				const int iBank    = pLscpEvent->data().section(' ', 1, 1).toInt();
+				const int iProg    = pLscpEvent->data().section(' ', 2, 2).toInt();
+				if (m_pInstrumentListForm)
+					m_pInstrumentListForm->updateMapEntry(iMidiMap, iBank, iProg);
+				m_pMapIndex->updateEntry(iMidiMap, iBank, iProg);
+				break;
+			}
 		#endif
 			default:
 				appendMessagesColor(tr("LSCP Event: %1 data: %2")
@@ -691,6 +980,25 @@ void MainForm::customEvent ( QEvent* pEvent )
 					.arg(pLscpEvent->data()), "#996699");
 		}
 	}
+	else
+	if (pEvent->type() == QSAMPLER_MIRROR_EVENT) {
+		MirrorEvent *pMirrorEvent = static_cast<MirrorEvent *> (pEvent);
+		switch (pMirrorEvent->kind()) {
+		case MirrorEvent::Error:
+			if (m_pMessages)
+				m_pMessages->show();
+			appendMessagesColor(pMirrorEvent->text(), "#ff0000");
+			break;
+		case MirrorEvent::Divergence:
+			appendMessagesColor(pMirrorEvent->text(), "#996633");
+			break;
+		case MirrorEvent::Info:
+		default:
+			appendMessages(pMirrorEvent->text());
+			break;
+		}
+		stabilizeForm();
+	}
 }
 
 
@@ -749,6 +1057,20 @@ lscp_client_t *MainForm::client (void) const
 }
 
 
+// The storage advisor accessor.
+StorageForm *MainForm::storageForm (void) const
+{
+	return m_pStorageForm;
+}
+
+
+// The messages dock widget.
+Messages *MainForm::messages (void) const
+{
+	return m_pMessages;
+}
+
+
 // The pseudo-singleton instance accessor.
 MainForm *MainForm::getInstance (void)
 {
@@ -756,6 +1078,13 @@ MainForm *MainForm::getInstance (void)
 }
 
 
+// Monotonic time reference (msecs; thread-safe).
+qint64 MainForm::timestamp (void) const
+{
+	return m_clock.elapsed();
+}
+
+
 //-------------------------------------------------------------------------
 // qsamplerMainForm -- Session file stuff.
 
@@ -894,6 +1223,11 @@ bool MainForm::closeSession ( bool bForce )
 
 	// If we may close it, dot it.
 	if (bClose) {
+		// Any staged session goes along...
+		if (m_pSessionStage) {
+			delete m_pSessionStage;
+			m_pSessionStage = NULL;
+		}
 		// Remove all channel strips from sight...
 		m_pWorkspace->setUpdatesEnabled(false);
 		QList<QMdiSubWindow *> wlist = m_pWorkspace->subWindowList();
@@ -926,9 +1260,18 @@ bool MainForm::loadSessionFile ( const QString& sFilename )
 	if (m_pClient == NULL)
 		return false;
 
-	// Open and read from real file.
-	QFile file(sFilename);
-	if (!file.open(QIODevice::ReadOnly)) {
+	// Has it been prepared while the server was starting?
+	Session session(sFilename);
+	if (m_pSessionThread) {
+		m_pSessionThread->wait();
+		if (m_pSessionThread->session().filename() == sFilename)
+			session = m_pSessionThread->session();
+		delete m_pSessionThread;
+		m_pSessionThread = NULL;
+	}
+
+	// Otherwise open and read from real file, now.
+	if (!session.isPrepared() && !session.prepare()) {
 		appendMessagesError(
 			tr("Could not open \"%1\" session file.\n\nSorry.")
 			.arg(sFilename));
@@ -938,34 +1281,32 @@ bool MainForm::loadSessionFile ( const QString& sFilename )
 	// Tell the world we'll take some time...
 	QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
 
-	// Read the file.
-	int iLine = 0;
-	int iErrors = 0;
-	QTextStream ts(&file);
-	while (!ts.atEnd()) {
-		// Read the line.
-		QString sCommand = ts.readLine().trimmed();
-		iLine++;
-		// If not empty, nor a comment, call the server...
-		if (!sCommand.isEmpty() && sCommand[0] != '#') {
-			// Remember that, no matter what,
-			// all LSCP commands are CR/LF terminated.
-			sCommand += "\r\n";
-			if (::lscp_client_query(m_pClient, sCommand.toUtf8().constData())
-				!= LSCP_OK) {
-				appendMessagesColor(QString("%1(%2): %3")
-					.arg(QFileInfo(sFilename).fileName()).arg(iLine)
-					.arg(sCommand.simplified()), "#996633");
-				appendMessagesClient("lscp_client_query");
-				iErrors++;
-			}
-		}
-		// Try to make it snappy :)
-		QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+	// Report whatever came out of the preparation...
+	QStringListIterator warning(session.warnings());
+	while (warning.hasNext())
+		appendMessagesColor(warning.next(), "#996633");
+	QStringListIterator missing(session.missingFiles());
+	while (missing.hasNext()) {
+		appendMessagesColor(tr("Instrument file not found: \"%1\".")
+			.arg(missing.next()), "#996633");
 	}
 
-	// Ok. we've read it.
-	file.close();
+	// Warm instrument names are good for the cache...
+	if (m_pInstrumentCache) {
+		QHash<QString, QStringList>::ConstIterator iter
+			= session.instrumentLists().constBegin();
+		for ( ; iter != session.instrumentLists().constEnd(); ++iter)
+			m_pInstrumentCache->insert(iter.key(), true, iter.value());
+	}
+
+	// Shortest instrument loads first, as far as known,
+	// but only if it's one of our own (command order)...
+	if (session.isGenerated())
+		session.deferInstrumentLoads(QList<int>(), m_pLoadHistory);
+	reportLoadTime(session);
+
+	// Send the whole command stream, back to back...
+	const int iErrors = sendSession(session);
 
 	// Now we'll try to create (update) the whole GUI session.
 	updateSession();
@@ -996,12 +1337,198 @@ bool MainForm::loadSessionFile ( const QString& sFilename )
 }
 
 
+// Send a prepared session command stream, back to back.
+int MainForm::sendSession ( const Session& session )
+{
+	if (m_pClient == NULL)
+		return 0;
+
+	const QString& sName = QFileInfo(session.filename()).fileName();
+
+	// Bulk deadlines; give up on the rest as soon as one is missed.
+	ServerCall call(m_pClient, ServerCall::Bulk);
+
+	int iErrors = 0;
+	QTime t;
+	t.start();
+	QListIterator<Session::Command> iter(session.commands());
+	while (iter.hasNext()) {
+		if (!call.isValid()) {
+			int iSkipped = 0;
+			while (iter.hasNext()) {
+				iter.next();
+				++iSkipped;
+			}
+			appendMessagesColor(
+				tr("%1: server not responding, %2 command(s) skipped.")
+				.arg(sName).arg(iSkipped), "#996633");
+			iErrors += iSkipped;
+			break;
+		}
+		const Session::Command& cmd = iter.next();
+		if (::lscp_client_query(m_pClient, cmd.sCommand.toUtf8().constData())
+			!= LSCP_OK) {
+			appendMessagesColor(QString("%1(%2): %3")
+				.arg(sName).arg(cmd.iLine)
+				.arg(cmd.sCommand.simplified()), "#996633");
+			appendMessagesClient("lscp_client_query");
+			iErrors++;
+		} else {
+			// Time instrument loads, from now on...
+			QString sInstrumentFile;
+			int iInstrumentNr = 0;
+			int iChannel = -1;
+			if (Session::parseInstrumentLoad(cmd.sCommand,
+					sInstrumentFile, iInstrumentNr, iChannel))
+				m_loadStarts.insert(iChannel, timestamp());
+		}
+		call.check();
+		// Try to make it snappy, but not sluggish :)
+		if (t.elapsed() > QSAMPLER_TIMER_MSECS) {
+			QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+			t.restart();
+		}
+	}
+
+	return iErrors;
+}
+
+
+// Report the predicted instrument load time of a session.
+void MainForm::reportLoadTime ( const Session& session )
+{
+	int iKnown = 0;
+	int iTotal = 0;
+	const int iMsecs
+		= session.predictLoadTime(*m_pLoadHistory, &iKnown, &iTotal);
+	if (iKnown > 0) {
+		appendMessages(
+			tr("Predicted instrument load time: %1 s (%2 of %3 instruments).")
+			.arg(QString::number(0.001 * iMsecs, 'f', 1))
+			.arg(iKnown).arg(iTotal));
+	}
+}
+
+
+// Account for an instrument load that has just finished.
+void MainForm::instrumentLoaded ( Channel *pChannel )
+{
+	QHash<int, qint64>::Iterator iter
+		= m_loadStarts.find(pChannel->channelID());
+	if (iter == m_loadStarts.end())
+		return;
+
+	// The server loads instruments one at a time,
+	// so don't count the time spent waiting in line...
+	const qint64 iNow = timestamp();
+	const qint64 iStart = qMax(iter.value(), m_iLoadDone);
+	m_loadStarts.erase(iter);
+	m_iLoadDone = iNow;
+
+	m_pLoadHistory->record(pChannel->instrumentFile(),
+		pChannel->instrumentNr(), int(iNow - iStart));
+}
+
+
+// Take a snapshot of the current session state (watchdog).
+void MainForm::updateSnapshot (void)
+{
+	if (m_pClient == NULL)
+		return;
+
+	// Check whether server is apparently OK...
+	if (::lscp_get_channels(m_pClient) < 0)
+		return;
+
+	QString sSnapshot;
+	QTextStream ts(&sSnapshot, QIODevice::WriteOnly);
+	if (saveSessionStream(ts, true) > 0)
+		return;
+	ts.flush();
+
+	// Critical channels are known by their order...
+	QList<int> critical;
+	QList<QMdiSubWindow *> wlist = m_pWorkspace->subWindowList();
+	for (int iChannel = 0; iChannel < (int) wlist.count(); ++iChannel) {
+		ChannelStrip *pChannelStrip = NULL;
+		QMdiSubWindow *pMdiSubWindow = wlist.at(iChannel);
+		if (pMdiSubWindow)
+			pChannelStrip = static_cast<ChannelStrip *> (pMdiSubWindow->widget());
+		if (pChannelStrip && pChannelStrip->channel()->isCritical())
+			critical.append(iChannel);
+	}
+
+	m_sSnapshot = sSnapshot;
+	m_snapshotCritical = critical;
+	m_bSnapshotDirty = false;
+
+	// Replicate it to the standby server, if any...
+	if (m_pMirror)
+		m_pMirror->update(m_sSnapshot);
+}
+
+
+// Restore the last known session state (watchdog).
+bool MainForm::restoreSnapshot (void)
+{
+	if (m_pClient == NULL || m_sSnapshot.isEmpty())
+		return false;
+
+	appendMessages(tr("Restoring last known session state..."));
+
+	QTextStream ts(&m_sSnapshot, QIODevice::ReadOnly);
+	Session session;
+	session.parse(ts);
+	// Instruments are loaded last, but critical channels first...
+	session.deferInstrumentLoads(m_snapshotCritical, m_pLoadHistory);
+	reportLoadTime(session);
+
+	QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
+
+	const int iErrors = sendSession(session);
+
+	// Now we'll try to create (update) the whole GUI session.
+	updateSession();
+
+	// Channels are added in order, on a fresh server...
+	QListIterator<int> iter(m_snapshotCritical);
+	while (iter.hasNext()) {
+		ChannelStrip *pChannelStrip = channelStrip(iter.next());
+		if (pChannelStrip)
+			pChannelStrip->channel()->setCritical(true);
+	}
+
+	QApplication::restoreOverrideCursor();
+
+	if (iErrors > 0) {
+		appendMessagesError(
+			tr("Session state restored with errors.\n\nSorry."));
+	}
+
+	// Session stays as dirty as it was before.
+	m_iDirtyCount = m_iSnapshotDirtyCount + iErrors;
+	appendMessages(tr("Restored session: \"%1\".")
+		.arg(sessionName(m_sFilename)));
+
+	stabilizeForm();
+	return true;
+}
+
+
 // Save current session to specific file path.
 bool MainForm::saveSessionFile ( const QString& sFilename )
 {
 	if (m_pClient == NULL)
 		return false;
 
+	// Don't even try while the server is not responding...
+	if (!ServerCall::isResponsive()) {
+		appendMessagesError(
+			tr("Could not save the session:\n"
+			"server is not responding.\n\nSorry."));
+		return false;
+	}
+
 	// Check whether server is apparently OK...
 	if (::lscp_get_channels(m_pClient) < 0) {
 		appendMessagesClient("lscp_get_channels");
@@ -1021,7 +1548,6 @@ bool MainForm::saveSessionFile ( const QString& sFilename )
 	QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
 
 	// Write the file.
-	int  iErrors = 0;
 	QTextStream ts(&file);
 	ts << "# " << QSAMPLER_TITLE " - " << tr(QSAMPLER_SUBTITLE) << endl;
 	ts << "# " << tr("Version")
@@ -1037,6 +1563,49 @@ bool MainForm::saveSessionFile ( const QString& sFilename )
 	ts << "#"  << endl;
 	ts << endl;
 
+	// Write the whole session contents.
+	int iErrors = saveSessionStream(ts, false);
+
+	// Ok. we've wrote it.
+	file.close();
+
+	// We're fornerly done.
+	QApplication::restoreOverrideCursor();
+
+	// Have we any errors?
+	if (iErrors > 0) {
+		appendMessagesError(
+			tr("Some settings could not be saved\n"
+			"to \"%1\" session file.\n\nSorry.")
+			.arg(sFilename));
+	}
+
+	// Save as default session directory.
+	if (m_pOptions)
+		m_pOptions->sSessionDir = QFileInfo(sFilename).dir().absolutePath();
+	// We're not dirty anymore.
+	m_iDirtyCount = 0;
+	// Stabilize form...
+	m_sFilename = sFilename;
+	updateRecentFiles(sFilename);
+	appendMessages(tr("Save session: \"%1\".").arg(sessionName(m_sFilename)));
+	stabilizeForm();
+	return true;
+}
+
+
+// Write current session contents to a text stream; snapshots
+// are taken without event processing and keep pending loads in.
+int MainForm::saveSessionStream ( QTextStream& ts, bool bSnapshot )
+{
+	int iErrors = 0;
+
+	// Snapshots are periodic, background stuff; otherwise it's bulk.
+	ServerCall call(m_pClient,
+		bSnapshot ? ServerCall::Background : ServerCall::Bulk);
+	if (!call.isValid())
+		return 1;
+
 	// It is assumed that this new kind of device+session file
 	// will be loaded from a complete initialized server...
 	int *piDeviceIDs;
@@ -1082,7 +1651,8 @@ bool MainForm::saveSessionFile ( const QString& sFilename )
 		// Audio device index/id mapping.
 		audioDeviceMap[device.deviceID()] = iDevice;
 		// Try to keep it snappy :)
-		QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+		if (!bSnapshot)
+			QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
 	}
 
 	// MIDI device mapping.
@@ -1124,16 +1694,26 @@ bool MainForm::saveSessionFile ( const QString& sFilename )
 		// MIDI device index/id mapping.
 		midiDeviceMap[device.deviceID()] = iDevice;
 		// Try to keep it snappy :)
-		QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+		if (!bSnapshot)
+			QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
 	}
 	ts << endl;
 
 #ifdef CONFIG_MIDI_INSTRUMENT
 	// MIDI instrument mapping...
+	// (entries are taken from the index, whenever it's complete,
+	// instead of asking the server for each and every one of them)
+	MapIndex *pMapIndex = MapIndex::getInstance();
+	const bool bMapIndex = (pMapIndex && pMapIndex->isValid());
 	QMap<int, int> midiInstrumentMap;
 	int *piMaps = ::lscp_list_midi_instrument_maps(m_pClient);
-	for (int iMap = 0; piMaps && piMaps[iMap] >= 0; iMap++) {
-		int iMidiMap = piMaps[iMap];
+	for (int i = 0; piMaps && piMaps[i] >= 0; i++) {
+		int iMidiMap = piMaps[i];
+		// Staged ones are not part of it, yet...
+		if (!bSnapshot && m_pSessionStage
+			&& m_pSessionStage->isStagedMap(iMidiMap))
+			continue;
+		const int iMap = midiInstrumentMap.count();
 		const char *pszMapName
 			= ::lscp_get_midi_instrument_map_name(m_pClient, iMidiMap);
 		ts << "# " << tr("MIDI instrument map") << " " << iMap;
@@ -1144,6 +1724,42 @@ bool MainForm::saveSessionFile ( const QString& sFilename )
 		if (pszMapName)
 			ts << " '" << pszMapName << "'";
 		ts << endl;
+		// MIDI instrument mapping, from the index...
+		if (bMapIndex) {
+			QListIterator<Instrument> iter(pMapIndex->instruments(iMidiMap));
+			while (iter.hasNext()) {
+				const Instrument& instr = iter.next();
+				ts << "MAP MIDI_INSTRUMENT "
+					<< iMap                 << " "
+					<< instr.bank()         << " "
+					<< instr.prog()         << " "
+					<< instr.engineName()   << " '"
+					<< qsamplerUtilities::lscpEscapePath(
+						instr.instrumentFile()) << "' "
+					<< instr.instrumentNr() << " "
+					<< instr.volume()       << " ";
+				switch (instr.loadMode()) {
+					case 3:
+						ts << "PERSISTENT";
+						break;
+					case 2:
+						ts << "ON_DEMAND_HOLD";
+						break;
+					case 1:
+					case 0:
+					default:
+						ts << "ON_DEMAND";
+						break;
+				}
+				if (!instr.name().isEmpty())
+					ts << " '" << qsamplerUtilities::lscpEscapeText(
+						instr.name()) << "'";
+				ts << endl;
+			}
+			ts << endl;
+			midiInstrumentMap[iMidiMap] = iMap;
+			continue;
+		}
 		// MIDI instrument mapping...
 		lscp_midi_instrument_t *pInstrs
 			= ::lscp_list_midi_instruments(m_pClient, iMidiMap);
@@ -1180,8 +1796,14 @@ bool MainForm::saveSessionFile ( const QString& sFilename )
 				appendMessagesClient("lscp_get_midi_instrument_info");
 				iErrors++;
 			}
+			// Don't wait for each and every one to time out...
+			if (!call.check()) {
+				iErrors++;
+				break;
+			}
 			// Try to keep it snappy :)
-			QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+			if (!bSnapshot)
+				QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
 		}
 		ts << endl;
 		// Check for errors...
@@ -1201,13 +1823,18 @@ bool MainForm::saveSessionFile ( const QString& sFilename )
 
 	// Sampler channel mapping.
 	QList<QMdiSubWindow *> wlist = m_pWorkspace->subWindowList();
-	for (int iChannel = 0; iChannel < (int) wlist.count(); ++iChannel) {
+	int iChannel = 0;
+	for (int iStrip = 0; iStrip < (int) wlist.count(); ++iStrip) {
 		ChannelStrip *pChannelStrip = NULL;
-		QMdiSubWindow *pMdiSubWindow = wlist.at(iChannel);
+		QMdiSubWindow *pMdiSubWindow = wlist.at(iStrip);
 		if (pMdiSubWindow)
 			pChannelStrip = static_cast<ChannelStrip *> (pMdiSubWindow->widget());
 		if (pChannelStrip) {
 			Channel *pChannel = pChannelStrip->channel();
+			// Staged ones are not part of it, yet...
+			if (pChannel && !bSnapshot && m_pSessionStage
+				&& m_pSessionStage->isStaged(pChannel->channelID()))
+				pChannel = NULL;
 			if (pChannel) {
 				ts << "# " << tr("Channel") << " " << iChannel << endl;
 				ts << "ADD CHANNEL" << endl;
@@ -1235,7 +1862,9 @@ bool MainForm::saveSessionFile ( const QString& sFilename )
 				ts << endl;
 				ts << "LOAD ENGINE " << pChannel->engineName()
 					<< " " << iChannel << endl;
-				if (pChannel->instrumentStatus() < 100) ts << "# ";
+				if (pChannel->instrumentStatus() < 100
+					&& !(bSnapshot && pChannel->instrumentStatus() >= 0))
+					ts << "# ";
 				ts << "LOAD INSTRUMENT NON_MODAL '"
 					<< pChannel->instrumentFile() << "' "
 					<< pChannel->instrumentNr() << " " << iChannel << endl;
@@ -1261,7 +1890,8 @@ bool MainForm::saveSessionFile ( const QString& sFilename )
 			#endif
 			#ifdef CONFIG_FXSEND
 				int iChannelID = pChannel->channelID();
-				int *piFxSends = ::lscp_list_fxsends(m_pClient, iChannelID);
+				int *piFxSends = (m_pServerCaps->has(ServerCaps::FxSends)
+					? ::lscp_list_fxsends(m_pClient, iChannelID) : NULL);
 				for (int iFxSend = 0;
 						piFxSends && piFxSends[iFxSend] >= 0;
 							iFxSend++) {
@@ -1296,10 +1926,12 @@ bool MainForm::saveSessionFile ( const QString& sFilename )
 				}
 			#endif
 				ts << endl;
+				++iChannel;
 			}
 		}
 		// Try to keep it snappy :)
-		QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+		if (!bSnapshot)
+			QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
 	}
 
 #ifdef CONFIG_VOLUME
@@ -1308,31 +1940,7 @@ bool MainForm::saveSessionFile ( const QString& sFilename )
 	ts << endl;
 #endif
 
-	// Ok. we've wrote it.
-	file.close();
-
-	// We're fornerly done.
-	QApplication::restoreOverrideCursor();
-
-	// Have we any errors?
-	if (iErrors > 0) {
-		appendMessagesError(
-			tr("Some settings could not be saved\n"
-			"to \"%1\" session file.\n\nSorry.")
-			.arg(sFilename));
-	}
-
-	// Save as default session directory.
-	if (m_pOptions)
-		m_pOptions->sSessionDir = QFileInfo(sFilename).dir().absolutePath();
-	// We're not dirty anymore.
-	m_iDirtyCount = 0;
-	// Stabilize form...
-	m_sFilename = sFilename;
-	updateRecentFiles(sFilename);
-	appendMessages(tr("Save session: \"%1\".").arg(sessionName(m_sFilename)));
-	stabilizeForm();
-	return true;
+	return iErrors;
 }
 
 
@@ -1341,6 +1949,7 @@ void MainForm::sessionDirty (void)
 {
 	// Just mark the dirty form.
 	m_iDirtyCount++;
+	m_bSnapshotDirty = true;
 	// and update the form status...
 	stabilizeForm();
 }
@@ -1398,6 +2007,136 @@ void MainForm::fileSaveAs (void)
 }
 
 
+// Collect current sampler session and all its instrument files.
+void MainForm::fileCollect (void)
+{
+	if (m_pClient == NULL || m_pOptions == NULL)
+		return;
+
+	// Where to?
+	const QString& sBundleDir = QFileDialog::getExistingDirectory(this,
+		QSAMPLER_TITLE ": " + tr("Collect Session"), // Caption.
+		m_pOptions->sSessionDir);                     // Start here.
+	if (sBundleDir.isEmpty())
+		return;
+
+	// Grab the current session state, as if saved...
+	QString sSession;
+	QTextStream ts(&sSession, QIODevice::WriteOnly);
+	if (saveSessionStream(ts, false) > 0) {
+		appendMessagesError(
+			tr("Could not collect the current session.\n\nSorry."));
+		return;
+	}
+	ts.flush();
+
+	QString sName = QFileInfo(m_sFilename).completeBaseName();
+	if (sName.isEmpty())
+		sName = sessionName(m_sFilename);
+	const QDir dir(sBundleDir);
+	const QString& sFilename = dir.filePath(sName + ".lscp");
+
+	// Check if already exists...
+	if (QFileInfo(sFilename).exists()) {
+		if (QMessageBox::warning(this,
+			QSAMPLER_TITLE ": " + tr("Warning"),
+			tr("The file already exists:\n\n"
+			"\"%1\"\n\n"
+			"Do you want to replace it?")
+			.arg(sFilename),
+			QMessageBox::Yes | QMessageBox::No) == QMessageBox::No)
+			return;
+	}
+
+	// Which instrument files are referred to?
+	QTextStream ts2(&sSession, QIODevice::ReadOnly);
+	Session session(sFilename);
+	session.parse(ts2);
+
+	const QString& sInstrumentDir = dir.filePath("instruments");
+	if (!dir.mkpath(sInstrumentDir)) {
+		appendMessagesError(
+			tr("Could not create \"%1\" directory.\n\nSorry.")
+			.arg(sInstrumentDir));
+		return;
+	}
+
+	appendMessages(tr("Collecting session: \"%1\"...").arg(sFilename));
+
+	// Commented out instrument loads are collected all the same...
+	QStringList files = session.instrumentFiles();
+	QStringListIterator commented(session.commentedFiles());
+	while (commented.hasNext()) {
+		const QString& sInstrumentFile = commented.next();
+		if (!files.contains(sInstrumentFile))
+			files.append(sInstrumentFile);
+	}
+
+	// Go parallel, while showing what's going on...
+	SessionBundle bundle(sInstrumentDir, files);
+	QProgressDialog progress(
+		tr("Collecting instrument files..."), tr("Cancel"), 0, 1000, this);
+	progress.setWindowTitle(QSAMPLER_TITLE ": " + tr("Collect Session"));
+	progress.setWindowModality(Qt::WindowModal);
+	progress.setMinimumDuration(500);
+	QTime t;
+	t.start();
+	bundle.start();
+	while (!bundle.wait(QSAMPLER_TIMER_MSECS)) {
+		const qint64 iBytesTotal = bundle.bytesTotal();
+		if (iBytesTotal > 0)
+			progress.setValue(int((1000 * bundle.bytesDone()) / iBytesTotal));
+		progress.setLabelText(tr("Collecting instrument files (%1 of %2)...")
+			.arg(bundle.filesDone()).arg(bundle.filesTotal()));
+		QApplication::processEvents();
+		if (progress.wasCanceled()) {
+			bundle.cancel();
+			appendMessagesColor(tr("Collect session cancelled."), "#996633");
+			return;
+		}
+	}
+	progress.setValue(1000);
+	const int iElapsed = t.elapsed();
+
+	// Report whatever went wrong...
+	QStringListIterator iter(bundle.errors());
+	while (iter.hasNext())
+		appendMessagesColor(iter.next(), "#996633");
+
+	// Now, the relocated session file itself...
+	QFile file(sFilename);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		appendMessagesError(
+			tr("Could not open \"%1\" session file.\n\nSorry.")
+			.arg(sFilename));
+		return;
+	}
+	QTextStream(&file) << Session::relocate(sSession, bundle.paths());
+	file.close();
+
+	// Throughput report...
+	const double fMBytes = double(bundle.bytesDone()) / (1024.0 * 1024.0);
+	const double fSecs = 0.001 * qMax(iElapsed, 1);
+	appendMessages(
+		tr("Collected session: \"%1\" (%2 files, %3 MB in %4 s, %5 MB/s).")
+		.arg(sFilename).arg(bundle.filesTotal())
+		.arg(QString::number(fMBytes, 'f', 1))
+		.arg(QString::number(fSecs, 'f', 1))
+		.arg(QString::number(fMBytes / fSecs, 'f', 1)));
+	appendMessages(
+		tr("Instrument files: %1 linked, %2 cloned, %3 copied, "
+		"%4 duplicates skipped.")
+		.arg(bundle.linked()).arg(bundle.reflinked())
+		.arg(bundle.copied()).arg(bundle.deduped()));
+
+	if (!bundle.errors().isEmpty()) {
+		appendMessagesError(
+			tr("Session collected with errors\nto \"%1\".\n\nSorry.")
+			.arg(sFilename));
+	}
+}
+
+
 // Reset the sampler instance.
 void MainForm::fileReset (void)
 {
@@ -1504,6 +2243,399 @@ void MainForm::fileRestart (void)
 }
 
 
+// Preload another session in background, muted.
+void MainForm::fileStage (void)
+{
+	if (m_pOptions == NULL || m_pClient == NULL)
+		return;
+
+	// Only one at a time...
+	if (m_pSessionStage) {
+		if (QMessageBox::warning(this,
+			QSAMPLER_TITLE ": " + tr("Warning"),
+			tr("Discard the currently staged session?\n\n\"%1\"")
+			.arg(sessionName(m_pSessionStage->filename())),
+			QMessageBox::Ok | QMessageBox::Cancel) == QMessageBox::Cancel)
+			return;
+		m_pSessionStage->discard();
+		delete m_pSessionStage;
+		m_pSessionStage = NULL;
+	}
+
+	const QString& sFilename = QFileDialog::getOpenFileName(this,
+		QSAMPLER_TITLE ": " + tr("Stage Next Session"), // Caption.
+		m_pOptions->sSessionDir,                        // Start here.
+		tr("LSCP Session files") + " (*.lscp)"          // Filter (LSCP files)
+	);
+
+	if (sFilename.isEmpty())
+		return;
+
+	Session session(sFilename);
+	if (!session.prepare()) {
+		appendMessagesError(
+			tr("Could not open \"%1\" session file.\n\nSorry.")
+			.arg(sFilename));
+		return;
+	}
+
+	QStringListIterator missing(session.missingFiles());
+	while (missing.hasNext()) {
+		appendMessagesColor(tr("Instrument file not found: \"%1\".")
+			.arg(missing.next()), "#996633");
+	}
+
+	// Shortest instrument loads first, as far as known,
+	// but only if it's one of our own (command order)...
+	if (session.isGenerated())
+		session.deferInstrumentLoads(QList<int>(), m_pLoadHistory);
+	reportLoadTime(session);
+
+	QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
+
+	m_pSessionStage = new SessionStage(this);
+	QObject::connect(m_pSessionStage,
+		SIGNAL(stageReady()),
+		SLOT(sessionStageReady()));
+
+	const int iErrors = m_pSessionStage->stage(session);
+
+	QApplication::restoreOverrideCursor();
+
+	if (iErrors > 0) {
+		appendMessagesError(
+			tr("Session staged with errors\nfrom \"%1\".\n\nSorry.")
+			.arg(sFilename));
+	}
+
+	appendMessages(tr("Staging session: \"%1\"...")
+		.arg(sessionName(sFilename)));
+
+	stabilizeForm();
+}
+
+
+// Bring the staged session in and the current one out.
+void MainForm::fileSwitch (void)
+{
+	if (m_pClient == NULL || m_pSessionStage == NULL)
+		return;
+
+	const QString sFilename = m_pSessionStage->filename();
+
+	// Not quite there yet?
+	if (!m_pSessionStage->isReady()) {
+		if (QMessageBox::warning(this,
+			QSAMPLER_TITLE ": " + tr("Warning"),
+			tr("The staged session is still loading:\n\n\"%1\"\n\n"
+			"Switch over anyway?").arg(sessionName(sFilename)),
+			QMessageBox::Ok | QMessageBox::Cancel) == QMessageBox::Cancel)
+			return;
+	}
+
+	// The current one is going away, for good...
+	if (m_iDirtyCount > 0) {
+		switch (QMessageBox::warning(this,
+			QSAMPLER_TITLE ": " + tr("Warning"),
+			tr("The current session has been changed:\n\n"
+			"\"%1\"\n\n"
+			"Do you want to save the changes?")
+			.arg(sessionName(m_sFilename)),
+			QMessageBox::Save |
+			QMessageBox::Discard |
+			QMessageBox::Cancel)) {
+		case QMessageBox::Save:
+			if (!saveSession(false))
+				return;
+			// Fall thru....
+		case QMessageBox::Discard:
+			break;
+		default:    // Cancel.
+			return;
+		}
+	}
+
+	const int iErrors = m_pSessionStage->commit();
+
+	delete m_pSessionStage;
+	m_pSessionStage = NULL;
+
+	// Old channel strips are gone with the server ones...
+	updateAllChannelStrips(true);
+
+	if (iErrors > 0) {
+		appendMessagesError(
+			tr("Session switched over with errors.\n\nSorry."));
+	}
+
+	if (m_pOptions)
+		m_pOptions->sSessionDir = QFileInfo(sFilename).dir().absolutePath();
+	m_iDirtyCount = iErrors;
+	m_sFilename = sFilename;
+	m_bSnapshotDirty = true;
+	updateRecentFiles(sFilename);
+	appendMessages(tr("Switched to session: \"%1\".")
+		.arg(sessionName(m_sFilename)));
+
+	stabilizeForm();
+}
+
+
+// Staged session readiness notification.
+void MainForm::sessionStageReady (void)
+{
+	if (m_pSessionStage == NULL)
+		return;
+
+	const QString& sText = tr("Staged session ready: \"%1\" "
+		"(%2 of %3 instruments loaded).")
+		.arg(sessionName(m_pSessionStage->filename()))
+		.arg(m_pSessionStage->readyCount())
+		.arg(m_pSessionStage->totalCount());
+	if (m_pSessionStage->failedCount() > 0)
+		appendMessagesColor(sText, "#996633");
+	else
+		appendMessages(sText);
+
+	stabilizeForm();
+}
+
+
+// Start/stop replicating the sampler state to a standby server.
+void MainForm::fileMirror ( bool bOn )
+{
+	if (m_pOptions == NULL)
+		return;
+
+	if (!bOn) {
+		if (m_pMirror) {
+			appendMessages(tr("Standby server %1:%2 no longer mirrored.")
+				.arg(m_pMirror->host()).arg(m_pMirror->port()));
+			delete m_pMirror;
+			m_pMirror = NULL;
+		}
+		stabilizeForm();
+		return;
+	}
+
+	if (m_pMirror || m_pClient == NULL) {
+		stabilizeForm();
+		return;
+	}
+
+	// Where's the standby?
+	bool bOk = false;
+	const QString& sServer = QInputDialog::getText(this,
+		QSAMPLER_TITLE ": " + tr("Mirror to Standby"),
+		tr("Standby server (host[:port]):"), QLineEdit::Normal,
+		m_pOptions->sMirrorServer, &bOk).simplified();
+	const QList<QPair<QString, int> >& servers
+		= LoadBalancer::parseServers(sServer, m_pOptions->iServerPort);
+	if (!bOk || servers.count() != 1) {
+		stabilizeForm();
+		return;
+	}
+
+	const QString& sHost = servers.first().first;
+	const int iPort = servers.first().second;
+	if (sHost == m_pOptions->sServerHost && iPort == m_pOptions->iServerPort) {
+		appendMessagesError(
+			tr("The standby server must not be the current one.\n\nSorry."));
+		stabilizeForm();
+		return;
+	}
+
+	m_pOptions->sMirrorServer = sServer;
+
+	// Replicate it all, right away...
+	m_pMirror = new Mirror(this, sHost, iPort, m_pOptions->iServerTimeout);
+	m_pMirror->start();
+
+	appendMessages(tr("Mirroring to standby server %1:%2...")
+		.arg(sHost).arg(iPort));
+
+	updateSnapshot();
+	stabilizeForm();
+}
+
+
+// Switch the whole GUI over to the standby server.
+void MainForm::fileFailover (void)
+{
+	if (m_pOptions == NULL || m_pMirror == NULL)
+		return;
+
+	const QString sHost = m_pMirror->host();
+	const int iPort = m_pMirror->port();
+
+	if (m_pClient) {
+		QString sText = tr("About to switch over to the standby server:\n\n"
+			"%1:%2\n\n").arg(sHost).arg(iPort);
+		if (!m_pMirror->isSynced())
+			sText += tr("Please note that it is not in sync right now.\n\n");
+		sText += tr("Are you sure?");
+		if (QMessageBox::warning(this,
+			QSAMPLER_TITLE ": " + tr("Warning"), sText,
+			QMessageBox::Ok | QMessageBox::Cancel) == QMessageBox::Cancel)
+			return;
+	}
+
+	// The standby is the one from now on...
+	delete m_pMirror;
+	m_pMirror = NULL;
+
+	const QString sFilename = m_sFilename;
+	const int iDirtyCount = m_iDirtyCount;
+
+	m_bWatchdogRestore = false;
+	stopClient();
+
+	appendMessages(tr("Failing over to standby server %1:%2...")
+		.arg(sHost).arg(iPort));
+
+	// For this session only, the configured server stays...
+	m_pOptions->setSessionServer(sHost, iPort);
+
+	// The session goes on, exactly as it was...
+	if (startClient()) {
+		m_sFilename = sFilename;
+		m_iDirtyCount = iDirtyCount;
+		appendMessages(tr("Failed over to standby server %1:%2.")
+			.arg(sHost).arg(iPort));
+	}
+
+	stabilizeForm();
+}
+
+
+// Run a script file against the current server.
+void MainForm::fileScript (void)
+{
+	if (m_pOptions == NULL || m_pClient == NULL)
+		return;
+
+#ifdef CONFIG_SCRIPT
+	// Only one at a time...
+	if (m_pScript) {
+		if (QMessageBox::warning(this,
+			QSAMPLER_TITLE ": " + tr("Warning"),
+			tr("The \"%1\" script is still running.\n\n"
+			"Do you want to stop it?")
+			.arg(QFileInfo(m_pScript->filename()).fileName()),
+			QMessageBox::Ok | QMessageBox::Cancel) == QMessageBox::Cancel)
+			return;
+		m_pScript->abort(1);
+		return;
+	}
+
+	const QString& sFilename = QFileDialog::getOpenFileName(this,
+		QSAMPLER_TITLE ": " + tr("Run Script"),   // Caption.
+		m_pOptions->sSessionDir,                  // Start here.
+		tr("Script files") + " (*.js)"            // Filter (JS files)
+	);
+
+	if (sFilename.isEmpty())
+		return;
+
+	runScript(sFilename);
+#endif
+}
+
+
+// Start running a script file (one at a time).
+bool MainForm::runScript ( const QString& sFilename )
+{
+#ifdef CONFIG_SCRIPT
+	if (m_pScript || m_pClient == NULL)
+		return false;
+
+	appendMessages(tr("Script \"%1\" running...").arg(sFilename));
+
+	m_pScript = new Script(this);
+	QObject::connect(m_pScript,
+		SIGNAL(finished(int)),
+		SLOT(scriptFinished(int)));
+
+	const bool bResult = m_pScript->run(sFilename);
+
+	stabilizeForm();
+
+	return bResult;
+#else
+	appendMessagesColor(
+		tr("Script \"%1\" not run: scripting support is not available.")
+		.arg(sFilename), "#996633");
+	return false;
+#endif
+}
+
+
+// A script is over, with nothing pending.
+void MainForm::scriptFinished ( int iExitCode )
+{
+#ifdef CONFIG_SCRIPT
+	if (m_pScript == NULL)
+		return;
+
+	const QString& sText = tr("Script \"%1\" finished (exit code %2).")
+		.arg(m_pScript->filename()).arg(iExitCode);
+	if (iExitCode)
+		appendMessagesColor(sText, "#996633");
+	else
+		appendMessages(sText);
+
+	// May well be in the middle of a callback...
+	m_pScript->deleteLater();
+	m_pScript = NULL;
+
+	// Headless runs are just about the script.
+	if (m_pOptions && m_pOptions->bHeadless)
+		QApplication::exit(iExitCode);
+
+	stabilizeForm();
+#else
+	Q_UNUSED(iExitCode);
+#endif
+}
+
+
+// Command line supplied script, once connected.
+void MainForm::startupScript (void)
+{
+	if (m_pOptions == NULL || m_pOptions->sScriptFile.isEmpty())
+		return;
+
+	const QString sFilename = m_pOptions->sScriptFile;
+	m_pOptions->sScriptFile.clear();
+
+	if (!runScript(sFilename) && m_pOptions->bHeadless)
+		QApplication::exit(1);
+}
+
+
+// Command line supplied instruments DB imports, once connected.
+void MainForm::startupImport (void)
+{
+	if (m_pOptions == NULL || m_pOptions->dbImportPaths.isEmpty())
+		return;
+
+	if (m_pDbImportForm == NULL)
+		return;
+
+	QStringListIterator iter(m_pOptions->dbImportPaths);
+	while (iter.hasNext())
+		m_pDbImportForm->addPath(iter.next());
+	m_pOptions->dbImportPaths.clear();
+
+	if (!m_pOptions->bHeadless) {
+		m_pDbImportForm->show();
+		m_pDbImportForm->raise();
+	}
+
+	m_pDbImportForm->startImport();
+}
+
+
 // Exit application program.
 void MainForm::fileExit (void)
 {
@@ -1620,55 +2752,350 @@ void MainForm::editSetupChannel (void)
 }
 
 
-// Edit current sampler channel.
-void MainForm::editEditChannel (void)
-{
-	if (m_pClient == NULL)
-		return;
+// Edit current sampler channel.
+void MainForm::editEditChannel (void)
+{
+	if (m_pClient == NULL)
+		return;
+
+	ChannelStrip *pChannelStrip = activeChannelStrip();
+	if (pChannelStrip == NULL)
+		return;
+
+	// Just invoque the channel strip procedure.
+	pChannelStrip->channelEdit();
+}
+
+
+// Reset current sampler channel.
+void MainForm::editResetChannel (void)
+{
+	if (m_pClient == NULL)
+		return;
+
+	ChannelStrip *pChannelStrip = activeChannelStrip();
+	if (pChannelStrip == NULL)
+		return;
+
+	// Just invoque the channel strip procedure.
+	pChannelStrip->channelReset();
+}
+
+
+// Reset all sampler channels.
+void MainForm::editResetAllChannels (void)
+{
+	if (m_pClient == NULL)
+		return;
+
+	// Invoque the channel strip procedure,
+	// for all channels out there...
+	m_pWorkspace->setUpdatesEnabled(false);
+	QList<QMdiSubWindow *> wlist = m_pWorkspace->subWindowList();
+	for (int iChannel = 0; iChannel < (int) wlist.count(); ++iChannel) {
+		ChannelStrip *pChannelStrip = NULL;
+		QMdiSubWindow *pMdiSubWindow = wlist.at(iChannel);
+		if (pMdiSubWindow)
+			pChannelStrip = static_cast<ChannelStrip *> (pMdiSubWindow->widget());
+		if (pChannelStrip)
+			pChannelStrip->channelReset();
+	}
+	m_pWorkspace->setUpdatesEnabled(true);
+}
+
+
+// Toggle current sampler channel restore priority.
+void MainForm::editCriticalChannel ( bool bOn )
+{
+	ChannelStrip *pChannelStrip = activeChannelStrip();
+	if (pChannelStrip == NULL)
+		return;
+
+	// Just flag it down, for the watchdog.
+	pChannelStrip->channel()->setCritical(bOn);
+	m_bSnapshotDirty = true;
+
+	stabilizeForm();
+}
+
+
+// Save the current sampler channel setup as a named template.
+void MainForm::editSaveTemplate (void)
+{
+	if (m_pOptions == NULL || m_pClient == NULL)
+		return;
+
+	ChannelStrip *pChannelStrip = activeChannelStrip();
+	if (pChannelStrip == NULL)
+		return;
+
+	Channel *pChannel = pChannelStrip->channel();
+	if (pChannel == NULL)
+		return;
+
+	bool bOk = false;
+	const QString& sName = QInputDialog::getText(this,
+		QSAMPLER_TITLE ": " + tr("Save Channel as Template"),
+		tr("Template name:"), QLineEdit::Normal,
+		pChannel->instrumentName(), &bOk).simplified();
+	if (!bOk || sName.isEmpty())
+		return;
+
+	ChannelTemplate channelTemplate(sName);
+	if (ChannelTemplate::names(m_pOptions->settings())
+			.contains(channelTemplate.name())) {
+		if (QMessageBox::warning(this,
+			QSAMPLER_TITLE ": " + tr("Warning"),
+			tr("The channel template already exists:\n\n"
+			"\"%1\"\n\n"
+			"Do you want to replace it?")
+			.arg(channelTemplate.name()),
+			QMessageBox::Ok | QMessageBox::Cancel) == QMessageBox::Cancel)
+			return;
+	}
+
+	if (!channelTemplate.capture(m_pClient, pChannel)) {
+		appendMessagesError(
+			tr("Could not take the channel template.\n\nSorry."));
+		return;
+	}
+
+	channelTemplate.save(m_pOptions->settings());
+	m_pOptions->sChannelTemplate = channelTemplate.name();
+
+	appendMessages(tr("Channel template \"%1\" saved.")
+		.arg(channelTemplate.name()));
+}
+
+
+// Create several sampler channels out of a channel template.
+void MainForm::editInstantiateTemplate (void)
+{
+	if (m_pOptions == NULL || m_pClient == NULL)
+		return;
+
+	ChannelTemplateForm form(m_pOptions, this);
+	if (!form.exec())
+		return;
+
+	const ChannelTemplate& channelTemplate = form.channelTemplate();
+
+	QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
+
+	QTime t;
+	t.start();
+
+	// All commands in one batch...
+	QStringList errors;
+	const QList<int>& channels = channelTemplate.instantiate(
+		m_pClient, form.count(), form.variation(), &errors);
+
+	// and one single update, for them all.
+	updateAllChannelStrips(false);
+
+	QApplication::restoreOverrideCursor();
+
+	QStringListIterator iter(errors);
+	while (iter.hasNext())
+		appendMessagesColor(iter.next(), "#996633");
+
+	appendMessages(tr("Channel template \"%1\": "
+		"%2 of %3 channels created in %4 msecs.")
+		.arg(channelTemplate.name())
+		.arg(channels.count()).arg(form.count())
+		.arg(t.elapsed()));
 
-	ChannelStrip *pChannelStrip = activeChannelStrip();
-	if (pChannelStrip == NULL)
-		return;
+	if (!channels.isEmpty())
+		m_iDirtyCount++;
 
-	// Just invoque the channel strip procedure.
-	pChannelStrip->channelEdit();
+	stabilizeForm();
 }
 
 
-// Reset current sampler channel.
-void MainForm::editResetChannel (void)
+// Distribute sampler channels across several servers, by load.
+void MainForm::editDistributeChannels (void)
 {
-	if (m_pClient == NULL)
+	if (m_pOptions == NULL || m_pClient == NULL)
 		return;
 
-	ChannelStrip *pChannelStrip = activeChannelStrip();
-	if (pChannelStrip == NULL)
+	// Which other servers are there to go?
+	bool bOk = false;
+	const QString& sServers = QInputDialog::getText(this,
+		QSAMPLER_TITLE ": " + tr("Distribute Channels"),
+		tr("Other servers (host[:port] ...):"), QLineEdit::Normal,
+		m_pOptions->sBalanceServers, &bOk).simplified();
+	if (!bOk || sServers.isEmpty())
 		return;
 
-	// Just invoque the channel strip procedure.
-	pChannelStrip->channelReset();
-}
-
+	m_pOptions->sBalanceServers = sServers;
+
+	LoadBalancer balancer(m_pOptions->iServerTimeout);
+	balancer.addServer(m_pOptions->sServerHost,
+		m_pOptions->iServerPort, m_pClient);
+
+	typedef QPair<QString, int> HostPort;
+	QListIterator<HostPort> server_iter(
+		LoadBalancer::parseServers(sServers, m_pOptions->iServerPort));
+	while (server_iter.hasNext()) {
+		const HostPort& server = server_iter.next();
+		if (balancer.addServer(server.first, server.second)) {
+			appendMessages(tr("Server %1 connected.")
+				.arg(LoadBalancer::serverName(balancer.server(
+					balancer.serverCount() - 1))));
+		}
+		else appendMessagesColor(balancer.errors().last(), "#996633");
+	}
 
-// Reset all sampler channels.
-void MainForm::editResetAllChannels (void)
-{
-	if (m_pClient == NULL)
+	if (balancer.serverCount() < 2) {
+		appendMessagesError(
+			tr("No other server to distribute channels to.\n\nSorry."));
 		return;
+	}
 
-	// Invoque the channel strip procedure,
-	// for all channels out there...
-	m_pWorkspace->setUpdatesEnabled(false);
-	QList<QMdiSubWindow *> wlist = m_pWorkspace->subWindowList();
+	const int iConnectErrors = balancer.errors().count();
+
+	// All loaded and non-critical channels may move...
+	QList<int> channels;
+	const QList<QMdiSubWindow *>& wlist = m_pWorkspace->subWindowList();
 	for (int iChannel = 0; iChannel < (int) wlist.count(); ++iChannel) {
 		ChannelStrip *pChannelStrip = NULL;
 		QMdiSubWindow *pMdiSubWindow = wlist.at(iChannel);
 		if (pMdiSubWindow)
 			pChannelStrip = static_cast<ChannelStrip *> (pMdiSubWindow->widget());
-		if (pChannelStrip)
-			pChannelStrip->channelReset();
+		if (pChannelStrip == NULL)
+			continue;
+		Channel *pChannel = pChannelStrip->channel();
+		if (pChannel == NULL || pChannel->isCritical()
+			|| pChannel->instrumentFile().isEmpty()
+			|| pChannel->engineName().isEmpty())
+			continue;
+		LoadBalancer::Demand demand;
+		demand.iChannelID      = pChannel->channelID();
+		demand.sEngineName     = pChannel->engineName();
+		demand.sInstrumentFile = pChannel->instrumentFile();
+		demand.iInstrumentNr   = pChannel->instrumentNr();
+		demand.iMidiPort       = pChannel->midiPort();
+		demand.iMidiChannel    = pChannel->midiChannel();
+		demand.iMidiMap        = pChannel->midiMap();
+		if (demand.iMidiMap >= 0)
+			demand.sMidiMapName = Instrument::getMapName(demand.iMidiMap);
+		demand.audioRouting    = pChannel->audioRouting();
+		demand.fVolume         = pChannel->volume();
+		demand.bMute           = pChannel->channelMute();
+		demand.bSolo           = pChannel->channelSolo();
+		QListIterator<int> fx_iter(
+			FxSend::allFxSendsOfSamplerChannel(demand.iChannelID));
+		while (fx_iter.hasNext()) {
+			FxSend fxSend(demand.iChannelID, fx_iter.next());
+			if (!fxSend.getFromSampler())
+				continue;
+			LoadBalancer::Send send;
+			send.sName           = fxSend.name();
+			send.iMidiController = fxSend.sendDepthMidiCtrl();
+			send.fLevel          = fxSend.currentDepth();
+			send.routing         = fxSend.audioRouting();
+			demand.sends.append(send);
+		}
+		demand.iVoices  = pChannelStrip->peakVoiceCount();
+		demand.iStreams = pChannelStrip->peakStreamCount();
+		demand.iMemory  = 0;
+		balancer.addDemand(demand);
+		channels.append(demand.iChannelID);
+	}
+
+	if (channels.isEmpty()) {
+		appendMessagesColor(
+			tr("No channels to distribute (critical ones stay)."), "#996633");
+		return;
+	}
+
+	// Where would each channel rather be?
+	balancer.refreshLoad(0, channels);
+	for (int iServer = 1; iServer < balancer.serverCount(); ++iServer)
+		balancer.refreshLoad(iServer);
+	balancer.assign();
+
+	int iMoves = 0;
+	QListIterator<LoadBalancer::Demand> demand_iter(balancer.demands());
+	while (demand_iter.hasNext()) {
+		if (demand_iter.next().iServer > 0)
+			++iMoves;
+	}
+
+	QStringList loads;
+	for (int iServer = 0; iServer < balancer.serverCount(); ++iServer) {
+		const LoadBalancer::Server& server = balancer.server(iServer);
+		loads.append(tr("%1: %2 channels, %3% load")
+			.arg(LoadBalancer::serverName(server))
+			.arg(server.iChannels)
+			.arg(int(100.0f * balancer.load(iServer))));
+	}
+
+	if (iMoves < 1) {
+		appendMessages(tr("Channels are best kept where they are (%1).")
+			.arg(loads.join("; ")));
+		return;
+	}
+
+	// Last chance to back out...
+	if (QMessageBox::warning(this,
+		QSAMPLER_TITLE ": " + tr("Warning"),
+		tr("About to move %1 of %2 channels to other servers:\n\n"
+		"%3\n\n"
+		"Moved channels will be removed from this server,\n"
+		"as soon as their instruments are loaded there.\n\n"
+		"Are you sure?")
+		.arg(iMoves).arg(channels.count()).arg(loads.join("\n")),
+		QMessageBox::Ok | QMessageBox::Cancel) == QMessageBox::Cancel)
+		return;
+
+	// Local channels keep playing until the remote ones are ready...
+	balancer.dispatch();
+	QProgressDialog progress(
+		tr("Loading instruments on other servers..."), tr("Cancel"),
+		0, iMoves, this);
+	progress.setWindowTitle(QSAMPLER_TITLE ": " + tr("Distribute Channels"));
+	progress.setWindowModality(Qt::WindowModal);
+	progress.setMinimumDuration(500);
+	while (!balancer.wait(QSAMPLER_TIMER_MSECS)) {
+		progress.setValue(balancer.loaded());
+		QApplication::processEvents();
+		if (progress.wasCanceled())
+			balancer.cancel();
+	}
+	progress.setValue(iMoves);
+
+	// Remove the moved (and fully loaded) ones from here...
+	int iPlaced = 0;
+	m_pWorkspace->setUpdatesEnabled(false);
+	demand_iter.toFront();
+	while (demand_iter.hasNext()) {
+		const LoadBalancer::Demand& demand = demand_iter.next();
+		if (demand.iRemoteChannel < 0)
+			continue;
+		appendMessages(tr("Channel %1 moved to server %2 as channel %3.")
+			.arg(demand.iChannelID)
+			.arg(LoadBalancer::serverName(balancer.server(demand.iServer)))
+			.arg(demand.iRemoteChannel));
+		// Might have gone away while waiting...
+		ChannelStrip *pChannelStrip = channelStrip(demand.iChannelID);
+		if (pChannelStrip && pChannelStrip->channel()->removeChannel())
+			destroyChannelStrip(pChannelStrip);
+		++iPlaced;
 	}
 	m_pWorkspace->setUpdatesEnabled(true);
+
+	const QStringList& errors = balancer.errors();
+	for (int i = iConnectErrors; i < errors.count(); ++i)
+		appendMessagesColor(errors.at(i), "#996633");
+
+	appendMessages(tr("%1 of %2 channels distributed (%3).")
+		.arg(iPlaced).arg(iMoves).arg(loads.join("; ")));
+
+	if (iPlaced > 0)
+		m_iDirtyCount++;
+
+	stabilizeForm();
 }
 
 
@@ -1758,6 +3185,120 @@ void MainForm::viewDevices (void)
 }
 
 
+// Show/hide the LSCP event inspector form.
+void MainForm::viewEvents (void)
+{
+	if (m_pOptions == NULL)
+		return;
+
+	if (m_pEventsForm) {
+		m_pOptions->saveWidgetGeometry(m_pEventsForm);
+		if (m_pEventsForm->isVisible()) {
+			m_pEventsForm->hide();
+		} else {
+			m_pEventsForm->show();
+			m_pEventsForm->raise();
+			m_pEventsForm->activateWindow();
+		}
+	}
+}
+
+
+// Show/hide the instrument switch latency form.
+void MainForm::viewSwitches (void)
+{
+	if (m_pOptions == NULL)
+		return;
+
+	if (m_pSwitchesForm) {
+		m_pOptions->saveWidgetGeometry(m_pSwitchesForm);
+		if (m_pSwitchesForm->isVisible()) {
+			m_pSwitchesForm->hide();
+		} else {
+			m_pSwitchesForm->show();
+			m_pSwitchesForm->raise();
+			m_pSwitchesForm->activateWindow();
+		}
+	}
+}
+
+
+// Show/hide the storage advisor form.
+void MainForm::viewStorage (void)
+{
+	if (m_pOptions == NULL)
+		return;
+
+	if (m_pStorageForm) {
+		m_pOptions->saveWidgetGeometry(m_pStorageForm);
+		if (m_pStorageForm->isVisible()) {
+			m_pStorageForm->hide();
+		} else {
+			m_pStorageForm->show();
+			m_pStorageForm->raise();
+			m_pStorageForm->activateWindow();
+		}
+	}
+}
+
+
+// Show/hide the load test form.
+void MainForm::viewLoadTest (void)
+{
+	if (m_pOptions == NULL)
+		return;
+
+	if (m_pLoadTestForm) {
+		m_pOptions->saveWidgetGeometry(m_pLoadTestForm);
+		if (m_pLoadTestForm->isVisible()) {
+			m_pLoadTestForm->hide();
+		} else {
+			m_pLoadTestForm->show();
+			m_pLoadTestForm->raise();
+			m_pLoadTestForm->activateWindow();
+		}
+	}
+}
+
+
+// Show/hide the instruments DB import form.
+void MainForm::viewDbImport (void)
+{
+	if (m_pOptions == NULL)
+		return;
+
+	if (m_pDbImportForm) {
+		m_pOptions->saveWidgetGeometry(m_pDbImportForm);
+		if (m_pDbImportForm->isVisible()) {
+			m_pDbImportForm->hide();
+		} else {
+			m_pDbImportForm->show();
+			m_pDbImportForm->raise();
+			m_pDbImportForm->activateWindow();
+		}
+	}
+}
+
+
+// Show/hide the resources monitor form.
+void MainForm::viewResources (void)
+{
+	if (m_pOptions == NULL)
+		return;
+
+	if (m_pResourcesForm) {
+		m_pOptions->saveWidgetGeometry(m_pResourcesForm);
+		if (m_pResourcesForm->isVisible()) {
+			m_pResourcesForm->hide();
+		} else {
+			m_pResourcesForm->show();
+			m_pResourcesForm->raise();
+			m_pResourcesForm->activateWindow();
+		}
+	}
+}
+
+
 // Show options dialog.
 void MainForm::viewOptions (void)
 {
@@ -1790,8 +3331,14 @@ void MainForm::viewOptions (void)
 		int     iOldMessagesLimitLines = m_pOptions->iMessagesLimitLines;
 		bool    bOldCompletePath    = m_pOptions->bCompletePath;
 		bool    bOldInstrumentNames = m_pOptions->bInstrumentNames;
+		bool    bOldServerInstrumentNames = m_pOptions->bServerInstrumentNames;
 		int     iOldMaxRecentFiles  = m_pOptions->iMaxRecentFiles;
 		int     iOldBaseFontSize    = m_pOptions->iBaseFontSize;
+		QString sOldServerCpus      = m_pOptions->sServerCpus;
+		QString sOldGuiCpus         = m_pOptions->sGuiCpus;
+		int     iOldServerSchedPolicy   = m_pOptions->iServerSchedPolicy;
+		int     iOldServerSchedPriority = m_pOptions->iServerSchedPriority;
+		int     iOldServerMemlock   = m_pOptions->iServerMemlock;
 		// Load the current setup settings.
 		pOptionsForm->setup(m_pOptions);
 		// Show the setup dialog...
@@ -1818,6 +3365,12 @@ void MainForm::viewOptions (void)
 				(!bOldCompletePath &&  m_pOptions->bCompletePath) ||
 				(iOldMaxRecentFiles != m_pOptions->iMaxRecentFiles))
 				updateRecentFilesMenu();
+			if (( bOldServerInstrumentNames && !m_pOptions->bServerInstrumentNames) ||
+				(!bOldServerInstrumentNames &&  m_pOptions->bServerInstrumentNames)) {
+				m_pInstrumentCache->invalidate();
+				updateInstrumentNames();
+			}
+			else
 			if (( bOldInstrumentNames && !m_pOptions->bInstrumentNames) ||
 				(!bOldInstrumentNames &&  m_pOptions->bInstrumentNames))
 				updateInstrumentNames();
@@ -1834,6 +3387,18 @@ void MainForm::viewOptions (void)
 				(!bOldMessagesLimit &&  m_pOptions->bMessagesLimit) ||
 				(iOldMessagesLimitLines !=  m_pOptions->iMessagesLimitLines))
 				updateMessagesLimit();
+			if (sOldGuiCpus != m_pOptions->sGuiCpus)
+				updateGuiAffinity();
+			// Server scheduling is only applied on (re)start.
+			if ((sOldServerCpus != m_pOptions->sServerCpus ||
+				iOldServerSchedPolicy != m_pOptions->iServerSchedPolicy ||
+				iOldServerSchedPriority != m_pOptions->iServerSchedPriority ||
+				iOldServerMemlock != m_pOptions->iServerMemlock)
+				&& m_pOptions->bServerStart && m_pServer) {
+				appendMessagesColor(
+					tr("Server scheduling changes will be effective "
+					"on next server start."), "#996633");
+			}
 			// And now the main thing, whether we'll do client/server recycling?
 			if ((sOldServerHost != m_pOptions->sServerHost) ||
 				(iOldServerPort != m_pOptions->iServerPort) ||
@@ -2000,6 +3565,11 @@ void MainForm::helpAbout (void)
 	sText += gig::libraryVersion().c_str();
 #endif
 	sText += "<br />\n";
+	// What the connected server has to offer, if any...
+	if (m_pClient) {
+		sText += "<br />\n";
+		sText += m_pServerCaps->summary();
+	}
 	sText += "<br />\n";
 	sText += tr("Website") + ": <a href=\"" QSAMPLER_WEBSITE "\">" QSAMPLER_WEBSITE "</a><br />\n";
 	sText += "<br />\n";
@@ -2036,8 +3606,15 @@ void MainForm::stabilizeForm (void)
 	m_ui.fileOpenAction->setEnabled(bHasClient);
 	m_ui.fileSaveAction->setEnabled(bHasClient && m_iDirtyCount > 0);
 	m_ui.fileSaveAsAction->setEnabled(bHasClient);
+	m_ui.fileCollectAction->setEnabled(bHasClient);
 	m_ui.fileResetAction->setEnabled(bHasClient);
 	m_ui.fileRestartAction->setEnabled(bHasClient || m_pServer == NULL);
+	m_ui.fileStageAction->setEnabled(bHasClient);
+	m_ui.fileSwitchAction->setEnabled(bHasClient && m_pSessionStage != NULL);
+	m_ui.fileMirrorAction->setEnabled(bHasClient || m_pMirror != NULL);
+	m_ui.fileMirrorAction->setChecked(m_pMirror != NULL);
+	m_ui.fileFailoverAction->setEnabled(m_pMirror != NULL);
+	m_ui.fileScriptAction->setEnabled(bHasClient);
 	m_ui.editAddChannelAction->setEnabled(bHasClient);
 	m_ui.editRemoveChannelAction->setEnabled(bHasChannel);
 	m_ui.editSetupChannelAction->setEnabled(bHasChannel);
@@ -2048,6 +3625,12 @@ void MainForm::stabilizeForm (void)
 #endif
 	m_ui.editResetChannelAction->setEnabled(bHasChannel);
 	m_ui.editResetAllChannelsAction->setEnabled(bHasChannels);
+	m_ui.editCriticalChannelAction->setEnabled(bHasChannel);
+	m_ui.editDistributeChannelsAction->setEnabled(bHasChannels);
+	m_ui.editSaveTemplateAction->setEnabled(bHasChannel);
+	m_ui.editInstantiateTemplateAction->setEnabled(bHasClient);
+	m_ui.editCriticalChannelAction->setChecked(bHasChannel
+		&& pChannelStrip->channel()->isCritical());
 	m_ui.viewMessagesAction->setChecked(m_pMessages && m_pMessages->isVisible());
 #ifdef CONFIG_MIDI_INSTRUMENT
 	m_ui.viewInstrumentsAction->setChecked(m_pInstrumentListForm
@@ -2059,6 +3642,22 @@ void MainForm::stabilizeForm (void)
 	m_ui.viewDevicesAction->setChecked(m_pDeviceForm
 		&& m_pDeviceForm->isVisible());
 	m_ui.viewDevicesAction->setEnabled(bHasClient);
+	m_ui.viewEventsAction->setChecked(m_pEventsForm
+		&& m_pEventsForm->isVisible());
+	m_ui.viewSwitchesAction->setChecked(m_pSwitchesForm
+		&& m_pSwitchesForm->isVisible());
+	m_ui.viewStorageAction->setChecked(m_pStorageForm
+		&& m_pStorageForm->isVisible());
+	m_ui.viewLoadTestAction->setChecked(m_pLoadTestForm
+		&& m_pLoadTestForm->isVisible());
+	if (m_pLoadTestForm)
+		m_pLoadTestForm->stabilizeForm();
+	m_ui.viewDbImportAction->setChecked(m_pDbImportForm
+		&& m_pDbImportForm->isVisible());
+	if (m_pDbImportForm)
+		m_pDbImportForm->stabilizeForm();
+	m_ui.viewResourcesAction->setChecked(m_pResourcesForm
+		&& m_pResourcesForm->isVisible());
 	m_ui.viewMidiDeviceStatusMenu->setEnabled(
 		DeviceStatusForm::getInstances().size() > 0);
 	m_ui.channelsArrangeAction->setEnabled(bHasChannels);
@@ -2071,7 +3670,8 @@ void MainForm::stabilizeForm (void)
 
 	// Client/Server status...
 	if (bHasClient) {
-		m_statusItem[QSAMPLER_STATUS_CLIENT]->setText(tr("Connected"));
+		m_statusItem[QSAMPLER_STATUS_CLIENT]->setText(m_bServerResponsive
+			? tr("Connected") : tr("Not responding"));
 		m_statusItem[QSAMPLER_STATUS_SERVER]->setText(m_pOptions->sServerHost
 			+ ':' + QString::number(m_pOptions->iServerPort));
 	} else {
@@ -2137,6 +3737,7 @@ void MainForm::channelStripChanged ( ChannelStrip *pChannelStrip )
 
 	// Just mark the dirty form.
 	m_iDirtyCount++;
+	m_bSnapshotDirty = true;
 	// and update the form status...
 	stabilizeForm();
 }
@@ -2283,7 +3884,10 @@ void MainForm::updateInstrumentNames (void)
 
 	m_pWorkspace->setUpdatesEnabled(false);
 	for (int iChannel = 0; iChannel < (int) wlist.count(); ++iChannel) {
-		ChannelStrip *pChannelStrip = (ChannelStrip *) wlist.at(iChannel);
+		ChannelStrip *pChannelStrip = NULL;
+		QMdiSubWindow *pMdiSubWindow = wlist.at(iChannel);
+		if (pMdiSubWindow)
+			pChannelStrip = static_cast<ChannelStrip *> (pMdiSubWindow->widget());
 		if (pChannelStrip)
 			pChannelStrip->updateInstrumentName(true);
 	}
@@ -2291,6 +3895,147 @@ void MainForm::updateInstrumentNames (void)
 }
 
 
+// Instrument file list arrival (server-side enumeration).
+void MainForm::instrumentListChanged ( const QString& sInstrumentFile )
+{
+	QList<QMdiSubWindow *> wlist = m_pWorkspace->subWindowList();
+	for (int iChannel = 0; iChannel < (int) wlist.count(); ++iChannel) {
+		ChannelStrip *pChannelStrip = NULL;
+		QMdiSubWindow *pMdiSubWindow = wlist.at(iChannel);
+		if (pMdiSubWindow)
+			pChannelStrip = static_cast<ChannelStrip *> (pMdiSubWindow->widget());
+		if (pChannelStrip && pChannelStrip->channel()
+			&& pChannelStrip->channel()->instrumentFile() == sInstrumentFile)
+			pChannelStrip->updateInstrumentName(true);
+	}
+}
+
+
+// Instrument file change watcher: only the (local) files in use
+// by channels and MIDI instrument map entries are to be watched.
+void MainForm::updateInstrumentWatches (void)
+{
+	if (m_pClient == NULL)
+		return;
+
+	QSet<QString> files = m_pMapIndex->instrumentFiles().toSet();
+	QList<QMdiSubWindow *> wlist = m_pWorkspace->subWindowList();
+	for (int iChannel = 0; iChannel < (int) wlist.count(); ++iChannel) {
+		ChannelStrip *pChannelStrip = NULL;
+		QMdiSubWindow *pMdiSubWindow = wlist.at(iChannel);
+		if (pMdiSubWindow)
+			pChannelStrip = static_cast<ChannelStrip *> (pMdiSubWindow->widget());
+		if (pChannelStrip && pChannelStrip->channel()
+			&& !pChannelStrip->channel()->instrumentFile().isEmpty())
+			files.insert(pChannelStrip->channel()->instrumentFile());
+	}
+
+	// Unwatch the ones not in use anymore...
+	QStringList stale;
+	QStringListIterator iter(m_pFileWatcher->files());
+	while (iter.hasNext()) {
+		const QString& sInstrumentFile = iter.next();
+		if (!files.remove(sInstrumentFile))
+			stale.append(sInstrumentFile);
+	}
+	if (!stale.isEmpty())
+		m_pFileWatcher->removePaths(stale);
+
+	// Watch the new ones (only local files may be watched)...
+	QSetIterator<QString> iter2(files);
+	while (iter2.hasNext()) {
+		const QString& sInstrumentFile = iter2.next();
+		if (QFileInfo(sInstrumentFile).exists())
+			m_pFileWatcher->addPath(sInstrumentFile);
+	}
+}
+
+
+// Instrument file change notification.
+void MainForm::instrumentFileChanged ( const QString& sInstrumentFile )
+{
+	// Cached instrument names are now stale...
+	m_pInstrumentCache->invalidate(sInstrumentFile);
+
+	// Files saved through rename/replace get dropped from watch.
+	updateInstrumentWatches();
+
+	if (m_changedFiles.contains(sInstrumentFile))
+		return;
+
+	// Let it settle a while (eg. large files being written)...
+	if (m_changedFiles.isEmpty()) {
+		QTimer::singleShot(QSAMPLER_RELOAD_MSECS,
+			this, SLOT(reloadInstrumentFiles()));
+	}
+
+	m_changedFiles.append(sInstrumentFile);
+}
+
+
+// Reload only the channels and MIDI instrument map entries
+// which are using any of the changed instrument files.
+void MainForm::reloadInstrumentFiles (void)
+{
+	const QStringList changedFiles = m_changedFiles;
+	m_changedFiles.clear();
+
+	if (m_pClient == NULL || changedFiles.isEmpty())
+		return;
+
+	// Which channels are affected?
+	QList<ChannelStrip *> strips;
+	QList<QMdiSubWindow *> wlist = m_pWorkspace->subWindowList();
+	for (int iChannel = 0; iChannel < (int) wlist.count(); ++iChannel) {
+		ChannelStrip *pChannelStrip = NULL;
+		QMdiSubWindow *pMdiSubWindow = wlist.at(iChannel);
+		if (pMdiSubWindow)
+			pChannelStrip = static_cast<ChannelStrip *> (pMdiSubWindow->widget());
+		if (pChannelStrip && pChannelStrip->channel()
+			&& changedFiles.contains(pChannelStrip->channel()->instrumentFile()))
+			strips.append(pChannelStrip);
+	}
+
+	// Which MIDI instrument map entries are affected?
+	QList<Instrument> instruments;
+	QStringListIterator iter_changed(changedFiles);
+	while (iter_changed.hasNext())
+		instruments += m_pMapIndex->instruments(iter_changed.next());
+
+	if (!strips.isEmpty() || !instruments.isEmpty()) {
+		// Prompt user if this is for real...
+		if (QMessageBox::question(this,
+			QSAMPLER_TITLE ": " + tr("Information"),
+			tr("Instrument file(s) changed on disk:\n\n"
+			"%1\n\n"
+			"Do you want to reload the %2 channel(s) and\n"
+			"%3 MIDI instrument map entries using them?")
+			.arg(changedFiles.join("\n"))
+			.arg(strips.count())
+			.arg(instruments.count()),
+			QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes) {
+			// Non-modal loads just get queued on the server side
+			// (and loaded one after the other) so we won't block...
+			QListIterator<ChannelStrip *> iter(strips);
+			while (iter.hasNext()) {
+				ChannelStrip *pChannelStrip = iter.next();
+				if (pChannelStrip->channel()->reloadInstrument())
+					channelStripChanged(pChannelStrip);
+			}
+			// Re-mapping is enough for map entries to reload...
+			QMutableListIterator<Instrument> iter_instr(instruments);
+			while (iter_instr.hasNext())
+				iter_instr.next().mapInstrument();
+		}
+	}
+
+	// Refresh any stale instrument names anyway...
+	QStringListIterator iter_file(changedFiles);
+	while (iter_file.hasNext())
+		instrumentListChanged(iter_file.next());
+}
+
+
 // Force update of the channels display font.
 void MainForm::updateDisplayFont (void)
 {
@@ -2403,6 +4148,14 @@ void MainForm::appendMessagesText( const QString& s )
 
 void MainForm::appendMessagesError( const QString& sText )
 {
+	// Headless runs have no one to pop anything up to...
+	if (m_pOptions && m_pOptions->bHeadless) {
+		appendMessagesColor(sText.simplified(), "#ff0000");
+		::fputs((sText.simplified() + '\n').toUtf8().constData(), stderr);
+		::fflush(stderr);
+		return;
+	}
+
 	if (m_pMessages)
 		m_pMessages->show();
 
@@ -2482,8 +4235,27 @@ void MainForm::updateMessagesCapture (void)
 	if (m_pOptions == NULL)
 		return;
 
-	if (m_pMessages)
-		m_pMessages->setCaptureEnabled(m_pOptions->bStdoutCapture);
+	// Headless runs keep the standard output for themselves.
+	if (m_pMessages) {
+		m_pMessages->setCaptureEnabled(
+			m_pOptions->bStdoutCapture && !m_pOptions->bHeadless);
+	}
+}
+
+
+// Pin our own threads to the CPU set of choice (if any).
+void MainForm::updateGuiAffinity (void)
+{
+	if (m_pOptions == NULL)
+		return;
+
+	// Nothing to pin? the original CPU set gets restored, but only
+	// if we've ever pinned ourselves before; left alone otherwise.
+	const QStringList& diags
+		= ServerProcess::setSelfAffinity(m_pOptions->sGuiCpus);
+	QStringListIterator iter(diags);
+	while (iter.hasNext())
+		appendMessagesColor(iter.next(), "#996633");
 }
 
 
@@ -2546,6 +4318,9 @@ void MainForm::destroyChannelStrip ( ChannelStrip *pChannelStrip )
 	delete pChannelStrip;
 	delete pMdiSubWindow;
 
+	// Its instrument file might not be in use anymore...
+	updateInstrumentWatches();
+
 	// Do we auto-arrange?
 	if (m_pOptions && m_pOptions->bAutoArrange)
 		channelsArrange();
@@ -2689,22 +4464,68 @@ void MainForm::timerSlot (void)
 	}
 
 	if (m_pClient) {
+		// Periodic stuff is background work: short deadlines...
+		ServerCall call(m_pClient, ServerCall::Background);
+		// Not responding? fail fast, but probe it once in a while...
+		if (!call.isValid()) {
+			m_iProbeTimer += QSAMPLER_TIMER_MSECS;
+			if (m_iProbeTimer >= QSAMPLER_PROBE_MSECS) {
+				m_iProbeTimer = 0;
+				if (::lscp_get_channels(m_pClient) >= 0)
+					ServerCall::setResponsive(true);
+			}
+			call.check();
+		}
 		// Update the channel information for each pending strip...
+		bool bWatches = false;
 		QListIterator<ChannelStrip *> iter(m_changedStrips);
-		while (iter.hasNext()) {
+		while (iter.hasNext() && call.isValid()) {
 			ChannelStrip *pChannelStrip = iter.next();
 			// If successfull, remove from pending list...
-			if (pChannelStrip->updateChannelInfo()) {
+			const bool bUpdated = pChannelStrip->updateChannelInfo();
+			// Keep track of instrument switch latencies...
+			if (m_pSwitchesForm)
+				m_pSwitchesForm->channelUpdated(
+					pChannelStrip->channel(), timestamp());
+			if (bUpdated) {
+				// Only actual changes are worth a new snapshot...
+				if (pChannelStrip->channel()->isInfoChanged())
+					m_bSnapshotDirty = true;
+				instrumentLoaded(pChannelStrip->channel());
 				int iChannelStrip = m_changedStrips.indexOf(pChannelStrip);
 				if (iChannelStrip >= 0)
 					m_changedStrips.removeAt(iChannelStrip);
+				// Keep an eye on its instrument file...
+				bWatches = true;
+			}
+			call.check();
+		}
+		if (bWatches)
+			updateInstrumentWatches();
+		// Keep the last known state at hand, for the watchdog
+		// or the standby server, which is way more eager...
+		if (m_bSnapshotDirty && call.isValid()
+			&& (m_pMirror || (m_pServer && m_pOptions->bServerWatchdog))) {
+			m_iSnapshotTimer += QSAMPLER_TIMER_MSECS;
+			if (m_iSnapshotTimer >= (m_pMirror
+				? QSAMPLER_MIRROR_MSECS : QSAMPLER_SNAPSHOT_MSECS)) {
+				m_iSnapshotTimer = 0;
+				updateSnapshot();
 			}
 		}
 		// Refresh each channel usage, on each period...
-		if (m_pOptions->bAutoRefresh) {
+		if (m_pOptions->bAutoRefresh && call.check()) {
 			m_iTimerSlot += QSAMPLER_TIMER_MSECS;
 			if (m_iTimerSlot >= m_pOptions->iAutoRefreshTime)  {
 				m_iTimerSlot = 0;
+				// No channel events? poll for channel changes instead...
+				const bool bChannelPoll
+					= !m_pServerCaps->has(ServerCaps::ChannelEvents);
+				if (bChannelPoll && ::lscp_get_channels(m_pClient)
+						!= m_pWorkspace->subWindowList().count()) {
+					updateAllChannelStrips(true);
+					m_bSnapshotDirty = true;
+				}
 				// Update the channel stream usage for each strip...
 				QList<QMdiSubWindow *> wlist = m_pWorkspace->subWindowList();
 				for (int iChannel = 0; iChannel < (int) wlist.count(); ++iChannel) {
@@ -2712,11 +4533,29 @@ void MainForm::timerSlot (void)
 					QMdiSubWindow *pMdiSubWindow = wlist.at(iChannel);
 					if (pMdiSubWindow)
 						pChannelStrip = static_cast<ChannelStrip *> (pMdiSubWindow->widget());
-					if (pChannelStrip && pChannelStrip->isVisible())
+					if (pChannelStrip && pChannelStrip->isVisible()) {
 						pChannelStrip->updateChannelUsage();
+						if (bChannelPoll
+							&& !m_changedStrips.contains(pChannelStrip))
+							m_changedStrips.append(pChannelStrip);
+						if (!call.check())
+							break;
+					}
 				}
 			}
 		}
+		// Let it be known whether the server is (still) answering...
+		if (m_bServerResponsive != ServerCall::isResponsive()) {
+			m_bServerResponsive = ServerCall::isResponsive();
+			if (m_bServerResponsive) {
+				appendMessages(tr("Server is responding again."));
+			} else {
+				appendMessagesColor(tr("Server is not responding: "
+					"requests will fail fast until it answers again."),
+					"#996633");
+			}
+			stabilizeForm();
+		}
 	}
 
 	// Register the next timer slot.
@@ -2739,6 +4578,12 @@ void MainForm::startServer (void)
 
 	// Is the server process instance still here?
 	if (m_pServer) {
+		if (m_pOptions->bHeadless) {
+			appendMessagesError(tr("Could not start the LinuxSampler server.\n\n"
+				"Maybe it is already started."));
+			QApplication::exit(1);
+		}
+		else
 		if (QMessageBox::warning(this,
 			QSAMPLER_TITLE ": " + tr("Warning"),
 			tr("Could not start the LinuxSampler server.\n\n"
@@ -2758,8 +4603,20 @@ void MainForm::startServer (void)
 		return;
 
 	// OK. Let's build the startup process...
-	m_pServer = new QProcess();
+	ServerProcess *pServer = new ServerProcess();
+	if (!pServer->setSchedSetup(
+			m_pOptions->sServerCpus,
+			m_pOptions->iServerSchedPolicy,
+			m_pOptions->iServerSchedPriority,
+			m_pOptions->iServerMemlock)
+		&& ServerProcess::isSchedSupported()) {
+		appendMessagesColor(
+			tr("Invalid server CPU list: \"%1\".")
+			.arg(m_pOptions->sServerCpus), "#996633");
+	}
+	m_pServer = pServer;
 	bForceServerStop = true;
+	m_bServerStopping = false;
 
 	// Setup stdout/stderr capture...
 //	if (m_pOptions->bStdoutCapture) {
@@ -2790,6 +4647,9 @@ void MainForm::startServer (void)
 	if (!m_pServer->waitForStarted()) {
 		appendMessagesError(tr("Could not start server.\n\nSorry."));
 		processServerExit();
+		// Headless runs have nothing else to do...
+		if (m_pOptions->bHeadless)
+			QApplication::exit(1);
 		return;
 	}
 
@@ -2797,6 +4657,25 @@ void MainForm::startServer (void)
 	appendMessages(
 		tr("Server was started with PID=%1.").arg((long) m_pServer->pid()));
 
+	// Check whether the scheduling setup has been honored...
+	if (pServer->isSchedSetup()) {
+		const QStringList& diags = pServer->verifySchedSetup();
+		QStringListIterator iter(diags);
+		if (iter.hasNext())
+			appendMessages(iter.next());
+		while (iter.hasNext())
+			appendMessagesColor(iter.next(), "#996633");
+	}
+
+	// Get the startup session ready, while the server is booting...
+	// (not on a watchdog restart, the last known state goes instead)...
+	if (!m_pOptions->sSessionFile.isEmpty() && m_pSessionThread == NULL
+		&& !m_bWatchdogRestore) {
+		m_pSessionThread = new SessionThread(
+			m_pOptions->sSessionFile, m_pOptions->bInstrumentNames);
+		m_pSessionThread->start();
+	}
+
 	// Reset (yet again) the timer counters,
 	// but this time is deferred as the user opted.
 	startSchedule(m_pOptions->iStartDelay);
@@ -2807,6 +4686,10 @@ void MainForm::startServer (void)
 // Stop linuxsampler server...
 void MainForm::stopServer (bool bInteractive)
 {
+	// This is no crash, for sure.
+	m_bServerStopping = true;
+	m_bWatchdogRestore = false;
+
 	// Stop client code.
 	stopClient();
 
@@ -2859,6 +4742,13 @@ void MainForm::readServerStdout (void)
 // Linuxsampler server cleanup.
 void MainForm::processServerExit (void)
 {
+	// Did it just crash, while being watched?
+	const bool bCrashed = (m_pServer && sender() == m_pServer
+		&& !m_bServerStopping && m_pOptions
+		&& m_pOptions->bServerStart && m_pOptions->bServerWatchdog);
+	if (bCrashed)
+		m_iSnapshotDirtyCount = m_iDirtyCount;
+
 	// Force client code cleanup.
 	stopClient();
 
@@ -2885,11 +4775,42 @@ void MainForm::processServerExit (void)
 		m_pServer = NULL;
 	}
 
+	// Watchdog: have it back, the sooner the better...
+	if (bCrashed) {
+		if (m_watchdogTime.isNull()
+			|| m_watchdogTime.elapsed() > QSAMPLER_WATCHDOG_MSECS) {
+			m_watchdogTime.start();
+			m_iWatchdogRestarts = 0;
+		}
+		if (++m_iWatchdogRestarts > QSAMPLER_WATCHDOG_RESTARTS) {
+			appendMessagesError(
+				tr("Server crashed %1 times in a row.\n\n"
+				"Automatic restart is given up.").arg(m_iWatchdogRestarts - 1));
+			if (m_pOptions->bHeadless)
+				QApplication::exit(1);
+		} else {
+			appendMessagesColor(tr("Server crashed; restarting..."), "#cc0000");
+			m_bWatchdogRestore = !m_sSnapshot.isEmpty();
+			QTimer::singleShot(QSAMPLER_TIMER_MSECS, this, SLOT(watchdogRestart()));
+		}
+	}
+
 	// Again, make status visible stable.
 	stabilizeForm();
 }
 
 
+// Server watchdog restart slot.
+void MainForm::watchdogRestart (void)
+{
+	// Might have been given up meanwhile...
+	if (m_pServer || m_pClient)
+		return;
+
+	startServer();
+}
+
+
 //-------------------------------------------------------------------------
 // qsamplerMainForm -- Client stuff.
 
@@ -2905,7 +4826,7 @@ lscp_status_t qsampler_client_callback ( lscp_client_t */*pClient*/,
 	// as this is run under some other thread context.
 	// A custom event must be posted here...
 	QApplication::postEvent(pMainForm,
-		new LscpEvent(event, pchData, cchData));
+		new LscpEvent(event, pchData, cchData, pMainForm->timestamp()));
 
 	return LSCP_OK;
 }
@@ -2936,6 +4857,11 @@ bool MainForm::startClient (void)
 			|| !m_pOptions->bServerStart) {
 			appendMessagesError(
 				tr("Could not connect to server as client.\n\nSorry."));
+			// Headless runs won't retry forever...
+			if (m_pOptions->bHeadless) {
+				stopSchedule();
+				QApplication::exit(1);
+			}
 		} else {
 			startServer();
 		}
@@ -2949,11 +4875,25 @@ bool MainForm::startClient (void)
 		tr("Client receive timeout is set to %1 msec.")
 		.arg(::lscp_client_get_timeout(m_pClient)));
 
-	// Subscribe to channel info change notifications...
-	if (::lscp_client_subscribe(m_pClient, LSCP_EVENT_CHANNEL_COUNT) != LSCP_OK)
-		appendMessagesClient("lscp_client_subscribe(CHANNEL_COUNT)");
-	if (::lscp_client_subscribe(m_pClient, LSCP_EVENT_CHANNEL_INFO) != LSCP_OK)
-		appendMessagesClient("lscp_client_subscribe(CHANNEL_INFO)");
+	// Deadlines per call class, and a fresh start on responsiveness.
+	ServerCall::setDeadline(ServerCall::Interactive, m_pOptions->iServerTimeout);
+	ServerCall::setDeadline(ServerCall::Background, m_pOptions->iBackgroundTimeout);
+	ServerCall::setDeadline(ServerCall::Bulk, m_pOptions->iBulkTimeout);
+	ServerCall::setResponsive(true);
+	m_bServerResponsive = true;
+	m_iProbeTimer = 0;
+
+	// Find out what this very server has to offer...
+	m_pServerCaps->probe(m_pClient);
+
+	// Subscribe to channel info change notifications,
+	// otherwise we'll have to poll for them...
+	if (::lscp_client_subscribe(m_pClient, LSCP_EVENT_CHANNEL_COUNT) != LSCP_OK
+		|| ::lscp_client_subscribe(m_pClient, LSCP_EVENT_CHANNEL_INFO) != LSCP_OK) {
+		m_pServerCaps->setSupported(ServerCaps::ChannelEvents, false);
+		appendMessages(tr("Channel events not supported: "
+			"polling channels instead."));
+	}
 
 	DeviceStatusForm::onDevicesChanged(); // initialize
 	updateViewMidiDeviceStatusMenu();
@@ -2967,26 +4907,61 @@ bool MainForm::startClient (void)
 		appendMessagesClient("lscp_client_subscribe(AUDIO_OUTPUT_DEVICE_INFO)");
 
 #if CONFIG_EVENT_CHANNEL_MIDI
-	// Subscribe to channel MIDI data notifications...
-	if (::lscp_client_subscribe(m_pClient, LSCP_EVENT_CHANNEL_MIDI) != LSCP_OK)
-		appendMessagesClient("lscp_client_subscribe(CHANNEL_MIDI)");
+	// Subscribe to channel MIDI data notifications, if any...
+	if (m_pServerCaps->has(ServerCaps::ChannelMidiEvents)) {
+		const bool bSubscribed = (::lscp_client_subscribe(
+			m_pClient, LSCP_EVENT_CHANNEL_MIDI) == LSCP_OK);
+		m_pServerCaps->setSupported(ServerCaps::ChannelMidiEvents, bSubscribed);
+		if (!bSubscribed)
+			appendMessages(tr("Channel MIDI events not supported."));
+	}
 #endif
 
 #if CONFIG_EVENT_DEVICE_MIDI
-	// Subscribe to channel MIDI data notifications...
-	if (::lscp_client_subscribe(m_pClient, LSCP_EVENT_DEVICE_MIDI) != LSCP_OK)
-		appendMessagesClient("lscp_client_subscribe(DEVICE_MIDI)");
+	// Subscribe to device MIDI data notifications, if any...
+	if (m_pServerCaps->has(ServerCaps::DeviceMidiEvents)) {
+		const bool bSubscribed = (::lscp_client_subscribe(
+			m_pClient, LSCP_EVENT_DEVICE_MIDI) == LSCP_OK);
+		m_pServerCaps->setSupported(ServerCaps::DeviceMidiEvents, bSubscribed);
+		if (!bSubscribed)
+			appendMessages(tr("Device MIDI events not supported."));
+	}
+#endif
+
+#ifdef CONFIG_MIDI_INSTRUMENT
+	// Subscribe to MIDI instrument map change notifications...
+	if (::lscp_client_subscribe(m_pClient, LSCP_EVENT_MIDI_INSTRUMENT_MAP_COUNT) != LSCP_OK)
+		appendMessagesClient("lscp_client_subscribe(MIDI_INSTRUMENT_MAP_COUNT)");
+	if (::lscp_client_subscribe(m_pClient, LSCP_EVENT_MIDI_INSTRUMENT_MAP_INFO) != LSCP_OK)
+		appendMessagesClient("lscp_client_subscribe(MIDI_INSTRUMENT_MAP_INFO)");
+	if (::lscp_client_subscribe(m_pClient, LSCP_EVENT_MIDI_INSTRUMENT_COUNT) != LSCP_OK)
+		appendMessagesClient("lscp_client_subscribe(MIDI_INSTRUMENT_COUNT)");
+	if (::lscp_client_subscribe(m_pClient, LSCP_EVENT_MIDI_INSTRUMENT_INFO) != LSCP_OK)
+		appendMessagesClient("lscp_client_subscribe(MIDI_INSTRUMENT_INFO)");
+	// Index all map entries, in background...
+	m_pMapIndex->refresh();
 #endif
 
 	// We may stop scheduling around.
 	stopSchedule();
 
+	// Whatever comes next, it's a new state to keep.
+	m_bSnapshotDirty = true;
+	m_iSnapshotTimer = 0;
+
 	// We'll accept drops from now on...
 	setAcceptDrops(true);
 
 	// Log success here.
 	appendMessages(tr("Client connected."));
 
+	// Any script to run, once all is settled?
+	if (!m_pOptions->sScriptFile.isEmpty())
+		QTimer::singleShot(0, this, SLOT(startupScript()));
+	// Or any instruments DB imports?
+	if (!m_pOptions->dbImportPaths.isEmpty())
+		QTimer::singleShot(0, this, SLOT(startupImport()));
+
 	// Hard-notify instrumnet and device configuration forms,
 	// if visible, that we're ready...
 	if (m_pInstrumentListForm)
@@ -2994,6 +4969,14 @@ bool MainForm::startClient (void)
 	if (m_pDeviceForm)
 		m_pDeviceForm->refreshDevices();
 
+	// Is there a last known state to be restored (watchdog)?
+	if (m_bWatchdogRestore) {
+		m_bWatchdogRestore = false;
+		m_pOptions->sendFineTuningSettings();
+		if (restoreSnapshot())
+			return true;
+	}
+
 	// Is any session pending to be loaded?
 	if (!m_pOptions->sSessionFile.isEmpty()) {
 		// Just load the prabably startup session...
@@ -3022,6 +5005,7 @@ void MainForm::stopClient (void)
 
 	// Clear timer counters...
 	stopSchedule();
+	m_iSnapshotTimer = 0;
 
 	// We'll reject drops from now on...
 	setAcceptDrops(false);
@@ -3032,12 +5016,25 @@ void MainForm::stopClient (void)
 	m_iDirtyCount = 0;
 	closeSession(false);
 
+	// Channel IDs are no longer meaningful...
+	if (m_pSwitchesForm)
+		m_pSwitchesForm->resetChannels();
+	m_loadStarts.clear();
+
 	// Close us as a client...
+#ifdef CONFIG_MIDI_INSTRUMENT
+	::lscp_client_unsubscribe(m_pClient, LSCP_EVENT_MIDI_INSTRUMENT_INFO);
+	::lscp_client_unsubscribe(m_pClient, LSCP_EVENT_MIDI_INSTRUMENT_COUNT);
+	::lscp_client_unsubscribe(m_pClient, LSCP_EVENT_MIDI_INSTRUMENT_MAP_INFO);
+	::lscp_client_unsubscribe(m_pClient, LSCP_EVENT_MIDI_INSTRUMENT_MAP_COUNT);
+#endif
 #if CONFIG_EVENT_DEVICE_MIDI
-	::lscp_client_unsubscribe(m_pClient, LSCP_EVENT_DEVICE_MIDI);
+	if (m_pServerCaps->has(ServerCaps::DeviceMidiEvents))
+		::lscp_client_unsubscribe(m_pClient, LSCP_EVENT_DEVICE_MIDI);
 #endif
 #if CONFIG_EVENT_CHANNEL_MIDI
-	::lscp_client_unsubscribe(m_pClient, LSCP_EVENT_CHANNEL_MIDI);
+	if (m_pServerCaps->has(ServerCaps::ChannelMidiEvents))
+		::lscp_client_unsubscribe(m_pClient, LSCP_EVENT_CHANNEL_MIDI);
 #endif
 	::lscp_client_unsubscribe(m_pClient, LSCP_EVENT_AUDIO_OUTPUT_DEVICE_INFO);
 	::lscp_client_unsubscribe(m_pClient, LSCP_EVENT_AUDIO_OUTPUT_DEVICE_COUNT);
@@ -3048,6 +5045,30 @@ void MainForm::stopClient (void)
 	::lscp_client_destroy(m_pClient);
 	m_pClient = NULL;
 
+	// Whatever the next server might be up to...
+	m_pServerCaps->reset();
+
+	// Instrument file lists might be stale from now on...
+	m_pInstrumentCache->reset();
+
+	// So are all map entries.
+	m_pMapIndex->reset();
+
+	// Any queued loads are now pointless...
+	m_pLoadScheduler->reset();
+
+	// So is any script still running.
+#ifdef CONFIG_SCRIPT
+	if (m_pScript)
+		m_pScript->abort(1);
+#endif
+
+	// Stop watching instrument files...
+	const QStringList& files = m_pFileWatcher->files();
+	if (!files.isEmpty())
+		m_pFileWatcher->removePaths(files);
+	m_changedFiles.clear();
+
 	// Hard-notify instrumnet and device configuration forms,
 	// if visible, that we're running out...
 	if (m_pInstrumentListForm)
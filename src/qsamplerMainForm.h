@@ -27,7 +27,13 @@
 
 #include <lscp/client.h>
 
+#include <QTime>
+#include <QElapsedTimer>
+#include <QHash>
+
 class QProcess;
+class QTextStream;
+class QFileSystemWatcher;
 class QMdiArea;
 class QMdiSubWindow;
 class QSocketNotifier;
@@ -42,7 +48,23 @@ class Messages;
 class Channel;
 class ChannelStrip;
 class DeviceForm;
+class EventsForm;
+class SwitchesForm;
+class StorageForm;
+class LoadTestForm;
+class DbImportForm;
+class ResourcesForm;
+class SessionThread;
+class Session;
 class InstrumentListForm;
+class InstrumentCache;
+class MapIndex;
+class ServerCaps;
+class LoadHistory;
+class LoadScheduler;
+class Mirror;
+class SessionStage;
+class Script;
 
 //-------------------------------------------------------------------------
 // QSampler::MainForm -- Main window form implementation.
@@ -62,6 +84,10 @@ public:
 	Options* options() const;
 	lscp_client_t* client() const;
 
+	StorageForm *storageForm() const;
+
+	Messages *messages() const;
+
 	QString sessionName(const QString& sFilename);
 
 	void appendMessages(const QString& sText);
@@ -80,6 +106,11 @@ public:
 
 	static MainForm* getInstance();
 
+	// Monotonic time reference (msecs; thread-safe).
+	qint64 timestamp() const;
+
+	bool runScript(const QString& sFilename);
+
 public slots:
 
 	void fileNew();
@@ -87,21 +118,37 @@ public slots:
 	void fileOpenRecent();
 	void fileSave();
 	void fileSaveAs();
+	void fileCollect();
 	void fileReset();
 	void fileRestart();
+	void fileStage();
+	void fileSwitch();
+	void fileMirror(bool bOn);
+	void fileFailover();
+	void fileScript();
 	void fileExit();
 	void editAddChannel();
 	void editRemoveChannel();
 	void editSetupChannel();
 	void editEditChannel();
+	void editSaveTemplate();
+	void editInstantiateTemplate();
 	void editResetChannel();
 	void editResetAllChannels();
+	void editCriticalChannel(bool bOn);
+	void editDistributeChannels();
 	void viewMenubar(bool bOn);
 	void viewToolbar(bool bOn);
 	void viewStatusbar(bool bOn);
 	void viewMessages(bool bOn);
 	void viewInstruments();
 	void viewDevices();
+	void viewEvents();
+	void viewSwitches();
+	void viewStorage();
+	void viewLoadTest();
+	void viewDbImport();
+	void viewResources();
 	void viewOptions();
 	void channelsArrange();
 	void channelsAutoArrange(bool bOn);
@@ -114,15 +161,31 @@ public slots:
 	void timerSlot();
 	void readServerStdout();
 	void processServerExit();
+	void watchdogRestart();
 	void sessionDirty();
+	void sessionStageReady();
+	void scriptFinished(int iExitCode);
 	void stabilizeForm();
 
+	void instrumentListChanged(const QString& sInstrumentFile);
+
+	void instrumentFileChanged(const QString& sInstrumentFile);
+	void reloadInstrumentFiles();
+
+	void updateInstrumentWatches();
+
 	void handle_sigusr1();
 
 protected slots:
 
 	void updateRecentFilesMenu();
 
+	// Command line supplied script, once connected.
+	void startupScript();
+
+	// Command line supplied instruments DB imports, once connected.
+	void startupImport();
+
 	// Channel strip activation/selection.
 	void activateStrip(QMdiSubWindow *pMdiSubWindow);
 
@@ -142,6 +205,12 @@ protected:
 	bool closeSession(bool bForce);
 	bool loadSessionFile(const QString& sFilename);
 	bool saveSessionFile(const QString& sFilename);
+	int sendSession(const Session& session);
+	void reportLoadTime(const Session& session);
+	void instrumentLoaded(Channel *pChannel);
+	int saveSessionStream(QTextStream& ts, bool bSnapshot);
+	void updateSnapshot();
+	bool restoreSnapshot();
 	void updateSession();
 	void updateRecentFiles(const QString& sFilename);
 	void updateInstrumentNames();
@@ -151,6 +220,7 @@ protected:
 	void updateMessagesFont();
 	void updateMessagesLimit();
 	void updateMessagesCapture();
+	void updateGuiAffinity();
 	void updateViewMidiDeviceStatusMenu();
 	void updateAllChannelStrips(bool bRemoveDeadStrips);
 	void startSchedule(int iStartDelay);
@@ -174,13 +244,44 @@ private:
 	lscp_client_t *m_pClient;
 	QProcess *m_pServer;
 	bool bForceServerStop;
+	bool m_bServerStopping;
+	QString m_sSnapshot;
+	QList<int> m_snapshotCritical;
+	bool m_bSnapshotDirty;
+	int m_iSnapshotTimer;
+	int m_iSnapshotDirtyCount;
+	bool m_bWatchdogRestore;
+	int m_iWatchdogRestarts;
+	QTime m_watchdogTime;
 	int m_iStartDelay;
 	int m_iTimerDelay;
 	int m_iTimerSlot;
+	int m_iProbeTimer;
+	bool m_bServerResponsive;
 	QLabel *m_statusItem[5];
 	QList<ChannelStrip *> m_changedStrips;
 	InstrumentListForm *m_pInstrumentListForm;
 	DeviceForm *m_pDeviceForm;
+	EventsForm *m_pEventsForm;
+	SwitchesForm *m_pSwitchesForm;
+	StorageForm *m_pStorageForm;
+	LoadTestForm *m_pLoadTestForm;
+	DbImportForm *m_pDbImportForm;
+	ResourcesForm *m_pResourcesForm;
+	SessionThread *m_pSessionThread;
+	InstrumentCache *m_pInstrumentCache;
+	MapIndex *m_pMapIndex;
+	ServerCaps *m_pServerCaps;
+	LoadHistory *m_pLoadHistory;
+	LoadScheduler *m_pLoadScheduler;
+	Mirror *m_pMirror;
+	SessionStage *m_pSessionStage;
+	Script *m_pScript;
+	QElapsedTimer m_clock;
+	QHash<int, qint64> m_loadStarts;
+	qint64 m_iLoadDone;
+	QFileSystemWatcher *m_pFileWatcher;
+	QStringList m_changedFiles;
 	static MainForm *g_pMainForm;
 	QSlider *m_pVolumeSlider;
 	QSpinBox *m_pVolumeSpinBox;
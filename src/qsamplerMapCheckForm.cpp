@@ -0,0 +1,452 @@
+// qsamplerMapCheckForm.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerMapCheckForm.h"
+
+#include "qsamplerOptions.h"
+#include "qsamplerMainForm.h"
+#include "qsamplerMapIndex.h"
+
+#include <QApplication>
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QCursor>
+#include <QTimer>
+
+
+namespace QSampler {
+
+// Progress feedback period (msecs).
+#define QSAMPLER_MAP_CHECK_MSECS  200
+
+
+//-------------------------------------------------------------------------
+// QSampler::MapCheckForm -- MIDI instrument map integrity report.
+//
+
+// Constructor.
+MapCheckForm::MapCheckForm ( QWidget *pParent )
+	: QDialog(pParent), m_pChecker(NULL)
+{
+	m_ui.setupUi(this);
+
+	QHeaderView *pHeader = m_ui.IssuesListView->header();
+	pHeader->resizeSection(0, 60);
+	pHeader->resizeSection(1, 48);
+	pHeader->resizeSection(2, 48);
+	pHeader->resizeSection(3, 120);
+	pHeader->resizeSection(4, 240);
+	pHeader->resizeSection(5, 32);
+	pHeader->resizeSection(6, 160);
+	m_ui.IssuesListView->sortByColumn(0, Qt::AscendingOrder);
+
+	m_pTimer = new QTimer(this);
+
+	QObject::connect(m_pTimer,
+		SIGNAL(timeout()),
+		SLOT(checkProgress()));
+	QObject::connect(m_ui.IssuesListView,
+		SIGNAL(itemChanged(QTreeWidgetItem *, int)),
+		SLOT(stabilizeForm()));
+	QObject::connect(m_ui.RelocatePushButton,
+		SIGNAL(clicked()),
+		SLOT(relocateFiles()));
+	QObject::connect(m_ui.ApplyPushButton,
+		SIGNAL(clicked()),
+		SLOT(applyFixes()));
+	QObject::connect(m_ui.ClosePushButton,
+		SIGNAL(clicked()),
+		SLOT(reject()));
+
+	stabilizeForm();
+}
+
+
+// Destructor.
+MapCheckForm::~MapCheckForm (void)
+{
+	if (m_pChecker) {
+		m_pChecker->cancel();
+		delete m_pChecker;
+	}
+}
+
+
+// Start checking (all maps, if negative).
+void MapCheckForm::check ( int iMidiMap,
+	const QMap<int, QList<Instrument> >& cachedMaps )
+{
+	if (m_pChecker)
+		return;
+
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL)
+		return;
+
+	Options *pOptions = pMainForm->options();
+	if (pOptions == NULL)
+		return;
+
+	m_pChecker = new MapChecker(
+		pOptions->sServerHost,
+		pOptions->iServerPort,
+		pOptions->iServerTimeout,
+		iMidiMap);
+
+	// Whatever's already known needs not be asked again...
+	m_pChecker->setCachedMaps(cachedMaps);
+	MapIndex *pMapIndex = MapIndex::getInstance();
+	if (pMapIndex)
+		m_pChecker->setIndexedInstruments(pMapIndex->instruments(iMidiMap));
+	InstrumentCache *pInstrumentCache = InstrumentCache::getInstance();
+	if (pInstrumentCache)
+		m_pChecker->setInstrumentCounts(pInstrumentCache->counts());
+
+	QObject::connect(m_pChecker,
+		SIGNAL(finished()),
+		SLOT(checkFinished()));
+
+	m_ui.StatusTextLabel->setText(tr("Checking MIDI instrument maps..."));
+
+	m_time.start();
+	m_pChecker->start();
+	m_pTimer->start(QSAMPLER_MAP_CHECK_MSECS);
+
+	stabilizeForm();
+}
+
+
+// Maps changed by applied fixes.
+const QSet<int>& MapCheckForm::fixedMaps (void) const
+{
+	return m_fixedMaps;
+}
+
+
+// Progress feedback.
+void MapCheckForm::checkProgress (void)
+{
+	if (m_pChecker == NULL)
+		return;
+
+	const int iFilesTotal = m_pChecker->filesTotal();
+	if (iFilesTotal > 0) {
+		const int iFilesDone = m_pChecker->filesDone();
+		m_ui.CheckProgressBar->setRange(0, iFilesTotal);
+		m_ui.CheckProgressBar->setValue(iFilesDone);
+		m_ui.StatusTextLabel->setText(tr("Checking instrument files (%1 of %2)...")
+			.arg(iFilesDone).arg(iFilesTotal));
+	} else {
+		const int iMappingsTotal = m_pChecker->mappingsTotal();
+		const int iMappingsDone = m_pChecker->mappingsDone();
+		m_ui.CheckProgressBar->setRange(0, iMappingsTotal);
+		m_ui.CheckProgressBar->setValue(iMappingsDone);
+		m_ui.StatusTextLabel->setText(tr("Fetching MIDI instrument mappings "
+			"(%1 of %2)...").arg(iMappingsDone).arg(iMappingsTotal));
+	}
+}
+
+
+// Check completion.
+void MapCheckForm::checkFinished (void)
+{
+	m_pTimer->stop();
+
+	if (m_pChecker == NULL)
+		return;
+
+	const int iElapsed = m_time.elapsed();
+
+	MainForm *pMainForm = MainForm::getInstance();
+
+	// Report whatever went wrong...
+	QStringListIterator iter(m_pChecker->errors());
+	while (iter.hasNext()) {
+		const QString& sError = iter.next();
+		if (pMainForm)
+			pMainForm->appendMessagesColor(sError, "#996633");
+	}
+
+	// Feed the name index with what we've read meanwhile...
+	InstrumentCache *pInstrumentCache = InstrumentCache::getInstance();
+	if (pInstrumentCache) {
+		const QHash<QString, QStringList>& instlists
+			= m_pChecker->instrumentLists();
+		QHash<QString, QStringList>::ConstIterator iter2
+			= instlists.constBegin();
+		for ( ; iter2 != instlists.constEnd(); ++iter2)
+			pInstrumentCache->insert(iter2.key(), true, iter2.value());
+	}
+
+	// Fill the report, all at once...
+	m_issues = m_pChecker->issues();
+	QList<QTreeWidgetItem *> items;
+	const int iIssues = m_issues.count();
+	for (int i = 0; i < iIssues; ++i) {
+		const MapChecker::Issue& issue = m_issues.at(i);
+		const Instrument& instrument = issue.instrument;
+		QTreeWidgetItem *pItem = new QTreeWidgetItem();
+		pItem->setData(0, Qt::DisplayRole, instrument.map());
+		pItem->setData(0, Qt::UserRole, i);
+		pItem->setData(1, Qt::DisplayRole, instrument.bank());
+		pItem->setData(2, Qt::DisplayRole, instrument.prog() + 1);
+		pItem->setText(3, instrument.name());
+		pItem->setText(4, instrument.instrumentFile());
+		pItem->setToolTip(4, instrument.instrumentFile());
+		pItem->setData(5, Qt::DisplayRole, instrument.instrumentNr());
+		QString sProblem = MapChecker::problemText(issue.problem);
+		if (issue.problem == MapChecker::BadInstrumentNr)
+			sProblem += ' ' + tr("(%1 available)").arg(issue.iInstrumentCount);
+		pItem->setText(6, sProblem);
+		pItem->setFlags(pItem->flags() | Qt::ItemIsUserCheckable);
+		pItem->setCheckState(0, Qt::Unchecked);
+		updateItem(pItem);
+		items.append(pItem);
+	}
+
+	m_ui.IssuesListView->setUpdatesEnabled(false);
+	m_ui.IssuesListView->clear();
+	m_ui.IssuesListView->addTopLevelItems(items);
+	m_ui.IssuesListView->setUpdatesEnabled(true);
+
+	const QString& sStatus
+		= tr("%1 mappings, %2 instrument files checked in %3 msecs: "
+		"%4 problem(s) found.")
+		.arg(m_pChecker->mappings())
+		.arg(m_pChecker->files())
+		.arg(iElapsed)
+		.arg(iIssues);
+
+	m_ui.StatusTextLabel->setText(sStatus);
+	m_ui.CheckProgressBar->hide();
+
+	if (pMainForm)
+		pMainForm->appendMessages(tr("MIDI instrument maps check: ") + sStatus);
+
+	delete m_pChecker;
+	m_pChecker = NULL;
+
+	stabilizeForm();
+}
+
+
+// Look for missing files elsewhere.
+void MapCheckForm::relocateFiles (void)
+{
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL)
+		return;
+
+	Options *pOptions = pMainForm->options();
+	if (pOptions == NULL)
+		return;
+
+	// Which ones are we looking for?
+	QHash<QString, QStringList> wanted;
+	QListIterator<MapChecker::Issue> iter(m_issues);
+	while (iter.hasNext()) {
+		const MapChecker::Issue& issue = iter.next();
+		if (issue.problem != MapChecker::MissingFile
+			&& issue.problem != MapChecker::UnreadableFile)
+			continue;
+		const QString& sInstrumentFile = issue.instrument.instrumentFile();
+		if (m_relocations.contains(sInstrumentFile))
+			continue;
+		QStringList& files = wanted[QFileInfo(sInstrumentFile).fileName()];
+		if (!files.contains(sInstrumentFile))
+			files.append(sInstrumentFile);
+	}
+
+	if (wanted.isEmpty())
+		return;
+
+	const QString& sDir = QFileDialog::getExistingDirectory(this,
+		QSAMPLER_TITLE ": " + tr("Relocate Instrument Files"), // Caption.
+		pOptions->sInstrumentDir);                           // Start here.
+	if (sDir.isEmpty())
+		return;
+
+	QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
+
+	// One single walk, first match wins...
+	int iFound = 0;
+	QDirIterator dirIter(sDir, QDir::Files | QDir::Readable,
+		QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
+	while (dirIter.hasNext() && !wanted.isEmpty()) {
+		const QString& sPath = dirIter.next();
+		QHash<QString, QStringList>::Iterator iter2
+			= wanted.find(dirIter.fileName());
+		if (iter2 == wanted.end())
+			continue;
+		QStringListIterator iter3(iter2.value());
+		while (iter3.hasNext()) {
+			m_relocations.insert(iter3.next(), sPath);
+			++iFound;
+		}
+		wanted.erase(iter2);
+	}
+
+	// Newly relocatable ones get checked...
+	m_ui.IssuesListView->blockSignals(true);
+	const int iItems = m_ui.IssuesListView->topLevelItemCount();
+	for (int i = 0; i < iItems; ++i) {
+		QTreeWidgetItem *pItem = m_ui.IssuesListView->topLevelItem(i);
+		const bool bRelocated = pItem->data(7, Qt::UserRole).toBool();
+		updateItem(pItem);
+		if (!bRelocated && pItem->data(7, Qt::UserRole).toBool())
+			pItem->setCheckState(0, Qt::Checked);
+	}
+	m_ui.IssuesListView->blockSignals(false);
+
+	QApplication::restoreOverrideCursor();
+
+	int iMissing = iFound;
+	QHash<QString, QStringList>::ConstIterator iter4 = wanted.constBegin();
+	for ( ; iter4 != wanted.constEnd(); ++iter4)
+		iMissing += iter4.value().count();
+
+	m_ui.StatusTextLabel->setText(
+		tr("%1 of %2 missing instrument files found in \"%3\".")
+		.arg(iFound).arg(iMissing).arg(sDir));
+
+	stabilizeForm();
+}
+
+
+// Apply all checked fixes, in one go.
+void MapCheckForm::applyFixes (void)
+{
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL)
+		return;
+	if (pMainForm->client() == NULL)
+		return;
+
+	QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
+
+	int iRelocated = 0;
+	int iUnmapped = 0;
+	int iFailed = 0;
+
+	QList<QTreeWidgetItem *> fixed;
+	const int iItems = m_ui.IssuesListView->topLevelItemCount();
+	for (int i = 0; i < iItems; ++i) {
+		QTreeWidgetItem *pItem = m_ui.IssuesListView->topLevelItem(i);
+		if (pItem->checkState(0) != Qt::Checked)
+			continue;
+		const int iIssue = pItem->data(0, Qt::UserRole).toInt();
+		Instrument instrument = m_issues.at(iIssue).instrument;
+		bool bResult = false;
+		if (pItem->data(7, Qt::UserRole).toBool()) {
+			instrument.setInstrumentFile(
+				m_relocations.value(instrument.instrumentFile()));
+			bResult = instrument.mapInstrument();
+			if (bResult)
+				++iRelocated;
+		} else {
+			bResult = instrument.unmapInstrument();
+			if (bResult)
+				++iUnmapped;
+		}
+		if (bResult) {
+			m_fixedMaps.insert(instrument.map());
+			fixed.append(pItem);
+		}
+		else ++iFailed;
+	}
+
+	qDeleteAll(fixed);
+
+	QApplication::restoreOverrideCursor();
+
+	const QString& sStatus
+		= tr("%1 mapping(s) relocated, %2 unmapped, %3 failed.")
+		.arg(iRelocated).arg(iUnmapped).arg(iFailed);
+
+	m_ui.StatusTextLabel->setText(sStatus);
+	pMainForm->appendMessages(tr("MIDI instrument maps fixes: ") + sStatus);
+
+	stabilizeForm();
+}
+
+
+// Form state stabilization.
+void MapCheckForm::stabilizeForm (void)
+{
+	const bool bRunning = (m_pChecker != NULL);
+
+	int iChecked = 0;
+	const int iItems = m_ui.IssuesListView->topLevelItemCount();
+	for (int i = 0; i < iItems; ++i) {
+		if (m_ui.IssuesListView->topLevelItem(i)->checkState(0) == Qt::Checked)
+			++iChecked;
+	}
+
+	m_ui.RelocatePushButton->setEnabled(!bRunning && iItems > 0);
+	m_ui.ApplyPushButton->setEnabled(!bRunning && iChecked > 0);
+	m_ui.ApplyPushButton->setText(iChecked > 0
+		? tr("&Apply Fixes (%1)").arg(iChecked) : tr("&Apply Fixes"));
+}
+
+
+// Cancel whatever's still running.
+void MapCheckForm::reject (void)
+{
+	m_pTimer->stop();
+
+	if (m_pChecker) {
+		m_pChecker->cancel();
+		delete m_pChecker;
+		m_pChecker = NULL;
+	}
+
+	QDialog::reject();
+}
+
+
+// Fix description of one item.
+void MapCheckForm::updateItem ( QTreeWidgetItem *pItem )
+{
+	const int iIssue = pItem->data(0, Qt::UserRole).toInt();
+	const MapChecker::Issue& issue = m_issues.at(iIssue);
+
+	QString sRelocation;
+	if (issue.problem == MapChecker::MissingFile
+		|| issue.problem == MapChecker::UnreadableFile)
+		sRelocation = m_relocations.value(issue.instrument.instrumentFile());
+
+	if (sRelocation.isEmpty()) {
+		pItem->setText(7, tr("Unmap"));
+		pItem->setData(7, Qt::UserRole, false);
+	} else {
+		pItem->setText(7, tr("Relocate to \"%1\"").arg(sRelocation));
+		pItem->setToolTip(7, sRelocation);
+		pItem->setData(7, Qt::UserRole, true);
+	}
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerMapCheckForm.cpp
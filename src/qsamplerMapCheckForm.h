@@ -0,0 +1,110 @@
+// qsamplerMapCheckForm.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerMapCheckForm_h
+#define __qsamplerMapCheckForm_h
+
+#include "ui_qsamplerMapCheckForm.h"
+
+#include "qsamplerMapChecker.h"
+
+#include <QTime>
+#include <QSet>
+
+class QTimer;
+
+
+namespace QSampler {
+
+//-------------------------------------------------------------------------
+// QSampler::MapCheckForm -- MIDI instrument map integrity report.
+//
+
+class MapCheckForm : public QDialog
+{
+	Q_OBJECT
+
+public:
+
+	// Constructor.
+	MapCheckForm(QWidget *pParent = NULL);
+
+	// Destructor.
+	~MapCheckForm();
+
+	// Start checking (all maps, if negative).
+	void check(int iMidiMap, const QMap<int, QList<Instrument> >& cachedMaps);
+
+	// Maps changed by applied fixes.
+	const QSet<int>& fixedMaps() const;
+
+protected slots:
+
+	// Progress feedback.
+	void checkProgress();
+
+	// Check completion.
+	void checkFinished();
+
+	// Look for missing files elsewhere.
+	void relocateFiles();
+
+	// Apply all checked fixes, in one go.
+	void applyFixes();
+
+	// Form state stabilization.
+	void stabilizeForm();
+
+protected:
+
+	// Cancel whatever's still running.
+	void reject();
+
+	// Fix description of one item.
+	void updateItem(QTreeWidgetItem *pItem);
+
+private:
+
+	// The Qt-designer UI struct...
+	Ui::qsamplerMapCheckForm m_ui;
+
+	// Instance variables.
+	MapChecker *m_pChecker;
+
+	QList<MapChecker::Issue> m_issues;
+
+	// Relocation candidates, per missing file.
+	QHash<QString, QString> m_relocations;
+
+	QSet<int> m_fixedMaps;
+
+	QTime m_time;
+
+	QTimer *m_pTimer;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerMapCheckForm_h
+
+
+// end of qsamplerMapCheckForm.h
@@ -0,0 +1,471 @@
+// qsamplerMapChecker.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerMapChecker.h"
+
+#include "qsamplerChannel.h"
+
+#include <QThreadPool>
+#include <QRunnable>
+#include <QMutexLocker>
+#include <QFileInfo>
+#include <QVector>
+#include <QSet>
+
+
+namespace QSampler {
+
+//-------------------------------------------------------------------------
+// QSampler::MapCheckerJob - one parallel instrument file check.
+//
+
+class MapCheckerJob : public QRunnable
+{
+public:
+
+	// Constructor.
+	MapCheckerJob(MapChecker *pChecker,
+		const QString& sInstrumentFile, MapChecker::File *pFile)
+		: m_pChecker(pChecker), m_sInstrumentFile(sInstrumentFile),
+			m_pFile(pFile) {}
+
+	// Job executive.
+	void run()
+	{
+		m_pChecker->checkFile(m_sInstrumentFile, m_pFile);
+	}
+
+private:
+
+	// Instance variables.
+	MapChecker       *m_pChecker;
+	QString           m_sInstrumentFile;
+	MapChecker::File *m_pFile;
+};
+
+
+// The dedicated connection is not subscribed to any events.
+static lscp_status_t qsampler_map_checker_callback (
+	lscp_client_t */*pClient*/, lscp_event_t /*event*/,
+	const char */*pchData*/, int /*cchData*/, void */*pvData*/ )
+{
+	return LSCP_OK;
+}
+
+
+//-------------------------------------------------------------------------
+// QSampler::MapChecker - MIDI instrument map integrity checker.
+//
+
+// Constructor.
+MapChecker::MapChecker ( const QString& sServerHost, int iServerPort,
+	int iServerTimeout, int iMidiMap, int iThreads )
+	: QThread(), m_sServerHost(sServerHost), m_iServerPort(iServerPort),
+		m_iServerTimeout(iServerTimeout), m_iMidiMap(iMidiMap),
+		m_iThreads(iThreads), m_iCancel(0),
+		m_iMappingsDone(0), m_iMappingsTotal(0),
+		m_iFilesDone(0), m_iFilesTotal(0)
+{
+	if (m_iThreads < 1)
+		m_iThreads = QThread::idealThreadCount();
+	if (m_iThreads < 1)
+		m_iThreads = 1;
+}
+
+
+// Already cached map partitions (not to be fetched again).
+void MapChecker::setCachedMaps ( const QMap<int, QList<Instrument> >& maps )
+{
+	m_cachedMaps = maps;
+}
+
+
+// Already indexed map entries (only the missing get fetched).
+void MapChecker::setIndexedInstruments ( const QList<Instrument>& instruments )
+{
+	m_indexedMaps.clear();
+
+	QListIterator<Instrument> iter(instruments);
+	while (iter.hasNext()) {
+		const Instrument& instrument = iter.next();
+		m_indexedMaps[instrument.map()].insert(
+			(instrument.bank() << 7) + (instrument.prog() & 0x7f), instrument);
+	}
+}
+
+
+// Already known instrument counts (the name index).
+void MapChecker::setInstrumentCounts (
+	const QHash<QString, InstrumentCache::Count>& counts )
+{
+	m_counts = counts;
+}
+
+
+// Cancel (and wait for) the whole thing.
+void MapChecker::cancel (void)
+{
+	m_iCancel.fetchAndStoreOrdered(1);
+
+	QThread::wait();
+}
+
+bool MapChecker::isCancelled (void) const
+{
+	return (m_iCancel.fetchAndAddOrdered(0) != 0);
+}
+
+
+// Progress accessors (any time).
+int MapChecker::mappingsDone (void) const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_iMappingsDone;
+}
+
+int MapChecker::mappingsTotal (void) const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_iMappingsTotal;
+}
+
+int MapChecker::filesDone (void) const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_iFilesDone;
+}
+
+int MapChecker::filesTotal (void) const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_iFilesTotal;
+}
+
+
+// Results accessors (only after the thread is finished).
+const QList<MapChecker::Issue>& MapChecker::issues (void) const
+{
+	return m_issues;
+}
+
+const QStringList& MapChecker::errors (void) const
+{
+	return m_errors;
+}
+
+int MapChecker::mappings (void) const
+{
+	return m_iMappingsTotal;
+}
+
+int MapChecker::files (void) const
+{
+	return m_iFilesTotal;
+}
+
+
+// Instrument names read on the way (to feed the name index).
+const QHash<QString, QStringList>& MapChecker::instrumentLists (void) const
+{
+	return m_instlists;
+}
+
+
+// Problem description.
+QString MapChecker::problemText ( Problem problem )
+{
+	switch (problem) {
+		case NoFile:
+			return QObject::tr("No instrument file");
+		case MissingFile:
+			return QObject::tr("Instrument file not found");
+		case UnreadableFile:
+			return QObject::tr("Instrument file not readable");
+		case BadInstrumentNr:
+			return QObject::tr("Instrument index out of range");
+		case NoProblem:
+		default:
+			return QString();
+	}
+}
+
+
+// The main thread executive.
+void MapChecker::run (void)
+{
+	// We'll have our very own connection,
+	// so not to get in the way of the main one...
+	lscp_client_t *pClient = ::lscp_client_create(
+		m_sServerHost.toUtf8().constData(), m_iServerPort,
+		qsampler_map_checker_callback, NULL);
+	if (pClient == NULL) {
+		addError(QObject::tr("Could not connect to server."));
+		return;
+	}
+
+	::lscp_client_set_timeout(pClient, m_iServerTimeout);
+
+	// Escape sequences are server version dependent...
+	const qsamplerUtilities::lscpVersion_t version
+		= qsamplerUtilities::getRemoteLscpVersion(pClient);
+
+	QList<int> maps;
+	if (m_iMidiMap < 0) {
+		int *piMaps = ::lscp_list_midi_instrument_maps(pClient);
+		if (piMaps == NULL && ::lscp_client_get_errno(pClient))
+			addError(QObject::tr("Could not get MIDI instrument maps."));
+		for (int i = 0; piMaps && piMaps[i] >= 0; ++i)
+			maps.append(piMaps[i]);
+	} else {
+		maps.append(m_iMidiMap);
+	}
+
+	// Bulk fetch all mappings, unless already cached...
+	QList<Instrument> instruments;
+	QListIterator<int> iter(maps);
+	while (iter.hasNext() && !isCancelled()) {
+		const int iMap = iter.next();
+		if (m_cachedMaps.contains(iMap)) {
+			const QList<Instrument>& cached = m_cachedMaps.value(iMap);
+			instruments += cached;
+			QMutexLocker locker(&m_mutex);
+			m_iMappingsTotal += cached.count();
+			m_iMappingsDone  += cached.count();
+		}
+		else
+		if (!fetchMap(pClient, iMap, version, instruments)) {
+			addError(QObject::tr("Could not get MIDI instrument map %1.")
+				.arg(iMap));
+		}
+	}
+
+	// Each referenced file gets checked only once...
+	QStringList files;
+	QSet<QString> unique;
+	QListIterator<Instrument> iter2(instruments);
+	while (iter2.hasNext()) {
+		const QString& sInstrumentFile = iter2.next().instrumentFile();
+		if (!sInstrumentFile.isEmpty() && !unique.contains(sInstrumentFile)) {
+			unique.insert(sInstrumentFile);
+			files.append(sInstrumentFile);
+		}
+	}
+
+	const int iFiles = files.count();
+	m_mutex.lock();
+	m_iFilesTotal = iFiles;
+	m_mutex.unlock();
+
+	// Local ones go parallel...
+	QVector<File> status(iFiles);
+	File *pStatus = status.data();
+	QThreadPool pool;
+	pool.setMaxThreadCount(m_iThreads);
+	for (int i = 0; i < iFiles && !isCancelled(); ++i)
+		pool.start(new MapCheckerJob(this, files.at(i), &pStatus[i]));
+	pool.waitForDone();
+
+	// Whatever's not local must be asked to the server...
+	for (int i = 0; i < iFiles && !isCancelled(); ++i) {
+		if (!pStatus[i].bLocal)
+			checkServerFile(pClient, files.at(i), version, &pStatus[i]);
+	}
+
+	::lscp_client_destroy(pClient);
+
+	if (isCancelled())
+		return;
+
+	QHash<QString, const File *> index;
+	for (int i = 0; i < iFiles; ++i) {
+		const File *pFile = &pStatus[i];
+		index.insert(files.at(i), pFile);
+		if (!pFile->instlist.isEmpty())
+			m_instlists.insert(files.at(i), pFile->instlist);
+	}
+
+	// Now for the verdicts...
+	QListIterator<Instrument> iter3(instruments);
+	while (iter3.hasNext()) {
+		const Instrument& instrument = iter3.next();
+		const File *pFile = index.value(instrument.instrumentFile(), NULL);
+		Issue issue;
+		issue.instrument = instrument;
+		issue.problem = NoProblem;
+		issue.iInstrumentCount = -1;
+		if (pFile == NULL)
+			issue.problem = NoFile;
+		else
+		if (!pFile->bReadable)
+			issue.problem = (pFile->bLocal ? UnreadableFile : MissingFile);
+		else
+		if (pFile->iInstrumentCount >= 0
+			&& (instrument.instrumentNr() < 0
+				|| instrument.instrumentNr() >= pFile->iInstrumentCount)) {
+			issue.problem = BadInstrumentNr;
+			issue.iInstrumentCount = pFile->iInstrumentCount;
+		}
+		if (issue.problem != NoProblem)
+			m_issues.append(issue);
+	}
+}
+
+
+// Bulk fetch of one map partition (runs on this thread only).
+bool MapChecker::fetchMap ( lscp_client_t *pClient, int iMap,
+	const qsamplerUtilities::lscpVersion_t& version,
+	QList<Instrument>& instruments )
+{
+	QList<lscp_midi_instrument_t> instrs;
+	lscp_midi_instrument_t *pInstrs
+		= ::lscp_list_midi_instruments(pClient, iMap);
+	if (pInstrs == NULL && ::lscp_client_get_errno(pClient))
+		return false;
+	for (int i = 0; pInstrs && pInstrs[i].map >= 0; ++i)
+		instrs.append(pInstrs[i]);
+
+	m_mutex.lock();
+	m_iMappingsTotal += instrs.count();
+	m_mutex.unlock();
+
+	// Whatever the map index has already needs not be asked again...
+	const QHash<int, Instrument> indexed = m_indexedMaps.value(iMap);
+
+	QListIterator<lscp_midi_instrument_t> iter(instrs);
+	while (iter.hasNext() && !isCancelled()) {
+		lscp_midi_instrument_t instr = iter.next();
+		QHash<int, Instrument>::ConstIterator found
+			= indexed.constFind((instr.bank << 7) + (instr.prog & 0x7f));
+		if (found != indexed.constEnd()) {
+			instruments.append(found.value());
+			QMutexLocker locker(&m_mutex);
+			++m_iMappingsDone;
+			continue;
+		}
+		Instrument instrument(instr.map, instr.bank, instr.prog);
+		lscp_midi_instrument_info_t *pInstrInfo
+			= ::lscp_get_midi_instrument_info(pClient, &instr);
+		if (pInstrInfo) {
+			instrument.setName(qsamplerUtilities::lscpEscapedTextToRaw(
+				pInstrInfo->name, version));
+			instrument.setEngineName(pInstrInfo->engine_name);
+			instrument.setInstrumentFile(
+				qsamplerUtilities::lscpEscapedPathToPosix(
+					pInstrInfo->instrument_file, version));
+			instrument.setInstrumentNr(pInstrInfo->instrument_nr);
+			instrument.setVolume(pInstrInfo->volume);
+			switch (pInstrInfo->load_mode) {
+				case LSCP_LOAD_PERSISTENT:
+					instrument.setLoadMode(3);
+					break;
+				case LSCP_LOAD_ON_DEMAND_HOLD:
+					instrument.setLoadMode(2);
+					break;
+				case LSCP_LOAD_ON_DEMAND:
+					instrument.setLoadMode(1);
+					break;
+				case LSCP_LOAD_DEFAULT:
+				default:
+					instrument.setLoadMode(0);
+					break;
+			}
+			instruments.append(instrument);
+		} else {
+			addError(QObject::tr("Could not get MIDI instrument %1/%2/%3.")
+				.arg(instr.map).arg(instr.bank).arg(instr.prog));
+		}
+		QMutexLocker locker(&m_mutex);
+		++m_iMappingsDone;
+	}
+
+	return true;
+}
+
+
+// Check one local file (runs on a worker thread).
+void MapChecker::checkFile ( const QString& sInstrumentFile, File *pFile )
+{
+	if (isCancelled())
+		return;
+
+	const QFileInfo fi(sInstrumentFile);
+	pFile->bLocal = fi.exists();
+	if (pFile->bLocal) {
+		pFile->bReadable = (fi.isFile() && fi.isReadable());
+		// Still fresh in the name index?
+		QHash<QString, InstrumentCache::Count>::ConstIterator iter
+			= m_counts.constFind(sInstrumentFile);
+		if (iter != m_counts.constEnd()
+			&& iter.value().modified == fi.lastModified()) {
+			pFile->iInstrumentCount = iter.value().iCount;
+		}
+		else
+		if (pFile->bReadable) {
+			pFile->instlist = Channel::readInstrumentList(sInstrumentFile);
+			if (!pFile->instlist.isEmpty())
+				pFile->iInstrumentCount = pFile->instlist.count();
+		}
+		QMutexLocker locker(&m_mutex);
+		++m_iFilesDone;
+	}
+}
+
+
+// Server-side check of one (non local) file.
+bool MapChecker::checkServerFile ( lscp_client_t *pClient,
+	const QString& sInstrumentFile,
+	const qsamplerUtilities::lscpVersion_t& version, File *pFile )
+{
+	// Remote file queries are only there since LSCP 1.2;
+	// otherwise just give it the benefit of the doubt...
+	if (version.major < 1 || (version.major == 1 && version.minor < 2)) {
+		pFile->bReadable = true;
+	} else {
+		const QString& sQuery = "GET FILE INSTRUMENTS '"
+			+ qsamplerUtilities::lscpEscapePath(sInstrumentFile, version)
+			+ "'\r\n";
+		if (::lscp_client_query(pClient, sQuery.toUtf8().constData())
+			== LSCP_OK) {
+			pFile->bReadable = true;
+			pFile->iInstrumentCount = QString::fromUtf8(
+				::lscp_client_get_result(pClient)).trimmed().toInt();
+		}
+	}
+
+	QMutexLocker locker(&m_mutex);
+	++m_iFilesDone;
+
+	return pFile->bReadable;
+}
+
+
+// Error accounting (any thread).
+void MapChecker::addError ( const QString& sError )
+{
+	QMutexLocker locker(&m_mutex);
+	m_errors.append(sError);
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerMapChecker.cpp
@@ -0,0 +1,164 @@
+// qsamplerMapChecker.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerMapChecker_h
+#define __qsamplerMapChecker_h
+
+#include "qsamplerInstrument.h"
+#include "qsamplerInstrumentCache.h"
+#include "qsamplerUtilities.h"
+
+#include <QThread>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QStringList>
+#include <QHash>
+#include <QMap>
+
+#include <lscp/client.h>
+
+
+namespace QSampler {
+
+//-------------------------------------------------------------------------
+// QSampler::MapChecker - MIDI instrument map integrity checker.
+//
+
+class MapChecker : public QThread
+{
+public:
+
+	// Constructor.
+	MapChecker(const QString& sServerHost, int iServerPort,
+		int iServerTimeout, int iMidiMap = -1, int iThreads = 0);
+
+	// Already cached map partitions (not to be fetched again).
+	void setCachedMaps(const QMap<int, QList<Instrument> >& maps);
+
+	// Already indexed map entries (only the missing get fetched).
+	void setIndexedInstruments(const QList<Instrument>& instruments);
+
+	// Already known instrument counts (the name index).
+	void setInstrumentCounts(
+		const QHash<QString, InstrumentCache::Count>& counts);
+
+	// Cancel (and wait for) the whole thing.
+	void cancel();
+	bool isCancelled() const;
+
+	// Progress accessors (any time).
+	int mappingsDone() const;
+	int mappingsTotal() const;
+	int filesDone() const;
+	int filesTotal() const;
+
+	// What may be wrong with a mapping.
+	enum Problem { NoProblem = 0, NoFile, MissingFile,
+		UnreadableFile, BadInstrumentNr };
+
+	// One broken mapping.
+	struct Issue
+	{
+		Instrument instrument;
+		Problem    problem;
+		int        iInstrumentCount;
+	};
+
+	// Results accessors (only after the thread is finished).
+	const QList<Issue>& issues() const;
+	const QStringList& errors() const;
+
+	int mappings() const;
+	int files() const;
+
+	// Instrument names read on the way (to feed the name index).
+	const QHash<QString, QStringList>& instrumentLists() const;
+
+	// Problem description.
+	static QString problemText(Problem problem);
+
+	// Status of one referenced file.
+	struct File
+	{
+		File() : bLocal(false), bReadable(false), iInstrumentCount(-1) {}
+
+		bool bLocal;
+		bool bReadable;
+		int  iInstrumentCount;
+		QStringList instlist;
+	};
+
+	// Check one local file (runs on a worker thread).
+	void checkFile(const QString& sInstrumentFile, File *pFile);
+
+protected:
+
+	// The main thread executive.
+	void run();
+
+	// Bulk fetch of one map partition (runs on this thread only).
+	bool fetchMap(lscp_client_t *pClient, int iMap,
+		const qsamplerUtilities::lscpVersion_t& version,
+		QList<Instrument>& instruments);
+
+	// Server-side check of one (non local) file.
+	bool checkServerFile(lscp_client_t *pClient,
+		const QString& sInstrumentFile,
+		const qsamplerUtilities::lscpVersion_t& version, File *pFile);
+
+	// Error accounting (any thread).
+	void addError(const QString& sError);
+
+private:
+
+	// Instance variables.
+	QString m_sServerHost;
+	int     m_iServerPort;
+	int     m_iServerTimeout;
+	int     m_iMidiMap;
+	int     m_iThreads;
+
+	QMap<int, QList<Instrument> > m_cachedMaps;
+	QMap<int, QHash<int, Instrument> > m_indexedMaps;
+	QHash<QString, InstrumentCache::Count> m_counts;
+
+	mutable QMutex m_mutex;
+
+	QList<Issue> m_issues;
+	QStringList  m_errors;
+
+	QHash<QString, QStringList> m_instlists;
+
+	mutable QAtomicInt m_iCancel;
+
+	int m_iMappingsDone;
+	int m_iMappingsTotal;
+	int m_iFilesDone;
+	int m_iFilesTotal;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerMapChecker_h
+
+
+// end of qsamplerMapChecker.h
@@ -0,0 +1,564 @@
+// qsamplerMapIndex.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerMapIndex.h"
+#include "qsamplerUtilities.h"
+
+#include "qsamplerOptions.h"
+#include "qsamplerMainForm.h"
+
+#include <QApplication>
+
+
+namespace QSampler {
+
+// Specialties for thread-callback comunication.
+#define QSAMPLER_MAP_INDEX_EVENT QEvent::Type(QEvent::User + 5)
+
+
+//-------------------------------------------------------------------------
+// QSampler::MapIndexEvent -- fetched map entries.
+
+class MapIndexEvent : public QEvent
+{
+public:
+
+	// Constructor.
+	MapIndexEvent(int iMap, int iBank, int iProg, const QList<int>& maps,
+		const QList<Instrument>& instruments, bool bResult)
+		: QEvent(QSAMPLER_MAP_INDEX_EVENT),
+			m_iMap(iMap), m_iBank(iBank), m_iProg(iProg), m_maps(maps),
+			m_instruments(instruments), m_bResult(bResult) {}
+
+	// Accessors.
+	int map() const { return m_iMap; }
+	int bank() const { return m_iBank; }
+	int prog() const { return m_iProg; }
+	const QList<int>& maps() const { return m_maps; }
+	const QList<Instrument>& instruments() const { return m_instruments; }
+	bool result() const { return m_bResult; }
+
+private:
+
+	int               m_iMap;
+	int               m_iBank;
+	int               m_iProg;
+	QList<int>        m_maps;
+	QList<Instrument> m_instruments;
+	bool              m_bResult;
+};
+
+
+// The dedicated connection is not subscribed to any events.
+static lscp_status_t qsampler_map_index_callback (
+	lscp_client_t */*pClient*/, lscp_event_t /*event*/,
+	const char */*pchData*/, int /*cchData*/, void */*pvData*/ )
+{
+	return LSCP_OK;
+}
+
+
+#ifdef CONFIG_MIDI_INSTRUMENT
+
+// Fetch one map entry; whether it's still there.
+static bool qsampler_map_index_entry ( lscp_client_t *pClient,
+	const qsamplerUtilities::lscpVersion_t& version,
+	lscp_midi_instrument_t *pInstr, QList<Instrument>& instruments )
+{
+	lscp_midi_instrument_info_t *pInstrInfo
+		= ::lscp_get_midi_instrument_info(pClient, pInstr);
+	if (pInstrInfo == NULL)
+		return false;
+
+	Instrument instrument(pInstr->map, pInstr->bank, pInstr->prog);
+	instrument.setName(qsamplerUtilities::lscpEscapedTextToRaw(
+		pInstrInfo->name, version));
+	instrument.setEngineName(pInstrInfo->engine_name);
+	instrument.setInstrumentFile(qsamplerUtilities::lscpEscapedPathToPosix(
+		pInstrInfo->instrument_file, version));
+	instrument.setInstrumentNr(pInstrInfo->instrument_nr);
+	instrument.setVolume(pInstrInfo->volume);
+	switch (pInstrInfo->load_mode) {
+		case LSCP_LOAD_PERSISTENT:
+			instrument.setLoadMode(3);
+			break;
+		case LSCP_LOAD_ON_DEMAND_HOLD:
+			instrument.setLoadMode(2);
+			break;
+		case LSCP_LOAD_ON_DEMAND:
+			instrument.setLoadMode(1);
+			break;
+		case LSCP_LOAD_DEFAULT:
+		default:
+			instrument.setLoadMode(0);
+			break;
+	}
+
+	instruments.append(instrument);
+	return true;
+}
+
+
+// Fetch one whole map.
+static bool qsampler_map_index_map ( lscp_client_t *pClient,
+	const qsamplerUtilities::lscpVersion_t& version,
+	int iMap, QList<Instrument>& instruments )
+{
+	QList<lscp_midi_instrument_t> instrs;
+	lscp_midi_instrument_t *pInstrs
+		= ::lscp_list_midi_instruments(pClient, iMap);
+	if (pInstrs == NULL && ::lscp_client_get_errno(pClient))
+		return false;
+	for (int i = 0; pInstrs && pInstrs[i].map >= 0; ++i)
+		instrs.append(pInstrs[i]);
+
+	QListIterator<lscp_midi_instrument_t> iter(instrs);
+	while (iter.hasNext()) {
+		lscp_midi_instrument_t instr = iter.next();
+		qsampler_map_index_entry(pClient, version, &instr, instruments);
+	}
+
+	return true;
+}
+
+#endif	// CONFIG_MIDI_INSTRUMENT
+
+
+//-------------------------------------------------------------------------
+// QSampler::MapIndexThread - MIDI instrument map entries fetcher.
+//
+
+// Constructor.
+MapIndexThread::MapIndexThread ( QObject *pReceiver,
+	const QString& sServerHost, int iServerPort, int iServerTimeout )
+	: QThread(), m_pReceiver(pReceiver),
+		m_sServerHost(sServerHost), m_iServerPort(iServerPort),
+		m_iServerTimeout(iServerTimeout), m_bRunState(true)
+{
+}
+
+
+// Destructor.
+MapIndexThread::~MapIndexThread (void)
+{
+	stop();
+}
+
+
+// Whether a request is already covered by another one.
+bool MapIndexThread::covers ( const Request& req1, const Request& req2 )
+{
+	// All maps...
+	if (req1.iMap < 0 && req1.iBank < 0)
+		return true;
+	// Maps list only...
+	if (req1.iMap < 0)
+		return (req2.iMap < 0 && req2.iBank >= 0);
+	// Whole map...
+	if (req1.iBank < 0)
+		return (req2.iMap == req1.iMap);
+	// Single map entry...
+	return (req2.iMap == req1.iMap
+		&& req2.iBank == req1.iBank && req2.iProg == req1.iProg);
+}
+
+
+// Enqueue a new fetch request.
+void MapIndexThread::request ( int iMap, int iBank, int iProg )
+{
+	Request req;
+	req.iMap  = iMap;
+	req.iBank = iBank;
+	req.iProg = iProg;
+
+	QMutexLocker locker(&m_mutex);
+
+	// Bursts of change events get coalesced here...
+	QMutableListIterator<Request> iter(m_requests);
+	while (iter.hasNext()) {
+		const Request& req1 = iter.next();
+		if (covers(req1, req))
+			return;
+		if (covers(req, req1))
+			iter.remove();
+	}
+
+	m_requests.append(req);
+	m_cond.wakeAll();
+}
+
+
+// Stop (and wait for) the thread.
+void MapIndexThread::stop (void)
+{
+	m_mutex.lock();
+	m_bRunState = false;
+	m_requests.clear();
+	m_cond.wakeAll();
+	m_mutex.unlock();
+
+	QThread::wait();
+}
+
+
+// The main thread executive.
+void MapIndexThread::run (void)
+{
+	lscp_client_t *pClient = NULL;
+	qsamplerUtilities::lscpVersion_t version;
+	version.major = 0;
+	version.minor = 0;
+
+	m_mutex.lock();
+	while (m_bRunState) {
+		if (m_requests.isEmpty()) {
+			m_cond.wait(&m_mutex);
+			continue;
+		}
+		const Request req = m_requests.takeFirst();
+		m_mutex.unlock();
+		// We'll have our very own connection,
+		// so not to get in the way of the main one...
+		if (pClient == NULL) {
+			pClient = ::lscp_client_create(
+				m_sServerHost.toUtf8().constData(), m_iServerPort,
+				qsampler_map_index_callback, NULL);
+			if (pClient) {
+				::lscp_client_set_timeout(pClient, m_iServerTimeout);
+				version = qsamplerUtilities::getRemoteLscpVersion(pClient);
+			}
+		}
+		QList<int> maps;
+		QList<Instrument> instruments;
+		bool bResult = false;
+	#ifdef CONFIG_MIDI_INSTRUMENT
+		if (pClient && req.iMap < 0) {
+			int *piMaps = ::lscp_list_midi_instrument_maps(pClient);
+			bResult = (piMaps || ::lscp_client_get_errno(pClient) == 0);
+			for (int i = 0; piMaps && piMaps[i] >= 0; ++i)
+				maps.append(piMaps[i]);
+			QListIterator<int> iter(maps);
+			while (bResult && iter.hasNext() && req.iBank < 0) {
+				bResult = qsampler_map_index_map(
+					pClient, version, iter.next(), instruments);
+			}
+		}
+		else
+		if (pClient && req.iBank < 0) {
+			bResult = qsampler_map_index_map(
+				pClient, version, req.iMap, instruments);
+		}
+		else
+		if (pClient) {
+			// Not there anymore, if it fails...
+			lscp_midi_instrument_t instr;
+			instr.map  = req.iMap;
+			instr.bank = req.iBank;
+			instr.prog = req.iProg;
+			qsampler_map_index_entry(pClient, version, &instr, instruments);
+			bResult = true;
+		}
+	#endif
+		QApplication::postEvent(m_pReceiver,
+			new MapIndexEvent(req.iMap, req.iBank, req.iProg,
+				maps, instruments, bResult));
+		m_mutex.lock();
+	}
+	m_mutex.unlock();
+
+	if (pClient)
+		::lscp_client_destroy(pClient);
+}
+
+
+//-------------------------------------------------------------------------
+// QSampler::MapIndex - MIDI instrument map entries index.
+//
+
+// Kind of singleton reference.
+MapIndex *MapIndex::g_pMapIndex = NULL;
+
+
+// Constructor.
+MapIndex::MapIndex ( QObject *pParent )
+	: QObject(pParent), m_bValid(false), m_pThread(NULL)
+{
+	g_pMapIndex = this;
+}
+
+
+// Destructor.
+MapIndex::~MapIndex (void)
+{
+	reset();
+
+	g_pMapIndex = NULL;
+}
+
+
+// Pseudo-singleton instance accessor.
+MapIndex *MapIndex::getInstance (void)
+{
+	return g_pMapIndex;
+}
+
+
+// Fetch requests.
+void MapIndex::refresh (void)
+{
+	updateEntry(-1, -1, -1);
+}
+
+
+void MapIndex::updateMaps (void)
+{
+	updateEntry(-1, 0, -1);
+}
+
+
+void MapIndex::updateMap ( int iMap )
+{
+	updateEntry(iMap, -1, -1);
+}
+
+
+void MapIndex::updateEntry ( int iMap, int iBank, int iProg )
+{
+#ifdef CONFIG_MIDI_INSTRUMENT
+
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL)
+		return;
+	if (pMainForm->client() == NULL)
+		return;
+
+	Options *pOptions = pMainForm->options();
+	if (pOptions == NULL)
+		return;
+
+	if (m_pThread == NULL) {
+		m_pThread = new MapIndexThread(this,
+			pOptions->sServerHost,
+			pOptions->iServerPort,
+			pOptions->iServerTimeout);
+		m_pThread->start();
+	}
+
+	m_pThread->request(iMap, iBank, iProg);
+
+#else
+
+	Q_UNUSED(iMap);
+	Q_UNUSED(iBank);
+	Q_UNUSED(iProg);
+
+#endif
+}
+
+
+// Stop and forget it all (eg. client shutdown).
+void MapIndex::reset (void)
+{
+	if (m_pThread) {
+		m_pThread->stop();
+		delete m_pThread;
+		m_pThread = NULL;
+	}
+
+	// Whatever is still on its way is stale by now...
+	QApplication::removePostedEvents(this, QSAMPLER_MAP_INDEX_EVENT);
+
+	m_maps.clear();
+	m_files.clear();
+
+	m_bValid = false;
+}
+
+
+// Whether the whole index has been fetched (yet).
+bool MapIndex::isValid (void) const
+{
+	return m_bValid;
+}
+
+
+// Index accessors (all maps, if map < 0).
+QList<Instrument> MapIndex::instruments ( int iMap ) const
+{
+	QList<Instrument> instruments;
+
+	QMap<int, Entries>::ConstIterator iter = m_maps.constBegin();
+	for ( ; iter != m_maps.constEnd(); ++iter) {
+		if (iMap < 0 || iMap == iter.key())
+			instruments += iter.value().values();
+	}
+
+	return instruments;
+}
+
+
+QList<Instrument> MapIndex::instruments ( const QString& sInstrumentFile ) const
+{
+	QList<Instrument> instruments;
+
+	if (!m_files.contains(sInstrumentFile))
+		return instruments;
+
+	QMap<int, Entries>::ConstIterator iter = m_maps.constBegin();
+	for ( ; iter != m_maps.constEnd(); ++iter) {
+		Entries::ConstIterator iter2 = iter.value().constBegin();
+		for ( ; iter2 != iter.value().constEnd(); ++iter2) {
+			if (iter2.value().instrumentFile() == sInstrumentFile)
+				instruments.append(iter2.value());
+		}
+	}
+
+	return instruments;
+}
+
+
+const Instrument *MapIndex::instrument ( int iMap, int iBank, int iProg ) const
+{
+	QMap<int, Entries>::ConstIterator iter = m_maps.constFind(iMap);
+	if (iter == m_maps.constEnd())
+		return NULL;
+
+	Entries::ConstIterator iter2
+		= iter.value().constFind(entryKey(iBank, iProg));
+	if (iter2 == iter.value().constEnd())
+		return NULL;
+
+	return &iter2.value();
+}
+
+
+// All referenced instrument files.
+QStringList MapIndex::instrumentFiles (void) const
+{
+	return m_files.keys();
+}
+
+
+// File reference counting.
+void MapIndex::addEntry ( const Instrument& instrument )
+{
+	const int iKey = entryKey(instrument.bank(), instrument.prog());
+	removeEntry(instrument.map(), iKey);
+
+	m_maps[instrument.map()].insert(iKey, instrument);
+
+	const QString& sInstrumentFile = instrument.instrumentFile();
+	if (!sInstrumentFile.isEmpty())
+		++m_files[sInstrumentFile];
+}
+
+
+void MapIndex::removeEntry ( int iMap, int iKey )
+{
+	QMap<int, Entries>::Iterator iter = m_maps.find(iMap);
+	if (iter == m_maps.end())
+		return;
+
+	Entries::Iterator iter2 = iter.value().find(iKey);
+	if (iter2 == iter.value().end())
+		return;
+
+	const QString& sInstrumentFile = iter2.value().instrumentFile();
+	QHash<QString, int>::Iterator iter3 = m_files.find(sInstrumentFile);
+	if (iter3 != m_files.end() && --iter3.value() < 1)
+		m_files.erase(iter3);
+
+	iter.value().erase(iter2);
+}
+
+
+void MapIndex::removeMap ( int iMap )
+{
+	QMap<int, Entries>::Iterator iter = m_maps.find(iMap);
+	if (iter == m_maps.end())
+		return;
+
+	const QList<int>& keys = iter.value().keys();
+	QListIterator<int> iter2(keys);
+	while (iter2.hasNext())
+		removeEntry(iMap, iter2.next());
+
+	m_maps.remove(iMap);
+}
+
+
+// Fetched results receiver.
+void MapIndex::customEvent ( QEvent *pEvent )
+{
+	if (pEvent->type() != QSAMPLER_MAP_INDEX_EVENT)
+		return;
+
+	MapIndexEvent *pMapIndexEvent = static_cast<MapIndexEvent *> (pEvent);
+	if (!pMapIndexEvent->result())
+		return;
+
+	const int iMap = pMapIndexEvent->map();
+	const int iBank = pMapIndexEvent->bank();
+
+	if (iMap < 0) {
+		// Maps gone meanwhile...
+		const QList<int>& maps = pMapIndexEvent->maps();
+		const QList<int>& keys = m_maps.keys();
+		QListIterator<int> iter(keys);
+		while (iter.hasNext()) {
+			const int iOldMap = iter.next();
+			if (!maps.contains(iOldMap) || iBank < 0)
+				removeMap(iOldMap);
+		}
+		// Maps new meanwhile...
+		QListIterator<int> iter2(maps);
+		while (iter2.hasNext()) {
+			const int iNewMap = iter2.next();
+			if (!m_maps.contains(iNewMap)) {
+				m_maps.insert(iNewMap, Entries());
+				if (iBank >= 0)
+					updateMap(iNewMap);
+			}
+		}
+		if (iBank < 0)
+			m_bValid = true;
+	}
+	else
+	if (iBank < 0) {
+		removeMap(iMap);
+		m_maps.insert(iMap, Entries());
+	}
+	else {
+		removeEntry(iMap, entryKey(iBank, pMapIndexEvent->prog()));
+	}
+
+	QListIterator<Instrument> iter(pMapIndexEvent->instruments());
+	while (iter.hasNext())
+		addEntry(iter.next());
+
+	emit changed();
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerMapIndex.cpp
@@ -0,0 +1,177 @@
+// qsamplerMapIndex.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerMapIndex_h
+#define __qsamplerMapIndex_h
+
+#include "qsamplerInstrument.h"
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QStringList>
+#include <QHash>
+#include <QMap>
+
+#include <lscp/client.h>
+
+
+namespace QSampler {
+
+//-------------------------------------------------------------------------
+// QSampler::MapIndexThread - MIDI instrument map entries fetcher.
+//
+
+class MapIndexThread : public QThread
+{
+public:
+
+	// Constructor.
+	MapIndexThread(QObject *pReceiver,
+		const QString& sServerHost, int iServerPort, int iServerTimeout);
+
+	// Destructor.
+	~MapIndexThread();
+
+	// Enqueue a new fetch request: all maps (map < 0),
+	// the maps list only (map < 0, bank >= 0), a whole map
+	// (bank < 0) or a single map entry.
+	void request(int iMap, int iBank = -1, int iProg = -1);
+
+	// Stop (and wait for) the thread.
+	void stop();
+
+protected:
+
+	// The main thread executive.
+	void run();
+
+private:
+
+	// Request queue item.
+	struct Request
+	{
+		int iMap;
+		int iBank;
+		int iProg;
+	};
+
+	// Whether a request is already covered by another one.
+	static bool covers(const Request& req1, const Request& req2);
+
+	// Instance variables.
+	QObject *m_pReceiver;
+
+	QString m_sServerHost;
+	int     m_iServerPort;
+	int     m_iServerTimeout;
+
+	QMutex         m_mutex;
+	QWaitCondition m_cond;
+	QList<Request> m_requests;
+	bool           m_bRunState;
+};
+
+
+//-------------------------------------------------------------------------
+// QSampler::MapIndex - MIDI instrument map entries index.
+//
+// Fetched once on its own connection (and thread), then kept up to
+// date, one entry or map at a time, as server change events arrive.
+//
+
+class MapIndex : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	// Constructor.
+	MapIndex(QObject *pParent = NULL);
+
+	// Destructor.
+	~MapIndex();
+
+	// Pseudo-singleton instance accessor.
+	static MapIndex *getInstance();
+
+	// Fetch requests (eg. on server events).
+	void refresh();
+	void updateMaps();
+	void updateMap(int iMap);
+	void updateEntry(int iMap, int iBank, int iProg);
+
+	// Stop and forget it all (eg. client shutdown).
+	void reset();
+
+	// Whether the whole index has been fetched (yet).
+	bool isValid() const;
+
+	// Index accessors (all maps, if map < 0).
+	QList<Instrument> instruments(int iMap = -1) const;
+	QList<Instrument> instruments(const QString& sInstrumentFile) const;
+	const Instrument *instrument(int iMap, int iBank, int iProg) const;
+
+	// All referenced instrument files.
+	QStringList instrumentFiles() const;
+
+signals:
+
+	// Index change notification.
+	void changed();
+
+protected:
+
+	// Fetched results receiver.
+	void customEvent(QEvent *pEvent);
+
+	// File reference counting.
+	void addEntry(const Instrument& instrument);
+	void removeEntry(int iMap, int iKey);
+	void removeMap(int iMap);
+
+	// Entry key: (bank, prog) pair.
+	static int entryKey(int iBank, int iProg)
+		{ return (iBank << 7) + (iProg & 0x7f); }
+
+private:
+
+	// Instance variables.
+	typedef QMap<int, Instrument> Entries;
+
+	QMap<int, Entries>  m_maps;
+	QHash<QString, int> m_files;
+
+	bool m_bValid;
+
+	MapIndexThread *m_pThread;
+
+	// Kind-of singleton reference.
+	static MapIndex *g_pMapIndex;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerMapIndex_h
+
+
+// end of qsamplerMapIndex.h
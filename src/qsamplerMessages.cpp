@@ -30,6 +30,7 @@
 #include <QTextCursor>
 #include <QTextStream>
 #include <QTextBlock>
+#include <QTextDocument>
 #include <QScrollBar>
 #include <QDateTime>
 #include <QIcon>
@@ -239,6 +240,13 @@ void Messages::setMessagesLimit ( int iMessagesLimit )
 	m_iMessagesHigh  = iMessagesLimit + (iMessagesLimit / 3);
 }
 
+
+// Current messages document size (characters).
+int Messages::messagesSize (void) const
+{
+	return m_pMessagesTextView->document()->characterCount();
+}
+
 // Messages logging stuff.
 bool Messages::isLogging (void) const
 {
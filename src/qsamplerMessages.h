@@ -58,6 +58,9 @@ public:
 	int messagesLimit();
 	void setMessagesLimit(int iMessagesLimit);
 
+	// Current messages document size (characters).
+	int messagesSize() const;
+
 	// Logging settings.
 	bool isLogging() const;
 	void setLogging(bool bEnabled, const QString& sFilename = QString());
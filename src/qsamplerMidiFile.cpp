@@ -0,0 +1,292 @@
+// qsamplerMidiFile.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerMidiFile.h"
+
+#include <QObject>
+#include <QFile>
+#include <QByteArray>
+#include <QtAlgorithms>
+
+#include <string.h>
+
+
+namespace QSampler {
+
+// Default tempo (microseconds per quarter note; 120 bpm).
+#define QSAMPLER_MIDI_FILE_TEMPO  500000
+
+
+// One raw track event, still in ticks.
+struct MidiFileRawEvent
+{
+	qint64        iTick;
+	int           iTempo;   // Tempo change (> 0), or else a voice event.
+	unsigned char status;
+	unsigned char data1;
+	unsigned char data2;
+};
+
+
+// Merged track events are kept in tick order (stable).
+static bool midiFileRawEventLessThan (
+	const MidiFileRawEvent& event1, const MidiFileRawEvent& event2 )
+{
+	return (event1.iTick < event2.iTick);
+}
+
+
+// Big-endian integer readers.
+static quint32 midiFileRead32 ( const unsigned char *p )
+{
+	return (quint32(p[0]) << 24) | (quint32(p[1]) << 16)
+		| (quint32(p[2]) << 8) | quint32(p[3]);
+}
+
+static quint16 midiFileRead16 ( const unsigned char *p )
+{
+	return (quint16(p[0]) << 8) | quint16(p[1]);
+}
+
+
+// Variable-length quantity reader.
+static bool midiFileReadVarLen ( const unsigned char *p, int iEnd,
+	int& iPos, quint32& iValue )
+{
+	iValue = 0;
+	for (int i = 0; i < 4; ++i) {
+		if (iPos >= iEnd)
+			return false;
+		const unsigned char c = p[iPos++];
+		iValue = (iValue << 7) | (c & 0x7f);
+		if ((c & 0x80) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+
+//-------------------------------------------------------------------------
+// QSampler::MidiFile - Standard MIDI File (SMF) reader.
+//
+
+// Constructor.
+MidiFile::MidiFile (void) : m_iTracks(0)
+{
+}
+
+
+// Read a whole file (format 0 or 1), all tracks merged.
+bool MidiFile::load ( const QString& sFilename )
+{
+	m_sFilename = sFilename;
+	m_events.clear();
+	m_iTracks = 0;
+	m_sErrorString.clear();
+
+	QFile file(sFilename);
+	if (!file.open(QIODevice::ReadOnly)) {
+		m_sErrorString = file.errorString();
+		return false;
+	}
+
+	const QByteArray data = file.readAll();
+	file.close();
+
+	const unsigned char *p = (const unsigned char *) data.constData();
+	const int iSize = data.size();
+
+	// Header chunk...
+	if (iSize < 14 || ::memcmp(p, "MThd", 4) != 0) {
+		m_sErrorString = QObject::tr("Not a standard MIDI file");
+		return false;
+	}
+
+	const int iHeaderSize = int(midiFileRead32(p + 4));
+	const int iFormat     = midiFileRead16(p + 8);
+	const int iTracks     = midiFileRead16(p + 10);
+	const int iDivision   = midiFileRead16(p + 12);
+	if (iFormat > 1) {
+		m_sErrorString = QObject::tr("MIDI file format %1 is not supported")
+			.arg(iFormat);
+		return false;
+	}
+	if (iHeaderSize < 6 || iDivision == 0) {
+		m_sErrorString = QObject::tr("Invalid MIDI file header");
+		return false;
+	}
+
+	// Track chunks...
+	QList<MidiFileRawEvent> raws;
+	int iPos = 8 + iHeaderSize;
+	while (m_iTracks < iTracks && iPos + 8 <= iSize) {
+		const int iChunkSize = int(midiFileRead32(p + iPos + 4));
+		const bool bTrack = (::memcmp(p + iPos, "MTrk", 4) == 0);
+		iPos += 8;
+		const int iEnd = qMin(iPos + iChunkSize, iSize);
+		if (!bTrack) {
+			iPos = iEnd;
+			continue;
+		}
+		++m_iTracks;
+		qint64 iTick = 0;
+		unsigned char running = 0;
+		while (iPos < iEnd) {
+			quint32 iDelta = 0;
+			if (!midiFileReadVarLen(p, iEnd, iPos, iDelta) || iPos >= iEnd)
+				break;
+			iTick += iDelta;
+			const unsigned char b = p[iPos];
+			if (b == 0xff) {
+				// Meta event (only tempo changes matter)...
+				if (iPos + 2 > iEnd)
+					break;
+				const unsigned char type = p[iPos + 1];
+				iPos += 2;
+				quint32 iLength = 0;
+				if (!midiFileReadVarLen(p, iEnd, iPos, iLength))
+					break;
+				if (type == 0x51 && iLength == 3 && iPos + 3 <= iEnd) {
+					MidiFileRawEvent raw;
+					raw.iTick  = iTick;
+					raw.iTempo = (int(p[iPos]) << 16)
+						| (int(p[iPos + 1]) << 8) | int(p[iPos + 2]);
+					raw.status = raw.data1 = raw.data2 = 0;
+					if (raw.iTempo > 0)
+						raws.append(raw);
+				}
+				if (type == 0x2f)
+					break;
+				iPos += int(iLength);
+			}
+			else if (b == 0xf0 || b == 0xf7) {
+				// System exclusive (skipped)...
+				++iPos;
+				quint32 iLength = 0;
+				if (!midiFileReadVarLen(p, iEnd, iPos, iLength))
+					break;
+				iPos += int(iLength);
+				running = 0;
+			}
+			else {
+				// Channel voice event (running status aware)...
+				unsigned char status = running;
+				if (b & 0x80) {
+					status = b;
+					++iPos;
+				}
+				if (status < 0x80 || status >= 0xf0)
+					break;
+				running = status;
+				const int iData = ((status & 0xf0) == 0xc0
+					|| (status & 0xf0) == 0xd0 ? 1 : 2);
+				if (iPos + iData > iEnd)
+					break;
+				MidiFileRawEvent raw;
+				raw.iTick  = iTick;
+				raw.iTempo = 0;
+				raw.status = status;
+				raw.data1  = p[iPos] & 0x7f;
+				raw.data2  = (iData > 1 ? p[iPos + 1] & 0x7f : 0);
+				raws.append(raw);
+				iPos += iData;
+			}
+		}
+		iPos = iEnd;
+	}
+
+	if (m_iTracks < 1) {
+		m_sErrorString = QObject::tr("No MIDI tracks found");
+		return false;
+	}
+
+	// Merge all tracks, then on to real time...
+	qStableSort(raws.begin(), raws.end(), midiFileRawEventLessThan);
+
+	double fTickUsecs = 0.0;
+	const bool bSmpte = (iDivision & 0x8000);
+	if (bSmpte) {
+		const int iFramesPerSec = -int((signed char) (iDivision >> 8));
+		const int iTicksPerFrame = (iDivision & 0xff);
+		if (iFramesPerSec > 0 && iTicksPerFrame > 0)
+			fTickUsecs = 1000000.0 / double(iFramesPerSec * iTicksPerFrame);
+	} else {
+		fTickUsecs = double(QSAMPLER_MIDI_FILE_TEMPO) / double(iDivision);
+	}
+
+	double fTime = 0.0;
+	qint64 iLastTick = 0;
+	QListIterator<MidiFileRawEvent> iter(raws);
+	while (iter.hasNext()) {
+		const MidiFileRawEvent& raw = iter.next();
+		fTime += double(raw.iTick - iLastTick) * fTickUsecs;
+		iLastTick = raw.iTick;
+		if (raw.iTempo > 0) {
+			if (!bSmpte)
+				fTickUsecs = double(raw.iTempo) / double(iDivision);
+			continue;
+		}
+		Event event;
+		event.iTime  = qint64(fTime);
+		event.status = raw.status;
+		event.data1  = raw.data1;
+		event.data2  = raw.data2;
+		m_events.append(event);
+	}
+
+	return true;
+}
+
+
+// Accessors.
+const QString& MidiFile::filename (void) const
+{
+	return m_sFilename;
+}
+
+const QList<MidiFile::Event>& MidiFile::events (void) const
+{
+	return m_events;
+}
+
+qint64 MidiFile::duration (void) const
+{
+	return (m_events.isEmpty() ? 0 : m_events.last().iTime);
+}
+
+int MidiFile::tracks (void) const
+{
+	return m_iTracks;
+}
+
+
+// Last error description.
+const QString& MidiFile::errorString (void) const
+{
+	return m_sErrorString;
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerMidiFile.cpp
@@ -0,0 +1,78 @@
+// qsamplerMidiFile.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerMidiFile_h
+#define __qsamplerMidiFile_h
+
+#include <QString>
+#include <QList>
+
+
+namespace QSampler {
+
+//-------------------------------------------------------------------------
+// QSampler::MidiFile - Standard MIDI File (SMF) reader.
+//
+
+class MidiFile
+{
+public:
+
+	// Constructor.
+	MidiFile();
+
+	// One channel voice event, in real time.
+	struct Event
+	{
+		qint64        iTime;    // Microseconds from start.
+		unsigned char status;   // Channel voice status byte.
+		unsigned char data1;
+		unsigned char data2;
+	};
+
+	// Read a whole file (format 0 or 1), all tracks merged.
+	bool load(const QString& sFilename);
+
+	// Accessors.
+	const QString& filename() const;
+	const QList<Event>& events() const;
+	qint64 duration() const;
+	int tracks() const;
+
+	// Last error description.
+	const QString& errorString() const;
+
+private:
+
+	// Instance variables.
+	QString      m_sFilename;
+	QList<Event> m_events;
+	int          m_iTracks;
+	QString      m_sErrorString;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerMidiFile_h
+
+
+// end of qsamplerMidiFile.h
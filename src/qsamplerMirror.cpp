@@ -0,0 +1,489 @@
+// qsamplerMirror.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerMirror.h"
+#include "qsamplerUtilities.h"
+
+#include <QApplication>
+#include <QMutexLocker>
+
+
+namespace QSampler {
+
+// Standby verification period, when idle (msecs).
+#define QSAMPLER_MIRROR_VERIFY_MSECS  5000
+
+
+// The dedicated connection is not subscribed to any events.
+static lscp_status_t qsampler_mirror_callback ( lscp_client_t */*pClient*/,
+	lscp_event_t /*event*/, const char */*pchData*/, int /*cchData*/,
+	void */*pvData*/ )
+{
+	return LSCP_OK;
+}
+
+
+// Session script, split in replication units.
+struct MirrorScript
+{
+	QStringList header;             // Reset, devices and maps.
+	QList<QStringList> channels;    // One block per sampler channel.
+	QStringList footer;             // Global settings.
+};
+
+
+// Split a session script (comments and blank lines are dropped).
+static MirrorScript mirrorParseScript ( const QString& sScript )
+{
+	MirrorScript script;
+
+	const QStringList& lines = sScript.split('\n');
+	QStringListIterator iter(lines);
+	while (iter.hasNext()) {
+		const QString& sLine = iter.next().trimmed();
+		if (sLine.isEmpty() || sLine.startsWith('#'))
+			continue;
+		if (sLine == "ADD CHANNEL")
+			script.channels.append(QStringList());
+		if (sLine.startsWith("SET VOLUME "))
+			script.footer.append(sLine);
+		else
+		if (script.channels.isEmpty())
+			script.header.append(sLine);
+		else
+			script.channels.last().append(sLine);
+	}
+
+	return script;
+}
+
+
+// Lines of a block starting (or not) with a given prefix.
+static QStringList mirrorFilter ( const QStringList& lines,
+	const QString& sPrefix, bool bMatch = true )
+{
+	QStringList result;
+
+	QStringListIterator iter(lines);
+	while (iter.hasNext()) {
+		const QString& sLine = iter.next();
+		if (sLine.startsWith(sPrefix) == bMatch)
+			result.append(sLine);
+	}
+
+	return result;
+}
+
+
+// Incremental MIDI instrument map update, if that's all that changed.
+static bool mirrorHeaderDiff ( const QStringList& oldLines,
+	const QStringList& newLines, QStringList& commands )
+{
+	const QString sMap("MAP MIDI_INSTRUMENT ");
+	if (mirrorFilter(oldLines, sMap, false) != mirrorFilter(newLines, sMap, false))
+		return false;
+
+	QStringListIterator old_iter(mirrorFilter(oldLines, sMap));
+	while (old_iter.hasNext()) {
+		const QString& sLine = old_iter.next();
+		if (!newLines.contains(sLine))
+			commands.append("UN" + sLine.section(' ', 0, 4));
+	}
+
+	QStringListIterator new_iter(mirrorFilter(newLines, sMap));
+	while (new_iter.hasNext()) {
+		const QString& sLine = new_iter.next();
+		if (!oldLines.contains(sLine))
+			commands.append(sLine);
+	}
+
+	return true;
+}
+
+
+// Incremental sampler channel update, if it can be done in place.
+static bool mirrorChannelDiff ( const QStringList& oldLines,
+	const QStringList& newLines, QStringList& commands )
+{
+	// Anything that (re)creates channel parts needs a fresh start...
+	static const char *s_apszResetKeys[] = {
+		"LOAD ENGINE ", "CREATE FX_SEND ", NULL };
+
+	for (int i = 0; s_apszResetKeys[i]; ++i) {
+		const QString sKey(s_apszResetKeys[i]);
+		if (mirrorFilter(oldLines, sKey) != mirrorFilter(newLines, sKey))
+			return false;
+	}
+
+	QStringListIterator old_iter(oldLines);
+	while (old_iter.hasNext()) {
+		const QString& sLine = old_iter.next();
+		if (newLines.contains(sLine))
+			continue;
+		if (sLine.startsWith("SET CHANNEL MUTE ")
+			|| sLine.startsWith("SET CHANNEL SOLO "))
+			commands.append(sLine.section(' ', 0, 3) + " 0");
+		else
+		if (sLine.startsWith("SET CHANNEL MIDI_INSTRUMENT_MAP ")
+			&& mirrorFilter(newLines, "SET CHANNEL MIDI_INSTRUMENT_MAP ").isEmpty())
+			commands.append(sLine.section(' ', 0, 3) + " NONE");
+	}
+
+	QStringListIterator new_iter(newLines);
+	while (new_iter.hasNext()) {
+		const QString& sLine = new_iter.next();
+		if (!oldLines.contains(sLine))
+			commands.append(sLine);
+	}
+
+	return true;
+}
+
+
+//-------------------------------------------------------------------------
+// QSampler::Mirror - hot-standby server state replicator.
+//
+
+// Constructor.
+Mirror::Mirror ( QObject *pReceiver,
+	const QString& sHost, int iPort, int iTimeout )
+	: QThread(), m_pReceiver(pReceiver),
+		m_sHost(sHost), m_iPort(iPort), m_iTimeout(iTimeout),
+		m_bRunState(true), m_bSynced(false)
+{
+}
+
+
+// Destructor.
+Mirror::~Mirror (void)
+{
+	stop();
+}
+
+
+// Standby server address.
+const QString& Mirror::host (void) const
+{
+	return m_sHost;
+}
+
+int Mirror::port (void) const
+{
+	return m_iPort;
+}
+
+
+// Replicate the latest primary state (session script).
+void Mirror::update ( const QString& sScript )
+{
+	QMutexLocker locker(&m_mutex);
+	m_sPending = sScript;
+	m_cond.wakeAll();
+}
+
+
+// Whether the standby is connected and in sync.
+bool Mirror::isSynced (void) const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_bSynced;
+}
+
+
+// Stop (and wait for) the thread.
+void Mirror::stop (void)
+{
+	m_mutex.lock();
+	m_bRunState = false;
+	m_sPending.clear();
+	m_cond.wakeAll();
+	m_mutex.unlock();
+
+	QThread::wait();
+}
+
+
+// The main thread executive.
+void Mirror::run (void)
+{
+	lscp_client_t *pClient = NULL;
+	bool bConnectError = false;
+	QString sWanted;
+
+	m_mutex.lock();
+	while (m_bRunState) {
+		if (m_sPending.isEmpty())
+			m_cond.wait(&m_mutex, QSAMPLER_MIRROR_VERIFY_MSECS);
+		if (!m_bRunState)
+			break;
+		if (!m_sPending.isEmpty()) {
+			sWanted = m_sPending;
+			m_sPending.clear();
+		}
+		m_mutex.unlock();
+		// We'll have our very own connection to the standby...
+		if (pClient == NULL) {
+			pClient = ::lscp_client_create(
+				m_sHost.toUtf8().constData(), m_iPort,
+				qsampler_mirror_callback, NULL);
+			if (pClient) {
+				::lscp_client_set_timeout(pClient, m_iTimeout);
+				// Whatever it has, it's unknown to us...
+				m_sApplied.clear();
+				bConnectError = false;
+			}
+			else
+			if (!bConnectError) {
+				notify(MirrorEvent::Error,
+					QObject::tr("Could not connect to standby server %1:%2.")
+					.arg(m_sHost).arg(m_iPort));
+				bConnectError = true;
+			}
+		}
+		bool bSynced = false;
+		if (pClient && !sWanted.isEmpty() && sWanted != m_sApplied) {
+			bSynced = (sync(pClient, sWanted) == 0);
+		}
+		else
+		if (pClient && !m_sApplied.isEmpty()) {
+			// Still there, alright?
+			if (::lscp_get_channels(pClient) < 0) {
+				notify(MirrorEvent::Error,
+					QObject::tr("Standby server %1:%2 is not responding.")
+					.arg(m_sHost).arg(m_iPort));
+				::lscp_client_destroy(pClient);
+				pClient = NULL;
+			} else {
+				bool bResync = false;
+				const QStringList& divergences = verify(pClient, &bResync);
+				// Only persistent ones are worth a word...
+				QStringListIterator iter(divergences);
+				while (iter.hasNext()) {
+					const QString& sText = iter.next();
+					if (m_divergences.contains(sText)
+						&& !m_reported.contains(sText)) {
+						notify(MirrorEvent::Divergence, sText);
+						m_reported.append(sText);
+					}
+				}
+				if (divergences.isEmpty() && !m_reported.isEmpty()) {
+					notify(MirrorEvent::Info,
+						QObject::tr("Standby server %1:%2 is back in sync.")
+						.arg(m_sHost).arg(m_iPort));
+					m_reported.clear();
+				}
+				m_divergences = divergences;
+				if (bResync)
+					m_sApplied.clear();
+				bSynced = divergences.isEmpty();
+			}
+		}
+		m_mutex.lock();
+		m_bSynced = (pClient && bSynced);
+	}
+	m_bSynced = false;
+	m_mutex.unlock();
+
+	if (pClient)
+		::lscp_client_destroy(pClient);
+}
+
+
+// Bring the standby up to the given state.
+int Mirror::sync ( lscp_client_t *pClient, const QString& sScript )
+{
+	const MirrorScript& script = mirrorParseScript(sScript);
+	const MirrorScript& applied = mirrorParseScript(m_sApplied);
+
+	const int iApplied = applied.channels.count();
+
+	QStringList commands;
+	bool bFull = (m_sApplied.isEmpty() || script.channels.count() < iApplied
+		|| !mirrorHeaderDiff(applied.header, script.header, commands));
+	for (int iChannel = 0; iChannel < iApplied && !bFull; ++iChannel) {
+		bFull = !mirrorChannelDiff(applied.channels.at(iChannel),
+			script.channels.at(iChannel), commands);
+	}
+
+	if (bFull) {
+		// Start all over...
+		commands = script.header;
+		QListIterator<QStringList> iter(script.channels);
+		while (iter.hasNext())
+			commands.append(iter.next());
+		commands.append(script.footer);
+	} else {
+		// New channels are added in order...
+		for (int iChannel = iApplied;
+				iChannel < script.channels.count(); ++iChannel)
+			commands.append(script.channels.at(iChannel));
+		QStringListIterator iter(script.footer);
+		while (iter.hasNext()) {
+			const QString& sLine = iter.next();
+			if (!applied.footer.contains(sLine))
+				commands.append(sLine);
+		}
+	}
+
+	int iErrors = 0;
+	QStringListIterator iter(commands);
+	while (iter.hasNext() && m_bRunState) {
+		if (!send(pClient, iter.next()))
+			++iErrors;
+	}
+
+	m_sApplied = sScript;
+	m_divergences.clear();
+
+	if (bFull) {
+		notify(iErrors > 0 ? MirrorEvent::Divergence : MirrorEvent::Info,
+			QObject::tr("Standby server %1:%2 synchronized (%3 commands, %4 errors).")
+			.arg(m_sHost).arg(m_iPort).arg(commands.count()).arg(iErrors));
+	}
+
+	return iErrors;
+}
+
+
+// Check the standby against the last replicated state.
+QStringList Mirror::verify ( lscp_client_t *pClient, bool *pbResync ) const
+{
+	QStringList divergences;
+
+	const MirrorScript& script = mirrorParseScript(m_sApplied);
+	const int iChannels = script.channels.count();
+
+	// We're not on the GUI thread, so ask the standby itself...
+	const qsamplerUtilities::lscpVersion_t version
+		= qsamplerUtilities::getRemoteLscpVersion(pClient);
+
+	// Channel count mismatch is beyond any repair...
+	const int iStandbyChannels = ::lscp_get_channels(pClient);
+	if (iStandbyChannels != iChannels) {
+		divergences.append(
+			QObject::tr("Standby server has %1 channels instead of %2.")
+			.arg(iStandbyChannels).arg(iChannels));
+		if (pbResync)
+			*pbResync = true;
+		return divergences;
+	}
+
+	for (int iChannel = 0; iChannel < iChannels; ++iChannel) {
+		QString sEngineName;
+		QString sInstrumentFile;
+		int iInstrumentNr = -1;
+		bool bMute = false;
+		bool bSolo = false;
+		QStringListIterator iter(script.channels.at(iChannel));
+		while (iter.hasNext()) {
+			const QString& sLine = iter.next();
+			if (sLine.startsWith("LOAD ENGINE "))
+				sEngineName = sLine.section(' ', 2, 2);
+			else
+			if (sLine.startsWith("LOAD INSTRUMENT ")) {
+				const int iQuote1 = sLine.indexOf('\'');
+				const int iQuote2 = sLine.lastIndexOf('\'');
+				if (iQuote1 >= 0 && iQuote2 > iQuote1) {
+					sInstrumentFile = qsamplerUtilities::lscpEscapedPathToPosix(
+						sLine.mid(iQuote1 + 1, iQuote2 - iQuote1 - 1), version);
+					iInstrumentNr = sLine.mid(iQuote2 + 1)
+						.simplified().section(' ', 0, 0).toInt();
+				}
+			}
+			else
+			if (sLine.startsWith("SET CHANNEL MUTE "))
+				bMute = (sLine.section(' ', 4, 4).toInt() > 0);
+			else
+			if (sLine.startsWith("SET CHANNEL SOLO "))
+				bSolo = (sLine.section(' ', 4, 4).toInt() > 0);
+		}
+		lscp_channel_info_t *pChannelInfo
+			= ::lscp_get_channel_info(pClient, iChannel);
+		if (pChannelInfo == NULL) {
+			divergences.append(
+				QObject::tr("Standby channel %1 is missing.").arg(iChannel));
+			continue;
+		}
+		const QString sStandbyEngineName = pChannelInfo->engine_name;
+		if (!sEngineName.isEmpty()
+			&& sEngineName.compare(sStandbyEngineName, Qt::CaseInsensitive)) {
+			divergences.append(
+				QObject::tr("Standby channel %1 engine is %2 instead of %3.")
+				.arg(iChannel).arg(sStandbyEngineName).arg(sEngineName));
+		}
+		if (!sInstrumentFile.isEmpty()) {
+			const QString& sStandbyFile = (pChannelInfo->instrument_file
+				? qsamplerUtilities::lscpEscapedPathToPosix(
+					pChannelInfo->instrument_file, version) : QString());
+			if (sStandbyFile != sInstrumentFile
+				|| pChannelInfo->instrument_nr != iInstrumentNr) {
+				divergences.append(
+					QObject::tr("Standby channel %1 instrument is "
+					"\"%2\" [%3] instead of \"%4\" [%5].")
+					.arg(iChannel).arg(sStandbyFile)
+					.arg(pChannelInfo->instrument_nr)
+					.arg(sInstrumentFile).arg(iInstrumentNr));
+			}
+			else
+			if (pChannelInfo->instrument_status < 0) {
+				divergences.append(
+					QObject::tr("Standby channel %1 instrument failed to load.")
+					.arg(iChannel));
+			}
+		}
+		if ((pChannelInfo->mute > 0) != bMute
+			|| (pChannelInfo->solo > 0) != bSolo) {
+			divergences.append(
+				QObject::tr("Standby channel %1 mute/solo state differs.")
+				.arg(iChannel));
+		}
+	}
+
+	return divergences;
+}
+
+
+// Send one command line to the standby.
+bool Mirror::send ( lscp_client_t *pClient, const QString& sCommand )
+{
+	const QString& sQuery = sCommand + "\r\n";
+	if (::lscp_client_query(pClient, sQuery.toUtf8().constData()) != LSCP_OK) {
+		notify(MirrorEvent::Divergence,
+			QObject::tr("Standby server: %1: %2").arg(sCommand)
+			.arg(QString::fromUtf8(::lscp_client_get_result(pClient))));
+		return false;
+	}
+
+	return true;
+}
+
+
+// Status notification.
+void Mirror::notify ( MirrorEvent::Kind kind, const QString& sText )
+{
+	QApplication::postEvent(m_pReceiver, new MirrorEvent(kind, sText));
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerMirror.cpp
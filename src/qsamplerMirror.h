@@ -0,0 +1,138 @@
+// qsamplerMirror.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerMirror_h
+#define __qsamplerMirror_h
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QStringList>
+#include <QEvent>
+
+#include <lscp/client.h>
+
+
+namespace QSampler {
+
+// Specialties for thread-callback comunication.
+#define QSAMPLER_MIRROR_EVENT QEvent::Type(QEvent::User + 3)
+
+
+//-------------------------------------------------------------------------
+// QSampler::MirrorEvent -- standby server status notification.
+
+class MirrorEvent : public QEvent
+{
+public:
+
+	// Notification kinds.
+	enum Kind { Info, Divergence, Error };
+
+	// Constructor.
+	MirrorEvent(Kind kind, const QString& sText)
+		: QEvent(QSAMPLER_MIRROR_EVENT), m_kind(kind), m_sText(sText) {}
+
+	// Accessors.
+	Kind kind() const { return m_kind; }
+	const QString& text() const { return m_sText; }
+
+private:
+
+	Kind    m_kind;
+	QString m_sText;
+};
+
+
+//-------------------------------------------------------------------------
+// QSampler::Mirror - hot-standby server state replicator.
+//
+
+class Mirror : public QThread
+{
+public:
+
+	// Constructor.
+	Mirror(QObject *pReceiver,
+		const QString& sHost, int iPort, int iTimeout);
+
+	// Destructor.
+	~Mirror();
+
+	// Standby server address.
+	const QString& host() const;
+	int port() const;
+
+	// Replicate the latest primary state (session script).
+	void update(const QString& sScript);
+
+	// Whether the standby is connected and in sync.
+	bool isSynced() const;
+
+	// Stop (and wait for) the thread.
+	void stop();
+
+protected:
+
+	// The main thread executive.
+	void run();
+
+	// Bring the standby up to the given state.
+	int sync(lscp_client_t *pClient, const QString& sScript);
+
+	// Check the standby against the last replicated state.
+	QStringList verify(lscp_client_t *pClient, bool *pbResync) const;
+
+	// Send one command line to the standby.
+	bool send(lscp_client_t *pClient, const QString& sCommand);
+
+	// Status notification.
+	void notify(MirrorEvent::Kind kind, const QString& sText);
+
+private:
+
+	// Instance variables.
+	QObject *m_pReceiver;
+
+	QString m_sHost;
+	int     m_iPort;
+	int     m_iTimeout;
+
+	mutable QMutex m_mutex;
+	QWaitCondition m_cond;
+
+	QString m_sPending;
+	QString m_sApplied;
+
+	QStringList m_divergences;
+	QStringList m_reported;
+
+	bool m_bRunState;
+	bool m_bSynced;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerMirror_h
+
+
+// end of qsamplerMirror.h
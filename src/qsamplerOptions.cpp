@@ -44,6 +44,13 @@ namespace QSampler {
 Options::Options (void)
 	: m_settings(QSAMPLER_DOMAIN, QSAMPLER_TITLE)
 {
+	// Command line only.
+	bHeadless = false;
+
+	// No session-only server switch, yet.
+	m_iConfigPort  = 0;
+	m_iSessionPort = 0;
+
 	loadOptions();
 }
 
@@ -71,6 +78,8 @@ void Options::loadOptions (void)
 #else
 	iServerTimeout = m_settings.value("/ServerTimeout", 1000).toInt();
 #endif
+	iBackgroundTimeout = m_settings.value("/BackgroundTimeout", 500).toInt();
+	iBulkTimeout   = m_settings.value("/BulkTimeout", 5000).toInt();
 	bServerStart   = m_settings.value("/ServerStart", true).toBool();
 #if defined(__APPLE__)
 	sServerCmdLine = m_settings.value("/ServerCmdLine", "/usr/local/bin/linuxsampler").toString();
@@ -78,6 +87,18 @@ void Options::loadOptions (void)
 	sServerCmdLine = m_settings.value("/ServerCmdLine", "linuxsampler").toString();
 #endif
 	iStartDelay    = m_settings.value("/StartDelay", 3).toInt();
+	bServerInstrumentNames = m_settings.value("/ServerInstrumentNames", false).toBool();
+	bServerWatchdog = m_settings.value("/ServerWatchdog", false).toBool();
+	sBalanceServers = m_settings.value("/BalanceServers").toString();
+	sMirrorServer  = m_settings.value("/MirrorServer").toString();
+	sServerCpus    = m_settings.value("/ServerCpus").toString();
+	sGuiCpus       = m_settings.value("/GuiCpus").toString();
+	iServerSchedPolicy   = m_settings.value("/ServerSchedPolicy", 0).toInt();
+	iServerSchedPriority = m_settings.value("/ServerSchedPriority", 20).toInt();
+	iServerMemlock = m_settings.value("/ServerMemlock", 0).toInt();
+	bLoadThrottle  = m_settings.value("/LoadThrottle", false).toBool();
+	iLoadPauseFill = m_settings.value("/LoadPauseFill", 50).toInt();
+	iLoadResumeFill = m_settings.value("/LoadResumeFill", 75).toInt();
 	m_settings.endGroup();
 
 	// Load logging options...
@@ -153,6 +174,16 @@ void Options::loadOptions (void)
 	iMidiProg      = m_settings.value("/MidiProg", 0).toInt();
 	iVolume        = m_settings.value("/Volume", 100).toInt();
 	iLoadMode      = m_settings.value("/Loadmode", 0).toInt();
+	sChannelTemplate     = m_settings.value("/ChannelTemplate").toString();
+	iTemplateCount       = m_settings.value("/TemplateCount", 16).toInt();
+	iTemplateMidiStep    = m_settings.value("/TemplateMidiStep", 1).toInt();
+	bTemplateMidiCarry   = m_settings.value("/TemplateMidiCarry", true).toBool();
+	iTemplateAudioRotate = m_settings.value("/TemplateAudioRotate", 0).toInt();
+	bTemplateInstrument  = m_settings.value("/TemplateInstrument", true).toBool();
+	sDbImportDir         = m_settings.value("/DbImportDir", "/").toString();
+	iDbImportMode        = m_settings.value("/DbImportMode", 0).toInt();
+	bDbImportFileAsDir   = m_settings.value("/DbImportFileAsDir", false).toBool();
+	iDbImportJobs        = m_settings.value("/DbImportJobs", 1).toInt();
 	m_settings.endGroup();
 }
 
@@ -168,14 +199,34 @@ void Options::saveOptions (void)
 	// And go into general options group.
 	m_settings.beginGroup("/Options");
 
-	// Save server options.
+	// Save server options (unless switched for the session only).
 	m_settings.beginGroup("/Server");
-	m_settings.setValue("/ServerHost", sServerHost);
-	m_settings.setValue("/ServerPort", iServerPort);
+	if (!m_sSessionHost.isEmpty()
+		&& sServerHost == m_sSessionHost && iServerPort == m_iSessionPort) {
+		m_settings.setValue("/ServerHost", m_sConfigHost);
+		m_settings.setValue("/ServerPort", m_iConfigPort);
+	} else {
+		m_settings.setValue("/ServerHost", sServerHost);
+		m_settings.setValue("/ServerPort", iServerPort);
+	}
 	m_settings.setValue("/ServerTimeout", iServerTimeout);
+	m_settings.setValue("/BackgroundTimeout", iBackgroundTimeout);
+	m_settings.setValue("/BulkTimeout", iBulkTimeout);
 	m_settings.setValue("/ServerStart", bServerStart);
 	m_settings.setValue("/ServerCmdLine", sServerCmdLine);
 	m_settings.setValue("/StartDelay", iStartDelay);
+	m_settings.setValue("/ServerInstrumentNames", bServerInstrumentNames);
+	m_settings.setValue("/ServerWatchdog", bServerWatchdog);
+	m_settings.setValue("/BalanceServers", sBalanceServers);
+	m_settings.setValue("/MirrorServer", sMirrorServer);
+	m_settings.setValue("/ServerCpus", sServerCpus);
+	m_settings.setValue("/GuiCpus", sGuiCpus);
+	m_settings.setValue("/ServerSchedPolicy", iServerSchedPolicy);
+	m_settings.setValue("/ServerSchedPriority", iServerSchedPriority);
+	m_settings.setValue("/ServerMemlock", iServerMemlock);
+	m_settings.setValue("/LoadThrottle", bLoadThrottle);
+	m_settings.setValue("/LoadPauseFill", iLoadPauseFill);
+	m_settings.setValue("/LoadResumeFill", iLoadResumeFill);
 	m_settings.endGroup();
 
 	// Save logging options...
@@ -244,6 +295,16 @@ void Options::saveOptions (void)
 	m_settings.setValue("/MidiProg", iMidiProg);
 	m_settings.setValue("/Volume", iVolume);
 	m_settings.setValue("/Loadmode", iLoadMode);
+	m_settings.setValue("/ChannelTemplate", sChannelTemplate);
+	m_settings.setValue("/TemplateCount", iTemplateCount);
+	m_settings.setValue("/TemplateMidiStep", iTemplateMidiStep);
+	m_settings.setValue("/TemplateMidiCarry", bTemplateMidiCarry);
+	m_settings.setValue("/TemplateAudioRotate", iTemplateAudioRotate);
+	m_settings.setValue("/TemplateInstrument", bTemplateInstrument);
+	m_settings.setValue("/DbImportDir", sDbImportDir);
+	m_settings.setValue("/DbImportMode", iDbImportMode);
+	m_settings.setValue("/DbImportFileAsDir", bDbImportFileAsDir);
+	m_settings.setValue("/DbImportJobs", iDbImportJobs);
 	m_settings.endGroup();
 
 	// Save/commit to disk.
@@ -275,6 +336,13 @@ void Options::print_usage ( const QString& arg0 )
 		"  -s, --start\n\tStart linuxsampler server locally\n\n"
 		"  -h, --hostname\n\tSpecify linuxsampler server hostname (default = localhost)\n\n"
 		"  -p, --port\n\tSpecify linuxsampler server port number (default = 8888)\n\n"
+#ifdef CONFIG_SCRIPT
+		"  -x, --script\n\tRun a script file once connected\n\n"
+#endif
+		"  -i, --import\n\tImport a (server-side) directory into the instruments DB\n\n"
+		"  -d, --import-dir\n\tSpecify the instruments DB directory to import into (default = /)\n\n"
+		"  -j, --import-jobs\n\tSpecify how many import jobs may run at once (default = 1)\n\n"
+		"  -n, --headless\n\tRun the script or imports without the main window, then quit\n\n"
 		"  -?, --help\n\tShow help about command line options\n\n"
 		"  -v, --version\n\tShow version information\n\n")
 		.arg(arg0);
@@ -332,6 +400,47 @@ bool Options::parse_args ( const QStringList& args )
 			if (iEqual < 0)
 				i++;
 		}
+	#ifdef CONFIG_SCRIPT
+		else if (sArg == "-x" || sArg == "--script") {
+			if (sVal.isNull()) {
+				out << QObject::tr("Option -x requires an argument (file).") + sEol;
+				return false;
+			}
+			sScriptFile = sVal;
+			if (iEqual < 0)
+				i++;
+		}
+	#endif
+		else if (sArg == "-i" || sArg == "--import") {
+			if (sVal.isNull()) {
+				out << QObject::tr("Option -i requires an argument (path).") + sEol;
+				return false;
+			}
+			dbImportPaths.append(sVal);
+			if (iEqual < 0)
+				i++;
+		}
+		else if (sArg == "-d" || sArg == "--import-dir") {
+			if (sVal.isNull() || sVal[0] != '/') {
+				out << QObject::tr("Option -d requires an argument (absolute DB directory).") + sEol;
+				return false;
+			}
+			sDbImportDir = sVal;
+			if (iEqual < 0)
+				i++;
+		}
+		else if (sArg == "-j" || sArg == "--import-jobs") {
+			if (sVal.isNull() || sVal.toInt() < 1) {
+				out << QObject::tr("Option -j requires an argument (jobs).") + sEol;
+				return false;
+			}
+			iDbImportJobs = sVal.toInt();
+			if (iEqual < 0)
+				i++;
+		}
+		else if (sArg == "-n" || sArg == "--headless") {
+			bHeadless = true;
+		}
 		else if (sArg == "-?" || sArg == "--help") {
 			print_usage(args.at(0));
 			return false;
@@ -357,11 +466,36 @@ bool Options::parse_args ( const QStringList& args )
 		}
 	}
 
+	// Nothing to do without a window, but a script or imports.
+	if (bHeadless && sScriptFile.isEmpty() && dbImportPaths.isEmpty()) {
+		out << QObject::tr("Option -n requires a script (-x) or an import (-i).") + sEol;
+		return false;
+	}
+
 	// Alright with argument parsing.
 	return true;
 }
 
 
+//---------------------------------------------------------------------------
+// Session-only server switch.
+
+void Options::setSessionServer ( const QString& sHost, int iPort )
+{
+	// Remember the configured one, only the first time around...
+	if (m_sSessionHost.isEmpty()) {
+		m_sConfigHost = sServerHost;
+		m_iConfigPort = iServerPort;
+	}
+
+	m_sSessionHost = sHost;
+	m_iSessionPort = iPort;
+
+	sServerHost = sHost;
+	iServerPort = iPort;
+}
+
+
 //---------------------------------------------------------------------------
 // Widget geometry persistence helper methods.
 
@@ -60,13 +60,39 @@ public:
 	// Startup supplied session file.
 	QString sSessionFile;
 
+	// Startup supplied script file,
+	// and whether it's all there is to it.
+	QString sScriptFile;
+	bool    bHeadless;
+
+	// Startup supplied instruments DB imports.
+	QStringList dbImportPaths;
+
 	// Server options...
 	QString sServerHost;
 	int     iServerPort;
 	int     iServerTimeout;
+	int     iBackgroundTimeout;
+	int     iBulkTimeout;
 	bool    bServerStart;
 	QString sServerCmdLine;
 	int     iStartDelay;
+	bool    bServerInstrumentNames;
+	bool    bServerWatchdog;
+	QString sBalanceServers;
+	QString sMirrorServer;
+
+	// Scheduling options...
+	QString sServerCpus;
+	QString sGuiCpus;
+	int     iServerSchedPolicy;
+	int     iServerSchedPriority;
+	int     iServerMemlock;
+
+	// Background loading options...
+	bool    bLoadThrottle;
+	int     iLoadPauseFill;
+	int     iLoadResumeFill;
 
 	// Logging options...
 	bool    bMessagesLog;
@@ -109,10 +135,28 @@ public:
 	int     iVolume;
 	int     iLoadMode;
 
+	// Channel template instantiation defaults.
+	QString sChannelTemplate;
+	int     iTemplateCount;
+	int     iTemplateMidiStep;
+	bool    bTemplateMidiCarry;
+	int     iTemplateAudioRotate;
+	bool    bTemplateInstrument;
+
+	// Instruments DB import defaults.
+	QString sDbImportDir;
+	int     iDbImportMode;
+	bool    bDbImportFileAsDir;
+	int     iDbImportJobs;
+
 	// Recent file list.
 	int     iMaxRecentFiles;
 	QStringList recentFiles;
 
+	// Session-only server switch (eg. failover to the standby),
+	// never saved over the configured one.
+	void setSessionServer(const QString& sHost, int iPort);
+
 	// Widget geometry persistence helper prototypes.
 	void saveWidgetGeometry(QWidget *pWidget, bool bVisible = false);
 	void loadWidgetGeometry(QWidget *pWidget, bool bVisible = false);
@@ -136,6 +180,12 @@ private:
 	// Settings member variables.
 	QSettings m_settings;
 
+	// The configured server, while switched for the session.
+	QString m_sConfigHost;
+	int     m_iConfigPort;
+	QString m_sSessionHost;
+	int     m_iSessionPort;
+
 	// Tuning
 	int iMaxVoices;
 	int iMaxStreams;
@@ -24,6 +24,7 @@
 
 #include "qsamplerAbout.h"
 #include "qsamplerOptions.h"
+#include "qsamplerServerProcess.h"
 
 #include <QMessageBox>
 #include <QFontDialog>
@@ -73,6 +74,36 @@ OptionsForm::OptionsForm ( QWidget* pParent )
 	QObject::connect(m_ui.StartDelaySpinBox,
 		SIGNAL(valueChanged(int)),
 		SLOT(optionsChanged()));
+	QObject::connect(m_ui.ServerInstrumentNamesCheckBox,
+		SIGNAL(stateChanged(int)),
+		SLOT(optionsChanged()));
+	QObject::connect(m_ui.ServerWatchdogCheckBox,
+		SIGNAL(stateChanged(int)),
+		SLOT(optionsChanged()));
+	QObject::connect(m_ui.ServerCpusLineEdit,
+		SIGNAL(textChanged(const QString&)),
+		SLOT(optionsChanged()));
+	QObject::connect(m_ui.GuiCpusLineEdit,
+		SIGNAL(textChanged(const QString&)),
+		SLOT(optionsChanged()));
+	QObject::connect(m_ui.ServerSchedPolicyComboBox,
+		SIGNAL(activated(int)),
+		SLOT(optionsChanged()));
+	QObject::connect(m_ui.ServerSchedPrioritySpinBox,
+		SIGNAL(valueChanged(int)),
+		SLOT(optionsChanged()));
+	QObject::connect(m_ui.ServerMemlockSpinBox,
+		SIGNAL(valueChanged(int)),
+		SLOT(optionsChanged()));
+	QObject::connect(m_ui.LoadThrottleCheckBox,
+		SIGNAL(stateChanged(int)),
+		SLOT(optionsChanged()));
+	QObject::connect(m_ui.LoadPauseFillSpinBox,
+		SIGNAL(valueChanged(int)),
+		SLOT(optionsChanged()));
+	QObject::connect(m_ui.LoadResumeFillSpinBox,
+		SIGNAL(valueChanged(int)),
+		SLOT(optionsChanged()));
 	QObject::connect(m_ui.MessagesLogCheckBox,
 		SIGNAL(stateChanged(int)),
 		SLOT(optionsChanged()));
@@ -178,6 +209,20 @@ void OptionsForm::setup ( Options *pOptions )
 	m_ui.ServerStartCheckBox->setChecked(m_pOptions->bServerStart);
 	m_ui.ServerCmdLineComboBox->setEditText(m_pOptions->sServerCmdLine);
 	m_ui.StartDelaySpinBox->setValue(m_pOptions->iStartDelay);
+	m_ui.ServerInstrumentNamesCheckBox->setChecked(m_pOptions->bServerInstrumentNames);
+	m_ui.ServerWatchdogCheckBox->setChecked(m_pOptions->bServerWatchdog);
+
+	// Scheduling options...
+	m_ui.ServerCpusLineEdit->setText(m_pOptions->sServerCpus);
+	m_ui.GuiCpusLineEdit->setText(m_pOptions->sGuiCpus);
+	m_ui.ServerSchedPolicyComboBox->setCurrentIndex(m_pOptions->iServerSchedPolicy);
+	m_ui.ServerSchedPrioritySpinBox->setValue(m_pOptions->iServerSchedPriority);
+	m_ui.ServerMemlockSpinBox->setValue(m_pOptions->iServerMemlock);
+
+	// Background loading options...
+	m_ui.LoadThrottleCheckBox->setChecked(m_pOptions->bLoadThrottle);
+	m_ui.LoadPauseFillSpinBox->setValue(m_pOptions->iLoadPauseFill);
+	m_ui.LoadResumeFillSpinBox->setValue(m_pOptions->iLoadResumeFill);
 
 	// Logging options...
 	m_ui.MessagesLogCheckBox->setChecked(m_pOptions->bMessagesLog);
@@ -299,6 +344,18 @@ void OptionsForm::accept (void)
 		m_pOptions->bServerStart   = m_ui.ServerStartCheckBox->isChecked();
 		m_pOptions->sServerCmdLine = m_ui.ServerCmdLineComboBox->currentText().trimmed();
 		m_pOptions->iStartDelay    = m_ui.StartDelaySpinBox->value();
+		m_pOptions->bServerInstrumentNames = m_ui.ServerInstrumentNamesCheckBox->isChecked();
+		m_pOptions->bServerWatchdog = m_ui.ServerWatchdogCheckBox->isChecked();
+		// Scheduling options...
+		m_pOptions->sServerCpus    = m_ui.ServerCpusLineEdit->text().trimmed();
+		m_pOptions->sGuiCpus       = m_ui.GuiCpusLineEdit->text().trimmed();
+		m_pOptions->iServerSchedPolicy = m_ui.ServerSchedPolicyComboBox->currentIndex();
+		m_pOptions->iServerSchedPriority = m_ui.ServerSchedPrioritySpinBox->value();
+		m_pOptions->iServerMemlock = m_ui.ServerMemlockSpinBox->value();
+		// Background loading options...
+		m_pOptions->bLoadThrottle  = m_ui.LoadThrottleCheckBox->isChecked();
+		m_pOptions->iLoadPauseFill = m_ui.LoadPauseFillSpinBox->value();
+		m_pOptions->iLoadResumeFill = m_ui.LoadResumeFillSpinBox->value();
 		// Logging options...
 		m_pOptions->bMessagesLog   = m_ui.MessagesLogCheckBox->isChecked();
 		m_pOptions->sMessagesLogPath = m_ui.MessagesLogPathComboBox->currentText();
@@ -398,6 +455,36 @@ void OptionsForm::stabilizeForm (void)
 	m_ui.ServerCmdLineComboBox->setEnabled(bEnabled);
 	m_ui.StartDelayTextLabel->setEnabled(bEnabled);
 	m_ui.StartDelaySpinBox->setEnabled(bEnabled);
+	m_ui.ServerWatchdogCheckBox->setEnabled(bEnabled);
+
+	const bool bSched = ServerProcess::isSchedSupported();
+	m_ui.SchedulingGroupBox->setEnabled(bSched);
+	m_ui.ServerCpusTextLabel->setEnabled(bEnabled);
+	m_ui.ServerCpusLineEdit->setEnabled(bEnabled);
+	m_ui.ServerSchedPolicyTextLabel->setEnabled(bEnabled);
+	m_ui.ServerSchedPolicyComboBox->setEnabled(bEnabled);
+	m_ui.ServerMemlockTextLabel->setEnabled(bEnabled);
+	m_ui.ServerMemlockSpinBox->setEnabled(bEnabled);
+	const bool bRealtime = bEnabled
+		&& m_ui.ServerSchedPolicyComboBox->currentIndex() > 0;
+	m_ui.ServerSchedPriorityTextLabel->setEnabled(bRealtime);
+	m_ui.ServerSchedPrioritySpinBox->setEnabled(bRealtime);
+
+	QList<int> cpus;
+	if (bSched && bValid) {
+		bValid = ServerProcess::parseCpus(m_ui.ServerCpusLineEdit->text(), cpus)
+			&& ServerProcess::parseCpus(m_ui.GuiCpusLineEdit->text(), cpus);
+	}
+
+	const bool bThrottle = m_ui.LoadThrottleCheckBox->isChecked();
+	m_ui.LoadPauseFillTextLabel->setEnabled(bThrottle);
+	m_ui.LoadPauseFillSpinBox->setEnabled(bThrottle);
+	m_ui.LoadResumeFillTextLabel->setEnabled(bThrottle);
+	m_ui.LoadResumeFillSpinBox->setEnabled(bThrottle);
+	if (bThrottle && bValid) {
+		bValid = (m_ui.LoadPauseFillSpinBox->value()
+			< m_ui.LoadResumeFillSpinBox->value());
+	}
 
 	bEnabled = m_ui.MessagesLogCheckBox->isChecked();
 	m_ui.MessagesLogPathComboBox->setEnabled(bEnabled);
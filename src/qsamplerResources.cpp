@@ -0,0 +1,339 @@
+// qsamplerResources.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerResources.h"
+
+#include <QObject>
+#include <QTextStream>
+#include <QDateTime>
+#include <QStringList>
+#include <QFile>
+
+
+namespace QSampler {
+
+// Sample history capacity; older half gets thinned out when full.
+#define QSAMPLER_RESOURCES_HISTORY        1000
+
+// Minimum sampling (samples and time span, msecs) for trend detection.
+#define QSAMPLER_RESOURCES_TREND_SAMPLES  12
+#define QSAMPLER_RESOURCES_TREND_MSECS    (30 * 60 * 1000)
+
+
+//-------------------------------------------------------------------------
+// QSampler::Resources - live object accounting.
+//
+
+// Class-wide counters.
+QAtomicInt Resources::g_counts[Resources::Kinds];
+
+
+// Live object counting (thread-safe).
+void Resources::acquire ( Kind kind )
+{
+	g_counts[kind].ref();
+}
+
+void Resources::release ( Kind kind )
+{
+	g_counts[kind].deref();
+}
+
+
+int Resources::count ( Kind kind )
+{
+	return g_counts[kind].fetchAndAddOrdered(0);
+}
+
+
+//-------------------------------------------------------------------------
+// QSampler::ResourceMonitor - resource usage sampler and trend detector.
+//
+
+// Constructor.
+ResourceMonitor::ResourceMonitor (void)
+{
+	reset();
+}
+
+
+// Take one sample of everything.
+void ResourceMonitor::sample ( int iMessagesSize )
+{
+	Sample sample;
+	sample.iTime = m_timer.elapsed();
+	for (int i = 0; i < Resources::Kinds; ++i)
+		sample.values[i] = Resources::count(Resources::Kind(i));
+	sample.values[MessagesSize] = iMessagesSize;
+	sample.values[ProcessRss] = processRss();
+
+	for (int i = 0; i < Metrics; ++i) {
+		if (m_peaks[i] < sample.values[i])
+			m_peaks[i] = sample.values[i];
+	}
+
+	m_samples.append(sample);
+
+	// Keep it bounded: thin out the older half, leaving the
+	// very first (baseline) sample and the recent ones alone.
+	if (m_samples.count() > QSAMPLER_RESOURCES_HISTORY) {
+		const int iHalf = QSAMPLER_RESOURCES_HISTORY / 2;
+		QList<Sample> samples;
+		for (int i = 0; i < m_samples.count(); ++i) {
+			if ((i & 1) == 0 || i >= iHalf)
+				samples.append(m_samples.at(i));
+		}
+		m_samples = samples;
+	}
+}
+
+
+// Start all over (the next sample is the new baseline).
+void ResourceMonitor::reset (void)
+{
+	m_samples.clear();
+
+	for (int i = 0; i < Metrics; ++i)
+		m_peaks[i] = -1;
+
+	m_timer.start();
+}
+
+
+// Sampling accessors.
+int ResourceMonitor::samples (void) const
+{
+	return m_samples.count();
+}
+
+int ResourceMonitor::elapsed (void) const
+{
+	if (m_samples.isEmpty())
+		return 0;
+
+	return int(m_samples.last().iTime - m_samples.first().iTime);
+}
+
+
+// Per metric values (-1 if not known).
+int ResourceMonitor::current ( int iMetric ) const
+{
+	if (m_samples.isEmpty())
+		return -1;
+
+	return m_samples.last().values[iMetric];
+}
+
+int ResourceMonitor::baseline ( int iMetric ) const
+{
+	if (m_samples.isEmpty())
+		return -1;
+
+	return m_samples.first().values[iMetric];
+}
+
+int ResourceMonitor::peak ( int iMetric ) const
+{
+	return m_peaks[iMetric];
+}
+
+
+// Overall growth rate (per hour, least squares fit).
+float ResourceMonitor::growth ( int iMetric ) const
+{
+	double n = 0.0, sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+
+	QListIterator<Sample> iter(m_samples);
+	while (iter.hasNext()) {
+		const Sample& sample = iter.next();
+		if (sample.values[iMetric] < 0)
+			continue;
+		const double x = double(sample.iTime) / 3600000.0;
+		const double y = double(sample.values[iMetric]);
+		n   += 1.0;
+		sx  += x;
+		sy  += y;
+		sxx += x * x;
+		sxy += x * y;
+	}
+
+	const double d = n * sxx - sx * sx;
+	if (n < 2.0 || d <= 0.0)
+		return 0.0f;
+
+	return float((n * sxy - sx * sy) / d);
+}
+
+
+// Whether it has been growing steadily, all along.
+bool ResourceMonitor::isGrowing ( int iMetric ) const
+{
+	if (m_samples.count() < QSAMPLER_RESOURCES_TREND_SAMPLES)
+		return false;
+
+	const qint64 iStart = m_samples.first().iTime;
+	const qint64 iSpan  = m_samples.last().iTime - iStart;
+	if (iSpan < QSAMPLER_RESOURCES_TREND_MSECS)
+		return false;
+
+	// Mean value over each quarter of the whole time span...
+	double sums[4] = { 0.0, 0.0, 0.0, 0.0 };
+	int counts[4]  = { 0, 0, 0, 0 };
+
+	QListIterator<Sample> iter(m_samples);
+	while (iter.hasNext()) {
+		const Sample& sample = iter.next();
+		if (sample.values[iMetric] < 0)
+			continue;
+		const int q = int((4 * (sample.iTime - iStart)) / (iSpan + 1));
+		sums[q] += double(sample.values[iMetric]);
+		++counts[q];
+	}
+
+	double means[4];
+	for (int q = 0; q < 4; ++q) {
+		if (counts[q] < 1)
+			return false;
+		means[q] = sums[q] / double(counts[q]);
+	}
+
+	// Must go up on each quarter: a single step up
+	// (eg. a few more channels) is not a leak...
+	for (int q = 1; q < 4; ++q) {
+		if (means[q] <= means[q - 1])
+			return false;
+	}
+
+	// ...and by some significant amount.
+	return (means[3] - means[0] >= qMax(1.0, 0.01 * means[0]));
+}
+
+
+// Metric description.
+QString ResourceMonitor::metricName ( int iMetric )
+{
+	switch (iMetric) {
+		case Resources::Channels:
+			return QObject::tr("Channels");
+		case Resources::ChannelStrips:
+			return QObject::tr("Channel strips");
+		case Resources::Instruments:
+			return QObject::tr("MIDI instruments");
+		case Resources::Devices:
+			return QObject::tr("Devices");
+		case Resources::DevicePorts:
+			return QObject::tr("Device ports");
+		case Resources::FxSends:
+			return QObject::tr("FX sends");
+		case Resources::LscpEvents:
+			return QObject::tr("Pending events");
+		case Resources::DeviceStatusForms:
+			return QObject::tr("Device status windows");
+		case MessagesSize:
+			return QObject::tr("Messages (chars)");
+		case ProcessRss:
+			return QObject::tr("Process RSS (KB)");
+		default:
+			break;
+	}
+
+	return QString::null;
+}
+
+
+// Current process resident set size (KB; -1 if not known).
+int ResourceMonitor::processRss (void)
+{
+	int iRss = -1;
+
+#if defined(__linux__)
+	QFile status("/proc/self/status");
+	if (status.open(QIODevice::ReadOnly)) {
+		QTextStream ts(&status);
+		while (!ts.atEnd()) {
+			const QString& sLine = ts.readLine();
+			if (sLine.startsWith("VmRSS:")) {
+				iRss = sLine.simplified().section(' ', 1, 1).toInt();
+				break;
+			}
+		}
+	}
+#endif
+
+	return iRss;
+}
+
+
+// Diagnostic dump (plain text).
+QString ResourceMonitor::dump (void) const
+{
+	QString sText;
+	QTextStream ts(&sText, QIODevice::WriteOnly);
+
+	ts << QSAMPLER_TITLE " " QSAMPLER_VERSION " - "
+		<< QObject::tr("Resources") << " --- "
+		<< QDateTime::currentDateTime().toString() << endl;
+	ts << QObject::tr("%1 samples over %2 minutes.")
+		.arg(samples()).arg(elapsed() / 60000) << endl;
+	ts << endl;
+
+	// Summary table...
+	ts << QString(QObject::tr("Resource")).leftJustified(24)
+		<< QString(QObject::tr("Current")).rightJustified(12)
+		<< QString(QObject::tr("Baseline")).rightJustified(12)
+		<< QString(QObject::tr("Peak")).rightJustified(12)
+		<< QString(QObject::tr("Growth/h")).rightJustified(12)
+		<< "  " << QObject::tr("Trend") << endl;
+	for (int i = 0; i < Metrics; ++i) {
+		ts << metricName(i).leftJustified(24)
+			<< QString::number(current(i)).rightJustified(12)
+			<< QString::number(baseline(i)).rightJustified(12)
+			<< QString::number(peak(i)).rightJustified(12)
+			<< QString::number(growth(i), 'f', 2).rightJustified(12)
+			<< "  " << (isGrowing(i)
+				? QObject::tr("growing") : QObject::tr("steady")) << endl;
+	}
+	ts << endl;
+
+	// Whole sample history (tab separated)...
+	QStringList headers;
+	headers << QObject::tr("Minutes");
+	for (int i = 0; i < Metrics; ++i)
+		headers << metricName(i);
+	ts << headers.join("\t") << endl;
+
+	QListIterator<Sample> iter(m_samples);
+	while (iter.hasNext()) {
+		const Sample& sample = iter.next();
+		ts << QString::number(double(sample.iTime) / 60000.0, 'f', 1);
+		for (int i = 0; i < Metrics; ++i)
+			ts << '\t' << sample.values[i];
+		ts << endl;
+	}
+
+	return sText;
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerResources.cpp
@@ -0,0 +1,157 @@
+// qsamplerResources.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerResources_h
+#define __qsamplerResources_h
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QString>
+#include <QList>
+
+
+namespace QSampler {
+
+//-------------------------------------------------------------------------
+// QSampler::Resources - live object accounting.
+//
+
+class Resources
+{
+public:
+
+	// Accounted object kinds.
+	enum Kind {
+		Channels = 0,
+		ChannelStrips,
+		Instruments,
+		Devices,
+		DevicePorts,
+		FxSends,
+		LscpEvents,         // Pending (posted, not yet dispatched).
+		DeviceStatusForms,
+		Kinds               // Count.
+	};
+
+	// Live object counting (thread-safe).
+	static void acquire(Kind kind);
+	static void release(Kind kind);
+
+	static int count(Kind kind);
+
+private:
+
+	// Class-wide counters.
+	static QAtomicInt g_counts[Kinds];
+};
+
+
+//-------------------------------------------------------------------------
+// QSampler::ResourceCount - live object counter, as a class member
+// (so that copies are accounted for as well).
+//
+
+template <Resources::Kind K>
+class ResourceCount
+{
+public:
+
+	ResourceCount() { Resources::acquire(K); }
+	ResourceCount(const ResourceCount&) { Resources::acquire(K); }
+
+	~ResourceCount() { Resources::release(K); }
+
+	ResourceCount& operator= (const ResourceCount&) { return *this; }
+};
+
+
+//-------------------------------------------------------------------------
+// QSampler::ResourceMonitor - resource usage sampler and trend detector.
+//
+
+class ResourceMonitor
+{
+public:
+
+	// Sampled metrics: all the live object counts, then...
+	enum Metric {
+		MessagesSize = Resources::Kinds,
+		ProcessRss,
+		Metrics             // Count.
+	};
+
+	// Constructor.
+	ResourceMonitor();
+
+	// Take one sample of everything.
+	void sample(int iMessagesSize);
+
+	// Start all over (the next sample is the new baseline).
+	void reset();
+
+	// Sampling accessors.
+	int samples() const;
+	int elapsed() const;
+
+	// Per metric values (-1 if not known).
+	int current(int iMetric) const;
+	int baseline(int iMetric) const;
+	int peak(int iMetric) const;
+
+	// Overall growth rate (per hour, least squares fit).
+	float growth(int iMetric) const;
+
+	// Whether it has been growing steadily, all along.
+	bool isGrowing(int iMetric) const;
+
+	// Metric description.
+	static QString metricName(int iMetric);
+
+	// Current process resident set size (KB; -1 if not known).
+	static int processRss();
+
+	// Diagnostic dump (plain text).
+	QString dump() const;
+
+private:
+
+	// One sample of everything.
+	struct Sample
+	{
+		qint64 iTime;       // Since reset (msecs).
+		int    values[Metrics];
+	};
+
+	// Instance variables.
+	QList<Sample> m_samples;
+
+	int m_peaks[Metrics];
+
+	QElapsedTimer m_timer;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerResources_h
+
+
+// end of qsamplerResources.h
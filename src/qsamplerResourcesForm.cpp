@@ -0,0 +1,210 @@
+// qsamplerResourcesForm.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerResourcesForm.h"
+
+#include "qsamplerMainForm.h"
+#include "qsamplerMessages.h"
+
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QFile>
+#include <QTextStream>
+#include <QTimer>
+
+#include <QShowEvent>
+#include <QHideEvent>
+
+
+namespace QSampler {
+
+// Resource sampling period (msecs).
+#define QSAMPLER_RESOURCES_PERIOD_MSECS  10000
+
+
+//-------------------------------------------------------------------------
+// QSampler::ResourcesForm -- resource usage monitor form.
+//
+
+// Constructor.
+ResourcesForm::ResourcesForm ( QWidget *pParent, Qt::WindowFlags wflags )
+	: QWidget(pParent, wflags)
+{
+	m_ui.setupUi(this);
+
+	m_ui.ResourcesListView->header()->resizeSection(0, 200);
+	for (int i = 0; i < ResourceMonitor::Metrics; ++i) {
+		QTreeWidgetItem *pItem = new QTreeWidgetItem(m_ui.ResourcesListView);
+		pItem->setText(0, ResourceMonitor::metricName(i));
+		for (int j = 1; j < 5; ++j)
+			pItem->setTextAlignment(j, Qt::AlignRight);
+		m_growing[i] = false;
+	}
+
+	m_pTimer = new QTimer(this);
+
+	QObject::connect(m_pTimer,
+		SIGNAL(timeout()),
+		SLOT(timerSlot()));
+	QObject::connect(m_ui.ResetPushButton,
+		SIGNAL(clicked()),
+		SLOT(resetResources()));
+	QObject::connect(m_ui.DumpPushButton,
+		SIGNAL(clicked()),
+		SLOT(dumpResources()));
+
+	// Resources are sampled whether we're visible or not.
+	m_pTimer->start(QSAMPLER_RESOURCES_PERIOD_MSECS);
+}
+
+
+// Destructor.
+ResourcesForm::~ResourcesForm (void)
+{
+}
+
+
+// Start all over, from a new baseline.
+void ResourcesForm::resetResources (void)
+{
+	m_monitor.reset();
+
+	for (int i = 0; i < ResourceMonitor::Metrics; ++i)
+		m_growing[i] = false;
+
+	timerSlot();
+}
+
+
+// Save a diagnostic dump to file.
+void ResourcesForm::dumpResources (void)
+{
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL)
+		return;
+
+	const QString& sFilename = QFileDialog::getSaveFileName(this,
+		QSAMPLER_TITLE ": " + tr("Save Resources Dump"), // Caption.
+		"qsampler-resources.txt",                        // Start here.
+		tr("Text files") + " (*.txt)"                    // Filter.
+	);
+
+	if (sFilename.isEmpty())
+		return;
+
+	QFile file(sFilename);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		pMainForm->appendMessagesError(
+			tr("Could not open \"%1\" dump file.\n\nSorry.")
+			.arg(sFilename));
+		return;
+	}
+
+	QTextStream ts(&file);
+	ts << m_monitor.dump();
+	file.close();
+
+	pMainForm->appendMessages(tr("Resources dump saved: \"%1\".")
+		.arg(sFilename));
+}
+
+
+// Periodic sampling and view refreshment.
+void ResourcesForm::timerSlot (void)
+{
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL)
+		return;
+
+	Messages *pMessages = pMainForm->messages();
+	m_monitor.sample(pMessages ? pMessages->messagesSize() : -1);
+
+	// Let it be known, once, whatever keeps growing...
+	for (int i = 0; i < ResourceMonitor::Metrics; ++i) {
+		const bool bGrowing = m_monitor.isGrowing(i);
+		if (bGrowing && !m_growing[i]) {
+			pMainForm->appendMessagesColor(
+				tr("Resources: %1 keeps growing (%2 per hour, now %3).")
+				.arg(ResourceMonitor::metricName(i))
+				.arg(m_monitor.growth(i), 0, 'f', 2)
+				.arg(m_monitor.current(i)), "#996633");
+		}
+		m_growing[i] = bGrowing;
+	}
+
+	if (isVisible())
+		refreshResources();
+}
+
+
+// Notify our parent that we're emerging.
+void ResourcesForm::showEvent ( QShowEvent *pShowEvent )
+{
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm)
+		pMainForm->stabilizeForm();
+
+	refreshResources();
+
+	QWidget::showEvent(pShowEvent);
+}
+
+
+// Notify our parent that we're closing.
+void ResourcesForm::hideEvent ( QHideEvent *pHideEvent )
+{
+	QWidget::hideEvent(pHideEvent);
+
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm)
+		pMainForm->stabilizeForm();
+}
+
+
+// View refresher.
+void ResourcesForm::refreshResources (void)
+{
+	for (int i = 0; i < ResourceMonitor::Metrics; ++i) {
+		QTreeWidgetItem *pItem = m_ui.ResourcesListView->topLevelItem(i);
+		if (pItem == NULL)
+			continue;
+		pItem->setText(1, QString::number(m_monitor.current(i)));
+		pItem->setText(2, QString::number(m_monitor.baseline(i)));
+		pItem->setText(3, QString::number(m_monitor.peak(i)));
+		pItem->setText(4, QString::number(m_monitor.growth(i), 'f', 2));
+		if (m_growing[i]) {
+			pItem->setText(5, tr("growing"));
+			pItem->setForeground(5, Qt::red);
+		} else {
+			pItem->setText(5, tr("steady"));
+			pItem->setForeground(5, palette().text());
+		}
+	}
+
+	m_ui.SummaryTextLabel->setText(tr("%1 samples over %2 minutes")
+		.arg(m_monitor.samples()).arg(m_monitor.elapsed() / 60000));
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerResourcesForm.cpp
@@ -0,0 +1,91 @@
+// qsamplerResourcesForm.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerResourcesForm_h
+#define __qsamplerResourcesForm_h
+
+#include "ui_qsamplerResourcesForm.h"
+
+#include "qsamplerResources.h"
+
+class QTimer;
+
+
+namespace QSampler {
+
+//-------------------------------------------------------------------------
+// QSampler::ResourcesForm -- resource usage monitor form.
+//
+
+class ResourcesForm : public QWidget
+{
+	Q_OBJECT
+
+public:
+
+	// Constructor.
+	ResourcesForm(QWidget *pParent = NULL, Qt::WindowFlags wflags = 0);
+
+	// Destructor.
+	~ResourcesForm();
+
+public slots:
+
+	// Start all over, from a new baseline.
+	void resetResources();
+
+	// Save a diagnostic dump to file.
+	void dumpResources();
+
+protected slots:
+
+	// Periodic sampling and view refreshment.
+	void timerSlot();
+
+protected:
+
+	void showEvent(QShowEvent *pShowEvent);
+	void hideEvent(QHideEvent *pHideEvent);
+
+	// View refresher.
+	void refreshResources();
+
+private:
+
+	// The Qt-designer UI struct...
+	Ui::qsamplerResourcesForm m_ui;
+
+	// Instance variables.
+	ResourceMonitor m_monitor;
+
+	// Metrics already known (and warned) to be growing.
+	bool m_growing[ResourceMonitor::Metrics];
+
+	QTimer *m_pTimer;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerResourcesForm_h
+
+
+// end of qsamplerResourcesForm.h
@@ -0,0 +1,777 @@
+// qsamplerScript.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerScript.h"
+
+#ifdef CONFIG_SCRIPT
+
+#include "qsamplerOptions.h"
+#include "qsamplerChannel.h"
+#include "qsamplerChannelStrip.h"
+#include "qsamplerMainForm.h"
+#include "qsamplerUtilities.h"
+
+#include <QApplication>
+#include <QJSValueIterator>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QRegExp>
+#include <QFileInfo>
+#include <QFile>
+#include <QTimer>
+
+#include <lscp/client.h>
+
+#include <stdio.h>
+
+
+namespace QSampler {
+
+// Replies are delivered at least every so many commands.
+#define QSAMPLER_SCRIPT_REPLIES  32
+
+
+// The dedicated connection is not subscribed to any events.
+static lscp_status_t qsampler_script_callback ( lscp_client_t */*pClient*/,
+	lscp_event_t /*event*/, const char */*pchData*/, int /*cchData*/,
+	void */*pvData*/ )
+{
+	return LSCP_OK;
+}
+
+
+// Numbers as numbers, anything else as text.
+static QJSValue scriptScalar ( const QString& sValue )
+{
+	bool bOk = false;
+	const double fValue = sValue.toDouble(&bOk);
+	if (bOk)
+		return QJSValue(fValue);
+	if (sValue.compare("true", Qt::CaseInsensitive) == 0)
+		return QJSValue(true);
+	if (sValue.compare("false", Qt::CaseInsensitive) == 0)
+		return QJSValue(false);
+
+	return QJSValue(sValue);
+}
+
+
+// Device type keyword ("audio" or "midi").
+static QString scriptDeviceType ( const QString& sType )
+{
+	if (sType.compare("midi", Qt::CaseInsensitive) == 0)
+		return "MIDI_INPUT_DEVICE";
+	else
+		return "AUDIO_OUTPUT_DEVICE";
+}
+
+
+// Sampler channel cached state.
+static QJSValue scriptChannel ( QJSEngine *pEngine, Channel *pChannel )
+{
+	QJSValue channel = pEngine->newObject();
+	channel.setProperty("id", pChannel->channelID());
+	channel.setProperty("name", pChannel->channelName());
+	channel.setProperty("engine", pChannel->engineName());
+	channel.setProperty("instrumentFile", pChannel->instrumentFile());
+	channel.setProperty("instrumentNr", pChannel->instrumentNr());
+	channel.setProperty("instrumentName", pChannel->instrumentName());
+	channel.setProperty("instrumentStatus", pChannel->instrumentStatus());
+	channel.setProperty("audioDriver", pChannel->audioDriver());
+	channel.setProperty("audioDevice", pChannel->audioDevice());
+	channel.setProperty("midiDriver", pChannel->midiDriver());
+	channel.setProperty("midiDevice", pChannel->midiDevice());
+	channel.setProperty("midiPort", pChannel->midiPort());
+	channel.setProperty("midiChannel", pChannel->midiChannel());
+	channel.setProperty("midiMap", pChannel->midiMap());
+	channel.setProperty("volume", double(pChannel->volume()));
+	channel.setProperty("mute", pChannel->channelMute());
+	channel.setProperty("solo", pChannel->channelSolo());
+
+	return channel;
+}
+
+
+//-------------------------------------------------------------------------
+// QSampler::ScriptClient - batched command runner (own connection).
+//
+
+// Constructor.
+ScriptClient::ScriptClient ( QObject *pReceiver,
+	const QString& sHost, int iPort, int iTimeout )
+	: QThread(), m_pReceiver(pReceiver),
+		m_sHost(sHost), m_iPort(iPort), m_iTimeout(iTimeout),
+		m_bRunState(true)
+{
+}
+
+
+// Destructor.
+ScriptClient::~ScriptClient (void)
+{
+	stop();
+}
+
+
+// Hand over a whole batch of commands.
+void ScriptClient::post ( const QList<Request>& batch )
+{
+	QMutexLocker locker(&m_mutex);
+
+	m_requests.append(batch);
+	m_cond.wakeAll();
+}
+
+
+// Stop (and wait for) the thread.
+void ScriptClient::stop (void)
+{
+	m_mutex.lock();
+	m_bRunState = false;
+	m_requests.clear();
+	m_cond.wakeAll();
+	m_mutex.unlock();
+
+	QThread::wait();
+}
+
+
+// The main thread executive.
+void ScriptClient::run (void)
+{
+	lscp_client_t *pClient = NULL;
+
+	m_mutex.lock();
+	while (m_bRunState) {
+		if (m_requests.isEmpty())
+			m_cond.wait(&m_mutex);
+		if (!m_bRunState)
+			break;
+		const QList<Request> batch = m_requests;
+		m_requests.clear();
+		m_mutex.unlock();
+		// We'll have our very own connection...
+		if (pClient == NULL) {
+			pClient = ::lscp_client_create(
+				m_sHost.toUtf8().constData(), m_iPort,
+				qsampler_script_callback, NULL);
+			if (pClient)
+				::lscp_client_set_timeout(pClient, m_iTimeout);
+		}
+		// Back to back, no round trips to the GUI in between...
+		QList<ScriptEvent::Reply> replies;
+		QListIterator<Request> iter(batch);
+		while (iter.hasNext()) {
+			const Request& request = iter.next();
+			ScriptEvent::Reply reply;
+			reply.iTag = request.iTag;
+			if (pClient) {
+				const QString& sQuery = request.sCommand + "\r\n";
+				reply.bError = (::lscp_client_query(pClient,
+					sQuery.toUtf8().constData()) != LSCP_OK);
+				reply.sResult = QString::fromUtf8(
+					::lscp_client_get_result(pClient));
+			} else {
+				reply.bError = true;
+				reply.sResult = QObject::tr(
+					"Could not connect to server %1:%2.")
+					.arg(m_sHost).arg(m_iPort);
+			}
+			replies.append(reply);
+			if (replies.count() >= QSAMPLER_SCRIPT_REPLIES) {
+				QApplication::postEvent(m_pReceiver, new ScriptEvent(replies));
+				replies.clear();
+			}
+		}
+		if (!replies.isEmpty())
+			QApplication::postEvent(m_pReceiver, new ScriptEvent(replies));
+		m_mutex.lock();
+	}
+	m_mutex.unlock();
+
+	if (pClient)
+		::lscp_client_destroy(pClient);
+}
+
+
+//-------------------------------------------------------------------------
+// QSampler::ScriptApi - the script global "sampler" object.
+//
+
+// Constructor.
+ScriptApi::ScriptApi ( Script *pScript )
+	: QObject(pScript), m_pScript(pScript)
+{
+}
+
+
+// Cached state, straight from the channel strips.
+QJSValue ScriptApi::channels (void) const
+{
+	QJSEngine *pEngine = m_pScript->engine();
+
+	QList<Channel *> list;
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm) {
+		ChannelStrip *pChannelStrip = NULL;
+		for (int iStrip = 0;
+				(pChannelStrip = pMainForm->channelStripAt(iStrip)) != NULL;
+					++iStrip) {
+			if (pChannelStrip->channel())
+				list.append(pChannelStrip->channel());
+		}
+	}
+
+	QJSValue channels = pEngine->newArray(list.count());
+	for (int i = 0; i < list.count(); ++i)
+		channels.setProperty(quint32(i), scriptChannel(pEngine, list.at(i)));
+
+	return channels;
+}
+
+
+QJSValue ScriptApi::channel ( int iChannelID ) const
+{
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL)
+		return QJSValue(QJSValue::NullValue);
+
+	ChannelStrip *pChannelStrip = pMainForm->channelStrip(iChannelID);
+	if (pChannelStrip == NULL || pChannelStrip->channel() == NULL)
+		return QJSValue(QJSValue::NullValue);
+
+	return scriptChannel(m_pScript->engine(), pChannelStrip->channel());
+}
+
+
+// Plain LSCP command.
+int ScriptApi::send ( const QString& sCommand, const QJSValue& callback )
+{
+	return m_pScript->queue(sCommand.trimmed(), callback);
+}
+
+
+// Sampler channels.
+int ScriptApi::addChannel ( const QJSValue& callback )
+{
+	return send("ADD CHANNEL", callback);
+}
+
+int ScriptApi::removeChannel ( int iChannelID, const QJSValue& callback )
+{
+	return send(QString("REMOVE CHANNEL %1").arg(iChannelID), callback);
+}
+
+int ScriptApi::loadEngine ( int iChannelID, const QString& sEngineName,
+	const QJSValue& callback )
+{
+	return send(QString("LOAD ENGINE %1 %2")
+		.arg(sEngineName).arg(iChannelID), callback);
+}
+
+int ScriptApi::loadInstrument ( int iChannelID,
+	const QString& sInstrumentFile, int iInstrumentNr,
+	const QJSValue& callback )
+{
+	return send(QString("LOAD INSTRUMENT NON_MODAL '%1' %2 %3")
+		.arg(qsamplerUtilities::lscpEscapePath(sInstrumentFile))
+		.arg(iInstrumentNr).arg(iChannelID), callback);
+}
+
+int ScriptApi::setVolume ( int iChannelID, double fVolume,
+	const QJSValue& callback )
+{
+	return send(QString("SET CHANNEL VOLUME %1 %2")
+		.arg(iChannelID).arg(fVolume), callback);
+}
+
+int ScriptApi::setMute ( int iChannelID, bool bMute,
+	const QJSValue& callback )
+{
+	return send(QString("SET CHANNEL MUTE %1 %2")
+		.arg(iChannelID).arg(int(bMute)), callback);
+}
+
+int ScriptApi::setSolo ( int iChannelID, bool bSolo,
+	const QJSValue& callback )
+{
+	return send(QString("SET CHANNEL SOLO %1 %2")
+		.arg(iChannelID).arg(int(bSolo)), callback);
+}
+
+int ScriptApi::setAudioDevice ( int iChannelID, int iAudioDevice,
+	const QJSValue& callback )
+{
+	return send(QString("SET CHANNEL AUDIO_OUTPUT_DEVICE %1 %2")
+		.arg(iChannelID).arg(iAudioDevice), callback);
+}
+
+int ScriptApi::setMidiDevice ( int iChannelID, int iMidiDevice,
+	const QJSValue& callback )
+{
+	return send(QString("SET CHANNEL MIDI_INPUT_DEVICE %1 %2")
+		.arg(iChannelID).arg(iMidiDevice), callback);
+}
+
+int ScriptApi::setMidiPort ( int iChannelID, int iMidiPort,
+	const QJSValue& callback )
+{
+	return send(QString("SET CHANNEL MIDI_INPUT_PORT %1 %2")
+		.arg(iChannelID).arg(iMidiPort), callback);
+}
+
+int ScriptApi::setMidiChannel ( int iChannelID, int iMidiChannel,
+	const QJSValue& callback )
+{
+	// Zero based, as cached; anything out of range means omni.
+	return send(QString("SET CHANNEL MIDI_INPUT_CHANNEL %1 %2")
+		.arg(iChannelID).arg(iMidiChannel >= 0 && iMidiChannel < 16
+			? QString::number(iMidiChannel) : QString("ALL")), callback);
+}
+
+int ScriptApi::setMidiMap ( int iChannelID, int iMidiMap,
+	const QJSValue& callback )
+{
+	// Negative means no map at all.
+	return send(QString("SET CHANNEL MIDI_INSTRUMENT_MAP %1 %2")
+		.arg(iChannelID).arg(iMidiMap >= 0
+			? QString::number(iMidiMap) : QString("NONE")), callback);
+}
+
+
+// Audio output ("audio") and MIDI input ("midi") devices.
+int ScriptApi::devices ( const QString& sType, const QJSValue& callback )
+{
+	return send("LIST " + scriptDeviceType(sType) + 'S', callback);
+}
+
+int ScriptApi::deviceInfo ( const QString& sType, int iDeviceID,
+	const QJSValue& callback )
+{
+	return send(QString("GET %1 INFO %2")
+		.arg(scriptDeviceType(sType)).arg(iDeviceID), callback);
+}
+
+int ScriptApi::createDevice ( const QString& sType,
+	const QString& sDriverName, const QJSValue& params,
+	const QJSValue& callback )
+{
+	QString sCommand = "CREATE " + scriptDeviceType(sType) + ' ' + sDriverName;
+	if (params.isObject()) {
+		QJSValueIterator iter(params);
+		while (iter.hasNext()) {
+			iter.next();
+			sCommand += QString(" %1='%2'")
+				.arg(iter.name().toUpper())
+				.arg(iter.value().toString());
+		}
+	}
+
+	return send(sCommand, callback);
+}
+
+int ScriptApi::destroyDevice ( const QString& sType, int iDeviceID,
+	const QJSValue& callback )
+{
+	return send(QString("DESTROY %1 %2")
+		.arg(scriptDeviceType(sType)).arg(iDeviceID), callback);
+}
+
+int ScriptApi::setDeviceParam ( const QString& sType, int iDeviceID,
+	const QString& sParam, const QString& sValue,
+	const QJSValue& callback )
+{
+	return send(QString("SET %1_PARAMETER %2 %3='%4'")
+		.arg(scriptDeviceType(sType)).arg(iDeviceID)
+		.arg(sParam.toUpper()).arg(sValue), callback);
+}
+
+
+// MIDI instrument maps.
+int ScriptApi::maps ( const QJSValue& callback )
+{
+	return send("LIST MIDI_INSTRUMENT_MAPS", callback);
+}
+
+int ScriptApi::addMap ( const QString& sName, const QJSValue& callback )
+{
+	return send(QString("ADD MIDI_INSTRUMENT_MAP '%1'")
+		.arg(qsamplerUtilities::lscpEscapeText(sName)), callback);
+}
+
+int ScriptApi::removeMap ( int iMap, const QJSValue& callback )
+{
+	return send(QString("REMOVE MIDI_INSTRUMENT_MAP %1").arg(iMap), callback);
+}
+
+// Instrument given as an object, eg.:
+//   { map: 0, bank: 0, prog: 12, engine: "GIG", file: "/x/y.gig",
+//     nr: 0, volume: 1.0, mode: "ON_DEMAND", name: "Piano" }
+int ScriptApi::mapInstrument ( const QJSValue& instr,
+	const QJSValue& callback )
+{
+	const QJSValue& volume = instr.property("volume");
+	QString sCommand = QString(
+		"MAP MIDI_INSTRUMENT NON_MODAL %1 %2 %3 %4 '%5' %6 %7")
+		.arg(instr.property("map").toInt())
+		.arg(instr.property("bank").toInt())
+		.arg(instr.property("prog").toInt())
+		.arg(instr.property("engine").toString())
+		.arg(qsamplerUtilities::lscpEscapePath(
+			instr.property("file").toString()))
+		.arg(instr.property("nr").toInt())
+		.arg(volume.isNumber() ? volume.toNumber() : 1.0);
+	const QJSValue& mode = instr.property("mode");
+	if (mode.isString())
+		sCommand += ' ' + mode.toString().toUpper();
+	const QJSValue& name = instr.property("name");
+	if (name.isString()) {
+		sCommand += QString(" '%1'")
+			.arg(qsamplerUtilities::lscpEscapeText(name.toString()));
+	}
+
+	return send(sCommand, callback);
+}
+
+int ScriptApi::unmapInstrument ( int iMap, int iBank, int iProg,
+	const QJSValue& callback )
+{
+	return send(QString("UNMAP MIDI_INSTRUMENT %1 %2 %3")
+		.arg(iMap).arg(iBank).arg(iProg), callback);
+}
+
+
+// Channel effect sends.
+int ScriptApi::fxSends ( int iChannelID, const QJSValue& callback )
+{
+	return send(QString("LIST FX_SENDS %1").arg(iChannelID), callback);
+}
+
+int ScriptApi::createFxSend ( int iChannelID, int iMidiController,
+	const QString& sName, const QJSValue& callback )
+{
+	QString sCommand = QString("CREATE FX_SEND %1 %2")
+		.arg(iChannelID).arg(iMidiController);
+	if (!sName.isEmpty()) {
+		sCommand += QString(" '%1'")
+			.arg(qsamplerUtilities::lscpEscapeText(sName));
+	}
+
+	return send(sCommand, callback);
+}
+
+int ScriptApi::destroyFxSend ( int iChannelID, int iFxSend,
+	const QJSValue& callback )
+{
+	return send(QString("DESTROY FX_SEND %1 %2")
+		.arg(iChannelID).arg(iFxSend), callback);
+}
+
+int ScriptApi::setFxSendLevel ( int iChannelID, int iFxSend,
+	double fLevel, const QJSValue& callback )
+{
+	return send(QString("SET FX_SEND LEVEL %1 %2 %3")
+		.arg(iChannelID).arg(iFxSend).arg(fLevel), callback);
+}
+
+
+// Send whatever is queued right now (otherwise automatic).
+void ScriptApi::flush (void)
+{
+	m_pScript->flush();
+}
+
+
+// Messages window (and standard output, when headless).
+void ScriptApi::print ( const QString& sText ) const
+{
+	m_pScript->print(sText);
+}
+
+
+// Drop anything pending and end the script.
+void ScriptApi::exit ( int iExitCode )
+{
+	m_pScript->abort(iExitCode);
+}
+
+
+//-------------------------------------------------------------------------
+// QSampler::Script - embedded scripting engine host.
+//
+
+// Constructor.
+Script::Script ( QObject *pParent )
+	: QObject(pParent), m_pClient(NULL), m_iTag(0), m_iErrors(0),
+		m_bFlush(false), m_bFinished(false)
+{
+	m_pEngine = new QJSEngine(this);
+
+	// Parented, so it stays ours...
+	m_pApi = new ScriptApi(this);
+	m_pEngine->globalObject().setProperty("sampler",
+		m_pEngine->newQObject(m_pApi));
+
+	MainForm *pMainForm = MainForm::getInstance();
+	Options *pOptions = (pMainForm ? pMainForm->options() : NULL);
+	if (pOptions) {
+		m_pClient = new ScriptClient(this,
+			pOptions->sServerHost,
+			pOptions->iServerPort,
+			pOptions->iServerTimeout);
+		m_pClient->start();
+	}
+}
+
+
+// Destructor.
+Script::~Script (void)
+{
+	if (m_pClient)
+		delete m_pClient;
+}
+
+
+// Evaluate a script file; callbacks are run later, as replies come.
+bool Script::run ( const QString& sFilename )
+{
+	m_sFilename = sFilename;
+
+	QFile file(sFilename);
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		print(tr("Could not open \"%1\" script file.").arg(sFilename), true);
+		abort(1);
+		return false;
+	}
+
+	QTextStream ts(&file);
+	const QString sProgram = ts.readAll();
+	file.close();
+
+	const bool bResult = check(m_pEngine->evaluate(sProgram, sFilename));
+	if (!bResult)
+		abort(1);
+	else
+		finish();
+
+	return bResult;
+}
+
+
+// Script file name.
+const QString& Script::filename (void) const
+{
+	return m_sFilename;
+}
+
+
+// Script engine accessor.
+QJSEngine *Script::engine (void) const
+{
+	return m_pEngine;
+}
+
+
+// Queue a command for the next batch; returns its tag.
+int Script::queue ( const QString& sCommand, const QJSValue& callback )
+{
+	if (m_bFinished || m_pClient == NULL)
+		return -1;
+
+	ScriptClient::Request request;
+	request.iTag = ++m_iTag;
+	request.sCommand = sCommand;
+	m_batch.append(request);
+
+	Callback item;
+	item.sCommand = sCommand;
+	item.callback = callback;
+	m_callbacks.insert(request.iTag, item);
+
+	// Whatever gets queued in the same go, goes in the same batch...
+	if (!m_bFlush) {
+		m_bFlush = true;
+		QTimer::singleShot(0, this, SLOT(flush()));
+	}
+
+	return request.iTag;
+}
+
+
+// Number of commands still waiting for a reply.
+int Script::pending (void) const
+{
+	return m_callbacks.count();
+}
+
+
+// Drop anything pending and end the script.
+void Script::abort ( int iExitCode )
+{
+	m_batch.clear();
+	m_callbacks.clear();
+
+	if (!m_bFinished) {
+		m_bFinished = true;
+		emit finished(iExitCode);
+	}
+}
+
+
+// Messages window (and standard output, when headless).
+void Script::print ( const QString& sText, bool bError ) const
+{
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL)
+		return;
+
+	const QString& sName = QFileInfo(m_sFilename).fileName();
+	if (bError)
+		pMainForm->appendMessagesColor(sName + ": " + sText, "#ff0000");
+	else
+		pMainForm->appendMessages(sName + ": " + sText);
+
+	Options *pOptions = pMainForm->options();
+	if (pOptions && pOptions->bHeadless) {
+		FILE *pFile = (bError ? stderr : stdout);
+		::fputs((sText + '\n').toUtf8().constData(), pFile);
+		::fflush(pFile);
+	}
+}
+
+
+// Hand the current batch over to the runner.
+void Script::flush (void)
+{
+	m_bFlush = false;
+
+	if (m_batch.isEmpty() || m_pClient == NULL)
+		return;
+
+	m_pClient->post(m_batch);
+	m_batch.clear();
+}
+
+
+// Command replies delivery.
+void Script::customEvent ( QEvent *pEvent )
+{
+	if (pEvent->type() != QSAMPLER_SCRIPT_EVENT)
+		return;
+
+	ScriptEvent *pScriptEvent = static_cast<ScriptEvent *> (pEvent);
+	QListIterator<ScriptEvent::Reply> iter(pScriptEvent->replies());
+	while (iter.hasNext() && !m_bFinished) {
+		const ScriptEvent::Reply& reply = iter.next();
+		if (!m_callbacks.contains(reply.iTag))
+			continue;
+		const Callback item = m_callbacks.take(reply.iTag);
+		if (item.callback.isCallable()) {
+			// Error first, then the result...
+			QJSValueList args;
+			if (reply.bError) {
+				args << QJSValue(reply.sResult);
+			} else {
+				args << QJSValue(QJSValue::NullValue);
+				args << convert(item.sCommand, reply.sResult);
+			}
+			if (!check(item.callback.call(args)))
+				++m_iErrors;
+		}
+		else
+		if (reply.bError) {
+			print(QString("%1: %2").arg(item.sCommand).arg(reply.sResult));
+			++m_iErrors;
+		}
+	}
+
+	finish();
+}
+
+
+// Report an uncaught script exception, if any.
+bool Script::check ( const QJSValue& ret )
+{
+	if (!ret.isError())
+		return true;
+
+	print(tr("line %1: %2")
+		.arg(ret.property("lineNumber").toInt())
+		.arg(ret.toString()), true);
+
+	return false;
+}
+
+
+// Whether it's all over.
+void Script::finish (void)
+{
+	if (m_bFinished || !m_batch.isEmpty() || !m_callbacks.isEmpty())
+		return;
+
+	m_bFinished = true;
+
+	emit finished(m_iErrors > 0 ? 1 : 0);
+}
+
+
+// Convert a raw reply into something more scriptable.
+QJSValue Script::convert ( const QString& sCommand,
+	const QString& sResult ) const
+{
+	const QString& sVerb = sCommand.section(' ', 0, 0).toUpper();
+
+	// Key-value pairs (eg. GET ... INFO)...
+	if (sVerb == "GET" && sResult.contains(": ")) {
+		QJSValue info = m_pEngine->newObject();
+		const QStringList& lines = sResult.split(
+			QRegExp("[\r\n]+"), QString::SkipEmptyParts);
+		QStringListIterator iter(lines);
+		while (iter.hasNext()) {
+			const QString& sLine = iter.next();
+			const QString& sKey = sLine.section(": ", 0, 0).trimmed();
+			if (!sKey.isEmpty()) {
+				info.setProperty(sKey.toLower(),
+					scriptScalar(sLine.section(": ", 1).trimmed()));
+			}
+		}
+		return info;
+	}
+
+	// Plain lists (eg. LIST ...)...
+	if (sVerb == "LIST") {
+		const QStringList& items = sResult.split(',', QString::SkipEmptyParts);
+		QJSValue list = m_pEngine->newArray(items.count());
+		for (int i = 0; i < items.count(); ++i)
+			list.setProperty(quint32(i), scriptScalar(items.at(i).trimmed()));
+		return list;
+	}
+
+	return scriptScalar(sResult.trimmed());
+}
+
+} // namespace QSampler
+
+#endif	// CONFIG_SCRIPT
+
+
+// end of qsamplerScript.cpp
@@ -0,0 +1,321 @@
+// qsamplerScript.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerScript_h
+#define __qsamplerScript_h
+
+#include "config.h"
+
+#ifdef CONFIG_SCRIPT
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QEvent>
+#include <QHash>
+#include <QList>
+
+#include <QJSEngine>
+#include <QJSValue>
+
+
+namespace QSampler {
+
+class Script;
+
+// Specialties for thread-callback comunication.
+#define QSAMPLER_SCRIPT_EVENT QEvent::Type(QEvent::User + 4)
+
+
+//-------------------------------------------------------------------------
+// QSampler::ScriptEvent -- batch of command replies.
+
+class ScriptEvent : public QEvent
+{
+public:
+
+	// One command reply.
+	struct Reply
+	{
+		int     iTag;
+		QString sResult;
+		bool    bError;
+	};
+
+	// Constructor.
+	ScriptEvent(const QList<Reply>& replies)
+		: QEvent(QSAMPLER_SCRIPT_EVENT), m_replies(replies) {}
+
+	// Accessor.
+	const QList<Reply>& replies() const { return m_replies; }
+
+private:
+
+	QList<Reply> m_replies;
+};
+
+
+//-------------------------------------------------------------------------
+// QSampler::ScriptClient - batched command runner (own connection).
+//
+
+class ScriptClient : public QThread
+{
+public:
+
+	// One command request.
+	struct Request
+	{
+		int     iTag;
+		QString sCommand;
+	};
+
+	// Constructor.
+	ScriptClient(QObject *pReceiver,
+		const QString& sHost, int iPort, int iTimeout);
+
+	// Destructor.
+	~ScriptClient();
+
+	// Hand over a whole batch of commands.
+	void post(const QList<Request>& batch);
+
+	// Stop (and wait for) the thread.
+	void stop();
+
+protected:
+
+	// The main thread executive.
+	void run();
+
+private:
+
+	// Instance variables.
+	QObject *m_pReceiver;
+
+	QString m_sHost;
+	int     m_iPort;
+	int     m_iTimeout;
+
+	QMutex m_mutex;
+	QWaitCondition m_cond;
+
+	QList<Request> m_requests;
+
+	bool m_bRunState;
+};
+
+
+//-------------------------------------------------------------------------
+// QSampler::ScriptApi - the script global "sampler" object.
+//
+
+class ScriptApi : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	// Constructor.
+	ScriptApi(Script *pScript);
+
+	// Cached state, straight from the channel strips.
+	Q_INVOKABLE QJSValue channels() const;
+	Q_INVOKABLE QJSValue channel(int iChannelID) const;
+
+	// Plain LSCP command; all these return the request tag.
+	Q_INVOKABLE int send(const QString& sCommand,
+		const QJSValue& callback = QJSValue());
+
+	// Sampler channels.
+	Q_INVOKABLE int addChannel(const QJSValue& callback = QJSValue());
+	Q_INVOKABLE int removeChannel(int iChannelID,
+		const QJSValue& callback = QJSValue());
+	Q_INVOKABLE int loadEngine(int iChannelID, const QString& sEngineName,
+		const QJSValue& callback = QJSValue());
+	Q_INVOKABLE int loadInstrument(int iChannelID,
+		const QString& sInstrumentFile, int iInstrumentNr,
+		const QJSValue& callback = QJSValue());
+	Q_INVOKABLE int setVolume(int iChannelID, double fVolume,
+		const QJSValue& callback = QJSValue());
+	Q_INVOKABLE int setMute(int iChannelID, bool bMute,
+		const QJSValue& callback = QJSValue());
+	Q_INVOKABLE int setSolo(int iChannelID, bool bSolo,
+		const QJSValue& callback = QJSValue());
+	Q_INVOKABLE int setAudioDevice(int iChannelID, int iAudioDevice,
+		const QJSValue& callback = QJSValue());
+	Q_INVOKABLE int setMidiDevice(int iChannelID, int iMidiDevice,
+		const QJSValue& callback = QJSValue());
+	Q_INVOKABLE int setMidiPort(int iChannelID, int iMidiPort,
+		const QJSValue& callback = QJSValue());
+	Q_INVOKABLE int setMidiChannel(int iChannelID, int iMidiChannel,
+		const QJSValue& callback = QJSValue());
+	Q_INVOKABLE int setMidiMap(int iChannelID, int iMidiMap,
+		const QJSValue& callback = QJSValue());
+
+	// Audio output ("audio") and MIDI input ("midi") devices.
+	Q_INVOKABLE int devices(const QString& sType,
+		const QJSValue& callback = QJSValue());
+	Q_INVOKABLE int deviceInfo(const QString& sType, int iDeviceID,
+		const QJSValue& callback = QJSValue());
+	Q_INVOKABLE int createDevice(const QString& sType,
+		const QString& sDriverName, const QJSValue& params = QJSValue(),
+		const QJSValue& callback = QJSValue());
+	Q_INVOKABLE int destroyDevice(const QString& sType, int iDeviceID,
+		const QJSValue& callback = QJSValue());
+	Q_INVOKABLE int setDeviceParam(const QString& sType, int iDeviceID,
+		const QString& sParam, const QString& sValue,
+		const QJSValue& callback = QJSValue());
+
+	// MIDI instrument maps.
+	Q_INVOKABLE int maps(const QJSValue& callback = QJSValue());
+	Q_INVOKABLE int addMap(const QString& sName,
+		const QJSValue& callback = QJSValue());
+	Q_INVOKABLE int removeMap(int iMap,
+		const QJSValue& callback = QJSValue());
+	Q_INVOKABLE int mapInstrument(const QJSValue& instr,
+		const QJSValue& callback = QJSValue());
+	Q_INVOKABLE int unmapInstrument(int iMap, int iBank, int iProg,
+		const QJSValue& callback = QJSValue());
+
+	// Channel effect sends.
+	Q_INVOKABLE int fxSends(int iChannelID,
+		const QJSValue& callback = QJSValue());
+	Q_INVOKABLE int createFxSend(int iChannelID, int iMidiController,
+		const QString& sName, const QJSValue& callback = QJSValue());
+	Q_INVOKABLE int destroyFxSend(int iChannelID, int iFxSend,
+		const QJSValue& callback = QJSValue());
+	Q_INVOKABLE int setFxSendLevel(int iChannelID, int iFxSend,
+		double fLevel, const QJSValue& callback = QJSValue());
+
+	// Send whatever is queued right now (otherwise automatic).
+	Q_INVOKABLE void flush();
+
+	// Messages window (and standard output, when headless).
+	Q_INVOKABLE void print(const QString& sText) const;
+
+	// Drop anything pending and end the script.
+	Q_INVOKABLE void exit(int iExitCode = 0);
+
+private:
+
+	// Instance variables.
+	Script *m_pScript;
+};
+
+
+//-------------------------------------------------------------------------
+// QSampler::Script - embedded scripting engine host.
+//
+
+class Script : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	// Constructor.
+	Script(QObject *pParent = NULL);
+
+	// Destructor.
+	~Script();
+
+	// Evaluate a script file; callbacks are run later, as replies come.
+	bool run(const QString& sFilename);
+
+	// Script file name.
+	const QString& filename() const;
+
+	// Script engine accessor.
+	QJSEngine *engine() const;
+
+	// Queue a command for the next batch; returns its tag.
+	int queue(const QString& sCommand, const QJSValue& callback);
+
+	// Number of commands still waiting for a reply.
+	int pending() const;
+
+	// Drop anything pending and end the script.
+	void abort(int iExitCode);
+
+	// Messages window (and standard output, when headless).
+	void print(const QString& sText, bool bError = false) const;
+
+signals:
+
+	// Script is over, nothing pending (non-zero on errors).
+	void finished(int iExitCode);
+
+public slots:
+
+	// Hand the current batch over to the runner.
+	void flush();
+
+protected:
+
+	// Command replies delivery.
+	void customEvent(QEvent *pEvent);
+
+	// Report an uncaught script exception, if any.
+	bool check(const QJSValue& ret);
+
+	// Whether it's all over.
+	void finish();
+
+	// Convert a raw reply into something more scriptable.
+	QJSValue convert(const QString& sCommand, const QString& sResult) const;
+
+private:
+
+	// Instance variables.
+	QJSEngine *m_pEngine;
+	ScriptApi *m_pApi;
+
+	ScriptClient *m_pClient;
+
+	QString m_sFilename;
+
+	QList<ScriptClient::Request> m_batch;
+
+	struct Callback
+	{
+		QString  sCommand;
+		QJSValue callback;
+	};
+
+	QHash<int, Callback> m_callbacks;
+
+	int m_iTag;
+	int m_iErrors;
+
+	bool m_bFlush;
+	bool m_bFinished;
+};
+
+} // namespace QSampler
+
+#endif	// CONFIG_SCRIPT
+
+
+#endif  // __qsamplerScript_h
+
+
+// end of qsamplerScript.h
@@ -0,0 +1,144 @@
+// qsamplerServerCall.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerServerCall.h"
+
+#include <QWidget>
+
+
+namespace QSampler {
+
+//-------------------------------------------------------------------------
+// QSampler::ServerCall - per-request deadline and cancellation scope.
+//
+
+// Class-wide state.
+int  ServerCall::g_iDeadlines[ServerCall::Bulk + 1] = { 1000, 500, 5000 };
+bool ServerCall::g_bResponsive = true;
+
+QHash<lscp_client_t *, int> ServerCall::g_scopes;
+
+
+// Constructor.
+ServerCall::ServerCall ( lscp_client_t *pClient, Class callClass,
+	QObject *pView ) : m_pClient(pClient), m_iDeadline(deadline(callClass)),
+		m_iOldTimeout(0), m_pView(pView), m_bView(pView != NULL),
+		m_bVisible(false), m_bCancelled(false)
+{
+	QWidget *pWidget = qobject_cast<QWidget *> (pView);
+	if (pWidget)
+		m_bVisible = pWidget->isVisible();
+
+	// Only the outermost scope sets the deadline...
+	if (m_pClient && g_scopes[m_pClient]++ == 0) {
+		m_iOldTimeout = ::lscp_client_get_timeout(m_pClient);
+		::lscp_client_set_timeout(m_pClient, m_iDeadline);
+	}
+}
+
+
+// Destructor.
+ServerCall::~ServerCall (void)
+{
+	if (m_pClient == NULL)
+		return;
+
+	if (--g_scopes[m_pClient] < 1)
+		g_scopes.remove(m_pClient);
+
+	if (m_iOldTimeout > 0)
+		::lscp_client_set_timeout(m_pClient, m_iOldTimeout);
+}
+
+
+// Whether it's still worth going on with requests.
+bool ServerCall::isValid (void) const
+{
+	return (m_pClient && g_bResponsive && !isCancelled());
+}
+
+
+// Explicit cancellation.
+void ServerCall::cancel (void)
+{
+	m_bCancelled = true;
+}
+
+bool ServerCall::isCancelled (void) const
+{
+	if (m_bCancelled)
+		return true;
+
+	if (m_bView) {
+		if (m_pView.isNull())
+			return true;
+		QWidget *pWidget = qobject_cast<QWidget *> (m_pView);
+		if (pWidget && m_bVisible && !pWidget->isVisible())
+			return true;
+	}
+
+	return false;
+}
+
+
+// Account for the last request since the previous check.
+bool ServerCall::check (void)
+{
+	// The client timeout applies to each request on its own, so a
+	// missed deadline is told by the receive status it leaves behind:
+	// timeouts and socket failures are negative, while plain server
+	// errors (ERR:<code>) are positive and don't count at all...
+	if (m_pClient && ::lscp_client_get_errno(m_pClient) < 0)
+		g_bResponsive = false;
+
+	return isValid();
+}
+
+
+// Deadlines (msecs) per call class.
+void ServerCall::setDeadline ( Class callClass, int iMsecs )
+{
+	if (iMsecs > 0)
+		g_iDeadlines[callClass] = iMsecs;
+}
+
+int ServerCall::deadline ( Class callClass )
+{
+	return g_iDeadlines[callClass];
+}
+
+
+// Server responsiveness (fast failure) state.
+void ServerCall::setResponsive ( bool bResponsive )
+{
+	g_bResponsive = bResponsive;
+}
+
+bool ServerCall::isResponsive (void)
+{
+	return g_bResponsive;
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerServerCall.cpp
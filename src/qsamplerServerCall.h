@@ -0,0 +1,106 @@
+// qsamplerServerCall.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerServerCall_h
+#define __qsamplerServerCall_h
+
+#include <QPointer>
+#include <QObject>
+#include <QHash>
+
+#include <lscp/client.h>
+
+
+namespace QSampler {
+
+//-------------------------------------------------------------------------
+// QSampler::ServerCall - per-request deadline and cancellation scope.
+//
+// Sets the client timeout to the deadline of the given call class
+// for its lifetime (restoring the previous one on the way out);
+// once any request misses its deadline, the server is flagged as
+// not responding and all other scoped calls fail fast, until some
+// probe finds it answering again. Scopes nested on the same client
+// keep the outermost deadline.
+//
+
+class ServerCall
+{
+public:
+
+	// Call classes, each with its own deadline.
+	enum Class { Interactive = 0, Background, Bulk };
+
+	// Constructor; the originating view, if any, is the
+	// cancellation token: gone (or hidden, if it was visible
+	// from the start) means cancelled.
+	ServerCall(lscp_client_t *pClient, Class callClass,
+		QObject *pView = NULL);
+
+	// Destructor.
+	~ServerCall();
+
+	// Whether it's still worth going on with requests.
+	bool isValid() const;
+
+	// Explicit cancellation.
+	void cancel();
+	bool isCancelled() const;
+
+	// Account for the last request since the previous check;
+	// flags the server as not responding on a timeout or socket
+	// failure (but not on any other server error).
+	bool check();
+
+	// Deadlines (msecs) per call class.
+	static void setDeadline(Class callClass, int iMsecs);
+	static int deadline(Class callClass);
+
+	// Server responsiveness (fast failure) state.
+	static void setResponsive(bool bResponsive);
+	static bool isResponsive();
+
+private:
+
+	// Instance variables.
+	lscp_client_t *m_pClient;
+	int m_iDeadline;
+	int m_iOldTimeout;
+
+	QPointer<QObject> m_pView;
+	bool m_bView;
+	bool m_bVisible;
+	bool m_bCancelled;
+
+	// Class-wide state.
+	static int  g_iDeadlines[Bulk + 1];
+	static bool g_bResponsive;
+
+	static QHash<lscp_client_t *, int> g_scopes;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerServerCall_h
+
+
+// end of qsamplerServerCall.h
@@ -0,0 +1,309 @@
+// qsamplerServerCaps.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerServerCaps.h"
+
+#include "qsamplerServerCall.h"
+
+#include <QObject>
+#include <QRegExp>
+#include <QList>
+
+
+namespace QSampler {
+
+// What the build (liblscp) has to offer, whatever the server.
+static unsigned int qsampler_server_caps_available (void)
+{
+	unsigned int iAvailable = ~0U;
+
+#ifndef CONFIG_EVENT_CHANNEL_MIDI
+	iAvailable &= ~(1U << ServerCaps::ChannelMidiEvents);
+#endif
+#ifndef CONFIG_EVENT_DEVICE_MIDI
+	iAvailable &= ~(1U << ServerCaps::DeviceMidiEvents);
+#endif
+#ifndef CONFIG_INSTRUMENT_NAME
+	iAvailable &= ~(1U << ServerCaps::InstrumentName);
+#endif
+#ifndef CONFIG_MUTE_SOLO
+	iAvailable &= ~(1U << ServerCaps::MuteSolo);
+#endif
+#ifndef CONFIG_FXSEND
+	iAvailable &= ~(1U << ServerCaps::FxSends);
+#endif
+
+	return iAvailable;
+}
+
+
+//-------------------------------------------------------------------------
+// QSampler::ServerCaps - connected server capabilities.
+//
+
+// Kind of singleton reference.
+ServerCaps *ServerCaps::g_pServerCaps = NULL;
+
+
+// Constructor.
+ServerCaps::ServerCaps (void)
+{
+	reset();
+
+	g_pServerCaps = this;
+}
+
+
+// Destructor.
+ServerCaps::~ServerCaps (void)
+{
+	g_pServerCaps = NULL;
+}
+
+
+// Find out what the connected server is up to.
+void ServerCaps::probe ( lscp_client_t *pClient )
+{
+	reset();
+
+	if (pClient == NULL)
+		return;
+
+	// Don't let it take forever, anyway...
+	ServerCall call(pClient, ServerCall::Interactive);
+
+	m_version = qsamplerUtilities::getRemoteLscpVersion(pClient);
+	m_bProbed = true;
+
+	// First, whatever the protocol version tells...
+	assume(ChannelEvents,     true);
+	assume(InstrumentName,    isVersion(1, 1));
+	assume(MuteSolo,          isVersion(1, 1));
+	assume(FxSends,           isVersion(1, 2));
+	assume(ChannelMidiEvents, isVersion(1, 2));
+	assume(DeviceMidiEvents,  isVersion(1, 2));
+	assume(FileInstruments,   isVersion(1, 2));
+	assume(InstrumentsDb,     isVersion(1, 2));
+
+	// Then ask for real, wherever there's a cheap way to...
+	// (take a copy, as the client result buffer gets reused)
+	QList<int> channels;
+	const int *piChannelIDs = ::lscp_list_channels(pClient);
+	for (int i = 0; piChannelIDs && piChannelIDs[i] >= 0; ++i)
+		channels.append(piChannelIDs[i]);
+	bool bChannelInfo = false;
+	QListIterator<int> iter(channels);
+	while (iter.hasNext() && call.check()) {
+		const int iChannelID = iter.next();
+		QString sResult;
+		if (!query(pClient,
+				QString("GET CHANNEL INFO %1").arg(iChannelID), &sResult))
+			continue;
+		if (!bChannelInfo) {
+			setSupported(InstrumentName,
+				sResult.contains(QRegExp("(^|\\n)INSTRUMENT_NAME:")));
+			setSupported(MuteSolo,
+				sResult.contains(QRegExp("(^|\\n)MUTE:")));
+			bChannelInfo = true;
+		}
+		// Effect sends are only to be listed on channels
+		// with an engine loaded, otherwise it's no proof...
+		QRegExp rx("(^|\\n)ENGINE_NAME:\\s*(\\S*)");
+		if (rx.indexIn(sResult) < 0
+			|| rx.cap(2).isEmpty() || rx.cap(2).toUpper() == "NONE")
+			continue;
+		if (call.check() && isAvailable(FxSends)) {
+			setSupported(FxSends, query(pClient,
+				QString("LIST FX_SENDS %1").arg(iChannelID)));
+		}
+		break;
+	}
+
+	// The instruments database is an optional server build feature...
+	if (call.check() && has(InstrumentsDb))
+		setSupported(InstrumentsDb,
+			query(pClient, "GET DB_INSTRUMENT_DIRECTORIES '/'"));
+
+	call.check();
+}
+
+
+// Forget it all (eg. on client shutdown).
+void ServerCaps::reset (void)
+{
+	m_version.major = 0;
+	m_version.minor = 0;
+
+	m_bProbed = false;
+
+	m_iSupported = 0;
+	m_iProbed = 0;
+}
+
+
+// Whether the connected server supports the given capability.
+bool ServerCaps::has ( Capability cap ) const
+{
+	return (m_iSupported & (1U << cap));
+}
+
+
+// Late (eg. event subscription) findings.
+void ServerCaps::setSupported ( Capability cap, bool bSupported )
+{
+	assume(cap, bSupported);
+
+	m_iProbed |= (1U << cap);
+}
+
+
+// Whether the given capability was found by probing.
+bool ServerCaps::isProbed ( Capability cap ) const
+{
+	return (m_iProbed & (1U << cap));
+}
+
+
+// Connected server protocol version.
+const qsamplerUtilities::lscpVersion_t& ServerCaps::version (void) const
+{
+	return m_version;
+}
+
+
+// Whether the given capability is compiled in at all.
+bool ServerCaps::isAvailable ( Capability cap )
+{
+	return (qsampler_server_caps_available() & (1U << cap));
+}
+
+
+// Capability description.
+QString ServerCaps::capabilityName ( Capability cap )
+{
+	switch (cap) {
+		case ChannelEvents:
+			return QObject::tr("Channel events");
+		case ChannelMidiEvents:
+			return QObject::tr("Channel MIDI events");
+		case DeviceMidiEvents:
+			return QObject::tr("Device MIDI events");
+		case InstrumentName:
+			return QObject::tr("Instrument names");
+		case MuteSolo:
+			return QObject::tr("Mute/Solo");
+		case FxSends:
+			return QObject::tr("Effect Sends");
+		case FileInstruments:
+			return QObject::tr("Instrument file listing");
+		case InstrumentsDb:
+			return QObject::tr("Instruments database");
+		default:
+			break;
+	}
+
+	return QString::null;
+}
+
+
+// Rich text summary (eg. for the about box).
+QString ServerCaps::summary (void) const
+{
+	if (!m_bProbed)
+		return QString::null;
+
+	QString sText = QObject::tr("Server") + ": LSCP "
+		+ QString::number(m_version.major) + '.'
+		+ QString::number(m_version.minor) + "<br />\n";
+
+	sText += "<small>";
+	for (int i = 0; i < Capabilities; ++i) {
+		const Capability cap = Capability(i);
+		sText += capabilityName(cap) + ": ";
+		if (has(cap))
+			sText += QObject::tr("yes");
+		else
+		if (isAvailable(cap))
+			sText += "<font color=\"red\">" + QObject::tr("no") + "</font>";
+		else
+			sText += "<font color=\"red\">" + QObject::tr("disabled") + "</font>";
+		if (isAvailable(cap) && !isProbed(cap))
+			sText += ' ' + QObject::tr("(assumed)");
+		sText += "<br />\n";
+	}
+	sText += "</small>";
+
+	return sText;
+}
+
+
+// Pseudo-singleton instance accessor.
+ServerCaps *ServerCaps::getInstance (void)
+{
+	return g_pServerCaps;
+}
+
+
+// Shortcut: whether the current server supports it.
+bool ServerCaps::supports ( Capability cap )
+{
+	return (g_pServerCaps && g_pServerCaps->has(cap));
+}
+
+
+// Protocol version threshold helper.
+bool ServerCaps::isVersion ( int iMajor, int iMinor ) const
+{
+	return (m_version.major > iMajor
+		|| (m_version.major == iMajor && m_version.minor >= iMinor));
+}
+
+
+// Assumption (from the protocol version) setter.
+void ServerCaps::assume ( Capability cap, bool bSupported )
+{
+	if (bSupported && isAvailable(cap))
+		m_iSupported |=  (1U << cap);
+	else
+		m_iSupported &= ~(1U << cap);
+}
+
+
+// Raw query helper.
+bool ServerCaps::query ( lscp_client_t *pClient,
+	const QString& sQuery, QString *pResult )
+{
+	const QString& sCommand = sQuery + "\r\n";
+	if (::lscp_client_query(pClient,
+			sCommand.toUtf8().constData()) != LSCP_OK)
+		return false;
+
+	if (pResult)
+		*pResult = QString::fromUtf8(::lscp_client_get_result(pClient));
+
+	return true;
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerServerCaps.cpp
@@ -0,0 +1,133 @@
+// qsamplerServerCaps.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerServerCaps_h
+#define __qsamplerServerCaps_h
+
+#include "qsamplerUtilities.h"
+
+#include <QString>
+
+#include <lscp/client.h>
+
+
+namespace QSampler {
+
+//-------------------------------------------------------------------------
+// QSampler::ServerCaps - connected server capabilities.
+//
+// What the build (liblscp) makes available is still decided at
+// compile time; whether the connected server actually supports it
+// is decided here, per connection, from its protocol version and
+// by probing it, so that the same binary may go with the best
+// mechanism each server has to offer, falling back otherwise.
+//
+
+class ServerCaps
+{
+public:
+
+	// Known capabilities.
+	enum Capability {
+		ChannelEvents = 0,  // CHANNEL_COUNT/CHANNEL_INFO events.
+		ChannelMidiEvents,  // CHANNEL_MIDI events.
+		DeviceMidiEvents,   // DEVICE_MIDI events.
+		InstrumentName,     // Server-provided instrument names.
+		MuteSolo,           // Sampler channel mute/solo.
+		FxSends,            // Effect sends (and their levels).
+		FileInstruments,    // Server-side instrument file listing.
+		InstrumentsDb,      // Instruments database.
+		Capabilities        // Count.
+	};
+
+	// Constructor.
+	ServerCaps();
+
+	// Destructor.
+	~ServerCaps();
+
+	// Find out what the connected server is up to.
+	void probe(lscp_client_t *pClient);
+
+	// Forget it all (eg. on client shutdown).
+	void reset();
+
+	// Whether the connected server supports the given capability.
+	bool has(Capability cap) const;
+
+	// Late (eg. event subscription) findings.
+	void setSupported(Capability cap, bool bSupported);
+
+	// Whether the given capability was found by probing
+	// (otherwise it was assumed from the protocol version).
+	bool isProbed(Capability cap) const;
+
+	// Connected server protocol version.
+	const qsamplerUtilities::lscpVersion_t& version() const;
+
+	// Whether the given capability is compiled in at all.
+	static bool isAvailable(Capability cap);
+
+	// Capability description.
+	static QString capabilityName(Capability cap);
+
+	// Rich text summary (eg. for the about box).
+	QString summary() const;
+
+	// Pseudo-singleton instance accessor.
+	static ServerCaps *getInstance();
+
+	// Shortcut: whether the current server supports it.
+	static bool supports(Capability cap);
+
+protected:
+
+	// Protocol version threshold helper.
+	bool isVersion(int iMajor, int iMinor) const;
+
+	// Assumption (from the protocol version) setter.
+	void assume(Capability cap, bool bSupported);
+
+	// Raw query helper; whether it succeeded (and its result).
+	static bool query(lscp_client_t *pClient,
+		const QString& sQuery, QString *pResult = NULL);
+
+private:
+
+	// Instance variables.
+	qsamplerUtilities::lscpVersion_t m_version;
+
+	bool m_bProbed;
+
+	unsigned int m_iSupported;
+	unsigned int m_iProbed;
+
+	// Kind of singleton reference.
+	static ServerCaps *g_pServerCaps;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerServerCaps_h
+
+
+// end of qsamplerServerCaps.h
@@ -0,0 +1,380 @@
+// qsamplerServerProcess.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerServerProcess.h"
+
+#include <QDir>
+
+#if defined(__linux__) && defined(HAVE_SCHED_H) && defined(HAVE_SYS_RESOURCE_H)
+#define CONFIG_SCHED_SETUP 1
+#include <sched.h>
+#include <sys/resource.h>
+#include <errno.h>
+#include <string.h>
+#endif
+
+
+namespace QSampler {
+
+//-------------------------------------------------------------------------
+// QSampler::ServerProcess - local server process, scheduling aware.
+//
+
+#ifdef CONFIG_SCHED_SETUP
+
+// Scheduling policy mappings.
+static int serverSchedPolicy ( int iSchedPolicy )
+{
+	switch (iSchedPolicy) {
+	case ServerProcess::SchedFifo:
+		return SCHED_FIFO;
+	case ServerProcess::SchedRoundRobin:
+		return SCHED_RR;
+	default:
+		return SCHED_OTHER;
+	}
+}
+
+static QString serverSchedPolicyName ( int iPolicy )
+{
+	switch (iPolicy) {
+	case SCHED_FIFO:
+		return "SCHED_FIFO";
+	case SCHED_RR:
+		return "SCHED_RR";
+	case SCHED_OTHER:
+		return "SCHED_OTHER";
+	default:
+		return QString::number(iPolicy);
+	}
+}
+
+// CPU set conversions.
+static void serverCpuSet ( const QList<int>& cpus, cpu_set_t *pCpuSet )
+{
+	CPU_ZERO(pCpuSet);
+	QListIterator<int> iter(cpus);
+	while (iter.hasNext()) {
+		const int iCpu = iter.next();
+		if (iCpu < CPU_SETSIZE)
+			CPU_SET(iCpu, pCpuSet);
+	}
+}
+
+static QList<int> serverCpuList ( const cpu_set_t *pCpuSet )
+{
+	QList<int> cpus;
+	for (int iCpu = 0; iCpu < CPU_SETSIZE; ++iCpu) {
+		if (CPU_ISSET(iCpu, pCpuSet))
+			cpus.append(iCpu);
+	}
+	return cpus;
+}
+
+// Our own original CPU set, as it was before any pinning.
+static cpu_set_t g_selfCpuSet;
+static bool g_bSelfCpuSet = false;
+
+#endif	// CONFIG_SCHED_SETUP
+
+
+// CPU list formatter (eg. "0-3,6").
+static QString serverCpusText ( const QList<int>& cpus )
+{
+	QStringList ranges;
+	int i = 0;
+	while (i < cpus.count()) {
+		int j = i;
+		while (j + 1 < cpus.count() && cpus.at(j + 1) == cpus.at(j) + 1)
+			++j;
+		if (j > i)
+			ranges.append(QString("%1-%2").arg(cpus.at(i)).arg(cpus.at(j)));
+		else
+			ranges.append(QString::number(cpus.at(i)));
+		i = j + 1;
+	}
+	return ranges.join(",");
+}
+
+
+// Constructor.
+ServerProcess::ServerProcess ( QObject *pParent )
+	: QProcess(pParent), m_iSchedPolicy(SchedDefault),
+		m_iSchedPriority(0), m_iMemlock(0)
+{
+}
+
+
+// Scheduling setup, applied on the child process before exec.
+bool ServerProcess::setSchedSetup ( const QString& sCpus,
+	int iSchedPolicy, int iSchedPriority, int iMemlock )
+{
+	m_cpus.clear();
+	m_iSchedPolicy   = SchedDefault;
+	m_iSchedPriority = 0;
+	m_iMemlock       = 0;
+
+	if (!isSchedSupported())
+		return false;
+
+	if (!parseCpus(sCpus, m_cpus))
+		return false;
+
+	m_iSchedPolicy   = iSchedPolicy;
+	m_iSchedPriority = iSchedPriority;
+	m_iMemlock       = iMemlock;
+
+	return true;
+}
+
+
+// Whether there's any scheduling setup to apply at all.
+bool ServerProcess::isSchedSetup (void) const
+{
+	return (!m_cpus.isEmpty()
+		|| m_iSchedPolicy != SchedDefault
+		|| m_iMemlock > 0);
+}
+
+
+// Runs on the child process, between fork and exec:
+// only plain system calls are allowed in here; failures
+// are left to be caught later by verifySchedSetup().
+void ServerProcess::setupChildProcess (void)
+{
+#ifdef CONFIG_SCHED_SETUP
+	if (!m_cpus.isEmpty()) {
+		cpu_set_t cpuset;
+		serverCpuSet(m_cpus, &cpuset);
+		::sched_setaffinity(0, sizeof(cpuset), &cpuset);
+	}
+	else if (g_bSelfCpuSet) {
+		// Don't inherit whatever the GUI threads were pinned to...
+		::sched_setaffinity(0, sizeof(g_selfCpuSet), &g_selfCpuSet);
+	}
+
+	if (m_iMemlock > 0) {
+		struct rlimit rlim;
+		rlim.rlim_cur = rlim.rlim_max = rlim_t(m_iMemlock) << 20;
+		::setrlimit(RLIMIT_MEMLOCK, &rlim);
+	}
+
+	if (m_iSchedPolicy != SchedDefault) {
+		struct sched_param param;
+		::memset(&param, 0, sizeof(param));
+		param.sched_priority = m_iSchedPriority;
+		::sched_setscheduler(0, serverSchedPolicy(m_iSchedPolicy), &param);
+	}
+#endif
+}
+
+
+// Read back the effective settings of the running process.
+QStringList ServerProcess::verifySchedSetup (void) const
+{
+	QStringList diags;
+
+#ifdef CONFIG_SCHED_SETUP
+
+	const pid_t pid = pid_t(QProcess::pid());
+	if (pid <= 0)
+		return diags;
+
+	QString sSummary = QObject::tr("Server scheduling:");
+
+	// CPU affinity...
+	cpu_set_t cpuset;
+	CPU_ZERO(&cpuset);
+	if (::sched_getaffinity(pid, sizeof(cpuset), &cpuset) == 0) {
+		const QList<int>& cpus = serverCpuList(&cpuset);
+		sSummary += ' ' + QObject::tr("CPUs %1").arg(serverCpusText(cpus));
+		if (!m_cpus.isEmpty() && cpus != m_cpus) {
+			diags.append(QObject::tr(
+				"Server CPU affinity is %1, not %2 as requested "
+				"(CPUs offline or not allowed by the current cpuset?)")
+				.arg(serverCpusText(cpus)).arg(serverCpusText(m_cpus)));
+		}
+	}
+	else diags.append(QObject::tr("Server CPU affinity could not be read: %1")
+		.arg(::strerror(errno)));
+
+	// Scheduling policy and priority...
+	const int iPolicy = ::sched_getscheduler(pid);
+	struct sched_param param;
+	::memset(&param, 0, sizeof(param));
+	if (iPolicy >= 0 && ::sched_getparam(pid, &param) == 0) {
+		sSummary += ", " + serverSchedPolicyName(iPolicy);
+		if (iPolicy == SCHED_FIFO || iPolicy == SCHED_RR)
+			sSummary += QString(":%1").arg(param.sched_priority);
+		if (m_iSchedPolicy != SchedDefault
+			&& (iPolicy != serverSchedPolicy(m_iSchedPolicy)
+				|| param.sched_priority != m_iSchedPriority)) {
+			diags.append(QObject::tr(
+				"Server scheduling is %1:%2, not %3:%4 as requested "
+				"(real-time scheduling needs CAP_SYS_NICE or a suitable "
+				"\"rtprio\" entry in /etc/security/limits.conf)")
+				.arg(serverSchedPolicyName(iPolicy))
+				.arg(param.sched_priority)
+				.arg(serverSchedPolicyName(serverSchedPolicy(m_iSchedPolicy)))
+				.arg(m_iSchedPriority));
+		}
+	}
+	else diags.append(QObject::tr("Server scheduling could not be read: %1")
+		.arg(::strerror(errno)));
+
+	// Locked memory limit...
+	struct rlimit rlim;
+	if (::prlimit(pid, RLIMIT_MEMLOCK, NULL, &rlim) == 0) {
+		if (rlim.rlim_cur == RLIM_INFINITY)
+			sSummary += ", " + QObject::tr("memlock unlimited");
+		else
+			sSummary += ", " + QObject::tr("memlock %1 MB")
+				.arg(qulonglong(rlim.rlim_cur >> 20));
+		if (m_iMemlock > 0 && rlim.rlim_cur != RLIM_INFINITY
+			&& rlim.rlim_cur < (rlim_t(m_iMemlock) << 20)) {
+			diags.append(QObject::tr(
+				"Server locked memory limit is %1 MB, not %2 MB as requested "
+				"(raising it needs CAP_SYS_RESOURCE or a suitable "
+				"\"memlock\" entry in /etc/security/limits.conf)")
+				.arg(qulonglong(rlim.rlim_cur >> 20)).arg(m_iMemlock));
+		}
+	}
+
+	diags.prepend(sSummary + '.');
+
+#endif	// CONFIG_SCHED_SETUP
+
+	return diags;
+}
+
+
+// Pin all the current threads of this very process to the given
+// CPU list; if empty, restore the original set, if ever pinned.
+QStringList ServerProcess::setSelfAffinity ( const QString& sCpus )
+{
+	QStringList diags;
+
+#ifdef CONFIG_SCHED_SETUP
+
+	QList<int> cpus;
+	if (!parseCpus(sCpus, cpus)) {
+		diags.append(QObject::tr("Invalid CPU list: \"%1\"").arg(sCpus));
+		return diags;
+	}
+
+	// Never pinned before? leave it alone...
+	if (cpus.isEmpty() && !g_bSelfCpuSet)
+		return diags;
+
+	// Remember what we had in the first place (eg. taskset, cpuset)...
+	if (!g_bSelfCpuSet) {
+		CPU_ZERO(&g_selfCpuSet);
+		if (::sched_getaffinity(0, sizeof(g_selfCpuSet), &g_selfCpuSet) != 0) {
+			diags.append(QObject::tr("CPU affinity could not be read: %1")
+				.arg(::strerror(errno)));
+			return diags;
+		}
+		g_bSelfCpuSet = true;
+	}
+
+	cpu_set_t cpuset;
+	if (cpus.isEmpty())
+		cpuset = g_selfCpuSet;
+	else
+		serverCpuSet(cpus, &cpuset);
+
+	// Threads created later will inherit from their creator anyway...
+	const QStringList& tasks = QDir("/proc/self/task")
+		.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+	QStringListIterator iter(tasks);
+	while (iter.hasNext()) {
+		const pid_t tid = pid_t(iter.next().toInt());
+		if (tid > 0 && ::sched_setaffinity(tid, sizeof(cpuset), &cpuset) != 0) {
+			diags.append(QObject::tr("Could not set CPU affinity of thread %1: %2")
+				.arg(long(tid)).arg(::strerror(errno)));
+		}
+	}
+
+	// Check what we've got, on this very thread...
+	cpu_set_t cpuset2;
+	CPU_ZERO(&cpuset2);
+	if (!cpus.isEmpty() && ::sched_getaffinity(0, sizeof(cpuset2), &cpuset2) == 0
+		&& serverCpuList(&cpuset2) != cpus) {
+		diags.append(QObject::tr("CPU affinity is %1, not %2 as requested.")
+			.arg(serverCpusText(serverCpuList(&cpuset2)))
+			.arg(serverCpusText(cpus)));
+	}
+
+#else
+
+	if (!sCpus.trimmed().isEmpty())
+		diags.append(QObject::tr("CPU affinity is not supported on this platform."));
+
+#endif	// !CONFIG_SCHED_SETUP
+
+	return diags;
+}
+
+
+// CPU list parser (eg. "0-3,6"); empty is valid (any CPU).
+bool ServerProcess::parseCpus ( const QString& sCpus, QList<int>& cpus )
+{
+	cpus.clear();
+
+	const QStringList& ranges
+		= sCpus.simplified().remove(' ').split(',', QString::SkipEmptyParts);
+	QStringListIterator iter(ranges);
+	while (iter.hasNext()) {
+		const QString& sRange = iter.next();
+		bool bOk1 = false, bOk2 = false;
+		const int iFirst = sRange.section('-', 0, 0).toInt(&bOk1);
+		const int iLast  = (sRange.contains('-')
+			? sRange.section('-', 1, 1).toInt(&bOk2) : iFirst);
+		if (!bOk1 || (sRange.contains('-') && !bOk2)
+			|| iFirst < 0 || iLast < iFirst || iLast >= 1024)
+			return false;
+		for (int iCpu = iFirst; iCpu <= iLast; ++iCpu) {
+			if (!cpus.contains(iCpu))
+				cpus.append(iCpu);
+		}
+	}
+
+	qSort(cpus);
+
+	return true;
+}
+
+
+// Whether scheduling control is supported on this platform.
+bool ServerProcess::isSchedSupported (void)
+{
+#ifdef CONFIG_SCHED_SETUP
+	return true;
+#else
+	return false;
+#endif
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerServerProcess.cpp
@@ -0,0 +1,88 @@
+// qsamplerServerProcess.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerServerProcess_h
+#define __qsamplerServerProcess_h
+
+#include <QProcess>
+#include <QStringList>
+#include <QList>
+
+
+namespace QSampler {
+
+//-------------------------------------------------------------------------
+// QSampler::ServerProcess - local server process, scheduling aware.
+//
+
+class ServerProcess : public QProcess
+{
+public:
+
+	// Scheduling policies, as given on options.
+	enum SchedPolicy { SchedDefault = 0, SchedFifo = 1, SchedRoundRobin = 2 };
+
+	// Constructor.
+	ServerProcess(QObject *pParent = NULL);
+
+	// Scheduling setup, applied on the child process before exec.
+	// (CPU list eg. "0-3,6"; memlock limit in MB, 0 for unchanged).
+	bool setSchedSetup(const QString& sCpus,
+		int iSchedPolicy, int iSchedPriority, int iMemlock);
+
+	// Whether there's any scheduling setup to apply at all.
+	bool isSchedSetup() const;
+
+	// Read back the effective settings of the running process;
+	// returns a summary line and any mismatch diagnostics.
+	QStringList verifySchedSetup() const;
+
+	// Pin all the current threads of this very process
+	// to the given CPU list; returns any diagnostics.
+	static QStringList setSelfAffinity(const QString& sCpus);
+
+	// CPU list parser (eg. "0-3,6"); empty is valid (any CPU).
+	static bool parseCpus(const QString& sCpus, QList<int>& cpus);
+
+	// Whether scheduling control is supported on this platform.
+	static bool isSchedSupported();
+
+protected:
+
+	// Runs on the child process, between fork and exec.
+	void setupChildProcess();
+
+private:
+
+	// Instance variables.
+	QList<int> m_cpus;
+	int        m_iSchedPolicy;
+	int        m_iSchedPriority;
+	int        m_iMemlock;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerServerProcess_h
+
+
+// end of qsamplerServerProcess.h
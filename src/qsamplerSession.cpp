@@ -0,0 +1,459 @@
+// qsamplerSession.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerSession.h"
+
+#include "qsamplerChannel.h"
+#include "qsamplerLoadHistory.h"
+#include "qsamplerUtilities.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QRegExp>
+#include <QtAlgorithms>
+
+
+namespace QSampler {
+
+// Instrument file header warm-up size (bytes).
+#define QSAMPLER_SESSION_WARMUP_SIZE  (256 * 1024)
+
+
+// Resolve LSCP hex escape sequences (\xHH) of a quoted path, blindly,
+// as the server protocol version is not known before connection.
+static QString sessionUnescapePath ( const QString& sPath )
+{
+	QString sResult(sPath);
+
+	QRegExp rx("\\\\x([0-9a-fA-F]{2})");
+	for (int i = rx.indexIn(sResult); i >= 0; i = rx.indexIn(sResult, i + 1))
+		sResult.replace(i, 4, QChar(rx.cap(1).toInt(NULL, 16)));
+
+	return sResult;
+}
+
+
+// Instrument files are the first quoted argument
+// of either LOAD INSTRUMENT or MAP MIDI_INSTRUMENT.
+static QString sessionInstrumentFile ( const QString& sCommand )
+{
+	const QString& sVerb = sCommand.section(' ', 0, 0).toUpper();
+	const QString& sObject = sCommand.section(' ', 1, 1).toUpper();
+	if ((sVerb == "LOAD" && sObject == "INSTRUMENT")
+		|| (sVerb == "MAP" && sObject == "MIDI_INSTRUMENT"))
+		return sessionUnescapePath(sCommand.section('\'', 1, 1));
+	else
+		return QString();
+}
+
+
+// Instrument load ordering item.
+struct SessionLoad
+{
+	Session::Command cmd;
+	bool    bCritical;
+	int     iBucket;        // Predicted load time bucket.
+	QString sDir;
+	QString sFile;
+	int     iNr;
+};
+
+// Instrument load time buckets (msecs).
+#define QSAMPLER_SESSION_LOAD_BUCKET  1000
+
+static bool sessionLoadLessThan ( const SessionLoad& a, const SessionLoad& b )
+{
+	if (a.bCritical != b.bCritical)
+		return a.bCritical;
+	if (a.iBucket != b.iBucket)
+		return a.iBucket < b.iBucket;
+	if (a.sDir != b.sDir)
+		return a.sDir < b.sDir;
+	if (a.sFile != b.sFile)
+		return a.sFile < b.sFile;
+	return a.iNr < b.iNr;
+}
+
+
+//-------------------------------------------------------------------------
+// QSampler::Session - prepared session command stream.
+//
+
+// Constructor.
+Session::Session ( const QString& sFilename )
+	: m_sFilename(sFilename), m_bPrepared(false), m_bGenerated(false)
+{
+}
+
+
+// Session file name accessor.
+const QString& Session::filename (void) const
+{
+	return m_sFilename;
+}
+
+
+// Parse and validate the session file; optionally check and
+// warm-up all referenced instrument files (any thread).
+bool Session::prepare ( bool bPreflight, bool bInstrumentNames )
+{
+	m_missingFiles.clear();
+	m_instrumentLists.clear();
+
+	QFile file(m_sFilename);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	QTextStream ts(&file);
+	parse(ts);
+
+	file.close();
+
+	if (bPreflight) {
+		QStringListIterator iter(m_instrumentFiles);
+		while (iter.hasNext())
+			preflight(iter.next(), bInstrumentNames);
+	}
+
+	return true;
+}
+
+
+// Parse and validate a session command stream (eg. in-memory).
+void Session::parse ( QTextStream& ts )
+{
+	m_commands.clear();
+	m_warnings.clear();
+	m_instrumentFiles.clear();
+	m_commentedFiles.clear();
+
+	m_bGenerated = false;
+
+	int iLine = 0;
+	while (!ts.atEnd()) {
+		const QString& sCommand = ts.readLine().trimmed();
+		iLine++;
+		// Our own saved files have a distinctive header...
+		if (iLine == 1)
+			m_bGenerated = sCommand.startsWith("# " QSAMPLER_TITLE " - ");
+		// If not empty, nor a comment, it's for the server...
+		if (sCommand.isEmpty())
+			continue;
+		if (sCommand[0] == '#') {
+			// Commented out instrument loads (eg. not loaded
+			// when saved) still refer to their instrument files...
+			const QString& sInstrumentFile
+				= sessionInstrumentFile(sCommand.mid(1).trimmed());
+			if (!sInstrumentFile.isEmpty()
+				&& !m_commentedFiles.contains(sInstrumentFile))
+				m_commentedFiles.append(sInstrumentFile);
+			continue;
+		}
+		validate(iLine, sCommand);
+		// Remember that, no matter what,
+		// all LSCP commands are CR/LF terminated.
+		Command cmd;
+		cmd.iLine = iLine;
+		cmd.sCommand = sCommand + "\r\n";
+		m_commands.append(cmd);
+	}
+
+	m_bPrepared = true;
+}
+
+
+// Whether the session file has been read already.
+bool Session::isPrepared (void) const
+{
+	return m_bPrepared;
+}
+
+
+// Whether the session file was written by ourselves.
+bool Session::isGenerated (void) const
+{
+	return m_bGenerated;
+}
+
+
+// Have all instrument loads moved last, the ones
+// of the given (critical) sampler channels first;
+// then the shortest ones, close on disk, if known.
+void Session::deferInstrumentLoads (
+	const QList<int>& channels, const LoadHistory *pLoadHistory )
+{
+	QList<Command> commands;
+	QList<SessionLoad> loads;
+
+	int iKnownMsecs = 0;
+	int iKnown = 0;
+
+	QListIterator<Command> iter(m_commands);
+	while (iter.hasNext()) {
+		const Command& cmd = iter.next();
+		SessionLoad load;
+		int iChannel = -1;
+		if (parseInstrumentLoad(cmd.sCommand, load.sFile, load.iNr, iChannel)) {
+			load.cmd = cmd;
+			load.bCritical = channels.contains(iChannel);
+			load.iBucket = -1;
+			if (pLoadHistory) {
+				const int iMsecs = pLoadHistory->estimate(load.sFile, load.iNr);
+				if (iMsecs >= 0) {
+					load.iBucket = iMsecs / QSAMPLER_SESSION_LOAD_BUCKET;
+					iKnownMsecs += iMsecs;
+					++iKnown;
+				}
+				load.sDir = QFileInfo(load.sFile).absolutePath();
+			} else {
+				load.sFile.clear();
+				load.iNr = 0;
+			}
+			loads.append(load);
+		}
+		else commands.append(cmd);
+	}
+
+	// Unknown ones are taken as average ones, as far as known
+	// (nothing known at all makes it all the same bucket)...
+	const int iUnknownBucket = (iKnown > 0
+		? (iKnownMsecs / iKnown) / QSAMPLER_SESSION_LOAD_BUCKET : 0);
+	QMutableListIterator<SessionLoad> unknown(loads);
+	while (unknown.hasNext()) {
+		SessionLoad& load = unknown.next();
+		if (load.iBucket < 0)
+			load.iBucket = iUnknownBucket;
+	}
+
+	// Keep original order, whenever there's no better clue...
+	qStableSort(loads.begin(), loads.end(), sessionLoadLessThan);
+
+	QListIterator<SessionLoad> load(loads);
+	while (load.hasNext())
+		commands.append(load.next().cmd);
+
+	m_commands = commands;
+}
+
+
+// Predicted total instrument load time (msecs), and how
+// many instrument loads are accounted for (serialized, as
+// the server loads instruments one at a time anyway).
+int Session::predictLoadTime ( const LoadHistory& loadHistory,
+	int *piKnown, int *piTotal ) const
+{
+	int iMsecs = 0;
+	int iKnown = 0;
+	int iTotal = 0;
+
+	QListIterator<Command> iter(m_commands);
+	while (iter.hasNext()) {
+		QString sInstrumentFile;
+		int iInstrumentNr = 0;
+		int iChannel = -1;
+		if (!parseInstrumentLoad(iter.next().sCommand,
+				sInstrumentFile, iInstrumentNr, iChannel))
+			continue;
+		++iTotal;
+		const int iEstimate
+			= loadHistory.estimate(sInstrumentFile, iInstrumentNr);
+		if (iEstimate >= 0) {
+			iMsecs += iEstimate;
+			++iKnown;
+		}
+	}
+
+	if (piKnown)
+		*piKnown = iKnown;
+	if (piTotal)
+		*piTotal = iTotal;
+
+	return iMsecs;
+}
+
+
+// Rewrite all instrument file references of a session text
+// (eg. as saved), according to the given original-to-new map.
+QString Session::relocate ( const QString& sSession,
+	const QHash<QString, QString>& paths )
+{
+	QStringList lines = sSession.split('\n');
+	QMutableStringListIterator iter(lines);
+	while (iter.hasNext()) {
+		QString& sLine = iter.next();
+		QString sCommand = sLine.trimmed();
+		// Commented out ones are relocated all the same...
+		QString sComment;
+		if (sCommand.startsWith('#')) {
+			sComment = "# ";
+			sCommand = sCommand.mid(1).trimmed();
+		}
+		const QString& sPath = sessionInstrumentFile(sCommand);
+		if (sPath.isEmpty())
+			continue;
+		QHash<QString, QString>::ConstIterator found = paths.constFind(sPath);
+		if (found == paths.constEnd())
+			continue;
+		sLine = sComment + sCommand.section('\'', 0, 0)
+			+ '\'' + qsamplerUtilities::lscpEscapePath(found.value())
+			+ '\'' + sCommand.section('\'', 2);
+	}
+
+	return lines.join("\n");
+}
+
+
+// Split an instrument load command in its arguments
+// eg. LOAD INSTRUMENT [NON_MODAL] '<filename>' <nr> <channel>
+bool Session::parseInstrumentLoad ( const QString& sCommand,
+	QString& sInstrumentFile, int& iInstrumentNr, int& iChannel )
+{
+	if (!sCommand.startsWith("LOAD INSTRUMENT", Qt::CaseInsensitive))
+		return false;
+
+	const QString& sArgs = sCommand.section('\'', 2).simplified();
+	sInstrumentFile = sessionUnescapePath(sCommand.section('\'', 1, 1));
+	iInstrumentNr = sArgs.section(' ', 0, 0).toInt();
+	iChannel = sArgs.section(' ', 1, 1).toInt();
+
+	return true;
+}
+
+
+// Prepared results accessors.
+const QList<Session::Command>& Session::commands (void) const
+{
+	return m_commands;
+}
+
+const QStringList& Session::warnings (void) const
+{
+	return m_warnings;
+}
+
+const QStringList& Session::commentedFiles (void) const
+{
+	return m_commentedFiles;
+}
+
+const QStringList& Session::missingFiles (void) const
+{
+	return m_missingFiles;
+}
+
+const QStringList& Session::instrumentFiles (void) const
+{
+	return m_instrumentFiles;
+}
+
+const QHash<QString, QStringList>& Session::instrumentLists (void) const
+{
+	return m_instrumentLists;
+}
+
+
+// Validate one command line, noting any instrument file found.
+void Session::validate ( int iLine, const QString& sCommand )
+{
+	static const char *s_apszVerbs[] = {
+		"ADD", "CLEAR", "COPY", "CREATE", "DESTROY", "EDIT", "FIND",
+		"FORMAT", "GET", "LIST", "LOAD", "MAP", "MOVE", "REMOVE", "RESET",
+		"SEND", "SET", "SUBSCRIBE", "UNMAP", "UNSUBSCRIBE", NULL
+	};
+
+	const QString& sVerb = sCommand.section(' ', 0, 0).toUpper();
+	int iVerb = 0;
+	while (s_apszVerbs[iVerb] && sVerb != s_apszVerbs[iVerb])
+		++iVerb;
+	if (s_apszVerbs[iVerb] == NULL) {
+		m_warnings.append(QObject::tr("%1(%2): unknown command \"%3\".")
+			.arg(QFileInfo(m_sFilename).fileName()).arg(iLine).arg(sVerb));
+		return;
+	}
+
+	if (sCommand.count('\'') % 2) {
+		m_warnings.append(QObject::tr("%1(%2): unbalanced quotes.")
+			.arg(QFileInfo(m_sFilename).fileName()).arg(iLine));
+		return;
+	}
+
+	const QString& sInstrumentFile = sessionInstrumentFile(sCommand);
+	if (!sInstrumentFile.isEmpty()
+		&& !m_instrumentFiles.contains(sInstrumentFile))
+		m_instrumentFiles.append(sInstrumentFile);
+}
+
+
+// Instrument file preflight and name-index warm-up.
+void Session::preflight (
+	const QString& sInstrumentFile, bool bInstrumentNames )
+{
+	QFile file(sInstrumentFile);
+	if (!file.open(QIODevice::ReadOnly)) {
+		m_missingFiles.append(sInstrumentFile);
+		return;
+	}
+
+	// Have the file header read ahead, which is just
+	// what the server will be reading first anyway...
+	file.read(QSAMPLER_SESSION_WARMUP_SIZE);
+	file.close();
+
+	if (bInstrumentNames) {
+		const QStringList& instlist
+			= Channel::readInstrumentList(sInstrumentFile);
+		if (!instlist.isEmpty())
+			m_instrumentLists.insert(sInstrumentFile, instlist);
+	}
+}
+
+
+//-------------------------------------------------------------------------
+// QSampler::SessionThread - background session preparation.
+//
+
+// Constructor.
+SessionThread::SessionThread (
+	const QString& sFilename, bool bInstrumentNames )
+	: QThread(), m_session(sFilename), m_bInstrumentNames(bInstrumentNames)
+{
+}
+
+
+// Prepared session accessor (only after the thread is finished).
+const Session& SessionThread::session (void) const
+{
+	return m_session;
+}
+
+
+// The main thread executive.
+void SessionThread::run (void)
+{
+	m_session.prepare(true, m_bInstrumentNames);
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerSession.cpp
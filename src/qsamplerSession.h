@@ -0,0 +1,158 @@
+// qsamplerSession.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerSession_h
+#define __qsamplerSession_h
+
+#include <QThread>
+#include <QStringList>
+#include <QHash>
+#include <QList>
+
+class QTextStream;
+
+
+namespace QSampler {
+
+class LoadHistory;
+
+
+//-------------------------------------------------------------------------
+// QSampler::Session - prepared session command stream.
+//
+
+class Session
+{
+public:
+
+	// Constructor.
+	Session(const QString& sFilename = QString());
+
+	// Session file name accessor.
+	const QString& filename() const;
+
+	// Parse and validate the session file; optionally check and
+	// warm-up all referenced instrument files (any thread).
+	bool prepare(bool bPreflight = false, bool bInstrumentNames = false);
+
+	// Parse and validate a session command stream (eg. in-memory).
+	void parse(QTextStream& ts);
+
+	// Whether the session file has been read already.
+	bool isPrepared() const;
+
+	// Whether the session file was written by ourselves
+	// (ie. its command order is ours to change).
+	bool isGenerated() const;
+
+	// Have all instrument loads moved last, the ones
+	// of the given (critical) sampler channels first;
+	// then the shortest ones, close on disk, if known.
+	void deferInstrumentLoads(const QList<int>& channels,
+		const LoadHistory *pLoadHistory = NULL);
+
+	// Predicted total instrument load time (msecs),
+	// and how many instrument loads are accounted for.
+	int predictLoadTime(const LoadHistory& loadHistory,
+		int *piKnown = NULL, int *piTotal = NULL) const;
+
+	// Rewrite all instrument file references of a session text
+	// (eg. as saved), according to the given original-to-new map.
+	static QString relocate(const QString& sSession,
+		const QHash<QString, QString>& paths);
+
+	// Split an instrument load command in its arguments.
+	static bool parseInstrumentLoad(const QString& sCommand,
+		QString& sInstrumentFile, int& iInstrumentNr, int& iChannel);
+
+	// One LSCP command line, as found in the session file.
+	struct Command
+	{
+		int     iLine;
+		QString sCommand;	// CR/LF terminated.
+	};
+
+	// Prepared results accessors.
+	const QList<Command>& commands() const;
+	const QStringList& warnings() const;
+	const QStringList& missingFiles() const;
+	const QStringList& instrumentFiles() const;
+	const QStringList& commentedFiles() const;
+	const QHash<QString, QStringList>& instrumentLists() const;
+
+protected:
+
+	// Validate one command line, noting any instrument file found.
+	void validate(int iLine, const QString& sCommand);
+
+	// Instrument file preflight and name-index warm-up.
+	void preflight(const QString& sInstrumentFile, bool bInstrumentNames);
+
+private:
+
+	// Instance variables.
+	QString m_sFilename;
+	bool    m_bPrepared;
+	bool    m_bGenerated;
+
+	QList<Command> m_commands;
+	QStringList    m_warnings;
+	QStringList    m_instrumentFiles;
+	QStringList    m_commentedFiles;	// Commented out references.
+	QStringList    m_missingFiles;
+
+	QHash<QString, QStringList> m_instrumentLists;
+};
+
+
+//-------------------------------------------------------------------------
+// QSampler::SessionThread - background session preparation.
+//
+
+class SessionThread : public QThread
+{
+public:
+
+	// Constructor.
+	SessionThread(const QString& sFilename, bool bInstrumentNames);
+
+	// Prepared session accessor (only after the thread is finished).
+	const Session& session() const;
+
+protected:
+
+	// The main thread executive.
+	void run();
+
+private:
+
+	// Instance variables.
+	Session m_session;
+	bool    m_bInstrumentNames;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerSession_h
+
+
+// end of qsamplerSession.h
@@ -0,0 +1,400 @@
+// qsamplerSessionBundle.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerSessionBundle.h"
+
+#include <QThreadPool>
+#include <QRunnable>
+#include <QMutexLocker>
+#include <QCryptographicHash>
+#include <QFileInfo>
+#include <QFile>
+#include <QDir>
+#include <QVector>
+
+#if defined(HAVE_UNISTD_H)
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && defined(HAVE_FCNTL_H) && defined(HAVE_SYS_IOCTL_H)
+#define CONFIG_REFLINK 1
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#ifndef FICLONE
+#define FICLONE _IOW(0x94, 9, int)
+#endif
+#endif
+
+
+namespace QSampler {
+
+// File copy/digest chunk size (bytes).
+#define QSAMPLER_BUNDLE_CHUNK_SIZE  (1024 * 1024)
+
+
+//-------------------------------------------------------------------------
+// QSampler::SessionBundleJob - one parallel digest or transfer.
+//
+
+class SessionBundleJob : public QRunnable
+{
+public:
+
+	// Constructor.
+	SessionBundleJob(SessionBundle *pBundle, const QString& sSrc,
+		const QString& sDst, QByteArray *pDigest = NULL)
+		: m_pBundle(pBundle), m_sSrc(sSrc), m_sDst(sDst), m_pDigest(pDigest) {}
+
+	// Job executive.
+	void run()
+	{
+		if (m_pDigest)
+			*m_pDigest = m_pBundle->digest(m_sSrc);
+		else
+			m_pBundle->transfer(m_sSrc, m_sDst);
+	}
+
+private:
+
+	// Instance variables.
+	SessionBundle *m_pBundle;
+	QString        m_sSrc;
+	QString        m_sDst;
+	QByteArray    *m_pDigest;
+};
+
+
+//-------------------------------------------------------------------------
+// QSampler::SessionBundle - session instrument files collector.
+//
+
+// Constructor.
+SessionBundle::SessionBundle ( const QString& sBundleDir,
+	const QStringList& files, int iThreads )
+	: QThread(), m_sBundleDir(sBundleDir), m_files(files),
+		m_iThreads(iThreads), m_bCancel(false),
+		m_iFilesDone(0), m_iFilesTotal(0),
+		m_iBytesDone(0), m_iBytesTotal(0),
+		m_iLinked(0), m_iReflinked(0), m_iCopied(0), m_iDeduped(0)
+{
+	if (m_iThreads < 1)
+		m_iThreads = QThread::idealThreadCount();
+	if (m_iThreads < 1)
+		m_iThreads = 1;
+}
+
+
+// Bundle directory accessor (where instrument files go).
+const QString& SessionBundle::bundleDir (void) const
+{
+	return m_sBundleDir;
+}
+
+
+// Cancel (and wait for) the whole thing.
+void SessionBundle::cancel (void)
+{
+	m_bCancel = true;
+
+	QThread::wait();
+}
+
+
+// Progress accessors (any time).
+int SessionBundle::filesDone (void) const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_iFilesDone;
+}
+
+int SessionBundle::filesTotal (void) const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_iFilesTotal;
+}
+
+qint64 SessionBundle::bytesDone (void) const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_iBytesDone;
+}
+
+qint64 SessionBundle::bytesTotal (void) const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_iBytesTotal;
+}
+
+
+// Results accessors (only after the thread is finished).
+const QHash<QString, QString>& SessionBundle::paths (void) const
+{
+	return m_paths;
+}
+
+const QStringList& SessionBundle::errors (void) const
+{
+	return m_errors;
+}
+
+int SessionBundle::linked (void) const
+{
+	return m_iLinked;
+}
+
+int SessionBundle::reflinked (void) const
+{
+	return m_iReflinked;
+}
+
+int SessionBundle::copied (void) const
+{
+	return m_iCopied;
+}
+
+int SessionBundle::deduped (void) const
+{
+	return m_iDeduped;
+}
+
+
+// The main thread executive.
+void SessionBundle::run (void)
+{
+	// Resolve the unique source files first...
+	QStringList sources;
+	QHash<QString, QString> canonicals;
+	QHash<qint64, int> sizes;
+	QStringListIterator iter(m_files);
+	while (iter.hasNext()) {
+		const QString& sPath = iter.next();
+		const QFileInfo fi(sPath);
+		if (!fi.exists() || !fi.isFile()) {
+			addError(QObject::tr("Instrument file not found: \"%1\".").arg(sPath));
+			continue;
+		}
+		const QString& sCanonical = fi.canonicalFilePath();
+		canonicals.insert(sPath, sCanonical);
+		if (!sources.contains(sCanonical)) {
+			sources.append(sCanonical);
+			sizes[fi.size()]++;
+		}
+	}
+
+	QThreadPool pool;
+	pool.setMaxThreadCount(m_iThreads);
+
+	// Only files of the very same size may have identical contents...
+	const int iSources = sources.count();
+	QVector<QByteArray> digests(iSources);
+	QByteArray *pDigests = digests.data();
+	for (int i = 0; i < iSources && !m_bCancel; ++i) {
+		const QString& sSource = sources.at(i);
+		if (sizes.value(QFileInfo(sSource).size()) > 1)
+			pool.start(new SessionBundleJob(this, sSource, QString(), &pDigests[i]));
+	}
+	pool.waitForDone();
+
+	// Deduplicate and assign unique bundle targets...
+	QHash<QString, QString> targets;
+	QHash<QByteArray, QString> contents;
+	QStringList names;
+	qint64 iBytesTotal = 0;
+	for (int i = 0; i < iSources && !m_bCancel; ++i) {
+		const QString& sSource = sources.at(i);
+		const QByteArray& digest = digests.at(i);
+		if (!digest.isEmpty() && contents.contains(digest)) {
+			targets.insert(sSource, targets.value(contents.value(digest)));
+			++m_iDeduped;
+			continue;
+		}
+		const QString& sTarget = targetPath(sSource, names);
+		targets.insert(sSource, sTarget);
+		if (!digest.isEmpty())
+			contents.insert(digest, sSource);
+		iBytesTotal += QFileInfo(sSource).size();
+		pool.start(new SessionBundleJob(this, sSource, sTarget));
+		m_mutex.lock();
+		++m_iFilesTotal;
+		m_iBytesTotal = iBytesTotal;
+		m_mutex.unlock();
+	}
+	pool.waitForDone();
+
+	// Original to bundle file paths map...
+	QHash<QString, QString>::ConstIterator iter2 = canonicals.constBegin();
+	for ( ; iter2 != canonicals.constEnd(); ++iter2) {
+		const QString& sTarget = targets.value(iter2.value());
+		if (!sTarget.isEmpty() && QFileInfo(sTarget).exists())
+			m_paths.insert(iter2.key(), sTarget);
+	}
+}
+
+
+// Bundle target path of a given file (unique).
+QString SessionBundle::targetPath (
+	const QString& sPath, QStringList& names ) const
+{
+	const QDir dir(m_sBundleDir);
+	const QFileInfo fi(sPath);
+	const QString& sBaseName = fi.completeBaseName();
+	const QString& sSuffix = fi.suffix();
+
+	QString sName = fi.fileName();
+	for (int i = 1; ; ++i) {
+		const QFileInfo target(dir.filePath(sName));
+		if (!names.contains(sName)
+			&& (!target.exists() || target.canonicalFilePath() == sPath))
+			break;
+		sName = sBaseName + '-' + QString::number(i);
+		if (!sSuffix.isEmpty())
+			sName += '.' + sSuffix;
+	}
+
+	names.append(sName);
+	return dir.filePath(sName);
+}
+
+
+// Transfer one file (runs on a worker thread).
+SessionBundle::Transfer SessionBundle::transfer (
+	const QString& sSrc, const QString& sDst )
+{
+	Transfer result = Failed;
+
+	const qint64 iSize = QFileInfo(sSrc).size();
+
+	const QByteArray aSrc = QFile::encodeName(sSrc);
+	const QByteArray aDst = QFile::encodeName(sDst);
+
+	if (m_bCancel)
+		return Failed;
+
+	// Already there (eg. collecting into the same place)?
+	if (QFileInfo(sDst).exists())
+		result = Present;
+
+#if defined(HAVE_UNISTD_H)
+	// A hard link is the cheapest of all (same file system)...
+	if (result == Failed && ::link(aSrc.constData(), aDst.constData()) == 0)
+		result = Linked;
+#endif
+
+#ifdef CONFIG_REFLINK
+	// Otherwise a copy-on-write clone (eg. btrfs, xfs)...
+	if (result == Failed) {
+		const int iSrcFd = ::open(aSrc.constData(), O_RDONLY);
+		if (iSrcFd >= 0) {
+			const int iDstFd = ::open(aDst.constData(),
+				O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			if (iDstFd >= 0) {
+				if (::ioctl(iDstFd, FICLONE, iSrcFd) == 0)
+					result = Reflinked;
+				::close(iDstFd);
+			}
+			::close(iSrcFd);
+		}
+	}
+#endif
+
+	if (result != Failed) {
+		QMutexLocker locker(&m_mutex);
+		m_iBytesDone += iSize;
+	} else {
+		// Last resort: a plain old copy, chunk by chunk.
+		QFile src(sSrc);
+		QFile dst(sDst);
+		if (src.open(QIODevice::ReadOnly)
+			&& dst.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+			result = Copied;
+			while (!src.atEnd()) {
+				const QByteArray& data = src.read(QSAMPLER_BUNDLE_CHUNK_SIZE);
+				if (m_bCancel || data.isEmpty()
+					|| dst.write(data) != data.size()) {
+					result = Failed;
+					break;
+				}
+				QMutexLocker locker(&m_mutex);
+				m_iBytesDone += data.size();
+			}
+			dst.close();
+		}
+		if (result == Failed) {
+			if (!m_bCancel) {
+				addError(QObject::tr("Could not copy \"%1\" to \"%2\": %3.")
+					.arg(sSrc).arg(sDst).arg(dst.errorString()));
+			}
+			dst.remove();
+		}
+	}
+
+	QMutexLocker locker(&m_mutex);
+	++m_iFilesDone;
+	switch (result) {
+	case Linked:
+		++m_iLinked;
+		break;
+	case Reflinked:
+		++m_iReflinked;
+		break;
+	case Copied:
+		++m_iCopied;
+		break;
+	default:
+		break;
+	}
+
+	return result;
+}
+
+
+// Content digest of one file (runs on a worker thread).
+QByteArray SessionBundle::digest ( const QString& sPath )
+{
+	QFile file(sPath);
+	if (!file.open(QIODevice::ReadOnly))
+		return QByteArray();
+
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	while (!file.atEnd() && !m_bCancel) {
+		const QByteArray& data = file.read(QSAMPLER_BUNDLE_CHUNK_SIZE);
+		if (data.isEmpty())
+			break;
+		hash.addData(data);
+	}
+
+	// Sizes are known to be the same already.
+	return hash.result();
+}
+
+
+// Error accounting (any thread).
+void SessionBundle::addError ( const QString& sError )
+{
+	QMutexLocker locker(&m_mutex);
+	m_errors.append(sError);
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerSessionBundle.cpp
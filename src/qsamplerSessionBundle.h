@@ -0,0 +1,117 @@
+// qsamplerSessionBundle.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerSessionBundle_h
+#define __qsamplerSessionBundle_h
+
+#include <QThread>
+#include <QMutex>
+#include <QStringList>
+#include <QHash>
+
+
+namespace QSampler {
+
+//-------------------------------------------------------------------------
+// QSampler::SessionBundle - session instrument files collector.
+//
+
+class SessionBundle : public QThread
+{
+public:
+
+	// Constructor.
+	SessionBundle(const QString& sBundleDir,
+		const QStringList& files, int iThreads = 0);
+
+	// Bundle directory accessor (where instrument files go).
+	const QString& bundleDir() const;
+
+	// Cancel (and wait for) the whole thing.
+	void cancel();
+
+	// Progress accessors (any time).
+	int filesDone() const;
+	int filesTotal() const;
+	qint64 bytesDone() const;
+	qint64 bytesTotal() const;
+
+	// Results accessors (only after the thread is finished).
+	const QHash<QString, QString>& paths() const;
+	const QStringList& errors() const;
+
+	int linked() const;
+	int reflinked() const;
+	int copied() const;
+	int deduped() const;
+
+	// How each file has been transferred.
+	enum Transfer { Failed = 0, Linked, Reflinked, Copied, Present };
+
+	// Transfer one file (runs on a worker thread).
+	Transfer transfer(const QString& sSrc, const QString& sDst);
+
+	// Content digest of one file (runs on a worker thread).
+	QByteArray digest(const QString& sPath);
+
+protected:
+
+	// The main thread executive.
+	void run();
+
+	// Error accounting (any thread).
+	void addError(const QString& sError);
+
+	// Bundle target path of a given file (unique).
+	QString targetPath(const QString& sPath, QStringList& targets) const;
+
+private:
+
+	// Instance variables.
+	QString     m_sBundleDir;
+	QStringList m_files;
+	int         m_iThreads;
+
+	mutable QMutex m_mutex;
+
+	QHash<QString, QString> m_paths;
+	QStringList m_errors;
+
+	volatile bool m_bCancel;
+
+	int    m_iFilesDone;
+	int    m_iFilesTotal;
+	qint64 m_iBytesDone;
+	qint64 m_iBytesTotal;
+
+	int m_iLinked;
+	int m_iReflinked;
+	int m_iCopied;
+	int m_iDeduped;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerSessionBundle_h
+
+
+// end of qsamplerSessionBundle.h
@@ -0,0 +1,478 @@
+// qsamplerSessionStage.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerSessionStage.h"
+
+#include "qsamplerSession.h"
+#include "qsamplerDevice.h"
+#include "qsamplerMainForm.h"
+
+#include <QFileInfo>
+#include <QHash>
+#include <QRegExp>
+#include <QTimer>
+
+
+namespace QSampler {
+
+// Readiness check period (msecs).
+#define QSAMPLER_SESSION_STAGE_MSECS  500
+
+
+// Take a copy of a (-1 terminated) ID list.
+static QList<int> sessionStageIDs ( const int *piIDs )
+{
+	QList<int> ids;
+	for (int i = 0; piIDs && piIDs[i] >= 0; ++i)
+		ids.append(piIDs[i]);
+	return ids;
+}
+
+
+// Map a session file index into a current server ID.
+static bool sessionStageMapArg ( QStringList& args, int iArg,
+	const QList<int>& ids )
+{
+	if (iArg >= args.count())
+		return false;
+
+	bool bOk = false;
+	const int iIndex = args.at(iArg).toInt(&bOk);
+	if (!bOk)
+		return true;	// eg. NONE, DEFAULT.
+	if (iIndex < 0 || iIndex >= ids.count() || ids.at(iIndex) < 0)
+		return false;
+
+	args[iArg] = QString::number(ids.at(iIndex));
+	return true;
+}
+
+
+//-------------------------------------------------------------------------
+// QSampler::SessionStage - next session preloader (muted channels).
+//
+
+// Constructor.
+SessionStage::SessionStage ( QObject *pParent )
+	: QObject(pParent), m_iReady(0), m_iFailed(0), m_iTotal(0),
+		m_bReady(false)
+{
+	m_pTimer = new QTimer(this);
+	m_pTimer->setInterval(QSAMPLER_SESSION_STAGE_MSECS);
+	QObject::connect(m_pTimer,
+		SIGNAL(timeout()),
+		SLOT(timerSlot()));
+}
+
+
+// Destructor.
+SessionStage::~SessionStage (void)
+{
+}
+
+
+// Stage all sampler channels of a prepared session, muted.
+int SessionStage::stage ( const Session& session )
+{
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL)
+		return 1;
+
+	lscp_client_t *pClient = pMainForm->client();
+	if (pClient == NULL)
+		return 1;
+
+	m_sFilename = session.filename();
+
+	const QString& sName = QFileInfo(m_sFilename).fileName();
+
+	// Devices are kept as they are,
+	// so session indexes map to the current ones...
+	const QList<int> audioDevices
+		= sessionStageIDs(Device::getDevices(pClient, Device::Audio));
+	const QList<int> midiDevices
+		= sessionStageIDs(Device::getDevices(pClient, Device::Midi));
+
+	// MIDI instrument maps get staged as new ones instead,
+	// the current ones being gone on commit...
+	m_maps.clear();
+	m_oldMaps.clear();
+#ifdef CONFIG_MIDI_INSTRUMENT
+	m_oldMaps = sessionStageIDs(::lscp_list_midi_instrument_maps(pClient));
+#endif
+
+	QHash<int, int> channels;
+	int iAdded = 0;
+	int iSkipped = 0;
+	int iErrors = 0;
+
+	QListIterator<Session::Command> iter(session.commands());
+	while (iter.hasNext()) {
+		const Session::Command& cmd = iter.next();
+		const QString& sCommand = cmd.sCommand.trimmed();
+		QStringList args = sCommand.split(' ');
+		const QString& sVerb = args.at(0).toUpper();
+		const QString& sWhat = (args.count() > 1 ? args.at(1).toUpper() : QString());
+		// New sampler channel, muted from the very start...
+		if (sVerb == "ADD" && sWhat == "CHANNEL" && args.count() == 2) {
+			const int iChannel = iAdded++;
+			const int iChannelID = ::lscp_add_channel(pClient);
+			if (iChannelID < 0) {
+				pMainForm->appendMessagesClient("lscp_add_channel");
+				++iErrors;
+				continue;
+			}
+			::lscp_set_channel_mute(pClient, iChannelID, 1);
+			Staged staged;
+			staged.iChannelID  = iChannelID;
+			staged.bMute       = false;
+			staged.bSolo       = false;
+			staged.bInstrument = false;
+			channels.insert(iChannel, m_staged.count());
+			m_staged.append(staged);
+			continue;
+		}
+	#ifdef CONFIG_MIDI_INSTRUMENT
+		// New MIDI instrument map, in session order...
+		if (sVerb == "ADD" && sWhat == "MIDI_INSTRUMENT_MAP") {
+			const QString& sQuery = sCommand + "\r\n";
+			int iMap = -1;
+			if (::lscp_client_query(pClient, sQuery.toUtf8().constData()) == LSCP_OK)
+				iMap = QString(::lscp_client_get_result(pClient)).trimmed().toInt();
+			else {
+				pMainForm->appendMessagesColor(QString("%1(%2): %3")
+					.arg(sName).arg(cmd.iLine).arg(sCommand), "#996633");
+				pMainForm->appendMessagesClient("lscp_client_query");
+				++iErrors;
+			}
+			// Failed ones still take their index...
+			m_maps.append(iMap);
+			continue;
+		}
+		// Its entries, always in background...
+		if (sVerb == "MAP" && sWhat == "MIDI_INSTRUMENT") {
+			QRegExp rx("^MAP\\s+MIDI_INSTRUMENT\\s+(NON_MODAL\\s+)?(\\d+)\\s+(.+)$",
+				Qt::CaseInsensitive);
+			const int iIndex = (rx.exactMatch(sCommand) ? rx.cap(2).toInt() : -1);
+			if (iIndex < 0 || iIndex >= m_maps.count() || m_maps.at(iIndex) < 0) {
+				pMainForm->appendMessagesColor(
+					tr("%1(%2): %3: no such map here.")
+					.arg(sName).arg(cmd.iLine).arg(sCommand), "#996633");
+				++iErrors;
+				continue;
+			}
+			const QString& sQuery = "MAP MIDI_INSTRUMENT NON_MODAL "
+				+ QString::number(m_maps.at(iIndex)) + ' ' + rx.cap(3) + "\r\n";
+			if (::lscp_client_query(pClient, sQuery.toUtf8().constData()) != LSCP_OK) {
+				pMainForm->appendMessagesColor(QString("%1(%2): %3")
+					.arg(sName).arg(cmd.iLine).arg(sCommand), "#996633");
+				pMainForm->appendMessagesClient("lscp_client_query");
+				++iErrors;
+			}
+			continue;
+		}
+	#endif
+		// Global settings are for later...
+		if (sVerb == "SET" && sWhat == "VOLUME" && args.count() > 2) {
+			m_sVolume = args.at(2);
+			continue;
+		}
+		// Where's the sampler channel index, if any?
+		int iArg = -1;
+		QString sInstrumentFile;
+		int iInstrumentNr = 0;
+		int iChannel = -1;
+		const bool bInstrument = Session::parseInstrumentLoad(
+			sCommand, sInstrumentFile, iInstrumentNr, iChannel);
+		if (!bInstrument) {
+			if ((sVerb == "SET" && (sWhat == "CHANNEL" || sWhat == "FX_SEND"))
+				|| (sVerb == "ADD" && sWhat == "CHANNEL")
+				|| (sVerb == "LOAD" && sWhat == "ENGINE"))
+				iArg = 3;
+			else
+			if (sVerb == "CREATE" && sWhat == "FX_SEND")
+				iArg = 2;
+			else {
+				// Devices and whatnot...
+				++iSkipped;
+				continue;
+			}
+			if (iArg < args.count())
+				iChannel = args.at(iArg).toInt();
+		}
+		if (!channels.contains(iChannel)) {
+			pMainForm->appendMessagesColor(QString("%1(%2): %3")
+				.arg(sName).arg(cmd.iLine).arg(sCommand), "#996633");
+			++iErrors;
+			continue;
+		}
+		Staged& staged = m_staged[channels.value(iChannel)];
+		const QString sChannelID = QString::number(staged.iChannelID);
+		QString sQuery;
+		if (bInstrument) {
+			// Always in background...
+			sQuery = "LOAD INSTRUMENT NON_MODAL '"
+				+ sCommand.section('\'', 1, 1) + "' "
+				+ QString::number(iInstrumentNr) + ' ' + sChannelID;
+			staged.bInstrument = true;
+		} else {
+			const QString& sKey = (args.count() > 2 ? args.at(2).toUpper() : QString());
+			// Mute and solo take effect on switch over only...
+			if (sVerb == "SET" && sWhat == "CHANNEL"
+				&& (sKey == "MUTE" || sKey == "SOLO") && args.count() > 4) {
+				if (sKey == "MUTE")
+					staged.bMute = (args.at(4).toInt() > 0);
+				else
+					staged.bSolo = (args.at(4).toInt() > 0);
+				continue;
+			}
+			args[iArg] = sChannelID;
+			bool bMapped = true;
+			if (sVerb == "SET" && sWhat == "CHANNEL") {
+				if (sKey == "AUDIO_OUTPUT_DEVICE")
+					bMapped = sessionStageMapArg(args, 4, audioDevices);
+				else
+				if (sKey == "MIDI_INPUT_DEVICE")
+					bMapped = sessionStageMapArg(args, 4, midiDevices);
+				else
+				if (sKey == "MIDI_INSTRUMENT_MAP")
+					bMapped = sessionStageMapArg(args, 4, m_maps);
+			}
+			else
+			if (sVerb == "ADD" && sWhat == "CHANNEL" && sKey == "MIDI_INPUT")
+				bMapped = sessionStageMapArg(args, 4, midiDevices);
+			if (!bMapped) {
+				pMainForm->appendMessagesColor(
+					tr("%1(%2): %3: no such device or map here.")
+					.arg(sName).arg(cmd.iLine).arg(sCommand), "#996633");
+				++iErrors;
+				continue;
+			}
+			sQuery = args.join(" ");
+		}
+		sQuery += "\r\n";
+		if (::lscp_client_query(pClient, sQuery.toUtf8().constData()) != LSCP_OK) {
+			pMainForm->appendMessagesColor(QString("%1(%2): %3")
+				.arg(sName).arg(cmd.iLine).arg(sCommand), "#996633");
+			pMainForm->appendMessagesClient("lscp_client_query");
+			++iErrors;
+		}
+	}
+
+	if (iSkipped > 0) {
+		pMainForm->appendMessagesColor(
+			tr("%1: %2 device commands skipped, "
+			"the current devices are kept.").arg(sName).arg(iSkipped), "#996633");
+	}
+
+	m_iReady = m_iFailed = m_iTotal = 0;
+	m_bReady = false;
+	m_pTimer->start();
+
+	return iErrors;
+}
+
+
+// Staged session file name.
+const QString& SessionStage::filename (void) const
+{
+	return m_sFilename;
+}
+
+
+// Whether a sampler channel is a staged one.
+bool SessionStage::isStaged ( int iChannelID ) const
+{
+	QListIterator<Staged> iter(m_staged);
+	while (iter.hasNext()) {
+		if (iter.next().iChannelID == iChannelID)
+			return true;
+	}
+
+	return false;
+}
+
+
+// Whether a MIDI instrument map is a staged one.
+bool SessionStage::isStagedMap ( int iMap ) const
+{
+	return (iMap >= 0 && m_maps.contains(iMap));
+}
+
+
+// Readiness, as of the last check.
+bool SessionStage::isReady (void) const
+{
+	return m_bReady;
+}
+
+int SessionStage::readyCount (void) const
+{
+	return m_iReady;
+}
+
+int SessionStage::failedCount (void) const
+{
+	return m_iFailed;
+}
+
+int SessionStage::totalCount (void) const
+{
+	return m_iTotal;
+}
+
+
+// Bring staged channels in and remove all others, in one batch.
+int SessionStage::commit (void)
+{
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL)
+		return 1;
+
+	lscp_client_t *pClient = pMainForm->client();
+	if (pClient == NULL)
+		return 1;
+
+	m_pTimer->stop();
+
+	int iErrors = 0;
+
+	// Take a copy, as the client result buffer gets reused...
+	const QList<int> current
+		= sessionStageIDs(::lscp_list_channels(pClient));
+
+	// New ones in first, so there's no gap at all...
+	QList<int> staged;
+	QListIterator<Staged> iter(m_staged);
+	while (iter.hasNext()) {
+		const Staged& item = iter.next();
+		staged.append(item.iChannelID);
+		if (item.bSolo
+			&& ::lscp_set_channel_solo(pClient, item.iChannelID, 1) != LSCP_OK)
+			++iErrors;
+		if (!item.bMute
+			&& ::lscp_set_channel_mute(pClient, item.iChannelID, 0) != LSCP_OK)
+			++iErrors;
+	}
+
+	// Old ones out, right after...
+	QListIterator<int> channel(current);
+	while (channel.hasNext()) {
+		const int iChannelID = channel.next();
+		if (!staged.contains(iChannelID)
+			&& ::lscp_remove_channel(pClient, iChannelID) != LSCP_OK)
+			++iErrors;
+	}
+
+#ifdef CONFIG_MIDI_INSTRUMENT
+	// Old maps out too, as they're all staged anew...
+	QListIterator<int> map(m_oldMaps);
+	while (map.hasNext()) {
+		if (::lscp_remove_midi_instrument_map(pClient, map.next()) != LSCP_OK)
+			++iErrors;
+	}
+#endif
+
+	if (!m_sVolume.isEmpty()) {
+		const QString& sQuery = "SET VOLUME " + m_sVolume + "\r\n";
+		if (::lscp_client_query(pClient, sQuery.toUtf8().constData()) != LSCP_OK)
+			++iErrors;
+	}
+
+	if (iErrors > 0)
+		pMainForm->appendMessagesClient("lscp_client_query");
+
+	m_staged.clear();
+	m_maps.clear();
+	m_oldMaps.clear();
+
+	return iErrors;
+}
+
+
+// Remove all staged channels and maps, leaving the current ones alone.
+void SessionStage::discard (void)
+{
+	m_pTimer->stop();
+
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm && pMainForm->client()) {
+		QListIterator<Staged> iter(m_staged);
+		while (iter.hasNext())
+			::lscp_remove_channel(pMainForm->client(), iter.next().iChannelID);
+	#ifdef CONFIG_MIDI_INSTRUMENT
+		QListIterator<int> map(m_maps);
+		while (map.hasNext()) {
+			const int iMap = map.next();
+			if (iMap >= 0)
+				::lscp_remove_midi_instrument_map(pMainForm->client(), iMap);
+		}
+	#endif
+	}
+
+	m_staged.clear();
+	m_maps.clear();
+	m_oldMaps.clear();
+}
+
+
+// Periodic readiness check.
+void SessionStage::timerSlot (void)
+{
+	MainForm *pMainForm = MainForm::getInstance();
+	if (pMainForm == NULL || pMainForm->client() == NULL)
+		return;
+
+	int iReady = 0;
+	int iFailed = 0;
+	int iTotal = 0;
+
+	QListIterator<Staged> iter(m_staged);
+	while (iter.hasNext()) {
+		const Staged& staged = iter.next();
+		if (!staged.bInstrument)
+			continue;
+		++iTotal;
+		lscp_channel_info_t *pChannelInfo
+			= ::lscp_get_channel_info(pMainForm->client(), staged.iChannelID);
+		if (pChannelInfo == NULL || pChannelInfo->instrument_status < 0)
+			++iFailed;
+		else
+		if (pChannelInfo->instrument_status >= 100)
+			++iReady;
+	}
+
+	m_iReady  = iReady;
+	m_iFailed = iFailed;
+	m_iTotal  = iTotal;
+
+	if (iReady + iFailed >= iTotal) {
+		m_pTimer->stop();
+		m_bReady = true;
+		emit stageReady();
+	}
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerSessionStage.cpp
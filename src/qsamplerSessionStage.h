@@ -0,0 +1,126 @@
+// qsamplerSessionStage.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerSessionStage_h
+#define __qsamplerSessionStage_h
+
+#include <QObject>
+#include <QStringList>
+#include <QList>
+
+class QTimer;
+
+
+namespace QSampler {
+
+class Session;
+
+
+//-------------------------------------------------------------------------
+// QSampler::SessionStage - next session preloader (muted channels).
+//
+
+class SessionStage : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	// Constructor.
+	SessionStage(QObject *pParent = NULL);
+
+	// Destructor.
+	~SessionStage();
+
+	// Stage all sampler channels of a prepared session,
+	// muted, next to the current ones; returns errors.
+	int stage(const Session& session);
+
+	// Staged session file name.
+	const QString& filename() const;
+
+	// Whether a sampler channel is a staged one.
+	bool isStaged(int iChannelID) const;
+
+	// Whether a MIDI instrument map is a staged one.
+	bool isStagedMap(int iMap) const;
+
+	// Readiness, as of the last check.
+	bool isReady() const;
+	int  readyCount() const;
+	int  failedCount() const;
+	int  totalCount() const;
+
+	// Bring staged channels in and remove all others, in one batch.
+	int commit();
+
+	// Remove all staged channels and maps, leaving the current ones alone.
+	void discard();
+
+signals:
+
+	// All staged instruments are done loading.
+	void stageReady();
+
+protected slots:
+
+	// Periodic readiness check.
+	void timerSlot();
+
+private:
+
+	// One staged sampler channel.
+	struct Staged
+	{
+		int  iChannelID;
+		bool bMute;
+		bool bSolo;
+		bool bInstrument;
+	};
+
+	// Instance variables.
+	QString m_sFilename;
+
+	QList<Staged> m_staged;
+
+	// Staged MIDI instrument maps (by session index),
+	// and the current ones to go away on commit.
+	QList<int> m_maps;
+	QList<int> m_oldMaps;
+
+	QString m_sVolume;
+
+	int m_iReady;
+	int m_iFailed;
+	int m_iTotal;
+
+	bool m_bReady;
+
+	QTimer *m_pTimer;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerSessionStage_h
+
+
+// end of qsamplerSessionStage.h
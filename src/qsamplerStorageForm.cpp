@@ -0,0 +1,421 @@
+// qsamplerStorageForm.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerStorageForm.h"
+
+#include <QHeaderView>
+#include <QSettings>
+#include <QFileInfo>
+#include <QFile>
+#include <QTextStream>
+#include <QTimer>
+#include <QMap>
+
+#include <QShowEvent>
+
+#if defined(__linux__)
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#endif
+
+
+namespace QSampler {
+
+// View refresh period (msecs).
+#define QSAMPLER_STORAGE_PERIOD_MSECS  2000
+
+// Stream buffer fill low-water mark (percent).
+#define QSAMPLER_STORAGE_LOW_BUFFER    25
+
+// Minimum samples for a storage kind to be compared against.
+#define QSAMPLER_STORAGE_MIN_SAMPLES   100
+
+// Assumed solid-state to rotational low-buffer ratio,
+// whenever there's no local evidence of our own.
+#define QSAMPLER_STORAGE_SOLID_FACTOR  0.1
+
+// Maximum number of instrument files to remember.
+#define QSAMPLER_STORAGE_HISTORY_MAX   500
+
+
+//-------------------------------------------------------------------------
+// QSampler::StorageForm -- disk streaming storage advisor form.
+//
+
+// Constructor.
+StorageForm::StorageForm ( QWidget *pParent, Qt::WindowFlags wflags )
+	: QWidget(pParent, wflags), m_bDirty(false)
+{
+	m_ui.setupUi(this);
+
+	m_ui.StatsListView->header()->resizeSection(0, 200);
+	m_ui.StatsListView->header()->resizeSection(2, 160);
+	m_ui.StatsListView->sortByColumn(6, Qt::DescendingOrder);
+
+	m_pTimer = new QTimer(this);
+
+	QObject::connect(m_pTimer,
+		SIGNAL(timeout()),
+		SLOT(refreshStats()));
+	QObject::connect(m_ui.ClearPushButton,
+		SIGNAL(clicked()),
+		SLOT(clearStats()));
+
+	m_pTimer->start(QSAMPLER_STORAGE_PERIOD_MSECS);
+}
+
+
+// Destructor.
+StorageForm::~StorageForm (void)
+{
+	m_stats.clear();
+	m_devices.clear();
+	m_files.clear();
+}
+
+
+// Account for one channel usage sample.
+void StorageForm::usageArrived ( const QString& sInstrumentFile,
+	int iStreamCount, int iStreamUsage )
+{
+	// Only actual disk streaming matters...
+	if (sInstrumentFile.isEmpty() || iStreamCount < 1 || iStreamUsage < 0)
+		return;
+
+	QHash<QString, Stats>::Iterator iter = m_stats.find(sInstrumentFile);
+	if (iter == m_stats.end()) {
+		Stats stats;
+		stats.iSamples = 0;
+		stats.iStreamSum = 0;
+		stats.iPeakStreams = 0;
+		stats.iLowBuffer = 0;
+		stats.iMinFill = 100;
+		iter = m_stats.insert(sInstrumentFile, stats);
+	}
+
+	Stats& stats = iter.value();
+	++stats.iSamples;
+	stats.iStreamSum += iStreamCount;
+	if (stats.iPeakStreams < iStreamCount)
+		stats.iPeakStreams = iStreamCount;
+	if (iStreamUsage < QSAMPLER_STORAGE_LOW_BUFFER)
+		++stats.iLowBuffer;
+	if (stats.iMinFill > iStreamUsage)
+		stats.iMinFill = iStreamUsage;
+
+	m_bDirty = true;
+}
+
+
+// Load history from settings.
+void StorageForm::loadHistory ( QSettings& settings )
+{
+	m_stats.clear();
+
+	settings.beginGroup("/StorageHistory");
+	const int iCount = settings.beginReadArray("/Instruments");
+	for (int i = 0; i < iCount; ++i) {
+		settings.setArrayIndex(i);
+		const QString& sInstrumentFile = settings.value("/File").toString();
+		Stats stats;
+		stats.iSamples = settings.value("/Samples", 0).toInt();
+		stats.iStreamSum = settings.value("/StreamSum", 0).toLongLong();
+		stats.iPeakStreams = settings.value("/PeakStreams", 0).toInt();
+		stats.iLowBuffer = settings.value("/LowBuffer", 0).toInt();
+		stats.iMinFill = settings.value("/MinFill", 100).toInt();
+		if (!sInstrumentFile.isEmpty() && stats.iSamples > 0)
+			m_stats.insert(sInstrumentFile, stats);
+	}
+	settings.endArray();
+	settings.endGroup();
+
+	m_bDirty = true;
+}
+
+
+// Save history into settings (busiest ones only).
+void StorageForm::saveHistory ( QSettings& settings ) const
+{
+	QMultiMap<int, QString> files;
+	QHash<QString, Stats>::ConstIterator iter = m_stats.constBegin();
+	for ( ; iter != m_stats.constEnd(); ++iter)
+		files.insert(iter.value().iSamples, iter.key());
+	while (files.count() > QSAMPLER_STORAGE_HISTORY_MAX)
+		files.erase(files.begin());
+
+	settings.beginGroup("/StorageHistory");
+	settings.remove("/Instruments");
+	settings.beginWriteArray("/Instruments", files.count());
+	int i = 0;
+	QMapIterator<int, QString> iter2(files);
+	while (iter2.hasNext()) {
+		const QString& sInstrumentFile = iter2.next().value();
+		const Stats& stats = m_stats[sInstrumentFile];
+		settings.setArrayIndex(i++);
+		settings.setValue("/File", sInstrumentFile);
+		settings.setValue("/Samples", stats.iSamples);
+		settings.setValue("/StreamSum", stats.iStreamSum);
+		settings.setValue("/PeakStreams", stats.iPeakStreams);
+		settings.setValue("/LowBuffer", stats.iLowBuffer);
+		settings.setValue("/MinFill", stats.iMinFill);
+	}
+	settings.endArray();
+	settings.endGroup();
+}
+
+
+// Reset all streaming statistics.
+void StorageForm::clearStats (void)
+{
+	m_stats.clear();
+	m_ui.StatsListView->clear();
+	m_ui.SummaryTextLabel->clear();
+
+	m_bDirty = false;
+}
+
+
+// Periodic view refreshment.
+void StorageForm::refreshStats (void)
+{
+	if (!m_bDirty || !isVisible())
+		return;
+
+	m_bDirty = false;
+
+	// Low-buffer ratios of each storage kind, first...
+	qint64 aiSamples[Network + 1];
+	qint64 aiLowBuffer[Network + 1];
+	for (int i = 0; i <= Network; ++i)
+		aiSamples[i] = aiLowBuffer[i] = 0;
+
+	QHash<QString, Stats>::ConstIterator iter = m_stats.constBegin();
+	for ( ; iter != m_stats.constEnd(); ++iter) {
+		const Device& dev = device(iter.key());
+		aiSamples[dev.kind]   += iter.value().iSamples;
+		aiLowBuffer[dev.kind] += iter.value().iLowBuffer;
+	}
+
+	// Locally observed solid-state advantage, if any...
+	double fFactor = QSAMPLER_STORAGE_SOLID_FACTOR;
+	bool bObserved = false;
+	if (aiSamples[Solid] >= QSAMPLER_STORAGE_MIN_SAMPLES
+		&& aiSamples[Rotational] >= QSAMPLER_STORAGE_MIN_SAMPLES
+		&& aiLowBuffer[Rotational] > 0) {
+		const double fSolid
+			= double(aiLowBuffer[Solid]) / double(aiSamples[Solid]);
+		const double fRotational
+			= double(aiLowBuffer[Rotational]) / double(aiSamples[Rotational]);
+		fFactor = qMin(1.0, fSolid / fRotational);
+		bObserved = true;
+	}
+
+	m_ui.StatsListView->setUpdatesEnabled(false);
+	m_ui.StatsListView->setSortingEnabled(false);
+	m_ui.StatsListView->clear();
+
+	qint64 iLowBufferTotal = 0;
+	qint64 iLowBufferMoved = 0;
+	qint64 iSizeMoved = 0;
+	int iFilesMoved = 0;
+
+	for (iter = m_stats.constBegin(); iter != m_stats.constEnd(); ++iter) {
+		const QString& sInstrumentFile = iter.key();
+		const Stats& stats = iter.value();
+		const Device& dev = device(sInstrumentFile);
+		const QFileInfo fi(sInstrumentFile);
+		const double fLowBuffer
+			= (100.0 * stats.iLowBuffer) / qMax(stats.iSamples, 1);
+		iLowBufferTotal += stats.iLowBuffer;
+		QTreeWidgetItem *pItem = new QTreeWidgetItem(m_ui.StatsListView);
+		pItem->setText(0, fi.fileName());
+		pItem->setToolTip(0, sInstrumentFile);
+		pItem->setData(1, Qt::DisplayRole, int(fi.size() >> 20));
+		pItem->setText(2, kindName(dev.kind) + " (" + dev.sMount + ')');
+		pItem->setToolTip(2, dev.sSource + ' ' + dev.sType);
+		pItem->setData(3, Qt::DisplayRole, stats.iSamples);
+		pItem->setData(4, Qt::DisplayRole,
+			int(stats.iStreamSum / qMax(stats.iSamples, 1)));
+		pItem->setData(5, Qt::DisplayRole, stats.iPeakStreams);
+		pItem->setData(6, Qt::DisplayRole, qRound(fLowBuffer * 10.0) / 10.0);
+		pItem->setData(7, Qt::DisplayRole, stats.iMinFill);
+		for (int i = 1; i < 8; ++i)
+			pItem->setTextAlignment(i, Qt::AlignRight);
+		// Any advice?
+		if (dev.kind == Rotational && stats.iLowBuffer > 0) {
+			pItem->setText(8, tr("Move to solid-state (-%1% low buffer)")
+				.arg(QString::number(fLowBuffer * (1.0 - fFactor), 'f', 1)));
+			iLowBufferMoved += stats.iLowBuffer;
+			iSizeMoved += fi.size();
+			++iFilesMoved;
+		}
+	}
+
+	m_ui.StatsListView->setSortingEnabled(true);
+	m_ui.StatsListView->setUpdatesEnabled(true);
+
+	// Overall summary...
+	QString sSummary;
+	if (iFilesMoved > 0 && iLowBufferTotal > 0) {
+		const double fReduction = (100.0 * iLowBufferMoved * (1.0 - fFactor))
+			/ double(iLowBufferTotal);
+		sSummary = tr("Moving %1 instrument file(s) (%2 MB) off rotational "
+			"storage is expected to cut low buffer occurrences by %3%")
+			.arg(iFilesMoved).arg(iSizeMoved >> 20)
+			.arg(QString::number(fReduction, 'f', 1));
+		if (bObserved)
+			sSummary += ' ' + tr("(as observed on this system).");
+		else
+			sSummary += ' ' + tr("(assumed; no solid-state streaming seen yet).");
+	}
+	else if (!m_stats.isEmpty()) {
+		sSummary = tr("No instrument file on rotational storage "
+			"has run low on stream buffers.");
+	}
+
+	m_ui.SummaryTextLabel->setText(sSummary);
+}
+
+
+// Refresh right away, whenever shown.
+void StorageForm::showEvent ( QShowEvent *pShowEvent )
+{
+	QWidget::showEvent(pShowEvent);
+
+	m_bDirty = true;
+	refreshStats();
+}
+
+
+// Resolve the storage device of a given file.
+const StorageForm::Device& StorageForm::device ( const QString& sPath )
+{
+	QString sDevNo = m_files.value(sPath);
+	if (!sDevNo.isEmpty())
+		return m_devices[sDevNo];
+
+	Device dev;
+	dev.kind = Unknown;
+
+#if defined(__linux__)
+	struct stat st;
+	if (::stat(QFile::encodeName(sPath).constData(), &st) == 0) {
+		const uint iMajor = major(st.st_dev);
+		const uint iMinor = minor(st.st_dev);
+		sDevNo = QString("%1:%2").arg(iMajor).arg(iMinor);
+		if (m_devices.contains(sDevNo)) {
+			m_files.insert(sPath, sDevNo);
+			return m_devices[sDevNo];
+		}
+		// Mount point and file system type...
+		QFile mountinfo("/proc/self/mountinfo");
+		if (mountinfo.open(QIODevice::ReadOnly)) {
+			QTextStream ts(&mountinfo);
+			while (!ts.atEnd()) {
+				const QStringList& fields
+					= ts.readLine().split(' ', QString::SkipEmptyParts);
+				if (fields.count() < 10 || fields.at(2) != sDevNo)
+					continue;
+				const int iSep = fields.indexOf("-");
+				if (iSep < 0 || iSep + 2 >= fields.count())
+					continue;
+				dev.sMount  = fields.at(4);
+				dev.sType   = fields.at(iSep + 1);
+				dev.sSource = fields.at(iSep + 2);
+			}
+			mountinfo.close();
+		}
+		// Network file systems go by their own type...
+		static const char *s_apszNetworkTypes[] = {
+			"nfs", "nfs4", "cifs", "smb", "smb3", "smbfs", "sshfs",
+			"fuse.sshfs", "9p", "ceph", "fuse.ceph", "glusterfs",
+			"fuse.glusterfs", "afs", "ncpfs", "lustre", "davfs",
+			"fuse.davfs2", "fuse.rclone", NULL
+		};
+		for (int i = 0; s_apszNetworkTypes[i]; ++i) {
+			if (dev.sType == s_apszNetworkTypes[i]) {
+				dev.kind = Network;
+				break;
+			}
+		}
+		// Backing block device: the mount source, if it's one
+		// (eg. btrfs, lvm, md); or else, the file's own device...
+		QString sBlockDevNo;
+		struct stat st2;
+		if (dev.sSource.startsWith('/')
+			&& ::stat(QFile::encodeName(dev.sSource).constData(), &st2) == 0
+			&& S_ISBLK(st2.st_mode)) {
+			sBlockDevNo = QString("%1:%2")
+				.arg(major(st2.st_rdev)).arg(minor(st2.st_rdev));
+		}
+		else if (iMajor > 0)
+			sBlockDevNo = sDevNo;
+		// Block device rotational attribute (whole disk, if partition)...
+		if (dev.kind == Unknown && !sBlockDevNo.isEmpty()) {
+			QString sSysDev = QFileInfo("/sys/dev/block/" + sBlockDevNo)
+				.canonicalFilePath();
+			if (QFileInfo(sSysDev + "/partition").exists())
+				sSysDev = QFileInfo(sSysDev).path();
+			QFile rotational(sSysDev + "/queue/rotational");
+			if (rotational.open(QIODevice::ReadOnly)) {
+				const int iRotational
+					= QString(rotational.readAll()).trimmed().toInt();
+				dev.kind = (iRotational > 0 ? Rotational : Solid);
+				rotational.close();
+			}
+		}
+	}
+#endif
+
+	if (sDevNo.isEmpty())
+		sDevNo = "?";
+	if (dev.sMount.isEmpty())
+		dev.sMount = QFileInfo(sPath).path();
+
+	m_files.insert(sPath, sDevNo);
+	if (!m_devices.contains(sDevNo))
+		m_devices.insert(sDevNo, dev);
+
+	return m_devices[sDevNo];
+}
+
+
+// Storage device kind name.
+QString StorageForm::kindName ( DeviceKind kind )
+{
+	switch (kind) {
+	case Solid:
+		return tr("Solid-state");
+	case Rotational:
+		return tr("Rotational");
+	case Network:
+		return tr("Network");
+	default:
+		return tr("Unknown");
+	}
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerStorageForm.cpp
@@ -0,0 +1,121 @@
+// qsamplerStorageForm.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerStorageForm_h
+#define __qsamplerStorageForm_h
+
+#include "ui_qsamplerStorageForm.h"
+
+#include <QHash>
+
+class QTimer;
+class QSettings;
+
+
+namespace QSampler {
+
+//-------------------------------------------------------------------------
+// QSampler::StorageForm -- disk streaming storage advisor form.
+//
+
+class StorageForm : public QWidget
+{
+	Q_OBJECT
+
+public:
+
+	// Constructor.
+	StorageForm(QWidget *pParent = NULL, Qt::WindowFlags wflags = 0);
+
+	// Destructor.
+	~StorageForm();
+
+	// Account for one channel usage sample.
+	void usageArrived(const QString& sInstrumentFile,
+		int iStreamCount, int iStreamUsage);
+
+	// Persistence (as found on settings).
+	void loadHistory(QSettings& settings);
+	void saveHistory(QSettings& settings) const;
+
+	// Storage device kinds.
+	enum DeviceKind { Unknown = 0, Solid, Rotational, Network };
+
+public slots:
+
+	// Reset all streaming statistics.
+	void clearStats();
+
+protected slots:
+
+	// Periodic view refreshment.
+	void refreshStats();
+
+protected:
+
+	void showEvent(QShowEvent *pShowEvent);
+
+	// Per-instrument file streaming statistics.
+	struct Stats
+	{
+		int    iSamples;
+		qint64 iStreamSum;
+		int    iPeakStreams;
+		int    iLowBuffer;      // Samples under the low-water mark.
+		int    iMinFill;
+	};
+
+	// Storage device of a file.
+	struct Device
+	{
+		QString    sMount;
+		QString    sSource;
+		QString    sType;
+		DeviceKind kind;
+	};
+
+	// Resolve the storage device of a given file.
+	const Device& device(const QString& sPath);
+
+	// Storage device kind name.
+	static QString kindName(DeviceKind kind);
+
+private:
+
+	// Instance variables.
+	QHash<QString, Stats>  m_stats;
+	QHash<QString, Device> m_devices;  // Keyed by device number.
+	QHash<QString, QString> m_files;   // File to device number.
+
+	Ui::qsamplerStorageForm m_ui;
+
+	bool m_bDirty;
+
+	QTimer *m_pTimer;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerStorageForm_h
+
+
+// end of qsamplerStorageForm.h
@@ -0,0 +1,301 @@
+// qsamplerSwitchesForm.cpp
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "qsamplerAbout.h"
+#include "qsamplerSwitchesForm.h"
+
+#include "qsamplerChannel.h"
+#include "qsamplerMapIndex.h"
+
+#include <QHeaderView>
+#include <QFileInfo>
+#include <QTime>
+
+
+namespace QSampler {
+
+// Latency history length, per mapping.
+#define QSAMPLER_SWITCHES_HISTORY   100
+
+// Slowest switches list capacity.
+#define QSAMPLER_SWITCHES_SLOWEST   20
+
+
+//-------------------------------------------------------------------------
+// QSampler::SwitchesForm -- instrument switch latency form.
+//
+
+// Constructor.
+SwitchesForm::SwitchesForm ( QWidget *pParent, Qt::WindowFlags wflags )
+	: QWidget(pParent, wflags)
+{
+	m_ui.setupUi(this);
+
+	m_ui.StatsListView->header()->resizeSection(0, 160);
+	m_ui.StatsListView->header()->resizeSection(1, 160);
+	m_ui.StatsListView->sortByColumn(6, Qt::DescendingOrder);
+	m_ui.SlowestListView->header()->resizeSection(0, 100);
+	m_ui.SlowestListView->header()->resizeSection(2, 120);
+	m_ui.SlowestListView->header()->resizeSection(3, 200);
+
+	QObject::connect(m_ui.ClearPushButton,
+		SIGNAL(clicked()),
+		SLOT(clearSwitches()));
+}
+
+
+// Destructor.
+SwitchesForm::~SwitchesForm (void)
+{
+	m_stats.clear();
+	m_states.clear();
+}
+
+
+// A channel info event has arrived; the earliest one
+// of a burst is taken as the start of a possible switch.
+void SwitchesForm::channelInfoArrived ( int iChannelID, qint64 iStamp )
+{
+	QHash<int, State>::Iterator iter = m_states.find(iChannelID);
+	if (iter == m_states.end())
+		return;
+
+	State& state = iter.value();
+	if (state.iInfoStamp == 0)
+		state.iInfoStamp = iStamp;
+}
+
+
+// A channel state has been refreshed (eg. on timer slot).
+void SwitchesForm::channelUpdated ( Channel *pChannel, qint64 iStamp )
+{
+	if (pChannel == NULL)
+		return;
+
+	const int iChannelID = pChannel->channelID();
+	const int iInstrumentStatus = pChannel->instrumentStatus();
+
+	QHash<int, State>::Iterator iter = m_states.find(iChannelID);
+	if (iter == m_states.end()) {
+		// First sight (eg. session load): no switch whatsoever.
+		State state;
+		state.sInstrumentFile = pChannel->instrumentFile();
+		state.iInstrumentNr   = pChannel->instrumentNr();
+		state.iInfoStamp = 0;
+		state.iStart = 0;
+		m_states.insert(iChannelID, state);
+		return;
+	}
+
+	State& state = iter.value();
+
+	// Failed loads are no switches either...
+	if (iInstrumentStatus < 0) {
+		state.sInstrumentFile = pChannel->instrumentFile();
+		state.iInstrumentNr   = pChannel->instrumentNr();
+		state.iInfoStamp = 0;
+		state.iStart = 0;
+		return;
+	}
+
+	// Has a new switch just started?
+	if (state.iStart == 0
+		&& (state.sInstrumentFile != pChannel->instrumentFile()
+			|| state.iInstrumentNr != pChannel->instrumentNr()
+			|| iInstrumentStatus < 100)) {
+		state.iStart = (state.iInfoStamp > 0 ? state.iInfoStamp : iStamp);
+	}
+
+	state.sInstrumentFile = pChannel->instrumentFile();
+	state.iInstrumentNr   = pChannel->instrumentNr();
+
+	// Is it ready now?
+	if (state.iStart > 0 && iInstrumentStatus == 100) {
+		switchCompleted(pChannel, int(iStamp - state.iStart));
+		state.iStart = 0;
+	}
+
+	if (state.iStart == 0)
+		state.iInfoStamp = 0;
+}
+
+
+// Forget all current channel states (eg. on client shutdown).
+void SwitchesForm::resetChannels (void)
+{
+	m_states.clear();
+}
+
+
+// Reset all switch statistics.
+void SwitchesForm::clearSwitches (void)
+{
+	m_stats.clear();
+	m_ui.StatsListView->clear();
+	m_ui.SlowestListView->clear();
+}
+
+
+// Record one completed switch.
+void SwitchesForm::switchCompleted ( Channel *pChannel, int iLatency )
+{
+	const QString& sInstrumentFile = pChannel->instrumentFile();
+	const int iInstrumentNr = pChannel->instrumentNr();
+	if (sInstrumentFile.isEmpty())
+		return;
+
+	// Keyed by mapping; plain instrument loads are keyed by instrument...
+	QString sKey, sMapping;
+	Instrument instrument;
+	if (channelMapping(pChannel, instrument)) {
+		sKey = QString("%1/%2/%3")
+			.arg(instrument.map())
+			.arg(instrument.bank())
+			.arg(instrument.prog() + 1);
+		QString sLoadMode;
+		switch (instrument.loadMode()) {
+		case 3:
+			sLoadMode = tr("Persistent");
+			break;
+		case 2:
+			sLoadMode = tr("On Demand Hold");
+			break;
+		case 1:
+		default:
+			sLoadMode = tr("On Demand");
+			break;
+		}
+		sMapping = sKey + ' ' + sLoadMode;
+	}
+	else sKey = sInstrumentFile + '#' + QString::number(iInstrumentNr);
+
+	QHash<QString, Stats>::Iterator iter = m_stats.find(sKey);
+	if (iter == m_stats.end()) {
+		Stats stats;
+		stats.pItem = NULL;
+		stats.sMapping = sMapping;
+		stats.sInstrumentName = pChannel->instrumentName();
+		stats.sInstrumentFile = sInstrumentFile;
+		stats.iInstrumentNr   = iInstrumentNr;
+		stats.iCount = 0;
+		stats.iMin = iLatency;
+		stats.iMax = iLatency;
+		stats.iSum = 0;
+		iter = m_stats.insert(sKey, stats);
+	}
+
+	Stats& stats = iter.value();
+	stats.latencies.append(iLatency);
+	while (stats.latencies.count() > QSAMPLER_SWITCHES_HISTORY)
+		stats.latencies.removeFirst();
+	++stats.iCount;
+	if (stats.iMin > iLatency)
+		stats.iMin = iLatency;
+	if (stats.iMax < iLatency)
+		stats.iMax = iLatency;
+	stats.iSum += iLatency;
+
+	refreshStats(stats);
+
+	// Slowest switches list (kept sorted, slowest first)...
+	int iIndex = 0;
+	QTreeWidget *pSlowestView = m_ui.SlowestListView;
+	const int iCount = pSlowestView->topLevelItemCount();
+	while (iIndex < iCount && pSlowestView->topLevelItem(iIndex)
+			->data(4, Qt::DisplayRole).toInt() >= iLatency)
+		++iIndex;
+	if (iIndex < QSAMPLER_SWITCHES_SLOWEST) {
+		QTreeWidgetItem *pItem = new QTreeWidgetItem();
+		pItem->setText(0, QTime::currentTime().toString("hh:mm:ss.zzz"));
+		pItem->setText(1, QString::number(pChannel->channelID()));
+		pItem->setText(2, stats.sMapping);
+		pItem->setText(3, stats.sInstrumentName);
+		pItem->setData(4, Qt::DisplayRole, iLatency);
+		pItem->setTextAlignment(4, Qt::AlignRight);
+		pSlowestView->insertTopLevelItem(iIndex, pItem);
+		while (pSlowestView->topLevelItemCount() > QSAMPLER_SWITCHES_SLOWEST)
+			delete pSlowestView->takeTopLevelItem(QSAMPLER_SWITCHES_SLOWEST);
+	}
+}
+
+
+// Find out the MIDI instrument mapping a channel has switched to,
+// as found on the channel's own map (or any, if none) in the map
+// index cache; no server round trips whatsoever in here.
+bool SwitchesForm::channelMapping (
+	Channel *pChannel, Instrument& instrument ) const
+{
+	MapIndex *pMapIndex = MapIndex::getInstance();
+	if (pMapIndex == NULL)
+		return false;
+
+	const int iMidiMap = pChannel->midiMap();
+	const QList<Instrument>& instruments
+		= pMapIndex->instruments(pChannel->instrumentFile());
+	QListIterator<Instrument> iter(instruments);
+	while (iter.hasNext()) {
+		const Instrument& instr = iter.next();
+		if (instr.instrumentNr() != pChannel->instrumentNr())
+			continue;
+		if (iMidiMap >= 0 && instr.map() != iMidiMap)
+			continue;
+		instrument = instr;
+		return true;
+	}
+
+	return false;
+}
+
+
+// Per-mapping statistics view refresher.
+void SwitchesForm::refreshStats ( Stats& stats )
+{
+	m_ui.StatsListView->setSortingEnabled(false);
+
+	if (stats.pItem == NULL) {
+		stats.pItem = new QTreeWidgetItem(m_ui.StatsListView);
+		stats.pItem->setText(0, stats.sMapping);
+		stats.pItem->setText(1, stats.sInstrumentName);
+		stats.pItem->setText(7, QFileInfo(stats.sInstrumentFile).fileName()
+			+ " [" + QString::number(stats.iInstrumentNr) + "]");
+		stats.pItem->setToolTip(7, stats.sInstrumentFile);
+		for (int i = 2; i < 7; ++i)
+			stats.pItem->setTextAlignment(i, Qt::AlignRight);
+	}
+
+	QList<int> latencies = stats.latencies;
+	qSort(latencies);
+	const int iP90 = latencies.at((latencies.count() * 9) / 10
+		- ((latencies.count() * 9) % 10 == 0 ? 1 : 0));
+
+	stats.pItem->setData(2, Qt::DisplayRole, stats.iCount);
+	stats.pItem->setData(3, Qt::DisplayRole, stats.iMin);
+	stats.pItem->setData(4, Qt::DisplayRole, int(stats.iSum / stats.iCount));
+	stats.pItem->setData(5, Qt::DisplayRole, iP90);
+	stats.pItem->setData(6, Qt::DisplayRole, stats.iMax);
+
+	m_ui.StatsListView->setSortingEnabled(true);
+}
+
+} // namespace QSampler
+
+
+// end of qsamplerSwitchesForm.cpp
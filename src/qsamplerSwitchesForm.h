@@ -0,0 +1,119 @@
+// qsamplerSwitchesForm.h
+//
+/****************************************************************************
+   Copyright (C) 2004-2016, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __qsamplerSwitchesForm_h
+#define __qsamplerSwitchesForm_h
+
+#include "ui_qsamplerSwitchesForm.h"
+
+#include <QHash>
+#include <QList>
+
+class QTreeWidgetItem;
+
+
+namespace QSampler {
+
+class Channel;
+class Instrument;
+
+
+//-------------------------------------------------------------------------
+// QSampler::SwitchesForm -- instrument switch latency form.
+//
+
+class SwitchesForm : public QWidget
+{
+	Q_OBJECT
+
+public:
+
+	// Constructor.
+	SwitchesForm(QWidget *pParent = NULL, Qt::WindowFlags wflags = 0);
+
+	// Destructor.
+	~SwitchesForm();
+
+	// A channel info event has arrived (stamped on callback arrival).
+	void channelInfoArrived(int iChannelID, qint64 iStamp);
+
+	// A channel state has been refreshed (eg. on timer slot).
+	void channelUpdated(Channel *pChannel, qint64 iStamp);
+
+	// Forget all current channel states (eg. on client shutdown).
+	void resetChannels();
+
+public slots:
+
+	// Reset all switch statistics.
+	void clearSwitches();
+
+protected:
+
+	// Per-mapping switch statistics.
+	struct Stats
+	{
+		QTreeWidgetItem *pItem;
+		QString    sMapping;    // Map/bank/prog and load mode.
+		QString    sInstrumentName;
+		QString    sInstrumentFile;
+		int        iInstrumentNr;
+		QList<int> latencies;   // Recent latencies (msecs).
+		int        iCount;
+		int        iMin;
+		int        iMax;
+		qint64     iSum;
+	};
+
+	// Record one completed switch.
+	void switchCompleted(Channel *pChannel, int iLatency);
+
+	// Find out the MIDI instrument mapping a channel has switched to.
+	bool channelMapping(Channel *pChannel, Instrument& instrument) const;
+
+	// View refreshers.
+	void refreshStats(Stats& stats);
+
+private:
+
+	// Per-channel tracking state.
+	struct State
+	{
+		QString sInstrumentFile;
+		int     iInstrumentNr;
+		qint64  iInfoStamp;     // Earliest pending info event.
+		qint64  iStart;         // Pending switch start (or zero).
+	};
+
+	// Instance variables.
+	Ui::qsamplerSwitchesForm m_ui;
+
+	QHash<int, State>     m_states;
+	QHash<QString, Stats> m_stats;
+};
+
+} // namespace QSampler
+
+
+#endif  // __qsamplerSwitchesForm_h
+
+
+// end of qsamplerSwitchesForm.h
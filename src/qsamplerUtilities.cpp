@@ -67,17 +67,28 @@ static int _hexsToNumber(char hex_digit0, char hex_digit1) {
     return _hexToNumber(hex_digit1)*16 + _hexToNumber(hex_digit0);
 }
 
-// returns true if the connected LSCP server supports escape sequences
-static bool _remoteSupportsEscapeSequences() {
-    const lscpVersion_t version = getRemoteLscpVersion();
+// returns true if the given LSCP server version supports escape sequences
+static bool _supportsEscapeSequences(const lscpVersion_t& version) {
     // LSCP v1.2 or younger required
     return (version.major > 1 || (version.major == 1 && version.minor >= 2));
 }
 
+// returns true if the connected LSCP server supports escape sequences
+static bool _remoteSupportsEscapeSequences() {
+    return _supportsEscapeSequences(getRemoteLscpVersion());
+}
+
 // converts the given file path into a path as expected by LSCP 1.2
 QString lscpEscapePath ( const QString& sPath )
 {
-    if (!_remoteSupportsEscapeSequences()) return sPath;
+    return lscpEscapePath(sPath, getRemoteLscpVersion());
+}
+
+// same as above, for an already known server version
+// (no main client involved, so it may be called from any thread)
+QString lscpEscapePath ( const QString& sPath, const lscpVersion_t& version )
+{
+    if (!_supportsEscapeSequences(version)) return sPath;
 
     QString path(sPath);
 
@@ -130,7 +141,13 @@ QString lscpEscapePath ( const QString& sPath )
 // converts a path returned by a LSCP command (and may contain escape
 // sequences) into the appropriate POSIX path
 QString lscpEscapedPathToPosix(QString path) {
-    if (!_remoteSupportsEscapeSequences()) return path;
+    return lscpEscapedPathToPosix(path, getRemoteLscpVersion());
+}
+
+// same as above, for an already known server version
+// (no main client involved, so it may be called from any thread)
+QString lscpEscapedPathToPosix(QString path, const lscpVersion_t& version) {
+    if (!_supportsEscapeSequences(version)) return path;
 
     // first escape all percent ('%') characters for POSIX
     for (int i = path.indexOf('%'); i >= 0; i = path.indexOf('%', i+2))
@@ -185,7 +202,13 @@ QString lscpEscapeText(const QString& txt) {
 // converts a text returned by a LSCP command and may contain escape
 // sequences) into raw text, that is with all escape sequences decoded
 QString lscpEscapedTextToRaw(QString txt) {
-    if (!_remoteSupportsEscapeSequences()) return txt;
+    return lscpEscapedTextToRaw(txt, getRemoteLscpVersion());
+}
+
+// same as above, for an already known server version
+// (no main client involved, so it may be called from any thread)
+QString lscpEscapedTextToRaw(QString txt, const lscpVersion_t& version) {
+    if (!_supportsEscapeSequences(version)) return txt;
 
     // resolve LSCP hex escape sequences (\xHH)
     QRegExp regexp(QRegExp::escape("\\x") + "[0-9a-fA-F][0-9a-fA-F]");
@@ -201,16 +224,22 @@ QString lscpEscapedTextToRaw(QString txt) {
 
 lscpVersion_t getRemoteLscpVersion (void)
 {
-    lscpVersion_t result = { 0, 0 };
-
     MainForm* pMainForm = MainForm::getInstance();
-    if (pMainForm == NULL)
-        return result;
-    if (pMainForm->client() == NULL)
+    if (pMainForm == NULL || pMainForm->client() == NULL) {
+        const lscpVersion_t result = { 0, 0 };
         return result;
+    }
+
+    return getRemoteLscpVersion(pMainForm->client());
+}
+
+// the LSCP server version as seen from any given client connection
+lscpVersion_t getRemoteLscpVersion ( lscp_client_t *pClient )
+{
+    lscpVersion_t result = { 0, 0 };
 
     lscp_server_info_t* pServerInfo =
-        ::lscp_get_server_info(pMainForm->client());
+        ::lscp_get_server_info(pClient);
     if (pServerInfo && pServerInfo->protocol_version)
         ::sscanf(pServerInfo->protocol_version, "%d.%d",
             &result.major, &result.minor);
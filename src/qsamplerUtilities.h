@@ -25,6 +25,8 @@
 
 #include <QString>
 
+#include <lscp/client.h>
+
 
 namespace qsamplerUtilities {
 
@@ -38,7 +40,13 @@ QString lscpEscapedPathToPosix(QString path);
 QString lscpEscapeText(const QString& txt);
 QString lscpEscapedTextToRaw(QString txt);
 
+// Thread-safe variants, for an already known server version.
+QString lscpEscapePath(const QString& sPath, const lscpVersion_t& version);
+QString lscpEscapedPathToPosix(QString path, const lscpVersion_t& version);
+QString lscpEscapedTextToRaw(QString txt, const lscpVersion_t& version);
+
 lscpVersion_t getRemoteLscpVersion();
+lscpVersion_t getRemoteLscpVersion(lscp_client_t *pClient);
 
 } // namespace qsamplerUtilities
 
@@ -13,20 +13,48 @@ HEADERS += config.h \
 	qsamplerAbout.h \
 	qsamplerOptions.h \
 	qsamplerChannel.h \
+	qsamplerChannelTemplate.h \
 	qsamplerMessages.h \
 	qsamplerInstrument.h \
 	qsamplerInstrumentList.h \
+	qsamplerMapChecker.h \
+	qsamplerInstrumentCache.h \
+	qsamplerMapIndex.h \
+	qsamplerSession.h \
+	qsamplerSessionBundle.h \
+	qsamplerSessionStage.h \
+	qsamplerLoadHistory.h \
+	qsamplerLoadScheduler.h \
+	qsamplerServerProcess.h \
+	qsamplerServerCall.h \
+	qsamplerServerCaps.h \
+	qsamplerResources.h \
+	qsamplerLoadBalancer.h \
+	qsamplerMirror.h \
+	qsamplerMidiFile.h \
+	qsamplerLoadTest.h \
+	qsamplerScript.h \
 	qsamplerDevice.h \
+	qsamplerDbImport.h \
 	qsamplerFxSend.h \
 	qsamplerFxSendsModel.h \
 	qsamplerUtilities.h \
 	qsamplerInstrumentForm.h \
 	qsamplerInstrumentListForm.h \
+	qsamplerMapCheckForm.h \
 	qsamplerDeviceForm.h \
 	qsamplerDeviceStatusForm.h \
+	qsamplerEventsForm.h \
+	qsamplerEventsGraph.h \
+	qsamplerSwitchesForm.h \
+	qsamplerStorageForm.h \
+	qsamplerLoadTestForm.h \
 	qsamplerChannelStrip.h \
 	qsamplerChannelForm.h \
 	qsamplerChannelFxForm.h \
+	qsamplerChannelTemplateForm.h \
+	qsamplerDbImportForm.h \
+	qsamplerResourcesForm.h \
 	qsamplerOptionsForm.h \
 	qsamplerMainForm.h
 
@@ -34,20 +62,48 @@ SOURCES += \
 	qsampler.cpp \
 	qsamplerOptions.cpp \
 	qsamplerChannel.cpp \
+	qsamplerChannelTemplate.cpp \
 	qsamplerMessages.cpp \
 	qsamplerInstrument.cpp \
 	qsamplerInstrumentList.cpp \
+	qsamplerMapChecker.cpp \
+	qsamplerInstrumentCache.cpp \
+	qsamplerMapIndex.cpp \
+	qsamplerSession.cpp \
+	qsamplerSessionBundle.cpp \
+	qsamplerSessionStage.cpp \
+	qsamplerLoadHistory.cpp \
+	qsamplerLoadScheduler.cpp \
+	qsamplerServerProcess.cpp \
+	qsamplerServerCall.cpp \
+	qsamplerServerCaps.cpp \
+	qsamplerResources.cpp \
+	qsamplerLoadBalancer.cpp \
+	qsamplerMirror.cpp \
+	qsamplerMidiFile.cpp \
+	qsamplerLoadTest.cpp \
+	qsamplerScript.cpp \
 	qsamplerDevice.cpp \
+	qsamplerDbImport.cpp \
 	qsamplerFxSend.cpp \
 	qsamplerFxSendsModel.cpp \
 	qsamplerUtilities.cpp \
 	qsamplerInstrumentForm.cpp \
 	qsamplerInstrumentListForm.cpp \
+	qsamplerMapCheckForm.cpp \
 	qsamplerDeviceForm.cpp \
 	qsamplerDeviceStatusForm.cpp \
+	qsamplerEventsForm.cpp \
+	qsamplerEventsGraph.cpp \
+	qsamplerSwitchesForm.cpp \
+	qsamplerStorageForm.cpp \
+	qsamplerLoadTestForm.cpp \
 	qsamplerChannelStrip.cpp \
 	qsamplerChannelForm.cpp \
 	qsamplerChannelFxForm.cpp \
+	qsamplerChannelTemplateForm.cpp \
+	qsamplerDbImportForm.cpp \
+	qsamplerResourcesForm.cpp \
 	qsamplerOptionsForm.cpp \
 	qsamplerMainForm.cpp
 
@@ -58,6 +114,14 @@ FORMS += \
 	qsamplerChannelStrip.ui \
 	qsamplerChannelForm.ui \
 	qsamplerChannelFxForm.ui \
+	qsamplerEventsForm.ui \
+	qsamplerSwitchesForm.ui \
+	qsamplerStorageForm.ui \
+	qsamplerLoadTestForm.ui \
+	qsamplerDbImportForm.ui \
+	qsamplerResourcesForm.ui \
+	qsamplerChannelTemplateForm.ui \
+	qsamplerMapCheckForm.ui \
 	qsamplerOptionsForm.ui \
 	qsamplerMainForm.ui
 